@@ -6,6 +6,7 @@
 #include "Core/Log.h"
 #include "Core/Camera.h"
 #include "Physics/PhysicsSystem.h"
+#include "Physics/WorldBVH.h"
 
 XMMATRIX Actor::GetWorldMatrix() const
 {
@@ -140,9 +141,10 @@ Properties Actor::GetProps()
 	props.ownerUID = GetUID();
 	//Got the whitespace here because std::map orders by key, don't have time to make an ordered_map,
 	//meaning the whitespace will keep the transform values at the top of the props dock.
-	props.Add(" Position", &rootComponent->transform.position);
-	props.Add(" Scale", &rootComponent->transform.scale);
-	props.Add(" Rotation", &rootComponent->transform.rotation);
+	const auto markTransformDirty = [this](Property&) { rootComponent->MarkTransformDirty(); };
+	props.Add(" Position", &rootComponent->transform.position).change = markTransformDirty;
+	props.Add(" Scale", &rootComponent->transform.scale).change = markTransformDirty;
+	props.Add(" Rotation", &rootComponent->transform.rotation).change = markTransformDirty;
 	props.Add("UID", &uid).hide = true;
 	props.Add("Name", &_name).hide = true;
 	props.Add(" Enabled", &active);
@@ -266,11 +268,15 @@ void Actor::AddComponent(Component* component)
 
 	assert(componentMap.find(component->GetName()) == componentMap.end() && "Duplicate Component name (Actor::Create() might be being called twice).");
 	componentMap.emplace(component->GetName(), component);
+
+	//Meshes added at runtime need a raycast BVH proxy.
+	WorldBVH::MarkStale();
 }
 
 void Actor::RemoveComponent(Component* componentToRemove)
 {
 	componentMap.erase(componentToRemove->GetName());
+	WorldBVH::MarkStale();
 }
 
 bool Actor::CheckComponentExists(std::string componentName)
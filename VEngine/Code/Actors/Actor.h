@@ -6,6 +6,7 @@
 #include <set>
 #include "Core/Transform.h"
 #include "Core/Properties.h"
+#include "Core/PropertyTable.h"
 #include "Core/UID.h"
 
 class Component;
@@ -52,6 +53,9 @@ public:
 	virtual Properties GetProps() = 0;
 	std::vector<Properties> GetAllProps();
 
+	//The type's PropertyTable bound to this actor. Defined in ACTOR_SYSTEM, returns an invalid view otherwise.
+	virtual PropertyView GetPropertyView() { return {}; }
+
 	//called before all Start()'s
 	virtual void Awake() {}
 
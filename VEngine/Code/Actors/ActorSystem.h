@@ -9,8 +9,8 @@
 #include "Core/Serialiser.h"
 #include "Core/Deserialiser.h"
 #include "Core/BinarySerialiser.h"
-#include "Core/BinaryDeserialiser.h"
 #include "Components/Component.h"
+#include "Components/SpatialComponent.h"
 #include "Editor/Editor.h"
 #include "Core/VString.h"
 #include "Core/World.h"
@@ -153,42 +153,70 @@ public:
 
 		for (auto& actor : actors)
 		{
-			auto props = actor->GetProps();
-			//actor->ResetOwnerUIDToComponents();
-			s.Serialise(props);
+			const PropertyView view = GetPropertyView(actor.get());
+			if (view.IsValid())
+			{
+				s.Serialise(view);
+			}
+			else
+			{
+				auto props = actor->GetProps();
+				s.Serialise(props);
+			}
 			s.WriteLine(L"next");
 		}
 	}
 
 	virtual void SerialiseBinary(BinarySerialiser& s) override
 	{
-		s.WriteString(GetName());
-		size_t numActors = actors.size();
-		s.Write(&numActors);
+		s.BeginSystem(GetName(), WorldBinarySystemKind::Actor);
 
 		for (auto& actor : actors)
 		{
-			auto props = actor->GetProps();
-			s.Serialise(props);
+			const PropertyView view = GetPropertyView(actor.get());
+			if (view.IsValid())
+			{
+				s.Serialise(view);
+			}
+			else
+			{
+				auto props = actor->GetProps();
+				s.Serialise(props);
+			}
 		}
+
+		s.EndSystem();
 	}
 
 	virtual void Deserialise(Deserialiser& d) override
 	{
 		for (auto& actor : actors)
 		{
-			auto props = actor->GetProps();
-			d.Deserialise(props);
+			const PropertyView view = GetPropertyView(actor.get());
+			if (view.IsValid())
+			{
+				d.Deserialise(view);
+			}
+			else
+			{
+				auto props = actor->GetProps();
+				d.Deserialise(props);
+			}
 		}
 	}
 
-	virtual void DeserialiseBinary(BinaryDeserialiser& d) override
+	//The table is built from the first actor asked for, every T declares the same props in GetProps().
+	PropertyView GetPropertyView(T* actor)
 	{
-		for (auto& actor : actors)
+		Transform* rootTransform = &actor->GetRootComponent().transform;
+
+		if (!propertyTable.IsBuilt())
 		{
 			auto props = actor->GetProps();
-			d.Deserialise(props);
+			propertyTable.Build(props, actor, sizeof(T), rootTransform);
 		}
+
+		return { &propertyTable, actor, rootTransform, actor->GetUID() };
 	}
 
 	virtual Actor* FindActorByName(std::string actorName) override
@@ -210,6 +238,20 @@ public:
 		return actor;
 	}
 
+	//World loads give the actor its saved name and UID through its props and then add every loaded actor to the
+	//world in one go, so this skips the naming and registration Add() does.
+	virtual Actor* SpawnActorForWorldLoad() override
+	{
+		actors.emplace_back(std::make_unique<T>());
+		auto& actor = actors.back();
+
+		actor->SetActorSystem(this);
+		actor->SetSystemIndex(actors.size() - 1);
+		actor->SetTransform(Transform());
+
+		return actor.get();
+	}
+
 	virtual std::vector<Actor*> GetActorsAsBaseClass() override
 	{
 		std::vector<Actor*> outActors;
@@ -300,7 +342,9 @@ private:
 	std::vector<std::unique_ptr<T>> actors;
 	std::vector<Actor*> deletedActors;
 	std::unordered_set<size_t> actorIndexToDeferDestroy;
+	PropertyTable propertyTable;
 };
 
 #define ACTOR_SYSTEM(type) inline static ActorSystem<type> system; \
+virtual PropertyView GetPropertyView() override { return system.GetPropertyView(this); } \
 virtual void Remove() override { __super::Remove(); Destroy(); system.Remove(GetSystemIndex()); } \
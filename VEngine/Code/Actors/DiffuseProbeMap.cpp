@@ -2,6 +2,7 @@
 #include "DiffuseProbeMap.h"
 #include <filesystem>
 #include <algorithm>
+#include <cmath>
 #include "Core/World.h"
 #include "Core/Log.h"
 #include "Components/MeshComponent.h"
@@ -16,6 +17,7 @@ DiffuseProbeMap::DiffuseProbeMap()
 void DiffuseProbeMap::Create()
 {
 	ReadProbeDataFromFile();
+	SetupProbeLattice();
 
 	const auto probeCount = GetProbeCount();
 
@@ -37,9 +39,11 @@ Properties DiffuseProbeMap::GetProps()
 {
 	auto props = __super::GetProps();
 	props.title = GetTypeName();
-	props.Add("Size X", &sizeX);
-	props.Add("Size Y", &sizeY);
-	props.Add("Size Z", &sizeZ);
+	const auto setupProbeLattice = [this](Property&) { SetupProbeLattice(); };
+	props.Add("Size X", &sizeX).change = setupProbeLattice;
+	props.Add("Size Y", &sizeY).change = setupProbeLattice;
+	props.Add("Size Z", &sizeZ).change = setupProbeLattice;
+	props.Add("Blend Probes", &blendProbes);
 	return props;
 }
 
@@ -86,30 +90,159 @@ LightProbeInstanceData DiffuseProbeMap::GetProbeByIndex(int index)
 
 LightProbeInstanceData DiffuseProbeMap::FindClosestProbe(XMVECTOR pos)
 {
-	struct ProbeDist
+	if (!EnsureProbeLattice())
 	{
-		LightProbeInstanceData data;
-		float distance = 0.f;
-	};
+		return FindClosestProbeLinear(pos);
+	}
+
+	XMFLOAT3 localPos;
+	XMStoreFloat3(&localPos, pos - XMLoadFloat3(&latticeOrigin));
 
-	std::vector<ProbeDist> probeDistances;
+	//Probes sit on integer offsets from the origin, rounding gives the closest one.
+	const int x = std::clamp(static_cast<int>(std::round(localPos.x)), 0, latticeSizeX - 1);
+	const int y = std::clamp(static_cast<int>(std::round(localPos.y)), 0, latticeSizeY - 1);
+	const int z = std::clamp(static_cast<int>(std::round(localPos.z)), 0, latticeSizeZ - 1);
+
+	return lightProbeData[GetLatticeIndex(x, y, z)];
+}
 
-	for (auto& probe : lightProbeData)
+bool DiffuseProbeMap::GetSurroundingProbes(XMVECTOR pos, int outIndices[8], XMFLOAT3& outCellFraction)
+{
+	if (!EnsureProbeLattice())
 	{
-		const float distance = XMVector3Length(XMLoadFloat3(&probe.position) - pos).m128_f32[0];
-		ProbeDist probeDist;
-		probeDist.distance = distance;
-		probeDist.data = probe;
-		probeDistances.emplace_back(probeDist);
+		return false;
 	}
 
-	auto ProbeDistCompare = [](const ProbeDist& l, const ProbeDist& r) -> bool {
-		return l.distance < r.distance;
+	XMFLOAT3 localPos;
+	XMStoreFloat3(&localPos, pos - XMLoadFloat3(&latticeOrigin));
+
+	//Cell corners and fraction along one axis. Single probe axes collapse onto probe 0.
+	const auto GetAxisCell = [](float local, int size, int& lower, int& upper, float& fraction)
+		{
+			const float clamped = std::clamp(local, 0.f, static_cast<float>(size - 1));
+			lower = std::min(static_cast<int>(clamped), std::max(size - 2, 0));
+			upper = std::min(lower + 1, size - 1);
+			fraction = upper > lower ? clamped - static_cast<float>(lower) : 0.f;
 		};
 
-	std::sort(probeDistances.begin(), probeDistances.end(), ProbeDistCompare);
+	int x[2], y[2], z[2];
+	GetAxisCell(localPos.x, latticeSizeX, x[0], x[1], outCellFraction.x);
+	GetAxisCell(localPos.y, latticeSizeY, y[0], y[1], outCellFraction.y);
+	GetAxisCell(localPos.z, latticeSizeZ, z[0], z[1], outCellFraction.z);
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		outIndices[corner] = GetLatticeIndex(x[corner & 1], y[(corner >> 1) & 1], z[(corner >> 2) & 1]);
+	}
+
+	return true;
+}
+
+void DiffuseProbeMap::SampleProbeSH(XMVECTOR pos, XMFLOAT4 outSH[9])
+{
+	int corners[8];
+	XMFLOAT3 fraction;
+	if (!blendProbes || !GetSurroundingProbes(pos, corners, fraction))
+	{
+		const LightProbeInstanceData closestProbe = FindClosestProbe(pos);
+		memcpy(outSH, closestProbe.SH, sizeof(XMFLOAT4) * 9);
+		return;
+	}
+
+	//SH projection is linear, so a weighted sum of the coefficients is the blended irradiance.
+	//Coefficients are stored RGB interleaved per XMFLOAT4, blending them as vectors covers all three channels
+	//at once rather than going through XMSHScale/XMSHAdd per channel.
+	XMVECTOR blendedSH[9] = {};
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		const float weight =
+			((corner & 1) ? fraction.x : 1.f - fraction.x) *
+			((corner & 2) ? fraction.y : 1.f - fraction.y) *
+			((corner & 4) ? fraction.z : 1.f - fraction.z);
+		if (weight <= 0.f)
+		{
+			continue;
+		}
+
+		const XMVECTOR weightV = XMVectorReplicate(weight);
+		const LightProbeInstanceData& probe = lightProbeData[corners[corner]];
+		for (int i = 0; i < 9; i++)
+		{
+			blendedSH[i] = XMVectorMultiplyAdd(XMLoadFloat4(&probe.SH[i]), weightV, blendedSH[i]);
+		}
+	}
+
+	for (int i = 0; i < 9; i++)
+	{
+		XMStoreFloat4(&outSH[i], blendedSH[i]);
+	}
+}
+
+LightProbeInstanceData DiffuseProbeMap::FindClosestProbeLinear(XMVECTOR pos)
+{
+	if (lightProbeData.empty())
+	{
+		return LightProbeInstanceData();
+	}
+
+	size_t closestIndex = 0;
+	float closestDistanceSq = FLT_MAX;
+
+	for (size_t i = 0; i < lightProbeData.size(); i++)
+	{
+		const float distanceSq = XMVectorGetX(XMVector3LengthSq(XMLoadFloat3(&lightProbeData[i].position) - pos));
+		if (distanceSq < closestDistanceSq)
+		{
+			closestDistanceSq = distanceSq;
+			closestIndex = i;
+		}
+	}
+
+	return lightProbeData[closestIndex];
+}
+
+bool DiffuseProbeMap::EnsureProbeLattice()
+{
+	if (sizeX != latticeSizeX || sizeY != latticeSizeY || sizeZ != latticeSizeZ ||
+		lightProbeData.size() != latticeProbeCount)
+	{
+		SetupProbeLattice();
+	}
+
+	return isLatticeValid;
+}
+
+void DiffuseProbeMap::SetupProbeLattice()
+{
+	isLatticeValid = false;
+	latticeSizeX = sizeX;
+	latticeSizeY = sizeY;
+	latticeSizeZ = sizeZ;
+	latticeProbeCount = lightProbeData.size();
+
+	if (sizeX <= 0 || sizeY <= 0 || sizeZ <= 0 || lightProbeData.empty() || lightProbeData.size() != GetProbeCount())
+	{
+		Log("DiffuseProbeMap [%s] probe data doesn't match its %dx%dx%d size, falling back to linear probe search. Rebake probes.",
+			GetName().c_str(), sizeX, sizeY, sizeZ);
+		return;
+	}
+
+	//Probe 0 is the lattice's min corner and the last probe its max corner, if both line up the rest do too.
+	latticeOrigin = lightProbeData.front().position;
+
+	const XMVECTOR expectedLastPosition = XMLoadFloat3(&latticeOrigin) +
+		XMVectorSet(static_cast<float>(sizeX - 1), static_cast<float>(sizeY - 1), static_cast<float>(sizeZ - 1), 0.f);
+	const XMVECTOR lastPosition = XMLoadFloat3(&lightProbeData.back().position);
+
+	if (!XMVector3NearEqual(lastPosition, expectedLastPosition, XMVectorReplicate(0.01f)))
+	{
+		Log("DiffuseProbeMap [%s] probes aren't laid out on a unit lattice, falling back to linear probe search.",
+			GetName().c_str());
+		return;
+	}
 
-	return probeDistances.front().data;
+	isLatticeValid = true;
 }
 
 void DiffuseProbeMap::WriteProbeDataToFile()
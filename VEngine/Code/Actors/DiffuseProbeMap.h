@@ -18,6 +18,7 @@ struct ID3D11ShaderResourceView;
 //		Renderer will render out cubemaps for every probe in the world and setup all spherical harmonic data.
 //		SH data at this point is just a single ambient colour per probe. Meshes will take its closest light probe
 //		and add its colour to its pixel output.
+//		'BAKE CPU' does the same by tracing rays on the CPU (see ProbeBake.h).
 //4. Reload the world 
 
 //There are a fuckload of references to do with GI, SH, Lightmapping and whatever else. Here are the best ones.
@@ -46,6 +47,14 @@ public:
 	uint32_t GetProbeCount();
 	LightProbeInstanceData GetProbeByIndex(int index);
 	LightProbeInstanceData FindClosestProbe(XMVECTOR pos);
+
+	//Gets the 8 probes of the lattice cell around pos (corner bit 0 = +X, bit 1 = +Y, bit 2 = +Z) and the
+	//position's fraction across the cell on each axis. Positions outside the lattice are clamped to its edges.
+	//Returns false if the probe data doesn't match the lattice (e.g. sizes changed since the last bake).
+	bool GetSurroundingProbes(XMVECTOR pos, int outIndices[8], XMFLOAT3& outCellFraction);
+
+	//Trilinearly blends the SH of the surrounding probes, or takes the closest probe's SH if blending is off.
+	void SampleProbeSH(XMVECTOR pos, XMFLOAT4 outSH[9]);
 	void WriteProbeDataToFile();
 
 	ID3D11Buffer* GetStructuredBuffer() { return structuredBuffer.Get(); }
@@ -63,6 +72,15 @@ private:
 
 	void AssignStaticMeshesLightProbeIndex();
 
+	void SetupProbeLattice();
+
+	//Re-runs SetupProbeLattice() if the sizes or the probe data count changed since it last ran
+	//(props edited, probes rebaked or reloaded), returns whether the lattice can be indexed.
+	bool EnsureProbeLattice();
+
+	int GetLatticeIndex(int x, int y, int z) const { return (x * latticeSizeY + y) * latticeSizeZ + z; }
+	LightProbeInstanceData FindClosestProbeLinear(XMVECTOR pos);
+
 	Microsoft::WRL::ComPtr<ID3D11Buffer> structuredBuffer;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
 
@@ -73,4 +91,16 @@ private:
 	int sizeX = 1;
 	int sizeY = 1;
 	int sizeZ = 1;
+
+	//Position of probe 0, probes are 1 unit apart from there.
+	XMFLOAT3 latticeOrigin = XMFLOAT3(0.f, 0.f, 0.f);
+	bool isLatticeValid = false;
+
+	//What SetupProbeLattice() last ran with.
+	int latticeSizeX = 0;
+	int latticeSizeY = 0;
+	int latticeSizeZ = 0;
+	size_t latticeProbeCount = 0;
+
+	bool blendProbes = true;
 };
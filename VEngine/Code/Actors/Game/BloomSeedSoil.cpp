@@ -22,17 +22,17 @@ void BloomSeedSoil::Create()
 	boxTrigger->AddLocalPosition(XMVectorSet(0.f, 1.f, 0.f, 1.f));
 }
 
-void BloomSeedSoil::Tick(float deltaTime)
+void BloomSeedSoil::Start()
 {
-	__super::Tick(deltaTime);
+	__super::Start();
 
-	for (auto& bloomSeed : BloomSeed::system.GetActors())
-	{
-		if (boxTrigger->Contains(bloomSeed->GetPositionV()))
+	boxTrigger->SetActorEnterCallback([](Actor* actor)
 		{
-			bloomSeed->Plant();
-		}
-	}
+			if (auto bloomSeed = dynamic_cast<BloomSeed*>(actor))
+			{
+				bloomSeed->Plant();
+			}
+		});
 }
 
 Properties BloomSeedSoil::GetProps()
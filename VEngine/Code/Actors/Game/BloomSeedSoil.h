@@ -13,7 +13,7 @@ public:
 	ACTOR_SYSTEM(BloomSeedSoil);
 	BloomSeedSoil();
 	void Create() override;
-	void Tick(float deltaTime) override;
+	void Start() override;
 	Properties GetProps() override;
 
 private:
@@ -1,7 +1,6 @@
 #include "vpch.h"
 #include "Grid.h"
 #include "Components/InstanceMeshComponent.h"
-#include "Render/RenderUtils.h"
 #include "Render/Material.h"
 #include "Render/BlendStates.h"
 #include "Physics/Raycast.h"
@@ -107,25 +106,14 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 		}
 	}
 
-	nodeMesh->ReleaseBuffers();
-
-	//Set the mesh count as 1 and empty the data just to put dummy data into the buffers
-	nodeMesh->GetInstanceData().clear();
-	nodeMesh->GetInstanceData().emplace_back(InstanceData());
-
 	int meshInstanceCount = sizeX * sizeY;
 	nodeMesh->SetInstanceCount(meshInstanceCount);
 
-	//Re-setup shader buffers
-	RenderUtils::CreateStructuredBuffer(sizeof(InstanceData) * meshInstanceCount,
-		sizeof(InstanceData), nodeMesh->GetInstanceData().data(), nodeMesh->structuredBuffer);
-
-	RenderUtils::CreateSRVForMeshInstance(nodeMesh->structuredBuffer.Get(), meshInstanceCount, nodeMesh->srv);
+	//Built up here and handed over at the end, the mesh keeps its buffers and only grows them if needed.
+	std::vector<InstanceData> nodeInstances;
+	nodeInstances.reserve(meshInstanceCount);
 
 	const XMMATRIX rootWorldMatrix = GetRootComponent().GetWorldMatrix();
-	XMVECTOR rayOrigin = XMVectorZero();
-
-	nodeMesh->GetInstanceData().clear();
 
 	//Ignore player and units
 	hit.ignoreLayer = CollisionLayers::Editor;
@@ -154,6 +142,20 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 		}
 	}
 
+	//Raycast against the world for every node position in one batch, node (x, y) is at x * sizeY + y.
+	std::vector<Physics::BatchRay> rays;
+	rays.reserve(meshInstanceCount);
+	for (int x = 0; x < sizeX; x++)
+	{
+		for (int y = 0; y < sizeY; y++)
+		{
+			rays.emplace_back(Physics::BatchRay{ XMVectorSet(x, 20.f, y, 1.f), -VMath::GlobalUpVector(), 40.0f });
+		}
+	}
+
+	std::vector<HitResult> nodeHits;
+	Physics::RaycastBatch(rays, Physics::RaycastFilter(hit), nodeHits);
+
 	rows.clear();
 
 	for (int x = 0; x < sizeX; x++)
@@ -163,27 +165,22 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 
 		for (int y = 0; y < sizeY; y++)
 		{
-			rayOrigin = XMVectorSet(x, 20.f, y, 1.f);
+			const HitResult& nodeHit = nodeHits[x * sizeY + y];
 
 			//Set instance model matrix
 			InstanceData instanceData = {};
 			instanceData.world = rootWorldMatrix;
 
 			//create grid node in row
-			GridNode node = GridNode(x, y, nodeMesh->GetInstanceData().size());
+			GridNode node = GridNode(x, y, nodeInstances.size());
 
 			instanceData.colour = GridNode::normalColour;
 
-			hit.hitActor = nullptr;
-			hit.hitActors.clear();
-			hit.hitComponent = nullptr;
-			hit.hitComponents.clear();
-
-			//raycast against the world to set node position
-			if (Physics::Raycast(hit, rayOrigin, -VMath::GlobalUpVector(), 40.0f))
+			//Set node position from the raycast against the world
+			if (nodeHit.bHit)
 			{
 				//Position the node at the raycast's hitpos
-				XMFLOAT3 hitPos = hit.hitPos;
+				XMFLOAT3 hitPos = nodeHit.hitPos;
 				hitPos.y += 0.1f;
 				XMVECTOR hitPosVector = XMLoadFloat3(&hitPos);
 				hitPosVector.m128_f32[3] = 1.0f;
@@ -193,7 +190,7 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 				node.worldPosition.y = hitPos.y + 0.4f;
 
 				//Make node rotation match the hit normal.
-				instanceData.world = VMath::MakeRotationFromYAxis(hit.GetNormalV());
+				instanceData.world = VMath::MakeRotationFromYAxis(nodeHit.GetNormalV());
 				instanceData.world.r[3] = hitPosVector;
 
 				if (preserveNodeScaleValues)
@@ -212,9 +209,9 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 
 				node.active = true;
 
-				if (hit.hitActor)
+				if (nodeHit.hitActor)
 				{
-					auto meshes = hit.hitActor->GetComponents<MeshComponent>();
+					auto meshes = nodeHit.hitActor->GetComponents<MeshComponent>();
 					for (auto mesh : meshes)
 					{
 						if (mesh->gridObstacle)
@@ -232,12 +229,14 @@ void Grid::RecalcAllNodes(HitResult& hit, bool preserveNodeScaleValues)
 				node.active = false;
 			}
 
-			nodeMesh->GetInstanceData().emplace_back(instanceData);
+			nodeInstances.emplace_back(instanceData);
 
 			//Add node to column
 			rows[x].Add(node);
 		}
 	}
+
+	nodeMesh->SetInstanceData(nodeInstances);
 }
 
 void Grid::RecalcNodesToIgnoreLinkedGridActor(GridActor* gridActorToIgnore)
@@ -518,9 +517,9 @@ void Grid::DisplayShowAllNodes()
 	}
 }
 
-std::vector<InstanceData>& Grid::GetNodeMeshInstanceData()
+InstanceData& Grid::GetNodeMeshInstance(size_t index)
 {
-	return nodeMesh->GetInstanceData();
+	return nodeMesh->GetInstance(index);
 }
 
 void Grid::SetGridSize(int x, int y)
@@ -531,8 +530,6 @@ void Grid::SetGridSize(int x, int y)
 
 void Grid::SetAllNodesToCurrentLerpValue()
 {
-	auto& instanceData = nodeMesh->GetInstanceData();
-
 	for (auto& row : rows)
 	{
 		for (auto& node : row.columns)
@@ -542,7 +539,7 @@ void Grid::SetAllNodesToCurrentLerpValue()
 				continue;
 			}
 
-			XMMATRIX& worldMatrix = instanceData.at(node.instancedMeshIndex).world;
+			XMMATRIX& worldMatrix = nodeMesh->GetInstance(node.instancedMeshIndex).world;
 			worldMatrix.r[0].m128_f32[0] = currentLerpValue;
 			worldMatrix.r[1].m128_f32[1] = currentLerpValue;
 			worldMatrix.r[2].m128_f32[2] = currentLerpValue;
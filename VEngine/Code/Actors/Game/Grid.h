@@ -92,7 +92,8 @@ public:
 	void DisplayHideAllNodes();
 	void DisplayShowAllNodes();
 
-	std::vector<InstanceData>& GetNodeMeshInstanceData();
+	//Flags the node's instance as changed so that it gets uploaded.
+	InstanceData& GetNodeMeshInstance(size_t index);
 
 	auto GetSizeX() const { return sizeX; }
 	auto GetSizeY() const { return sizeY; }
@@ -22,21 +22,26 @@ void Lift::Create()
 	SetMeshFilename("node.vmesh");
 }
 
-void Lift::Tick(float deltaTime)
+void Lift::Start()
 {
-	__super::Tick(deltaTime);
+	__super::Start();
 
-	for (auto gridActor : World::GetAllActorsAsBaseType<GridActor>())
-	{
-		if (liftTrigger->Contains(gridActor->GetPositionV()))
+	liftTrigger->SetActorEnterCallback([this](Actor* actor)
 		{
-			gridActor->SetCanFall(false);
-		}
-		else
+			auto gridActor = dynamic_cast<GridActor*>(actor);
+			if (gridActor && gridActor != this)
+			{
+				gridActor->SetCanFall(false);
+			}
+		});
+	liftTrigger->SetActorExitCallback([this](Actor* actor)
 		{
-			gridActor->SetCanFall(true);
-		}
-	}
+			auto gridActor = dynamic_cast<GridActor*>(actor);
+			if (gridActor && gridActor != this)
+			{
+				gridActor->SetCanFall(true);
+			}
+		});
 }
 
 Properties Lift::GetProps()
@@ -48,17 +53,7 @@ Properties Lift::GetProps()
 
 std::vector<GridActor*> Lift::GetGridActorsContainedInLiftTrigger()
 {
-	std::vector<GridActor*> gridActors;
-	for (auto gridActor : World::GetAllActorsAsBaseType<GridActor>())
-	{
-		if (gridActor == this) //Ignore self
-		{
-			continue;
-		}
-		if (liftTrigger->Contains(gridActor->GetPositionV()))
-		{
-			gridActors.emplace_back(gridActor);
-		}
-	}
+	std::vector<GridActor*> gridActors = liftTrigger->GetOverlappingActors<GridActor>();
+	std::erase(gridActors, this); //Ignore self
 	return gridActors;
 }
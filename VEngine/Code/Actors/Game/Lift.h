@@ -12,7 +12,7 @@ public:
 
 	Lift();
 	void Create() override;
-	void Tick(float deltaTime) override;
+	void Start() override;
 	Properties GetProps() override;
 
 	std::vector<GridActor*> GetGridActorsContainedInLiftTrigger();
@@ -23,23 +23,17 @@ void MinesGenerator::Create()
 	crystalTrigger->SetLocalPosition(1.f, 0.f, 0.f);
 }
 
-void MinesGenerator::Tick(float deltaTime)
+void MinesGenerator::Start()
 {
-	__super::Tick(deltaTime);
+	__super::Start();
 
-	if (isGeneratorOn)
-	{
-		return;
-	}
-
-	for (auto& crystal : PowerCrystal::system.GetActors())
-	{
-		if (crystalTrigger->Contains(crystal->GetPositionV()))
+	crystalTrigger->SetActorEnterCallback([this](Actor* actor)
 		{
-			PowerOnGenerator();
-			return;
-		}
-	}
+			if (!isGeneratorOn && dynamic_cast<PowerCrystal*>(actor))
+			{
+				PowerOnGenerator();
+			}
+		});
 }
 
 Properties MinesGenerator::GetProps()
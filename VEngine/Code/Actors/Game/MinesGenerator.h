@@ -15,7 +15,7 @@ public:
 
 	MinesGenerator();
 	void Create() override;
-	void Tick(float deltaTime) override;
+	void Start() override;
 	Properties GetProps() override;
 
 private:
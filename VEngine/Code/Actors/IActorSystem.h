@@ -6,7 +6,6 @@ class Actor;
 class Serialiser;
 class BinarySerialiser;
 class Deserialiser;
-class BinaryDeserialiser;
 struct Transform;
 
 class IActorSystem
@@ -19,6 +18,7 @@ public:
 	std::string GetName() { return _name; }
 	virtual std::vector<Actor*> GetActorsAsBaseClass() = 0;
 	virtual Actor* SpawnActor(const Transform& transform) = 0;
+	virtual Actor* SpawnActorForWorldLoad() = 0;
 	virtual Actor* FindActorByName(std::string actorName) = 0;
 	virtual size_t GetNumActors() = 0;
 	virtual void DeferActorForDestroy(size_t index) = 0;
@@ -35,7 +35,6 @@ public:
 	virtual void Serialise(Serialiser& s) = 0;
 	virtual void SerialiseBinary(BinarySerialiser& s) = 0;
 	virtual void Deserialise(Deserialiser& s) = 0;
-	virtual void DeserialiseBinary(BinaryDeserialiser& s) = 0;
 	virtual void Cleanup() = 0;
 
 protected:
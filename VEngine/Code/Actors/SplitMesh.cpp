@@ -25,7 +25,7 @@ void SplitMesh::CreateSplitMesh(std::vector<Vertex>& meshVerts, MeshComponent* o
 	mesh->SetRastState(RastStates::noBackCull);
 
 	//Call 'new' here, can't just give the vertices a pointer to nothing
-	mesh->meshDataProxy.vertices = meshVerts;
+	mesh->meshDataProxy.SetVertices(meshVerts);
 
 	mesh->SetPhysicsStatic(false);
 
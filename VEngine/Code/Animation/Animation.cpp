@@ -6,6 +6,11 @@ using namespace DirectX;
 
 float Animation::GetFinalTime()
 {
+	if (frames.empty())
+	{
+		return clip.duration;
+	}
+
 	float highestTime = 0.f;
 
 	for (auto& framePair : frames)
@@ -22,6 +27,16 @@ float Animation::GetFinalTime()
 	return highestTime;
 }
 
+const AnimationClip& Animation::GetClip()
+{
+	if (clipDirty)
+	{
+		clip.Build(*this);
+		clipDirty = false;
+	}
+	return clip;
+}
+
 void Animation::Interpolate(float t, Joint& joint, std::vector<Joint>& joints)
 {
 	if (!isPlaying)
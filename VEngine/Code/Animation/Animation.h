@@ -3,6 +3,7 @@
 #include <map>
 #include <vector>
 #include "AnimFrame.h"
+#include "AnimationClip.h"
 #include "Joint.h"
 
 class Animation
@@ -37,15 +38,32 @@ public:
 	auto& GetFrame(int jointIndex) { return frames.find(jointIndex)->second; }
 	auto& GetFrames() { return frames; }
 
-	void AddFrame(Joint::JointIndex index, std::vector<AnimFrame>& frame) { frames.emplace(index, frame); }
-	bool HasFrames() { return frames.size() > 0; }
+	void AddFrame(Joint::JointIndex index, std::vector<AnimFrame>& frame)
+	{
+		frames.emplace(index, frame);
+		clipDirty = true;
+	}
+	bool HasFrames() { return frames.size() > 0 || !clip.Empty(); }
 
 	float GetFinalTime();
 
+	//Linear search through the joint's frames. AnimationSampler is the faster path for playback.
 	void Interpolate(float t, Joint& joint, std::vector<Joint>& joints);
 
+	//Flattened frames for AnimationSampler, rebuilt on first call after frames are added.
+	const AnimationClip& GetClip();
+
+	//For animations decoded straight into a clip (.vanim v2), these have no AnimFrames.
+	void SetClip(AnimationClip&& newClip)
+	{
+		clip = std::move(newClip);
+		clipDirty = false;
+	}
+
 private:
 	char name[ANIM_NAME_MAX]{};
 	std::map<Joint::JointIndex, std::vector<AnimFrame>> frames;
+	AnimationClip clip;
+	bool clipDirty = true;
 	bool isPlaying = true;
 };
@@ -0,0 +1,65 @@
+#include "vpch.h"
+#include "AnimationClip.h"
+#include "Animation.h"
+
+void AnimationClip::Build(Animation& animation)
+{
+	Clear();
+
+	auto& frames = animation.GetFrames();
+	if (frames.empty())
+	{
+		return;
+	}
+
+	//Frames are in a map ordered by joint index, so the last entry gives the track count.
+	const int trackCount = frames.rbegin()->first + 1;
+	tracks.resize(trackCount);
+
+	size_t keyCount = 0;
+	for (auto& [jointIndex, jointFrames] : frames)
+	{
+		keyCount += jointFrames.size();
+	}
+
+	times.reserve(keyCount);
+	rotations.reserve(keyCount);
+	translations.reserve(keyCount);
+	scales.reserve(keyCount);
+
+	for (auto& [jointIndex, jointFrames] : frames)
+	{
+		if (jointIndex < 0)
+		{
+			continue;
+		}
+
+		Track& track = tracks[jointIndex];
+		track.firstKey = (uint32_t)times.size();
+		track.keyCount = (uint32_t)jointFrames.size();
+
+		for (auto& frame : jointFrames)
+		{
+			times.emplace_back((float)frame.time);
+			rotations.emplace_back(frame.rot);
+			translations.emplace_back(frame.pos);
+			scales.emplace_back(frame.scale);
+
+			if (frame.time > duration)
+			{
+				duration = (float)frame.time;
+			}
+		}
+	}
+}
+
+void AnimationClip::Clear()
+{
+	tracks.clear();
+	times.clear();
+	rotations.clear();
+	translations.clear();
+	scales.clear();
+	duration = 0.f;
+	sampleRate = 0.f;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+
+class Animation;
+
+//Flat structure-of-arrays copy of an Animation's keyframes for sampling. Keys for every joint are packed
+//into the same rotation/translation/scale streams and each joint's track is a range into them.
+struct AnimationClip
+{
+	struct Track
+	{
+		uint32_t firstKey = 0;
+		uint32_t keyCount = 0;
+	};
+
+	//Indexed by joint index. Joints without keyframes have a keyCount of 0.
+	std::vector<Track> tracks;
+
+	std::vector<float> times;
+	std::vector<DirectX::XMFLOAT4> rotations; //Quaternions
+	std::vector<DirectX::XMFLOAT3> translations;
+	std::vector<DirectX::XMFLOAT3> scales;
+
+	float duration = 0.f;
+
+	//Non-zero when every animated track has a key at each 1/sampleRate step (from .vanim v2 files),
+	//which lets the sampler find keys without searching.
+	float sampleRate = 0.f;
+
+	void Build(Animation& animation);
+	void Clear();
+
+	bool Empty() const { return times.empty(); }
+};
@@ -0,0 +1,533 @@
+#include "vpch.h"
+#include "AnimationCompression.h"
+#include <algorithm>
+#include <cmath>
+#include "AnimationClip.h"
+#include "AnimationSampler.h"
+#include "Asset/AnimationAssetHeader.h"
+
+using namespace DirectX;
+
+static constexpr float quaternionComponentRange = 0.70710678f; //Smallest three are within +-1/sqrt(2)
+static constexpr uint32_t quaternionComponentMax = 0x7FFF;
+static constexpr uint32_t translationMax = 0xFFFF;
+
+//Uncompressed keys of one track, either copied from the clip or resampled.
+struct TrackKeys
+{
+	std::vector<float> times;
+	std::vector<XMFLOAT4> rotations;
+	std::vector<XMFLOAT3> translations;
+	std::vector<XMFLOAT3> scales;
+
+	size_t Size() const { return times.size(); }
+};
+
+template <typename T>
+static void WriteToBuffer(std::vector<uint8_t>& buffer, const T* data, size_t count)
+{
+	const auto bytes = reinterpret_cast<const uint8_t*>(data);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * count);
+}
+
+struct BufferReader
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	size_t offset = 0;
+
+	//Returns false without reading anything if there aren't count T's left.
+	template <typename T>
+	bool Read(T* out, size_t count)
+	{
+		if (count > (size - offset) / sizeof(T))
+		{
+			return false;
+		}
+
+		const size_t byteCount = sizeof(T) * count;
+		memcpy(out, data + offset, byteCount);
+		offset += byteCount;
+		return true;
+	}
+
+	size_t Remaining() const { return size - offset; }
+};
+
+//Bytes a track's streams take after its header, see CompressClip().
+static uint64_t GetTrackStreamSize(const AnimationTrackHeader& trackHeader, float sampleRate)
+{
+	const uint64_t keyCount = trackHeader.keyCount;
+	const uint64_t packedSize = sizeof(uint16_t) * 3;
+
+	uint64_t size = 0;
+	if (sampleRate <= 0.f && keyCount > 1)
+	{
+		size += sizeof(float) * keyCount;
+	}
+
+	size += trackHeader.rotation == AnimationTrackChannel::Animated ? packedSize * keyCount : packedSize;
+	size += trackHeader.translation == AnimationTrackChannel::Animated ?
+		sizeof(XMFLOAT3) * 2 + packedSize * keyCount : sizeof(XMFLOAT3);
+
+	if (trackHeader.scale == AnimationTrackChannel::Animated)
+	{
+		size += sizeof(XMFLOAT3) * keyCount;
+	}
+	else if (trackHeader.scale == AnimationTrackChannel::Constant)
+	{
+		size += sizeof(XMFLOAT3);
+	}
+
+	return size;
+}
+
+void AnimationCompression::PackQuaternion(const XMFLOAT4& q, uint16_t packed[3])
+{
+	XMFLOAT4 normalised;
+	XMStoreFloat4(&normalised, XMQuaternionNormalize(XMLoadFloat4(&q)));
+	const float components[4] = { normalised.x, normalised.y, normalised.z, normalised.w };
+
+	int largestIndex = 0;
+	for (int i = 1; i < 4; i++)
+	{
+		if (std::abs(components[i]) > std::abs(components[largestIndex]))
+		{
+			largestIndex = i;
+		}
+	}
+
+	//q and -q are the same rotation, flip so the dropped component is always positive
+	const float sign = components[largestIndex] < 0.f ? -1.f : 1.f;
+
+	int packedIndex = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largestIndex)
+		{
+			continue;
+		}
+
+		const float normalisedComponent = (components[i] * sign / quaternionComponentRange) * 0.5f + 0.5f;
+		const float clamped = std::clamp(normalisedComponent, 0.f, 1.f);
+		packed[packedIndex++] = (uint16_t)std::lround(clamped * quaternionComponentMax);
+	}
+
+	packed[0] |= (uint16_t)((largestIndex >> 1) << 15);
+	packed[1] |= (uint16_t)((largestIndex & 1) << 15);
+}
+
+XMFLOAT4 AnimationCompression::UnpackQuaternion(const uint16_t packed[3])
+{
+	const int largestIndex = ((packed[0] >> 15) << 1) | (packed[1] >> 15);
+
+	float components[4]{};
+	float sumOfSquares = 0.f;
+
+	int packedIndex = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (i == largestIndex)
+		{
+			continue;
+		}
+
+		const float normalisedComponent = (float)(packed[packedIndex++] & quaternionComponentMax) / quaternionComponentMax;
+		components[i] = (normalisedComponent * 2.f - 1.f) * quaternionComponentRange;
+		sumOfSquares += components[i] * components[i];
+	}
+
+	components[largestIndex] = std::sqrt(std::max(0.f, 1.f - sumOfSquares));
+
+	return XMFLOAT4(components[0], components[1], components[2], components[3]);
+}
+
+static TrackKeys GetTrackKeys(const AnimationClip& clip, AnimationSampler& sampler, int jointIndex, float sampleRate)
+{
+	TrackKeys keys;
+	const AnimationClip::Track& track = clip.tracks[jointIndex];
+
+	if (sampleRate > 0.f)
+	{
+		const uint32_t sampleCount = (uint32_t)std::ceil(clip.duration * sampleRate - 0.0001f) + 1;
+		for (uint32_t i = 0; i < sampleCount; i++)
+		{
+			const float t = std::min(i / sampleRate, clip.duration);
+
+			XMVECTOR scale, rot, pos;
+			sampler.SampleJoint(jointIndex, t, scale, rot, pos);
+
+			keys.times.emplace_back(t);
+			keys.rotations.emplace_back();
+			XMStoreFloat4(&keys.rotations.back(), rot);
+			keys.translations.emplace_back();
+			XMStoreFloat3(&keys.translations.back(), pos);
+			keys.scales.emplace_back();
+			XMStoreFloat3(&keys.scales.back(), scale);
+		}
+		return keys;
+	}
+
+	const auto first = track.firstKey;
+	const auto last = track.firstKey + track.keyCount;
+	keys.times.assign(clip.times.begin() + first, clip.times.begin() + last);
+	keys.rotations.assign(clip.rotations.begin() + first, clip.rotations.begin() + last);
+	keys.translations.assign(clip.translations.begin() + first, clip.translations.begin() + last);
+	keys.scales.assign(clip.scales.begin() + first, clip.scales.begin() + last);
+	return keys;
+}
+
+static float RotationError(FXMVECTOR a, FXMVECTOR b)
+{
+	const float dot = std::min(1.f, std::abs(XMVectorGetX(XMQuaternionDot(a, b))));
+	return 2.f * std::acos(dot);
+}
+
+static float Float3Error(FXMVECTOR a, FXMVECTOR b)
+{
+	return XMVectorGetX(XMVector3Length(a - b));
+}
+
+//Whether every key between first and last can be rebuilt by interpolating first and last.
+static bool CanInterpolateKeys(const TrackKeys& keys, size_t first, size_t last,
+	const AnimationCompression::Settings& settings)
+{
+	const float firstTime = keys.times[first];
+	const float timeRange = keys.times[last] - firstTime;
+
+	const XMVECTOR rot0 = XMLoadFloat4(&keys.rotations[first]);
+	const XMVECTOR rot1 = XMLoadFloat4(&keys.rotations[last]);
+	const XMVECTOR pos0 = XMLoadFloat3(&keys.translations[first]);
+	const XMVECTOR pos1 = XMLoadFloat3(&keys.translations[last]);
+	const XMVECTOR scale0 = XMLoadFloat3(&keys.scales[first]);
+	const XMVECTOR scale1 = XMLoadFloat3(&keys.scales[last]);
+
+	for (size_t i = first + 1; i < last; i++)
+	{
+		const float lerpPercent = timeRange > 0.f ? (keys.times[i] - firstTime) / timeRange : 0.f;
+
+		if (RotationError(XMQuaternionSlerp(rot0, rot1, lerpPercent), XMLoadFloat4(&keys.rotations[i])) > settings.rotationTolerance ||
+			Float3Error(XMVectorLerp(pos0, pos1, lerpPercent), XMLoadFloat3(&keys.translations[i])) > settings.translationTolerance ||
+			Float3Error(XMVectorLerp(scale0, scale1, lerpPercent), XMLoadFloat3(&keys.scales[i])) > settings.scaleTolerance)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//Greedily drops keys that linear interpolation between the kept keys reproduces within tolerance.
+static void ReduceKeys(TrackKeys& keys, const AnimationCompression::Settings& settings)
+{
+	if (keys.Size() <= 2)
+	{
+		return;
+	}
+
+	std::vector<size_t> keptKeys;
+	keptKeys.emplace_back(0);
+
+	size_t anchor = 0;
+	for (size_t candidate = 2; candidate < keys.Size(); candidate++)
+	{
+		if (!CanInterpolateKeys(keys, anchor, candidate, settings))
+		{
+			anchor = candidate - 1;
+			keptKeys.emplace_back(anchor);
+		}
+	}
+	keptKeys.emplace_back(keys.Size() - 1);
+
+	TrackKeys reduced;
+	for (size_t keyIndex : keptKeys)
+	{
+		reduced.times.emplace_back(keys.times[keyIndex]);
+		reduced.rotations.emplace_back(keys.rotations[keyIndex]);
+		reduced.translations.emplace_back(keys.translations[keyIndex]);
+		reduced.scales.emplace_back(keys.scales[keyIndex]);
+	}
+	keys = std::move(reduced);
+}
+
+static AnimationTrackChannel GetRotationChannel(const TrackKeys& keys, float tolerance)
+{
+	const XMVECTOR first = XMLoadFloat4(&keys.rotations[0]);
+	for (const auto& rotation : keys.rotations)
+	{
+		if (RotationError(first, XMLoadFloat4(&rotation)) > tolerance)
+		{
+			return AnimationTrackChannel::Animated;
+		}
+	}
+	return AnimationTrackChannel::Constant;
+}
+
+static AnimationTrackChannel GetFloat3Channel(const std::vector<XMFLOAT3>& values, float tolerance,
+	bool allowIdentity)
+{
+	const XMVECTOR first = XMLoadFloat3(&values[0]);
+	for (const auto& value : values)
+	{
+		if (Float3Error(first, XMLoadFloat3(&value)) > tolerance)
+		{
+			return AnimationTrackChannel::Animated;
+		}
+	}
+
+	if (allowIdentity && Float3Error(first, XMVectorSplatOne()) <= tolerance)
+	{
+		return AnimationTrackChannel::Identity;
+	}
+
+	return AnimationTrackChannel::Constant;
+}
+
+void AnimationCompression::CompressClip(const AnimationClip& clip, const Settings& settings,
+	AnimationClipHeader& header, std::vector<uint8_t>& buffer)
+{
+	header.duration = clip.duration;
+	header.sampleRate = settings.uniformSampleRate;
+	header.trackCount = 0;
+
+	AnimationSampler sampler;
+	sampler.SetClip(&clip);
+
+	for (int jointIndex = 0; jointIndex < (int)clip.tracks.size(); jointIndex++)
+	{
+		if (clip.tracks[jointIndex].keyCount == 0)
+		{
+			continue;
+		}
+
+		TrackKeys keys = GetTrackKeys(clip, sampler, jointIndex, settings.uniformSampleRate);
+		if (settings.uniformSampleRate <= 0.f)
+		{
+			ReduceKeys(keys, settings);
+		}
+
+		AnimationTrackHeader trackHeader;
+		trackHeader.jointIndex = jointIndex;
+		trackHeader.rotation = GetRotationChannel(keys, settings.rotationTolerance);
+		trackHeader.translation = GetFloat3Channel(keys.translations, settings.translationTolerance, false);
+		trackHeader.scale = GetFloat3Channel(keys.scales, settings.scaleTolerance, true);
+
+		const bool isConstantTrack = trackHeader.rotation != AnimationTrackChannel::Animated &&
+			trackHeader.translation != AnimationTrackChannel::Animated &&
+			trackHeader.scale != AnimationTrackChannel::Animated;
+		trackHeader.keyCount = isConstantTrack ? 1 : (uint32_t)keys.Size();
+
+		WriteToBuffer(buffer, &trackHeader, 1);
+
+		//Times
+		if (header.sampleRate <= 0.f && trackHeader.keyCount > 1)
+		{
+			WriteToBuffer(buffer, keys.times.data(), keys.times.size());
+		}
+
+		//Rotations
+		const size_t rotationCount = trackHeader.rotation == AnimationTrackChannel::Animated ? trackHeader.keyCount : 1;
+		for (size_t i = 0; i < rotationCount; i++)
+		{
+			uint16_t packed[3];
+			PackQuaternion(keys.rotations[i], packed);
+			WriteToBuffer(buffer, packed, 3);
+		}
+
+		//Translations
+		if (trackHeader.translation == AnimationTrackChannel::Animated)
+		{
+			XMVECTOR minV = XMLoadFloat3(&keys.translations[0]);
+			XMVECTOR maxV = minV;
+			for (const auto& translation : keys.translations)
+			{
+				minV = XMVectorMin(minV, XMLoadFloat3(&translation));
+				maxV = XMVectorMax(maxV, XMLoadFloat3(&translation));
+			}
+
+			XMFLOAT3 min, extent;
+			XMStoreFloat3(&min, minV);
+			XMStoreFloat3(&extent, maxV - minV);
+			WriteToBuffer(buffer, &min, 1);
+			WriteToBuffer(buffer, &extent, 1);
+
+			const XMVECTOR invExtent = XMVectorSelect(XMVectorReciprocal(maxV - minV), XMVectorZero(),
+				XMVectorEqual(maxV - minV, XMVectorZero()));
+
+			for (const auto& translation : keys.translations)
+			{
+				XMFLOAT3 normalised;
+				XMStoreFloat3(&normalised, XMVectorSaturate((XMLoadFloat3(&translation) - minV) * invExtent));
+				const uint16_t quantised[3] = {
+					(uint16_t)std::lround(normalised.x * translationMax),
+					(uint16_t)std::lround(normalised.y * translationMax),
+					(uint16_t)std::lround(normalised.z * translationMax) };
+				WriteToBuffer(buffer, quantised, 3);
+			}
+		}
+		else
+		{
+			WriteToBuffer(buffer, &keys.translations[0], 1);
+		}
+
+		//Scales
+		if (trackHeader.scale == AnimationTrackChannel::Animated)
+		{
+			WriteToBuffer(buffer, keys.scales.data(), keys.scales.size());
+		}
+		else if (trackHeader.scale == AnimationTrackChannel::Constant)
+		{
+			WriteToBuffer(buffer, &keys.scales[0], 1);
+		}
+
+		header.trackCount++;
+	}
+}
+
+bool AnimationCompression::DecompressClip(const AnimationClipHeader& header, const uint8_t* data, size_t dataSize,
+	uint32_t jointCount, AnimationClip& clip, size_t& bytesRead)
+{
+	clip.Clear();
+	clip.duration = header.duration;
+	clip.sampleRate = header.sampleRate;
+
+	BufferReader reader{ data, dataSize };
+	bytesRead = 0;
+
+	for (uint32_t trackIndex = 0; trackIndex < header.trackCount; trackIndex++)
+	{
+		AnimationTrackHeader trackHeader;
+		if (!reader.Read(&trackHeader, 1))
+		{
+			return false;
+		}
+
+		if (trackHeader.jointIndex < 0 || (uint32_t)trackHeader.jointIndex >= jointCount)
+		{
+			return false;
+		}
+
+		//Everything below grows the clip by keyCount, so make sure the keys are actually there first.
+		//Tracks with nothing animated are always written with a single key.
+		const bool hasAnimatedChannel = trackHeader.rotation == AnimationTrackChannel::Animated ||
+			trackHeader.translation == AnimationTrackChannel::Animated ||
+			trackHeader.scale == AnimationTrackChannel::Animated;
+		if (trackHeader.keyCount == 0 || (!hasAnimatedChannel && trackHeader.keyCount != 1) ||
+			GetTrackStreamSize(trackHeader, header.sampleRate) > reader.Remaining())
+		{
+			return false;
+		}
+
+		if (trackHeader.jointIndex >= (int)clip.tracks.size())
+		{
+			clip.tracks.resize(trackHeader.jointIndex + 1);
+		}
+
+		const uint32_t keyCount = trackHeader.keyCount;
+
+		AnimationClip::Track& track = clip.tracks[trackHeader.jointIndex];
+		track.firstKey = (uint32_t)clip.times.size();
+		track.keyCount = keyCount;
+
+		//Times
+		if (keyCount == 1)
+		{
+			clip.times.emplace_back(0.f);
+		}
+		else if (header.sampleRate > 0.f)
+		{
+			for (uint32_t i = 0; i < keyCount; i++)
+			{
+				clip.times.emplace_back(std::min(i / header.sampleRate, header.duration));
+			}
+		}
+		else
+		{
+			clip.times.resize(clip.times.size() + keyCount);
+			if (!reader.Read(&clip.times[track.firstKey], keyCount))
+			{
+				return false;
+			}
+		}
+
+		//Rotations
+		if (trackHeader.rotation == AnimationTrackChannel::Animated)
+		{
+			for (uint32_t i = 0; i < keyCount; i++)
+			{
+				uint16_t packed[3];
+				if (!reader.Read(packed, 3))
+				{
+					return false;
+				}
+				clip.rotations.emplace_back(UnpackQuaternion(packed));
+			}
+		}
+		else
+		{
+			uint16_t packed[3];
+			if (!reader.Read(packed, 3))
+			{
+				return false;
+			}
+			clip.rotations.insert(clip.rotations.end(), keyCount, UnpackQuaternion(packed));
+		}
+
+		//Translations
+		if (trackHeader.translation == AnimationTrackChannel::Animated)
+		{
+			XMFLOAT3 min, extent;
+			if (!reader.Read(&min, 1) || !reader.Read(&extent, 1))
+			{
+				return false;
+			}
+
+			const XMVECTOR minV = XMLoadFloat3(&min);
+			const XMVECTOR scaleV = XMLoadFloat3(&extent) / (float)translationMax;
+
+			for (uint32_t i = 0; i < keyCount; i++)
+			{
+				uint16_t quantised[3];
+				if (!reader.Read(quantised, 3))
+				{
+					return false;
+				}
+
+				const XMVECTOR quantisedV = XMVectorSet(quantised[0], quantised[1], quantised[2], 0.f);
+				clip.translations.emplace_back();
+				XMStoreFloat3(&clip.translations.back(), XMVectorMultiplyAdd(quantisedV, scaleV, minV));
+			}
+		}
+		else
+		{
+			XMFLOAT3 translation;
+			if (!reader.Read(&translation, 1))
+			{
+				return false;
+			}
+			clip.translations.insert(clip.translations.end(), keyCount, translation);
+		}
+
+		//Scales
+		if (trackHeader.scale == AnimationTrackChannel::Animated)
+		{
+			clip.scales.resize(clip.scales.size() + keyCount);
+			if (!reader.Read(&clip.scales[track.firstKey], keyCount))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			XMFLOAT3 scale(1.f, 1.f, 1.f);
+			if (trackHeader.scale == AnimationTrackChannel::Constant && !reader.Read(&scale, 1))
+			{
+				return false;
+			}
+			clip.scales.insert(clip.scales.end(), keyCount, scale);
+		}
+	}
+
+	bytesRead = reader.offset;
+	return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <DirectXMath.h>
+
+struct AnimationClip;
+struct AnimationClipHeader;
+
+//Encoding for .vanim v2 tracks.
+//Rotations are smallest-three quantised (the largest component is dropped and rebuilt, the other three are
+//15 bits each, 6 bytes a key). Translations are 16 bits per axis within the track's bounds. Scales are raw floats.
+//Channels that don't change over a track store one value, and scales that stay at 1 store nothing.
+namespace AnimationCompression
+{
+	struct Settings
+	{
+		//Keys that can be rebuilt from their neighbours within these are dropped.
+		float translationTolerance = 0.0005f;
+		float rotationTolerance = 0.0005f; //Radians
+		float scaleTolerance = 0.0005f;
+
+		//Resample every track at this rate and drop key times from the file. Keys aren't reduced when set.
+		//0 keeps (reduced) per-key times.
+		float uniformSampleRate = 0.f;
+	};
+
+	//Appends the encoded tracks of clip to buffer and fills in the trackCount/duration/sampleRate of header.
+	void CompressClip(const AnimationClip& clip, const Settings& settings, AnimationClipHeader& header,
+		std::vector<uint8_t>& buffer);
+
+	//Decodes header.trackCount tracks starting at data into clip, ready for AnimationSampler.
+	//Returns false if the tracks run past dataSize, are for joints at or past jointCount or are otherwise
+	//malformed. Nothing is allocated for keys that aren't in data. clip is left partially filled on failure.
+	bool DecompressClip(const AnimationClipHeader& header, const uint8_t* data, size_t dataSize, uint32_t jointCount,
+		AnimationClip& clip, size_t& bytesRead);
+
+	//Smallest-three quaternion packing, the largest component index goes in the top bits of packed[0] and [1].
+	void PackQuaternion(const DirectX::XMFLOAT4& q, uint16_t packed[3]);
+	DirectX::XMFLOAT4 UnpackQuaternion(const uint16_t packed[3]);
+}
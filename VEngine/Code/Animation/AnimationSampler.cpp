@@ -0,0 +1,138 @@
+#include "vpch.h"
+#include "AnimationSampler.h"
+#include <algorithm>
+#include "AnimationClip.h"
+
+using namespace DirectX;
+
+void AnimationSampler::SetClip(const AnimationClip* newClip)
+{
+	clip = newClip;
+	cursors.assign(clip ? clip->tracks.size() : 0, 0);
+	lastSampleTime = 0.f;
+}
+
+bool AnimationSampler::SampleJoint(int jointIndex, float t, XMVECTOR& scale, XMVECTOR& rot, XMVECTOR& pos)
+{
+	if (clip == nullptr || jointIndex >= (int)clip->tracks.size() || clip->tracks[jointIndex].keyCount == 0)
+	{
+		return false;
+	}
+
+	const AnimationClip::Track& track = clip->tracks[jointIndex];
+	const uint32_t first = track.firstKey;
+
+	uint32_t key0 = first;
+	uint32_t key1 = first;
+	float lerpPercent = 0.f;
+
+	if (track.keyCount > 1)
+	{
+		uint32_t& cursor = cursors[jointIndex];
+
+		//Move to the key pair bracketing t. Sequential playback moves at most a key or two per frame.
+		const uint32_t lastPair = track.keyCount - 2;
+		if (clip->sampleRate > 0.f)
+		{
+			cursor = std::min((uint32_t)std::max(0.f, t * clip->sampleRate), lastPair);
+		}
+		else
+		{
+			while (cursor < lastPair && clip->times[first + cursor + 1] < t)
+			{
+				cursor++;
+			}
+		}
+
+		key0 = first + cursor;
+		key1 = key0 + 1;
+
+		const float keyTime0 = clip->times[key0];
+		const float keyTime1 = clip->times[key1];
+		if (keyTime1 > keyTime0)
+		{
+			lerpPercent = std::clamp((t - keyTime0) / (keyTime1 - keyTime0), 0.f, 1.f);
+		}
+	}
+
+	pos = XMVectorLerp(XMLoadFloat3(&clip->translations[key0]), XMLoadFloat3(&clip->translations[key1]), lerpPercent);
+	scale = XMVectorLerp(XMLoadFloat3(&clip->scales[key0]), XMLoadFloat3(&clip->scales[key1]), lerpPercent);
+	rot = XMQuaternionSlerp(XMLoadFloat4(&clip->rotations[key0]), XMLoadFloat4(&clip->rotations[key1]), lerpPercent);
+
+	return true;
+}
+
+void AnimationSampler::BeginPose(float t, const std::vector<Joint>& joints)
+{
+	//Clip was rebuilt in place
+	if (clip && cursors.size() != clip->tracks.size())
+	{
+		SetClip(clip);
+	}
+
+	if (t < lastSampleTime)
+	{
+		std::fill(cursors.begin(), cursors.end(), 0);
+	}
+	lastSampleTime = t;
+
+	chainPoses.resize(joints.size());
+
+	//First pose for this skeleton, every joint starts at its bind pose. With the parent chain built from skinning
+	//matrices (see Animation::Interpolate()), that's the local pose giving an identity skinning matrix.
+	if (localPoses.size() != joints.size())
+	{
+		localPoses.resize(joints.size());
+		for (size_t jointIndex = 0; jointIndex < joints.size(); jointIndex++)
+		{
+			localPoses[jointIndex] = XMMatrixInverse(nullptr, joints[jointIndex].inverseBindPose);
+		}
+	}
+}
+
+void AnimationSampler::SetJointPose(const std::vector<Joint>& joints, size_t jointIndex, const XMMATRIX* localPose,
+	XMMATRIX* skinningMatrices)
+{
+	const Joint& joint = joints[jointIndex];
+	assert(joint.parentIndex < (int)jointIndex);
+
+	const XMMATRIX parentChain = joint.parentIndex > Joint::ROOT_JOINT_INDEX ?
+		chainPoses[joint.parentIndex] : XMMatrixIdentity();
+
+	//Joints without a pose this time keep their last one
+	if (localPose)
+	{
+		localPoses[jointIndex] = *localPose;
+	}
+
+	const XMMATRIX pose = joint.inverseBindPose * (localPoses[jointIndex] * parentChain);
+
+	skinningMatrices[jointIndex] = pose;
+	chainPoses[jointIndex] = pose * parentChain;
+}
+
+void AnimationSampler::Evaluate(float t, const std::vector<Joint>& joints, XMMATRIX* skinningMatrices)
+{
+	if (clip == nullptr)
+	{
+		return;
+	}
+
+	BeginPose(t, joints);
+
+	const XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+	for (size_t jointIndex = 0; jointIndex < joints.size(); jointIndex++)
+	{
+		XMVECTOR scale, rot, pos;
+		if (SampleJoint((int)jointIndex, t, scale, rot, pos))
+		{
+			const XMMATRIX localPose = XMMatrixAffineTransformation(scale, zero, rot, pos);
+			SetJointPose(joints, jointIndex, &localPose, skinningMatrices);
+		}
+		else
+		{
+			SetJointPose(joints, jointIndex, nullptr, skinningMatrices);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+#include "Joint.h"
+
+struct AnimationClip;
+
+//Samples an AnimationClip for a skeleton. Each joint keeps a cursor to its last keyframe so that playing
+//forward only checks the current and next key instead of searching the whole track. Cursors rewind when
+//time goes backwards (looping, ResetAnimationTime()).
+//Poses are written to the caller's skinning matrices rather than the skeleton's joints, as skeletons are
+//shared between every component using the same mesh. One sampler per component.
+class AnimationSampler
+{
+public:
+	void SetClip(const AnimationClip* newClip);
+	const AnimationClip* GetClip() const { return clip; }
+
+	//Samples every joint at time t and writes its skinning matrix into skinningMatrices, in one pass over the
+	//joints. Joints are stored parent-before-child (see FBXLoader's ProcessSkeletonNodes()) so a parent's pose
+	//is always done before its children use it. Poses are composed the same way as Animation::Interpolate().
+	void Evaluate(float t, const std::vector<Joint>& joints, DirectX::XMMATRIX* skinningMatrices);
+
+	//For building a pose by hand (e.g. cross fades). Call BeginPose(), then SetJointPose() for each joint in order.
+	//A null localPose holds the joint's last local pose, which starts out as its bind pose.
+	void BeginPose(float t, const std::vector<Joint>& joints);
+	void SetJointPose(const std::vector<Joint>& joints, size_t jointIndex, const DirectX::XMMATRIX* localPose,
+		DirectX::XMMATRIX* skinningMatrices);
+
+	//Interpolated local transform components for the joint's track at time t, advancing its cursor.
+	//Returns false if the joint has no keyframes in the clip.
+	bool SampleJoint(int jointIndex, float t, DirectX::XMVECTOR& scale, DirectX::XMVECTOR& rot, DirectX::XMVECTOR& pos);
+
+private:
+	const AnimationClip* clip = nullptr;
+
+	std::vector<uint32_t> cursors;
+
+	//Joint pose multiplied by all its parents' poses, what Animation::Interpolate() walks the parent chain for.
+	std::vector<DirectX::XMMATRIX> chainPoses;
+
+	//Local pose each joint was last given. Kept here rather than in Joint::currentPose, which is shared by
+	//every component using the skeleton.
+	std::vector<DirectX::XMMATRIX> localPoses;
+
+	float lastSampleTime = 0.f;
+};
@@ -13,3 +13,46 @@ struct AnimationAssetHeader
 {
 	uint64_t animationCount = 0;
 };
+
+//Version 2 .vanim files start with this instead of AnimationAssetHeader. v1 files start straight with the
+//animation count, which is never going to be as high as the magic value, so the first 4 bytes tell them apart.
+//Layout: AnimationAssetHeaderV2, then per animation an AnimationClipHeader followed by trackCount tracks.
+//Each track is an AnimationTrackHeader then its streams, see AnimationCompression.
+struct AnimationAssetHeaderV2
+{
+	inline static const uint32_t MAGIC = 0x4D4E4156; //"VANM" in file order
+	inline static const uint32_t CURRENT_VERSION = 2;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = CURRENT_VERSION;
+	uint64_t animationCount = 0;
+};
+
+struct AnimationClipHeader
+{
+	char name[Animation::ANIM_NAME_MAX]{};
+	uint32_t trackCount = 0;
+	float duration = 0.f;
+
+	//Tracks are sampled at this rate and don't store key times. 0 means every track stores its own times.
+	float sampleRate = 0.f;
+
+	uint32_t padding = 0;
+};
+
+enum class AnimationTrackChannel : uint8_t
+{
+	Identity, //Nothing stored, only used for scale (1, 1, 1).
+	Constant, //One value for the whole track.
+	Animated  //One value per key.
+};
+
+struct AnimationTrackHeader
+{
+	int32_t jointIndex = 0;
+	uint32_t keyCount = 0;
+	AnimationTrackChannel rotation = AnimationTrackChannel::Animated;
+	AnimationTrackChannel translation = AnimationTrackChannel::Animated;
+	AnimationTrackChannel scale = AnimationTrackChannel::Animated;
+	uint8_t padding = 0;
+};
@@ -13,4 +13,5 @@ namespace AssetFileExtensions
 	inline static const std::string worldMap = ".vmap";
 	inline static const std::string gameSave = ".vmap";
 	inline static const std::string material = ".vmat";
+	inline static const std::string stringTable = ".vloc";
 };
@@ -1,12 +1,16 @@
 #include "vpch.h"
 #include "AssetSystem.h"
+#include <algorithm>
 #include <filesystem>
 #include <qfiledialog.h>
+#include <qmessagebox.h>
 #include "FBXLoader.h"
 #include "MeshAssetHeader.h"
 #include "AssetFileExtensions.h"
 #include "AnimationAssetHeader.h"
+#include "Animation/AnimationCompression.h"
 #include "Core/Profile.h"
+#include "Core/MappedFile.h"
 #include "Core/Log.h"
 #include "Core/FileSystem.h"
 #include "Core/WorldEditor.h"
@@ -16,6 +20,7 @@
 #include "Asset/VertexColourData.h"
 #include "Asset/VertexColourHeader.h"
 #include "Render/MeshData.h"
+#include "Render/MeshOptimiser.h"
 #include "Render/Vertex.h"
 #include "Render/Renderer.h"
 
@@ -25,16 +30,398 @@ struct FBXFileInfo
 	std::string filename;
 };
 
-std::unordered_map<std::string, MeshData> existingMeshData;
+//Loaded mesh data keyed by filename. Proxies share the vertices in here until they're written to.
+static std::unordered_map<std::string, std::shared_ptr<MeshData>> existingMeshData;
+static AssetSystem::MeshCacheStats meshCacheStats;
 
 static const std::string vertexColourDataFileExtension = ".vertexcolourdata";
 
+//Stands in for meshes that can't be loaded or rebuilt, so a bad file shows up in world instead of crashing.
+static const std::string fallbackMeshFilename = "cube.vmesh";
+
 void AssetSystem::ResetMeshData()
 {
 	existingMeshData.clear();
+	meshCacheStats = {};
+}
+
+AssetSystem::MeshCacheStats AssetSystem::GetMeshCacheStats()
+{
+	return meshCacheStats;
+}
+
+static MeshDataProxy CreateProxyFromCachedMeshData(const std::shared_ptr<MeshData>& meshData)
+{
+	MeshDataProxy meshDataProxy;
+	meshDataProxy.SetSharedMeshData(meshData);
+	meshDataProxy.boundingBox = &meshData->boundingBox;
+	meshDataProxy.skeleton = &meshData->skeleton;
+	meshDataProxy.triangleBVH = meshData->triangleBVH.get();
+	return meshDataProxy;
+}
+
+static void AddToCacheStats(const MeshData& data)
+{
+	meshCacheStats.cachedMeshCount++;
+	meshCacheStats.residentBytes += sizeof(Joint) * data.skeleton.GetJoints().size();
+	meshCacheStats.mappedBytes += data.mappedFile ? data.mappedFile->GetSize() : 0;
+}
+
+static void RemoveFromCacheStats(const MeshData& data)
+{
+	meshCacheStats.cachedMeshCount--;
+	meshCacheStats.residentBytes -= sizeof(Joint) * data.skeleton.GetJoints().size();
+	meshCacheStats.mappedBytes -= data.mappedFile ? data.mappedFile->GetSize() : 0;
 }
 
-void AssetSystem::BuildAllVMeshDataFromFBXImport()
+//Cache entries are keyed by filename under AssetBaseFolders::mesh, writers pass whatever path they have.
+static auto FindCachedMeshData(const std::string& filepath)
+{
+	std::error_code error;
+	for (auto it = existingMeshData.begin(); it != existingMeshData.end(); it++)
+	{
+		if (std::filesystem::equivalent(AssetBaseFolders::mesh + it->first, filepath, error))
+		{
+			return it;
+		}
+	}
+	return existingMeshData.end();
+}
+
+//Writes meshData out as a version 2 .vmesh (see MeshAssetHeaderV2), vertices split into VertexStreams.
+//The new file is written next to the old one and then swapped in. A cached copy of the old one is dropped
+//from the cache first, as its mapping would stop the swap. Returns false if the file couldn't be replaced.
+static bool WriteVMeshFile(const std::string& filepath, const MeshData& meshData, VertexFormat vertexFormat)
+{
+	struct SectionSource
+	{
+		MeshAssetSection section;
+		const void* data = nullptr;
+	};
+
+	const auto& joints = meshData.skeleton.GetJoints();
+
+	if (vertexFormat == VertexFormat::Compressed && joints.size() > UINT8_MAX + 1)
+	{
+		Log("%s has %zu joints, more than compressed bone indices can hold. Writing full vertices.",
+			filepath.c_str(), joints.size());
+		vertexFormat = VertexFormat::Full;
+	}
+
+	VertexStreams streams;
+	streams.Encode(meshData.vertices, vertexFormat, !joints.empty());
+	const uint64_t vertexCount = streams.GetVertexCount();
+
+	std::vector<SectionSource> sections;
+	sections.push_back({ { MeshAssetSectionType::Positions, sizeof(XMFLOAT3), 0, vertexCount }, streams.GetPositions().data() });
+	sections.push_back({ { MeshAssetSectionType::Shading, VertexStreams::GetShadingStride(vertexFormat), 0, vertexCount },
+		streams.GetShading() });
+	if (streams.HasSkin())
+	{
+		sections.push_back({ { MeshAssetSectionType::Skin, VertexStreams::GetSkinStride(vertexFormat), 0, vertexCount },
+			streams.GetSkin() });
+	}
+	const auto indices = meshData.GetIndices();
+	if (!indices.empty())
+	{
+		sections.push_back({ { MeshAssetSectionType::Indices, sizeof(MeshData::indexDataType), 0, indices.size() },
+			indices.data() });
+	}
+	const auto soupRemap = meshData.GetSoupRemap();
+	if (!soupRemap.empty())
+	{
+		sections.push_back({ { MeshAssetSectionType::SoupRemap, sizeof(MeshData::indexDataType), 0, soupRemap.size() },
+			soupRemap.data() });
+	}
+	sections.push_back({ { MeshAssetSectionType::BoundingBox, sizeof(DirectX::BoundingBox), 0, 1 }, &meshData.boundingBox });
+	sections.push_back({ { MeshAssetSectionType::Joints, sizeof(Joint), 0, joints.size() }, joints.data() });
+
+	const auto alignOffset = [](uint64_t offset)
+		{
+			const uint64_t alignment = MeshAssetHeaderV2::SECTION_ALIGNMENT;
+			return (offset + alignment - 1) & ~(alignment - 1);
+		};
+
+	MeshAssetHeaderV2 header;
+	header.sourceMeshFormat = SourceMeshFormat::FBX;
+	header.vertexFormat = vertexFormat;
+	header.sectionCount = (uint32_t)sections.size();
+
+	uint64_t offset = sizeof(MeshAssetHeaderV2) + sizeof(MeshAssetSection) * sections.size();
+	for (auto& source : sections)
+	{
+		offset = alignOffset(offset);
+		source.section.offset = offset;
+		offset += source.section.elementSize * source.section.count;
+	}
+
+	std::vector<uint8_t> fileData(offset);
+	memcpy(fileData.data(), &header, sizeof(MeshAssetHeaderV2));
+	for (size_t i = 0; i < sections.size(); i++)
+	{
+		const MeshAssetSection& section = sections[i].section;
+		memcpy(fileData.data() + sizeof(MeshAssetHeaderV2) + sizeof(MeshAssetSection) * i, &section, sizeof(MeshAssetSection));
+		if (section.count > 0)
+		{
+			memcpy(fileData.data() + section.offset, sections[i].data, section.elementSize * section.count);
+		}
+	}
+
+	const std::string tempFilepath = filepath + ".tmp";
+
+	FILE* file = nullptr;
+	fopen_s(&file, tempFilepath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		Log("Couldn't write mesh %s.", tempFilepath.c_str());
+		return false;
+	}
+	const size_t bytesWritten = fwrite(fileData.data(), 1, fileData.size(), file);
+	fclose(file);
+	if (bytesWritten != fileData.size())
+	{
+		Log("Couldn't write mesh %s.", tempFilepath.c_str());
+		return false;
+	}
+
+	//Windows won't replace a file that's mapped. The cached copy moves onto the heap for the components still
+	//using it and comes out of the cache, then the new file is loaded in its place.
+	std::string cachedFilename;
+	std::shared_ptr<MeshData> cachedMeshData;
+	auto cachedMeshDataIt = FindCachedMeshData(filepath);
+	if (cachedMeshDataIt != existingMeshData.end())
+	{
+		cachedFilename = cachedMeshDataIt->first;
+		cachedMeshData = cachedMeshDataIt->second;
+		RemoveFromCacheStats(*cachedMeshData);
+		cachedMeshData->ReleaseMappedFile();
+		existingMeshData.erase(cachedMeshDataIt);
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilepath, filepath, error);
+	if (error)
+	{
+		Log("Couldn't replace %s, it's probably open elsewhere. New mesh data is in %s.", filepath.c_str(),
+			tempFilepath.c_str());
+		if (cachedMeshData)
+		{
+			AddToCacheStats(*cachedMeshData);
+			existingMeshData.emplace(cachedFilename, cachedMeshData);
+		}
+		return false;
+	}
+
+	if (cachedMeshData)
+	{
+		AssetSystem::ReadVMeshAssetFromFile(cachedFilename);
+	}
+
+	return true;
+}
+
+//Points data at the sections of a mapped .vmesh. Vertex streams are used in place, bounds and joints are small
+//and get copied (Skeleton needs its own vector). Files with an interleaved Vertex section are converted to streams.
+static bool ReadVMeshSections(const std::string& filepath, MeshData& data)
+{
+	auto mappedFile = std::make_shared<MappedFile>();
+	if (!mappedFile->Open(filepath))
+	{
+		Log("Couldn't open %s.", filepath.c_str());
+		return false;
+	}
+
+	const uint8_t* fileData = mappedFile->GetData();
+	const size_t fileSize = mappedFile->GetSize();
+
+	std::vector<MeshAssetSection> sections;
+	VertexFormat vertexFormat = VertexFormat::Full;
+
+	uint32_t magic = 0;
+	if (fileSize >= sizeof(uint32_t))
+	{
+		memcpy(&magic, fileData, sizeof(uint32_t));
+	}
+
+	if (magic == MeshAssetHeaderV2::MAGIC)
+	{
+		MeshAssetHeaderV2 header;
+		if (fileSize < sizeof(MeshAssetHeaderV2))
+		{
+			Log("%s is truncated.", filepath.c_str());
+			return false;
+		}
+		memcpy(&header, fileData, sizeof(MeshAssetHeaderV2));
+
+		if (header.version > MeshAssetHeaderV2::CURRENT_VERSION)
+		{
+			Log("%s is mesh version %u, newer than supported version %u.", filepath.c_str(), header.version,
+				MeshAssetHeaderV2::CURRENT_VERSION);
+			return false;
+		}
+
+		if (sizeof(MeshAssetHeaderV2) + sizeof(MeshAssetSection) * header.sectionCount > fileSize)
+		{
+			Log("%s is truncated.", filepath.c_str());
+			return false;
+		}
+
+		sections.resize(header.sectionCount);
+		memcpy(sections.data(), fileData + sizeof(MeshAssetHeaderV2), sizeof(MeshAssetSection) * header.sectionCount);
+
+		vertexFormat = header.vertexFormat;
+	}
+	else
+	{
+		//Original layout: header, vertices, bounding box, joints packed one after the other.
+		MeshAssetHeader header;
+		if (fileSize < sizeof(MeshAssetHeader))
+		{
+			Log("%s is truncated.", filepath.c_str());
+			return false;
+		}
+		memcpy(&header, fileData, sizeof(MeshAssetHeader));
+
+		uint64_t offset = sizeof(MeshAssetHeader);
+		sections.push_back({ MeshAssetSectionType::Vertices, sizeof(Vertex), offset, header.vertexCount });
+		offset += sizeof(Vertex) * header.vertexCount;
+		sections.push_back({ MeshAssetSectionType::BoundingBox, sizeof(DirectX::BoundingBox), offset, 1 });
+		offset += sizeof(DirectX::BoundingBox);
+		sections.push_back({ MeshAssetSectionType::Joints, sizeof(Joint), offset, header.boneCount });
+	}
+
+	ArrayView<Vertex> interleavedVertices;
+	ArrayView<MeshData::indexDataType> indices;
+	ArrayView<MeshData::indexDataType> soupRemap;
+	ArrayView<XMFLOAT3> positions;
+	const uint8_t* shading = nullptr;
+	const uint8_t* skin = nullptr;
+
+	const auto checkElementSize = [&](const MeshAssetSection& section, size_t expectedSize)
+		{
+			if (section.elementSize != expectedSize)
+			{
+				Log("%s section %u element size %u doesn't match engine's %zu, rebuild the mesh.", filepath.c_str(),
+					(uint32_t)section.type, section.elementSize, expectedSize);
+				return false;
+			}
+			return true;
+		};
+
+	for (const auto& section : sections)
+	{
+		//Written so that neither side can wrap around, offsets and counts come straight from the file.
+		if (section.offset > fileSize ||
+			(section.elementSize != 0 && section.count > (fileSize - section.offset) / section.elementSize))
+		{
+			Log("%s section %u runs past the end of the file.", filepath.c_str(), (uint32_t)section.type);
+			return false;
+		}
+
+		const uint64_t sectionSize = (uint64_t)section.elementSize * section.count;
+		const uint8_t* sectionData = fileData + section.offset;
+
+		switch (section.type)
+		{
+		case MeshAssetSectionType::Vertices:
+			if (!checkElementSize(section, sizeof(Vertex))) return false;
+			interleavedVertices = ArrayView<Vertex>(reinterpret_cast<const Vertex*>(sectionData), section.count);
+			break;
+
+		case MeshAssetSectionType::Positions:
+			if (!checkElementSize(section, sizeof(XMFLOAT3))) return false;
+			positions = ArrayView<XMFLOAT3>(reinterpret_cast<const XMFLOAT3*>(sectionData), section.count);
+			break;
+
+		case MeshAssetSectionType::Shading:
+			if (!checkElementSize(section, VertexStreams::GetShadingStride(vertexFormat))) return false;
+			shading = sectionData;
+			break;
+
+		case MeshAssetSectionType::Skin:
+			if (!checkElementSize(section, VertexStreams::GetSkinStride(vertexFormat))) return false;
+			skin = sectionData;
+			break;
+
+		case MeshAssetSectionType::Indices:
+			if (!checkElementSize(section, sizeof(MeshData::indexDataType))) return false;
+			indices = ArrayView<MeshData::indexDataType>(
+				reinterpret_cast<const MeshData::indexDataType*>(sectionData), section.count);
+			break;
+
+		case MeshAssetSectionType::SoupRemap:
+			if (!checkElementSize(section, sizeof(MeshData::indexDataType))) return false;
+			soupRemap = ArrayView<MeshData::indexDataType>(
+				reinterpret_cast<const MeshData::indexDataType*>(sectionData), section.count);
+			break;
+
+		case MeshAssetSectionType::BoundingBox:
+			if (!checkElementSize(section, sizeof(DirectX::BoundingBox))) return false;
+			if (section.count != 1)
+			{
+				Log("%s has %llu bounding boxes, expected 1.", filepath.c_str(), section.count);
+				return false;
+			}
+			memcpy(&data.boundingBox, sectionData, sizeof(DirectX::BoundingBox));
+			break;
+
+		case MeshAssetSectionType::Joints:
+			if (!checkElementSize(section, sizeof(Joint))) return false;
+			data.skeleton.GetJoints().resize(section.count);
+			if (section.count > 0)
+			{
+				memcpy(data.skeleton.GetJoints().data(), sectionData, sectionSize);
+			}
+			break;
+		}
+	}
+
+	if (!interleavedVertices.empty())
+	{
+		data.streams.Encode(interleavedVertices, VertexFormat::Full, data.skeleton.GetNumJoints() > 0);
+	}
+	else
+	{
+		if (!positions.empty() && shading == nullptr)
+		{
+			Log("%s has positions but no shading section.", filepath.c_str());
+			return false;
+		}
+		data.streams.SetExternal(vertexFormat, positions, shading, skin);
+	}
+
+	if (!indices.empty())
+	{
+		//Bad indices would read past the vertex buffers on the GPU and in raycasts, check them once here.
+		const size_t vertexCount = data.streams.GetVertexCount();
+		const bool indicesInRange = std::all_of(indices.begin(), indices.end(),
+			[vertexCount](MeshData::indexDataType index) { return index < vertexCount; });
+		if (indices.size() % 3 != 0 || !indicesInRange)
+		{
+			Log("%s has a broken index buffer, rebuild the mesh.", filepath.c_str());
+			return false;
+		}
+		data.mappedIndices = indices;
+	}
+
+	if (!soupRemap.empty())
+	{
+		const size_t vertexCount = data.streams.GetVertexCount();
+		const bool remapInRange = std::all_of(soupRemap.begin(), soupRemap.end(),
+			[vertexCount](MeshData::indexDataType index) { return index < vertexCount; });
+		if (!remapInRange)
+		{
+			Log("%s has a broken soup remap, rebuild the mesh.", filepath.c_str());
+			return false;
+		}
+		data.mappedSoupRemap = soupRemap;
+	}
+
+	data.mappedFile = mappedFile;
+	return true;
+}
+
+void AssetSystem::BuildAllVMeshDataFromFBXImport(VertexFormat vertexFormat)
 {
 	uint64_t numberOfMeshFilesBuilt = 0;
 
@@ -60,7 +447,7 @@ void AssetSystem::BuildAllVMeshDataFromFBXImport()
 
 	for (const auto& fileInfo : fbxFileInfos)
 	{
-		AssetSystem::BuildSingleVMeshFromFBX(fileInfo.filepath, fileInfo.filename);
+		AssetSystem::BuildSingleVMeshFromFBX(fileInfo.filepath, fileInfo.filename, vertexFormat);
 		Renderer::SetRendererToCaptureMeshIcon(fileInfo.filename);
 		numberOfMeshFilesBuilt++;
 	}
@@ -82,12 +469,13 @@ void AssetSystem::CreateVMeshFromInWorldMesh()
 			MeshData meshData = {};
 			XMStoreFloat3(&meshData.boundingBox.Center, mesh->GetBoundsCenter());
 			XMStoreFloat3(&meshData.boundingBox.Extents, mesh->GetBoundsExtents());
-			meshData.vertices = mesh->GetAllVertices();
-
-			MeshAssetHeader header = {};
-			header.sourceMeshFormat = SourceMeshFormat::FBX;
-			header.vertexCount = meshData.vertices.size();
-			header.boneCount = meshData.skeleton.GetNumJoints();
+			meshData.vertices = mesh->GetAllVertices().ToVector();
+			meshData.indices = mesh->meshDataProxy.GetIndices().ToVector();
+			meshData.soupRemap = mesh->meshDataProxy.GetSoupRemap().ToVector();
+			if (meshData.indices.empty())
+			{
+				MeshOptimiser::Optimise(meshData);
+			}
 
 			QFileDialog dialog;
 			dialog.setFileMode(QFileDialog::AnyFile);
@@ -100,18 +488,11 @@ void AssetSystem::CreateVMeshFromInWorldMesh()
 				nullptr,
 				QFileDialog::Option::DontUseNativeDialog);
 
-			FILE* file = nullptr;
-			fopen_s(&file, meshFile.toStdString().c_str(), "wb");
-			assert(file);
-
-			fwrite(&header, sizeof(MeshAssetHeader), 1, file);
-			fwrite(meshData.vertices.data(), sizeof(Vertex), meshData.vertices.size(), file);
-			fwrite(&meshData.boundingBox, sizeof(DirectX::BoundingBox), 1, file);
-
-			auto& joints = meshData.skeleton.GetJoints();
-			fwrite(joints.data(), sizeof(Joint), joints.size(), file);
-
-			fclose(file);
+			if (!WriteVMeshFile(meshFile.toStdString(), meshData, VertexFormat::Full))
+			{
+				QMessageBox::warning(nullptr, "Create new vmesh",
+					"Couldn't write " + meshFile + ", see the log for details.");
+			}
 		}
 	}
 }
@@ -151,7 +532,8 @@ void AssetSystem::BuildAllAnimationFilesFromFBXImport()
 		numberOfAnimationFilesBuilt, elapsedTime);
 }
 
-void AssetSystem::BuildSingleVMeshFromFBX(const std::string fbxFilePath, const std::string fbxFilename)
+void AssetSystem::BuildSingleVMeshFromFBX(const std::string fbxFilePath, const std::string fbxFilename,
+	VertexFormat vertexFormat)
 {
 	const std::string baseFBXPath = VString::GetSubStringAtFoundOffset(fbxFilePath, AssetBaseFolders::fbxFiles);
 	const std::string vMeshPath = VString::ReplaceFileExtesnion(baseFBXPath, ".vmesh");
@@ -161,27 +543,12 @@ void AssetSystem::BuildSingleVMeshFromFBX(const std::string fbxFilePath, const s
 	MeshData meshData;
 	FBXLoader::ImportAsMesh(fbxFilePath, meshData);
 
-	MeshAssetHeader header;
-	header.sourceMeshFormat = SourceMeshFormat::FBX;
-	header.vertexCount = meshData.vertices.size();
-	header.boneCount = meshData.skeleton.GetNumJoints();
-
 	//Note: Make sure there's a matching folder for meshes from where the fbx file came from. 
-	FILE* file = nullptr;
-	fopen_s(&file, meshFilePath.string().c_str(), "wb");
-	assert(file);
-
-	assert(fwrite(&header, sizeof(MeshAssetHeader), 1, file));
-	assert(fwrite(meshData.vertices.data(), sizeof(Vertex), meshData.vertices.size(), file));
-	assert(fwrite(&meshData.boundingBox, sizeof(DirectX::BoundingBox), 1, file));
-
-	auto& joints = meshData.skeleton.GetJoints();
-	fwrite(joints.data(), sizeof(Joint), joints.size(), file);
-
-	fclose(file);
+	WriteVMeshFile(meshFilePath.string(), meshData, vertexFormat);
 }
 
-void AssetSystem::BuildSingleVAnimFromFBX(const std::string fbxAnimFilePath, const std::string fbxAnimFilename)
+void AssetSystem::BuildSingleVAnimFromFBX(const std::string fbxAnimFilePath, const std::string fbxAnimFilename,
+	float uniformSampleRate)
 {
 	auto animations = FBXLoader::ImportAsAnimation(fbxAnimFilePath, fbxAnimFilename);
 
@@ -196,83 +563,118 @@ void AssetSystem::BuildSingleVAnimFromFBX(const std::string fbxAnimFilePath, con
 	assert(file);
 
 	{
-		AnimationAssetHeader header;
+		AnimationAssetHeaderV2 header;
 		header.animationCount = animations.size();
-		assert(fwrite(&header, sizeof(AnimationAssetHeader), 1, file));
+		const size_t headerWriteCount = fwrite(&header, sizeof(AnimationAssetHeaderV2), 1, file);
+		assert(headerWriteCount == 1);
 	}
 
+	//What the v1 layout (raw AnimFrames) would have taken, for the log.
+	size_t uncompressedSize = sizeof(AnimationAssetHeader);
+	size_t compressedSize = sizeof(AnimationAssetHeaderV2);
+
+	AnimationCompression::Settings compressionSettings;
+	compressionSettings.uniformSampleRate = uniformSampleRate;
+
 	for (auto& [animName, animation] : animations)
 	{
-		AnimationFrameHeader animFrameHeader = {};
-		strcpy_s(animFrameHeader.name, sizeof(char) * Animation::ANIM_NAME_MAX, animName.c_str());
-		animFrameHeader.frameCount = animation.GetFrames().size();
-		assert(fwrite(&animFrameHeader, sizeof(AnimationFrameHeader), 1, file));
+		AnimationClipHeader clipHeader = {};
+		strcpy_s(clipHeader.name, sizeof(char) * Animation::ANIM_NAME_MAX, animName.c_str());
 
-		for (auto& [jointIndex, animFrame] : animation.GetFrames())
-		{
-			assert(fwrite(&jointIndex, sizeof(int), 1, file));
+		std::vector<uint8_t> trackData;
+		AnimationCompression::CompressClip(animation.GetClip(), compressionSettings, clipHeader, trackData);
 
-			const size_t animFrameCount = animFrame.size();
-			assert(fwrite(&animFrameCount, sizeof(size_t), 1, file));
-			assert(fwrite(animFrame.data(), sizeof(AnimFrame), animFrameCount, file));
+		fwrite(&clipHeader, sizeof(AnimationClipHeader), 1, file);
+		const size_t trackBytesWritten = fwrite(trackData.data(), 1, trackData.size(), file);
+		assert(trackBytesWritten == trackData.size());
+
+		compressedSize += sizeof(AnimationClipHeader) + trackData.size();
+
+		uncompressedSize += sizeof(AnimationFrameHeader);
+		for (auto& [jointIndex, animFrames] : animation.GetFrames())
+		{
+			uncompressedSize += sizeof(int) + sizeof(size_t) + sizeof(AnimFrame) * animFrames.size();
 		}
 	}
 
 	fclose(file);
+
+	Log("%s written as .vanim v%u, %zu bytes (%zu bytes uncompressed).", vAnimPath.c_str(),
+		AnimationAssetHeaderV2::CURRENT_VERSION, compressedSize, uncompressedSize);
+}
+
+//Builds Meshes/<filename> from the FBX of the same name. Returns false if there's no FBX to build from.
+static bool BuildVMeshFromMatchingFBX(const std::string& filename)
+{
+	const std::string fbxFile = VString::ReplaceFileExtesnion(filename, ".fbx");
+	const std::string fbxFilePath = std::filesystem::current_path().string() +
+		"\\" + AssetBaseFolders::fbxFiles + fbxFile;
+	if (!std::filesystem::exists(fbxFilePath))
+	{
+		return false;
+	}
+
+	AssetSystem::BuildSingleVMeshFromFBX(fbxFilePath, fbxFile);
+	return true;
 }
 
 MeshDataProxy AssetSystem::ReadVMeshAssetFromFile(const std::string filename)
 {
+	auto cachedMeshDataIt = existingMeshData.find(filename);
+	if (cachedMeshDataIt != existingMeshData.end())
+	{
+		meshCacheStats.hits++;
+		return CreateProxyFromCachedMeshData(cachedMeshDataIt->second);
+	}
+
+	meshCacheStats.misses++;
+
 	std::string filepath = AssetBaseFolders::mesh + filename;
 
 	//Create VMesh if it doesn't exist yet.
 	if (!std::filesystem::exists(filepath))
 	{
-		const std::string fbxFile = VString::ReplaceFileExtesnion(filename, ".fbx");
-		const std::string fbxFilePath = std::filesystem::current_path().string() +
-			"\\" + AssetBaseFolders::fbxFiles + fbxFile;
-		BuildSingleVMeshFromFBX(fbxFile, fbxFilePath);
+		BuildVMeshFromMatchingFBX(filename);
 	}
 
-	FILE* file = nullptr;
-	fopen_s(&file, filepath.c_str(), "rb");
-	assert(file);
+	auto data = std::make_shared<MeshData>();
+	bool loaded = ReadVMeshSections(filepath, *data);
 
-	MeshAssetHeader header;
-	MeshData data;
-
-	fread(&header, sizeof(MeshAssetHeader), 1, file);
+	//Old or damaged file, build it again if the FBX is around.
+	if (!loaded && BuildVMeshFromMatchingFBX(filename))
+	{
+		data = std::make_shared<MeshData>();
+		loaded = ReadVMeshSections(filepath, *data);
+	}
 
-	data.vertices.resize(header.vertexCount);
-	fread(data.vertices.data(), sizeof(Vertex), header.vertexCount, file);
+	if (!loaded)
+	{
+		//Nothing is cached under filename, so the next load tries the file again.
+		if (filename != fallbackMeshFilename)
+		{
+			Log("Couldn't load mesh %s, using %s instead.", filename.c_str(), fallbackMeshFilename.c_str());
+			return ReadVMeshAssetFromFile(fallbackMeshFilename);
+		}
 
-	fread(&data.boundingBox, sizeof(DirectX::BoundingBox), 1, file);
+		Log("Couldn't load fallback mesh %s.", filename.c_str());
+		auto emptyData = std::make_shared<MeshData>();
+		emptyData->triangleBVH = std::make_shared<TriangleBVH>();
+		return CreateProxyFromCachedMeshData(emptyData);
+	}
 
-	data.skeleton.GetJoints().resize(header.boneCount);
-	//Has to potential to read empty data, don't call assert()
-	fread(data.skeleton.GetJoints().data(), sizeof(Joint), header.boneCount, file);
+	data->triangleBVH = std::make_shared<TriangleBVH>();
+	data->triangleBVH->Build(data->GetPositions(), data->GetIndices());
 
-	fclose(file);
+	AddToCacheStats(*data);
 
 	existingMeshData.emplace(filename, data);
-	auto& foundMeshData = existingMeshData.find(filename)->second;
 
-	MeshDataProxy meshDataProxy;
-	meshDataProxy.vertices = foundMeshData.vertices;
-	meshDataProxy.boundingBox = &foundMeshData.boundingBox;
-	meshDataProxy.skeleton = &foundMeshData.skeleton;
-
-	return meshDataProxy;
+	return CreateProxyFromCachedMeshData(data);
 }
 
-std::vector<Animation> AssetSystem::ReadVAnimAssetFromFile(const std::string filename)
+//Version 1 .vanim, raw AnimFrames for every joint.
+static std::vector<Animation> ReadVAnimV1(FILE* file)
 {
-	const std::string filepath = AssetBaseFolders::anim + filename;
-
-	FILE* file = nullptr;
-	fopen_s(&file, filepath.c_str(), "rb");
-	assert(file);
-
 	AnimationAssetHeader header = {};
 	assert(fread(&header, sizeof(AnimationAssetHeader), 1, file));
 
@@ -304,6 +706,98 @@ std::vector<Animation> AssetSystem::ReadVAnimAssetFromFile(const std::string fil
 		animations.emplace_back(anim);
 	}
 
+	return animations;
+}
+
+//Version 2 .vanim. The whole file is read in one go and the tracks are decoded straight into each
+//Animation's clip, no AnimFrames are made.
+static std::vector<Animation> ReadVAnimV2(FILE* file, const std::string& filepath, uint32_t jointCount)
+{
+	fseek(file, 0, SEEK_END);
+	const size_t fileSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	std::vector<uint8_t> fileData(fileSize);
+	const size_t bytesRead = fread(fileData.data(), 1, fileSize, file);
+	if (bytesRead != fileSize)
+	{
+		Log("Couldn't read %s.", filepath.c_str());
+		return {};
+	}
+
+	size_t offset = 0;
+
+	AnimationAssetHeaderV2 header;
+	if (fileSize < sizeof(AnimationAssetHeaderV2))
+	{
+		Log("%s is truncated.", filepath.c_str());
+		return {};
+	}
+	memcpy(&header, fileData.data(), sizeof(AnimationAssetHeaderV2));
+	offset += sizeof(AnimationAssetHeaderV2);
+
+	if (header.version > AnimationAssetHeaderV2::CURRENT_VERSION)
+	{
+		Log("%s is animation version %u, newer than supported version %u.", filepath.c_str(), header.version,
+			AnimationAssetHeaderV2::CURRENT_VERSION);
+		return {};
+	}
+
+	//Every clip needs at least its header, stops a bad count from reserving a huge array.
+	if (header.animationCount > (fileSize - offset) / sizeof(AnimationClipHeader))
+	{
+		Log("%s is truncated.", filepath.c_str());
+		return {};
+	}
+
+	std::vector<Animation> animations;
+	animations.reserve(header.animationCount);
+
+	for (uint64_t i = 0; i < header.animationCount; i++)
+	{
+		AnimationClipHeader clipHeader;
+		if (offset + sizeof(AnimationClipHeader) > fileSize)
+		{
+			Log("%s is truncated.", filepath.c_str());
+			return {};
+		}
+		memcpy(&clipHeader, fileData.data() + offset, sizeof(AnimationClipHeader));
+		offset += sizeof(AnimationClipHeader);
+
+		//Names are written from fixed size buffers, but make sure a bad file can't run Animation() off the end.
+		clipHeader.name[Animation::ANIM_NAME_MAX - 1] = '\0';
+
+		AnimationClip clip;
+		size_t clipSize = 0;
+		if (!AnimationCompression::DecompressClip(clipHeader, fileData.data() + offset, fileSize - offset, jointCount,
+			clip, clipSize))
+		{
+			Log("%s animation %s is truncated or malformed.", filepath.c_str(), clipHeader.name);
+			return {};
+		}
+		offset += clipSize;
+
+		Animation& anim = animations.emplace_back(clipHeader.name);
+		anim.SetClip(std::move(clip));
+	}
+
+	return animations;
+}
+
+std::vector<Animation> AssetSystem::ReadVAnimAssetFromFile(const std::string filename, uint32_t jointCount)
+{
+	const std::string filepath = AssetBaseFolders::anim + filename;
+
+	FILE* file = nullptr;
+	fopen_s(&file, filepath.c_str(), "rb");
+	assert(file);
+
+	uint32_t magic = 0;
+	fread(&magic, sizeof(uint32_t), 1, file);
+	rewind(file);
+
+	std::vector<Animation> animations = magic == AnimationAssetHeaderV2::MAGIC ? ReadVAnimV2(file, filepath, jointCount) : ReadVAnimV1(file);
+
 	fclose(file);
 
 	return animations;
@@ -342,10 +836,10 @@ void AssetSystem::WriteOutAllVertexColourData()
 		data.meshComponentUID = mesh->GetUID();
 		fwrite(&data.meshComponentUID, sizeof(data.meshComponentUID), 1, file);
 
-		data.numVertices = mesh->meshDataProxy.GetVertices().size();
-		for (auto& vertex : mesh->meshDataProxy.GetVertices())
+		data.numVertices = mesh->meshDataProxy.GetVertexCount();
+		for (size_t vertexIndex = 0; vertexIndex < data.numVertices; vertexIndex++)
 		{
-			data.colours.emplace_back(vertex.colour);
+			data.colours.emplace_back(mesh->meshDataProxy.GetColour(vertexIndex));
 		}
 
 		fwrite(&data.numVertices, sizeof(data.numVertices), 1, file);
@@ -365,6 +859,39 @@ void AssetSystem::LoadVertexColourDataFromFile()
 	LoadVertexColourDataFromFilename(vertexColourFileFilename);
 }
 
+//Soup vertices welded into the same vertex get the average of their colours.
+static std::vector<XMFLOAT4> RemapSoupVertexColours(const std::vector<XMFLOAT4>& soupColours,
+	const ArrayView<uint32_t> soupRemap, const size_t vertexCount)
+{
+	std::vector<XMFLOAT4> colourSums(vertexCount, XMFLOAT4(0.f, 0.f, 0.f, 0.f));
+	std::vector<uint32_t> soupVertexCounts(vertexCount, 0);
+
+	for (size_t soupIndex = 0; soupIndex < soupRemap.size(); soupIndex++)
+	{
+		const uint32_t weldedIndex = soupRemap[soupIndex];
+		const XMFLOAT4& soupColour = soupColours[soupIndex];
+		XMFLOAT4& sum = colourSums[weldedIndex];
+		sum.x += soupColour.x;
+		sum.y += soupColour.y;
+		sum.z += soupColour.z;
+		sum.w += soupColour.w;
+		soupVertexCounts[weldedIndex]++;
+	}
+
+	for (size_t weldedIndex = 0; weldedIndex < vertexCount; weldedIndex++)
+	{
+		const uint32_t count = soupVertexCounts[weldedIndex];
+		if (count > 1)
+		{
+			XMFLOAT4& sum = colourSums[weldedIndex];
+			const float scale = 1.f / (float)count;
+			sum = XMFLOAT4(sum.x * scale, sum.y * scale, sum.z * scale, sum.w * scale);
+		}
+	}
+
+	return colourSums;
+}
+
 void AssetSystem::LoadVertexColourDataFromFilename(const std::string filename)
 {
 	FILE* file = nullptr;
@@ -401,17 +928,45 @@ void AssetSystem::LoadVertexColourDataFromFilename(const std::string filename)
 			continue;
 		}
 
-		const size_t vertexCount = mesh->meshDataProxy.GetVertices().size();
+		const size_t vertexCount = mesh->meshDataProxy.GetVertexCount();
 		if (vertexColourData.colours.size() != vertexCount)
 		{
-			Log("Mismatch of vertex colour data size and vertex count for mesh [%u] on Actor [%s].",
+			//Colours saved before the mesh was welded on import have one entry per soup vertex.
+			const ArrayView<uint32_t> soupRemap = mesh->meshDataProxy.GetSoupRemap();
+			if (vertexColourData.colours.size() != soupRemap.size())
+			{
+				Log("Mismatch of vertex colour data size and vertex count for mesh [%u] on Actor [%s].",
+					mesh->GetUID(), mesh->GetOwner()->GetName().c_str());
+				continue;
+			}
+
+			vertexColourData.colours = RemapSoupVertexColours(vertexColourData.colours, soupRemap, vertexCount);
+			Log("Remapped soup vertex colour data onto welded vertices for mesh [%u] on Actor [%s].",
 				mesh->GetUID(), mesh->GetOwner()->GetName().c_str());
+		}
+
+		//Most meshes keep the colours they were imported with, so only break off a unique copy of the
+		//vertices when the saved colours actually differ from the shared mesh data.
+		bool coloursMatch = true;
+		for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
+		{
+			const XMFLOAT4 colour = mesh->meshDataProxy.GetColour(vertexIndex);
+			if (memcmp(&colour, &vertexColourData.colours[vertexIndex], sizeof(DirectX::XMFLOAT4)) != 0)
+			{
+				coloursMatch = false;
+				break;
+			}
+		}
+
+		if (coloursMatch)
+		{
 			continue;
 		}
 
+		auto& vertices = mesh->meshDataProxy.GetMutableVertices();
 		for (int vertexIndex = 0; vertexIndex < vertexCount; vertexIndex++)
 		{
-			mesh->meshDataProxy.vertices.at(vertexIndex).colour = vertexColourData.colours[vertexIndex];
+			vertices.at(vertexIndex).colour = vertexColourData.colours[vertexIndex];
 		}
 
 		mesh->CreateNewVertexBuffer();
@@ -6,17 +6,32 @@
 
 namespace AssetSystem
 {
+	//Running counters for the shared mesh cache, see ReadVMeshAssetFromFile().
+	struct MeshCacheStats
+	{
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t cachedMeshCount = 0;
+		uint64_t residentBytes = 0; //Heap copies (joints), vertices are read in place from mappedBytes.
+		uint64_t mappedBytes = 0;
+	};
+
 	void ResetMeshData();
+	MeshCacheStats GetMeshCacheStats();
 
-	void BuildAllVMeshDataFromFBXImport();
+	void BuildAllVMeshDataFromFBXImport(VertexFormat vertexFormat = VertexFormat::Full);
 	void CreateVMeshFromInWorldMesh();
 	void BuildAllAnimationFilesFromFBXImport();
 
-	void BuildSingleVMeshFromFBX(const std::string fbxFilePath, const std::string fbxFilename);
-	void BuildSingleVAnimFromFBX(const std::string fbxAnimFilePath, const std::string fbxAnimFilename);
+	void BuildSingleVMeshFromFBX(const std::string fbxFilePath, const std::string fbxFilename,
+		VertexFormat vertexFormat = VertexFormat::Full);
+	//Writes a compressed .vanim v2. A non-zero uniformSampleRate resamples tracks and drops per-key times.
+	void BuildSingleVAnimFromFBX(const std::string fbxAnimFilePath, const std::string fbxAnimFilename,
+		float uniformSampleRate = 0.f);
 
 	MeshDataProxy ReadVMeshAssetFromFile(const std::string filename);
-	std::vector<Animation> ReadVAnimAssetFromFile(const std::string filename);
+	//jointCount is the skeleton the animations are for, v2 tracks for joints past it fail the load.
+	std::vector<Animation> ReadVAnimAssetFromFile(const std::string filename, uint32_t jointCount);
 
 	void BuildAllGameplayMapFiles();
 
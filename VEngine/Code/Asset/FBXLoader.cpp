@@ -14,6 +14,7 @@
 #include "Animation/Skeleton.h"
 #include "Render/Vertex.h"
 #include "Render/MeshData.h"
+#include "Render/MeshOptimiser.h"
 #include "Render/Material.h"
 
 using namespace fbxsdk;
@@ -82,6 +83,8 @@ void FBXLoader::ImportAsMesh(std::string filepath, MeshData& meshData)
 	assert(meshData.vertices.size() > 0 && "Nothing probably selected on fbx export in DCC.");
 	BoundingBox::CreateFromPoints(meshData.boundingBox, meshData.vertices.size(),
 		&meshData.vertices.at(0).pos, sizeof(Vertex));
+
+	MeshOptimiser::Optimise(meshData);
 }
 
 std::map<std::string, Animation> FBXLoader::ImportAsAnimation(const std::string filepath, const std::string filename)
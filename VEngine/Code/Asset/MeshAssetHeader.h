@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include "Render/VertexStreams.h"
 
 enum class SourceMeshFormat : uint8_t
 {
@@ -16,3 +17,43 @@ struct MeshAssetHeader
 
 	SourceMeshFormat sourceMeshFormat = SourceMeshFormat::FBX;
 };
+
+//Version 2 .vmesh files start with this header, followed by sectionCount MeshAssetSections, followed by the
+//section data. Sections are 16 byte aligned so the file can be memory-mapped and used in place.
+//Older files start straight with MeshAssetHeader (vertex count first), the magic tells them apart.
+struct MeshAssetHeaderV2
+{
+	inline static const uint32_t MAGIC = 0x48534D56; //"VMSH" in file order
+	//3: vertices split into Positions/Shading/Skin sections. Version 2 readers would skip them and load nothing.
+	//4: Indices section, vertices are welded and no longer triangle soup.
+	inline static const uint32_t CURRENT_VERSION = 4;
+	inline static const uint64_t SECTION_ALIGNMENT = 16;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = CURRENT_VERSION;
+	uint32_t sectionCount = 0;
+	SourceMeshFormat sourceMeshFormat = SourceMeshFormat::FBX;
+	VertexFormat vertexFormat = VertexFormat::Full; //Element layout of the Shading and Skin sections
+	uint8_t padding[2]{};
+};
+
+//Readers skip section types they don't know, so new ones can be added without a version bump.
+enum class MeshAssetSectionType : uint32_t
+{
+	Vertices, //Interleaved Vertex array, only in files written before the split streams. Converted on load.
+	BoundingBox,
+	Joints,
+	Positions,
+	Shading,
+	Skin, //Only for meshes with joints
+	Indices, //MeshData::indexDataType, three per triangle. Files without one are triangle soup.
+	SoupRemap //MeshData::indexDataType per vertex of the soup the mesh was welded from, see MeshData::soupRemap.
+};
+
+struct MeshAssetSection
+{
+	MeshAssetSectionType type = MeshAssetSectionType::Vertices;
+	uint32_t elementSize = 0; //Checked against the reader's struct size
+	uint64_t offset = 0; //From the start of the file
+	uint64_t count = 0;
+};
@@ -3,6 +3,8 @@
 #include "ICommand.h"
 #include "Core/Property.h"
 #include "Core/World.h"
+#include "Actors/Actor.h"
+#include "Components/Component.h"
 
 template <typename T>
 struct Command : ICommand
@@ -25,19 +27,40 @@ struct Command : ICommand
 			return;
 		}
 
-		auto allProps = actor->GetAllProps();
-		for (auto& props : allProps)
+		SetOn(actor);
+		for (Component* component : actor->GetAllComponents())
 		{
-			T* data = props.GetDataAllowNull<T>(prop.name);
-			if (data)
-			{
-				if (prop.change)
-				{
-					prop.change(prop);
-				}
+			SetOn(component);
+		}
+	}
+
+private:
+	//Types without a complete PropertyTable still go through GetProps().
+	template <typename Object>
+	void SetOn(Object* object)
+	{
+		const PropertyView view = object->GetPropertyView();
+		if (view.IsValid())
+		{
+			Set(view.GetDataAllowNull<T>(prop.name));
+		}
+		else
+		{
+			auto props = object->GetProps();
+			Set(props.template GetDataAllowNull<T>(prop.name));
+		}
+	}
 
-				*data = value;
+	void Set(T* data)
+	{
+		if (data)
+		{
+			if (prop.change)
+			{
+				prop.change(prop);
 			}
+
+			*data = value;
 		}
 	}
 };
@@ -1,9 +1,11 @@
 #include "vpch.h"
 #include "BoxTriggerComponent.h"
+#include <algorithm>
 #include "Components/MeshComponent.h"
 #include "Core/VMath.h"
 #include "Actors/Game/Player.h"
 #include "Physics/Raycast.h"
+#include "Core/World.h"
 
 BoxTriggerComponent::BoxTriggerComponent()
 {
@@ -14,11 +16,6 @@ BoxTriggerComponent::BoxTriggerComponent()
 	boundingBox.Extents = XMFLOAT3(0.45f, 0.45f, 0.45f);
 }
 
-void BoxTriggerComponent::Tick(float)
-{
-	TargetActorIntersectCallbackLogic();
-}
-
 Properties BoxTriggerComponent::GetProps()
 {
 	auto props = __super::GetProps();
@@ -40,18 +37,6 @@ bool BoxTriggerComponent::Contains(XMVECTOR point)
 	return bb.Contains(point);
 }
 
-bool BoxTriggerComponent::ContainsTarget()
-{
-	if (targetActor)
-	{
-		XMVECTOR targetPos = targetActor->GetPositionV();
-		bool result = Contains(targetPos);
-		return result;
-	}
-
-	return false;
-}
-
 void BoxTriggerComponent::SetTargetAsPlayer()
 {
 	targetActor = (Actor*)Player::system.GetFirstActor();
@@ -118,11 +103,76 @@ void BoxTriggerComponent::SetTriggerExitCallback(std::function<void()> callback)
 	triggerExitCallback = callback;
 }
 
+void BoxTriggerComponent::SetActorEnterCallback(std::function<void(Actor*)> callback)
+{
+	actorEnterCallback = callback;
+}
+
+void BoxTriggerComponent::SetActorStayCallback(std::function<void(Actor*)> callback)
+{
+	actorStayCallback = callback;
+}
+
+void BoxTriggerComponent::SetActorExitCallback(std::function<void(Actor*)> callback)
+{
+	actorExitCallback = callback;
+}
+
+void BoxTriggerComponent::UpdateOverlaps(std::vector<UID>& actorsInside)
+{
+	std::sort(actorsInside.begin(), actorsInside.end());
+	overlappingActors.swap(actorsInside);
+	const std::vector<UID>& previousActors = actorsInside;
+
+	TargetActorIntersectCallbackLogic();
+
+	if (!actorEnterCallback && !actorStayCallback && !actorExitCallback)
+	{
+		return;
+	}
+
+	//Both lists are sorted, so one merge walk splits them into entered, stayed and exited.
+	//Actors are looked up per event as a callback is free to remove any of them (removal is deferred).
+	const auto dispatch = [](const std::function<void(Actor*)>& callback, UID actorUID)
+		{
+			if (callback)
+			{
+				if (Actor* actor = World::GetActorByUIDAllowNull(actorUID))
+				{
+					callback(actor);
+				}
+			}
+		};
+
+	const std::vector<UID>& currentActors = overlappingActors;
+
+	size_t current = 0, previous = 0;
+	while (current < currentActors.size() || previous < previousActors.size())
+	{
+		if (previous == previousActors.size() ||
+			(current < currentActors.size() && currentActors[current] < previousActors[previous]))
+		{
+			dispatch(actorEnterCallback, currentActors[current++]);
+		}
+		else if (current == currentActors.size() || previousActors[previous] < currentActors[current])
+		{
+			dispatch(actorExitCallback, previousActors[previous++]);
+		}
+		else
+		{
+			dispatch(actorStayCallback, currentActors[current]);
+			current++;
+			previous++;
+		}
+	}
+}
+
 void BoxTriggerComponent::TargetActorIntersectCallbackLogic()
 {
 	if (targetActor)
 	{
-		const bool newIntersectingValue = ContainsTarget();
+		const bool newIntersectingValue = std::binary_search(overlappingActors.begin(), overlappingActors.end(),
+			targetActor->GetUID());
 		if (targetActorIntersecting == !newIntersectingValue)
 		{
 			targetActorIntersecting = newIntersectingValue;
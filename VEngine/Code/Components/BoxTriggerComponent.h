@@ -3,6 +3,7 @@
 #include "SpatialComponent.h"
 #include "ComponentSystem.h"
 #include <functional>
+#include "Core/UID.h"
 
 class Actor;
 struct HitResult;
@@ -16,7 +17,6 @@ public:
 	XMFLOAT4 renderWireframeColour = XMFLOAT4(0.1f, 0.75f, 0.1f, 1.0f);
 
 	BoxTriggerComponent();
-	void Tick(float deltaTime) override;
 	Properties GetProps() override;
 
 	//Remember to set arg as bounds in world space
@@ -24,7 +24,9 @@ public:
 	bool IntersectsWithAnyBoundingBoxInWorld();
 
 	bool Contains(XMVECTOR point);
-	bool ContainsTarget();
+
+	//Whether the target actor was inside as of the last TriggerSystem::Tick().
+	bool ContainsTarget() const { return targetActorIntersecting; }
 	void SetTargetAsPlayer();
 	XMVECTOR GetRandomPointInTrigger();
 
@@ -36,9 +38,40 @@ public:
 	Actor* GetTargetActor() { return targetActor; }
 	Actor* SetTargetActor(Actor* actor) { targetActor = actor; }
 
+	//Called when the target actor enters or exits.
 	void SetTriggerEnterCallback(std::function<void()> callback);
 	void SetTriggerExitCallback(std::function<void()> callback);
 
+	//Called with any actor in world that entered, is still inside or exited since the last TriggerSystem::Tick().
+	//Stay is called every frame for every actor inside, so leave it unset unless it's needed.
+	void SetActorEnterCallback(std::function<void(Actor*)> callback);
+	void SetActorStayCallback(std::function<void(Actor*)> callback);
+	void SetActorExitCallback(std::function<void(Actor*)> callback);
+
+	//Actors inside as of the last TriggerSystem::Tick(), sorted by UID.
+	const std::vector<UID>& GetOverlappingActorUIDs() const { return overlappingActors; }
+
+	//Same as GetAllContainedActors(), but from the overlaps TriggerSystem already worked out this frame
+	//instead of testing every actor of type T again.
+	template <typename T>
+	std::vector<T*> GetOverlappingActors()
+	{
+		std::vector<T*> actors;
+		for (const UID actorUID : overlappingActors)
+		{
+			T* actor = dynamic_cast<T*>(World::GetActorByUIDAllowNull(actorUID));
+			if (actor)
+			{
+				actors.emplace_back(actor);
+			}
+		}
+		return actors;
+	}
+
+	//Takes the actors TriggerSystem found inside this frame (swapped out for the previous frame's) and calls
+	//the enter/stay/exit callbacks for the differences.
+	void UpdateOverlaps(std::vector<UID>& actorsInside);
+
 	template <typename T>
 	std::vector<T*> GetAllContainedActors()
 	{
@@ -63,6 +96,12 @@ private:
 	std::function<void()> triggerEnterCallback;
 	std::function<void()> triggerExitCallback;
 
+	std::function<void(Actor*)> actorEnterCallback;
+	std::function<void(Actor*)> actorStayCallback;
+	std::function<void(Actor*)> actorExitCallback;
+
+	std::vector<UID> overlappingActors;
+
 	Actor* targetActor = nullptr;
 
 	bool targetActorIntersecting = false;
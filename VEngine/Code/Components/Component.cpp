@@ -1,5 +1,6 @@
 #include "vpch.h"
 #include "Component.h"
+#include "IComponentSystem.h"
 #include "Core/Log.h"
 #include "Core/World.h"
 
@@ -15,13 +16,48 @@ Properties Component::GetProps()
 
 	//props.Add("Name", &name).hide = true;
 	//props.Add("OwnerUID", &ownerUID).hide = true;
-	props.Add(" Enabled", &active);
+	props.Add(" Enabled", &active).change = [this](Property&) { NotifyTickStateChanged(); };
 	props.Add(" Visible", &visible);
 	props.Add("UID", &uid).hide = true;
 
 	return props;
 }
 
+void Component::SetActive(bool newActive)
+{
+	active = newActive;
+	NotifyTickStateChanged();
+}
+
+void Component::ToggleActive()
+{
+	active = !active;
+	NotifyTickStateChanged();
+}
+
+void Component::SetTickEnabled(bool newTickState)
+{
+	tickEnabled = newTickState;
+	NotifyTickStateChanged();
+}
+
+void Component::SetUID(UID uid_)
+{
+	uid = uid_;
+	if (componentSystem)
+	{
+		componentSystem->OnComponentUIDChanged();
+	}
+}
+
+void Component::NotifyTickStateChanged()
+{
+	if (componentSystem)
+	{
+		componentSystem->OnComponentTickStateChanged();
+	}
+}
+
 std::string Component::GetTypeName()
 {
 	return componentSystem->GetName();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Properties.h"
+#include "Core/PropertyTable.h"
 #include "Core/UID.h"
 #include <set>
 
@@ -20,6 +21,9 @@ public:
 
 	virtual Properties GetProps();
 
+	//The type's PropertyTable bound to this component. Defined in COMPONENT_SYSTEM, returns an invalid view otherwise.
+	virtual PropertyView GetPropertyView() { return {}; }
+
 	//Returns pruned typeid() name from linked Component System.
 	std::string GetTypeName();
 
@@ -27,8 +31,8 @@ public:
 	bool HasTag(const std::string& tag);
 
 	bool IsActive() const { return active; }
-	void SetActive(bool newActive) { active = newActive; }
-	void ToggleActive() { active = !active; }
+	void SetActive(bool newActive);
+	void ToggleActive();
 
 	auto GetIndex() const { return index; }
 	void SetIndex(size_t newIndex) { index = newIndex; }
@@ -36,7 +40,7 @@ public:
 	void SetComponentSystem(IComponentSystem* componentSystem_) { componentSystem = componentSystem_; }
 
 	auto GetUID() const { return uid; }
-	void SetUID(UID uid_) { uid = uid_; }
+	void SetUID(UID uid_);
 
 	auto GetOwnerUID() const { return ownerUID; }
 	void SetOwnerUID(UID ownerUID_) { ownerUID = ownerUID_; }
@@ -44,7 +48,7 @@ public:
 	Actor* GetOwner();
 
 	bool IsTickEnabled() const { return tickEnabled; }
-	void SetTickEnabled(bool newTickState) { tickEnabled = newTickState; }
+	void SetTickEnabled(bool newTickState);
 
 	bool IsVisible() const { return visible; }
 	void SetVisibility(bool isVisible) { visible = isVisible; }
@@ -57,6 +61,8 @@ public:
 	void SetName(std::string_view name) { _name = name; }
 
 private:
+	void NotifyTickStateChanged();
+
 	std::string _name;
 	std::set<std::string> tags;
 	IComponentSystem* componentSystem = nullptr;
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+//Storage policies for ComponentSystem<T, Storage>.
+//HeapComponentStorage is the default, one allocation per component.
+//PooledComponentStorage keeps components of a type together in fixed-size chunks. Chunks are never moved or
+//freed until the pool goes away, so component addresses stay stable like they do with the heap policy.
+
+//Refers to a component without holding a pointer to it. Once the component is removed, the handle's
+//generation no longer matches its slot and ComponentSystem::Get() returns null instead of a dangling pointer.
+template <typename T>
+struct ComponentHandle
+{
+	static constexpr uint32_t invalidSlot = UINT32_MAX;
+
+	uint32_t slot = invalidSlot;
+	uint32_t generation = 0;
+
+	bool IsNull() const { return slot == invalidSlot; }
+
+	bool operator==(const ComponentHandle& other) const { return slot == other.slot && generation == other.generation; }
+	bool operator!=(const ComponentHandle& other) const { return !(*this == other); }
+};
+
+template <typename T, uint32_t ChunkSize = 64>
+class ComponentPool
+{
+public:
+	ComponentPool() = default;
+	ComponentPool(const ComponentPool&) = delete;
+	ComponentPool& operator=(const ComponentPool&) = delete;
+
+	//Components aren't destructed here, the owning ComponentSystem frees every live slot first.
+	~ComponentPool() = default;
+
+	T* Allocate(T&& component, uint32_t& outSlot)
+	{
+		if (!freeSlots.empty())
+		{
+			outSlot = freeSlots.back();
+			freeSlots.pop_back();
+		}
+		else
+		{
+			outSlot = slotCount++;
+			if (outSlot / ChunkSize >= chunks.size())
+			{
+				chunks.emplace_back(std::make_unique<Chunk>());
+			}
+		}
+
+		liveCount++;
+		return new (GetSlotAddress(outSlot)) T(std::move(component));
+	}
+
+	void Free(uint32_t slot)
+	{
+		GetSlotAddress(slot)->~T();
+		freeSlots.emplace_back(slot);
+		liveCount--;
+	}
+
+	size_t GetLiveCount() const { return liveCount; }
+	size_t GetCapacity() const { return chunks.size() * ChunkSize; }
+
+private:
+	struct Chunk
+	{
+		alignas(T) unsigned char storage[sizeof(T) * ChunkSize];
+	};
+
+	T* GetSlotAddress(uint32_t slot)
+	{
+		return reinterpret_cast<T*>(chunks[slot / ChunkSize]->storage) + slot % ChunkSize;
+	}
+
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	std::vector<uint32_t> freeSlots;
+	uint32_t slotCount = 0;
+	size_t liveCount = 0;
+};
+
+//Non-owning stand-in for std::unique_ptr<T> in a pooled ComponentSystem's component list, so loops over
+//GetComponents() read the same for both storage policies.
+template <typename T>
+class PooledComponentPtr
+{
+public:
+	PooledComponentPtr() = default;
+	PooledComponentPtr(T* component_, uint32_t poolSlot_) : component(component_), poolSlot(poolSlot_) {}
+
+	T* get() const { return component; }
+	T* operator->() const { return component; }
+	T& operator*() const { return *component; }
+	explicit operator bool() const { return component != nullptr; }
+
+	uint32_t GetPoolSlot() const { return poolSlot; }
+
+private:
+	T* component = nullptr;
+	uint32_t poolSlot = 0;
+};
+
+template <typename T>
+struct HeapComponentStorage
+{
+	using Pointer = std::unique_ptr<T>;
+
+	Pointer Create(T&& component)
+	{
+		return std::make_unique<T>(std::move(component));
+	}
+
+	void Destroy(Pointer& pointer)
+	{
+		pointer.reset();
+	}
+};
+
+template <typename T>
+struct PooledComponentStorage
+{
+	using Pointer = PooledComponentPtr<T>;
+
+	Pointer Create(T&& component)
+	{
+		uint32_t poolSlot = 0;
+		T* pooledComponent = pool.Allocate(std::move(component), poolSlot);
+		return Pointer(pooledComponent, poolSlot);
+	}
+
+	void Destroy(Pointer& pointer)
+	{
+		pool.Free(pointer.GetPoolSlot());
+		pointer = Pointer();
+	}
+
+	ComponentPool<T> pool;
+};
@@ -1,19 +1,29 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 #include "IComponentSystem.h"
+#include "ComponentStorage.h"
 #include "Core/SystemStates.h"
 #include "Actors/Actor.h"
 #include "ComponentSystemCache.h"
 #include "Core/Serialiser.h"
+#include "Core/BinarySerialiser.h"
 #include "Core/VString.h"
 #include "Editor/Editor.h"
 #include "Core/World.h"
 
-template <typename T>
+//Storage is HeapComponentStorage (one allocation per component) or PooledComponentStorage (chunked, see
+//ComponentStorage.h), picked per type with COMPONENT_SYSTEM or COMPONENT_SYSTEM_POOLED.
+//Either way GetComponents() is a dense list, lookups by UID go through a hash index and Tick() only walks
+//the components that are active with ticking enabled.
+template <typename T, typename Storage = HeapComponentStorage<T>>
 class ComponentSystem : public IComponentSystem
 {
 public:
+	using ComponentPointer = typename Storage::Pointer;
+
 	ComponentSystem()
 	{
 		std::string typeName = typeid(T).name();
@@ -23,15 +33,27 @@ public:
 		ComponentSystemCache::Get().Add(typeid(T), this);
 	}
 
+	~ComponentSystem()
+	{
+		ReleaseAllComponents();
+	}
+
 	T* Add(std::string name, Actor* owner = nullptr, T newComponent = T(), bool callCreate = false)
 	{
-		components.emplace_back(std::make_unique<T>(std::move(newComponent)));
-		auto& component = components.back();
+		components.emplace_back(storage.Create(std::move(newComponent)));
+		T* component = components.back().get();
 
-		component->SetIndex(components.size() - 1);
-		component->SetComponentSystem(this);
+		const size_t index = components.size() - 1;
+		componentHandleSlots.emplace_back(AllocateHandleSlot(index));
+
+		//UID is set before the system so that it doesn't flag the whole UID index for a rebuild.
+		component->SetIndex(index);
 		component->SetName(name);
 		component->SetUID(GenerateUID());
+		component->SetComponentSystem(this);
+
+		uidToIndex[component->GetUID()] = index;
+		tickListDirty = true;
 
 		if (systemState == SystemStates::Loaded && callCreate)
 		{
@@ -40,13 +62,13 @@ public:
 
 		if (owner)
 		{
-			owner->AddComponent(component.get());
+			owner->AddComponent(component);
 		}
 
-		return component.get();
+		return component;
 	}
 
-	std::vector<std::unique_ptr<T>>& GetComponents()
+	std::vector<ComponentPointer>& GetComponents()
 	{
 		return components;
 	}
@@ -58,8 +80,25 @@ public:
 
 	void Remove(size_t index)
 	{
+		T* removedComponent = components[index].get();
+
+		RemoveFromTickList(removedComponent);
+
+		auto uidIt = uidToIndex.find(removedComponent->GetUID());
+		if (uidIt != uidToIndex.end() && uidIt->second == index)
+		{
+			uidToIndex.erase(uidIt);
+		}
+
 		std::swap(components[index], components.back());
+		std::swap(componentHandleSlots[index], componentHandleSlots.back());
+
 		components[index]->SetIndex(index);
+		handleSlots[componentHandleSlots[index]].componentIndex = static_cast<uint32_t>(index);
+		if (index != components.size() - 1)
+		{
+			uidToIndex[components[index]->GetUID()] = index;
+		}
 
 		if (components.back()->GetOwnerUID() != 0)
 		{
@@ -67,6 +106,10 @@ public:
 			owner->RemoveComponent(components.back().get());
 		}
 
+		FreeHandleSlot(componentHandleSlots.back());
+		componentHandleSlots.pop_back();
+
+		storage.Destroy(components.back());
 		components.pop_back();
 
 		//Make sure the Properties Dock is reset else you'll have widgets trying to access invalid pointers to components.
@@ -81,6 +124,10 @@ public:
 		}
 
 		systemState = SystemStates::Loaded;
+
+		//Deserialising writes UIDs and active flags straight through their properties.
+		uidIndexDirty = true;
+		tickListDirty = true;
 	}
 
 	virtual void Start() override
@@ -93,13 +140,33 @@ public:
 
 	virtual void Tick(float deltaTime) override
 	{
-		for (int i = 0; i < components.size(); i++)
+		if (tickListDirty)
+		{
+			RebuildTickList();
+		}
+
+		//Indexed because ticks can remove components, see RemoveFromTickList().
+		//The list is only rebuilt next frame, so components switched off by an earlier tick are skipped here.
+		ticking = true;
+		for (tickCursor = 0; tickCursor < tickComponents.size(); tickCursor++)
 		{
-			if (components[i]->IsActive() && components[i]->IsTickEnabled())
+			T* component = tickComponents[tickCursor];
+			if (component->IsActive() && component->IsTickEnabled())
 			{
-				components[i]->Tick(deltaTime);
+				component->Tick(deltaTime);
 			}
 		}
+		ticking = false;
+	}
+
+	virtual void OnComponentTickStateChanged() override
+	{
+		tickListDirty = true;
+	}
+
+	virtual void OnComponentUIDChanged() override
+	{
+		uidIndexDirty = true;
 	}
 
 	T* GetFirstComponent()
@@ -114,10 +181,28 @@ public:
 
 	T* GetComponentByUID(UID uid)
 	{
+		if (uidIndexDirty)
+		{
+			RebuildUIDIndex();
+		}
+
+		auto uidIt = uidToIndex.find(uid);
+		if (uidIt != uidToIndex.end() && uidIt->second < components.size())
+		{
+			T* component = components[uidIt->second].get();
+			if (component->GetUID() == uid)
+			{
+				return component;
+			}
+		}
+
+		//UIDs can still be written through GetProps() without a notify, so a miss falls back to a scan
+		//and the index is rebuilt if that finds it.
 		for (auto& component : components)
 		{
 			if (component->GetUID() == uid)
 			{
+				RebuildUIDIndex();
 				return component.get();
 			}
 		}
@@ -125,6 +210,34 @@ public:
 		return nullptr;
 	}
 
+	ComponentHandle<T> GetHandle(const T* component) const
+	{
+		ComponentHandle<T> handle;
+		if (component)
+		{
+			handle.slot = componentHandleSlots[component->GetIndex()];
+			handle.generation = handleSlots[handle.slot].generation;
+		}
+		return handle;
+	}
+
+	//Null if the component the handle was made from has since been removed.
+	T* Get(ComponentHandle<T> handle)
+	{
+		if (handle.IsNull() || handle.slot >= handleSlots.size())
+		{
+			return nullptr;
+		}
+
+		const HandleSlot& handleSlot = handleSlots[handle.slot];
+		if (handleSlot.generation != handle.generation || handleSlot.componentIndex == HandleSlot::freeIndex)
+		{
+			return nullptr;
+		}
+
+		return components[handleSlot.componentIndex].get();
+	}
+
 	T* GetComponentByName(std::string name)
 	{
 		for (auto& component : components)
@@ -148,8 +261,16 @@ public:
 			s.WriteLine(component->GetOwnerUID());
 			s.WriteLine(VString::stows(component->GetName()));
 
-			auto props = component->GetProps();
-			s.Serialise(props);
+			const PropertyView view = GetPropertyView(component.get());
+			if (view.IsValid())
+			{
+				s.Serialise(view);
+			}
+			else
+			{
+				auto props = component->GetProps();
+				s.Serialise(props);
+			}
 
 			s.WriteLine(L"next");
 		}
@@ -157,37 +278,55 @@ public:
 
 	virtual void SerialiseBinary(BinarySerialiser& s) override
 	{
-		s.WriteString(_name);
-		size_t numComponents = components.size();
-		s.Write(&numComponents);
+		s.BeginSystem(_name, WorldBinarySystemKind::Component);
 
 		for (auto& component : components)
 		{
-			UID ownerUID = component->GetOwnerUID();
-			s.Write(&ownerUID);
-			s.WriteString(component->GetName());
-
-			auto props = component->GetProps();
-			s.Serialise(props);
+			const PropertyView view = GetPropertyView(component.get());
+			if (view.IsValid())
+			{
+				s.SerialiseComponent(component->GetOwnerUID(), component->GetName(), view);
+			}
+			else
+			{
+				auto props = component->GetProps();
+				s.SerialiseComponent(component->GetOwnerUID(), component->GetName(), props);
+			}
 		}
+
+		s.EndSystem();
 	}
 
 	virtual void Deserialise(Deserialiser& d) override
 	{
 		for (auto& component : components)
 		{
-			auto props = component->GetProps();
-			d.Deserialise(props);
+			const PropertyView view = GetPropertyView(component.get());
+			if (view.IsValid())
+			{
+				d.Deserialise(view);
+			}
+			else
+			{
+				auto props = component->GetProps();
+				d.Deserialise(props);
+			}
 		}
+
+		uidIndexDirty = true;
+		tickListDirty = true;
 	}
 
-	virtual void DeserialiseBinary(BinaryDeserialiser& d) override
+	//The table is built from the first component asked for, every T declares the same props in GetProps().
+	PropertyView GetPropertyView(T* component)
 	{
-		for (auto& component : components)
+		if (!propertyTable.IsBuilt())
 		{
 			auto props = component->GetProps();
-			d.Deserialise(props);
+			propertyTable.Build(props, component, sizeof(T), nullptr);
 		}
+
+		return { &propertyTable, component, nullptr, component->GetOwnerUID() };
 	}
 
 	virtual void DestroyAll() override
@@ -200,7 +339,7 @@ public:
 
 	virtual void Cleanup() override
 	{
-		components.clear();
+		ReleaseAllComponents();
 		systemState = SystemStates::Unloaded;
 	}
 
@@ -238,9 +377,129 @@ public:
 	}
 
 private:
-	std::vector<std::unique_ptr<T>> components;
+	struct HandleSlot
+	{
+		static constexpr uint32_t freeIndex = UINT32_MAX;
+
+		uint32_t componentIndex = freeIndex;
+		uint32_t generation = 0;
+	};
+
+	uint32_t AllocateHandleSlot(size_t componentIndex)
+	{
+		uint32_t slot = 0;
+		if (!freeHandleSlots.empty())
+		{
+			slot = freeHandleSlots.back();
+			freeHandleSlots.pop_back();
+		}
+		else
+		{
+			slot = static_cast<uint32_t>(handleSlots.size());
+			handleSlots.emplace_back();
+		}
+
+		handleSlots[slot].componentIndex = static_cast<uint32_t>(componentIndex);
+		return slot;
+	}
+
+	void FreeHandleSlot(uint32_t slot)
+	{
+		handleSlots[slot].componentIndex = HandleSlot::freeIndex;
+		handleSlots[slot].generation++;
+		freeHandleSlots.emplace_back(slot);
+	}
+
+	void ReleaseAllComponents()
+	{
+		for (uint32_t slot : componentHandleSlots)
+		{
+			FreeHandleSlot(slot);
+		}
+		componentHandleSlots.clear();
+
+		for (auto& component : components)
+		{
+			storage.Destroy(component);
+		}
+		components.clear();
+
+		uidToIndex.clear();
+		uidIndexDirty = false;
+		tickComponents.clear();
+		tickListDirty = false;
+	}
+
+	void RebuildUIDIndex()
+	{
+		uidToIndex.clear();
+		uidToIndex.reserve(components.size());
+		for (size_t i = 0; i < components.size(); i++)
+		{
+			uidToIndex[components[i]->GetUID()] = i;
+		}
+		uidIndexDirty = false;
+	}
+
+	void RebuildTickList()
+	{
+		tickComponents.clear();
+		for (auto& component : components)
+		{
+			if (component->IsActive() && component->IsTickEnabled())
+			{
+				tickComponents.emplace_back(component.get());
+			}
+		}
+		tickListDirty = false;
+	}
+
+	//Ticks can remove components (including themselves), the cursor is moved back so nothing is skipped.
+	void RemoveFromTickList(T* component)
+	{
+		auto it = std::find(tickComponents.begin(), tickComponents.end(), component);
+		if (it == tickComponents.end())
+		{
+			return;
+		}
+
+		const size_t position = std::distance(tickComponents.begin(), it);
+		tickComponents.erase(it);
+
+		if (ticking && position <= tickCursor)
+		{
+			tickCursor--;
+		}
+	}
+
+	Storage storage;
+
+	std::vector<ComponentPointer> components;
+
+	//Generational handle slot of each entry in components, and the other way round.
+	std::vector<uint32_t> componentHandleSlots;
+	std::vector<HandleSlot> handleSlots;
+	std::vector<uint32_t> freeHandleSlots;
+
+	std::unordered_map<UID, size_t> uidToIndex;
+	bool uidIndexDirty = false;
+
+	std::vector<T*> tickComponents;
+	size_t tickCursor = 0;
+	bool tickListDirty = false;
+	bool ticking = false;
+
+	PropertyTable propertyTable;
 };
 
 #define COMPONENT_SYSTEM(type) \
 inline static ComponentSystem<type> system; \
 virtual void Remove() override { system.Remove(GetIndex()); } \
+virtual PropertyView GetPropertyView() override { return system.GetPropertyView(this); } \
+
+//Same as COMPONENT_SYSTEM with the components kept together in a chunked pool (see ComponentStorage.h).
+//For types that get into the thousands per level.
+#define COMPONENT_SYSTEM_POOLED(type) \
+inline static ComponentSystem<type, PooledComponentStorage<type>> system; \
+virtual void Remove() override { system.Remove(GetIndex()); } \
+virtual PropertyView GetPropertyView() override { return system.GetPropertyView(this); }
@@ -32,13 +32,13 @@ void DestructibleMeshComponent::Create()
 		mesh->SetPhysicsStatic(false);
 
 		mesh->meshDataProxy.boundingBox = &meshData.boundingBox;
-		mesh->meshDataProxy.vertices = meshData.vertices;
+		mesh->meshDataProxy.SetVertices(meshData.vertices);
 		mesh->meshDataProxy.skeleton = &meshData.skeleton;
 
 		//Setup bounds
 		auto meshBoundingBox = mesh->GetBoundsInWorldSpace();
-		BoundingOrientedBox::CreateFromPoints(meshBoundingBox, mesh->meshDataProxy.vertices.size(),
-			&mesh->meshDataProxy.vertices.at(0).pos, sizeof(Vertex));
+		const auto positions = mesh->meshDataProxy.GetPositions();
+		BoundingOrientedBox::CreateFromPoints(meshBoundingBox, positions.size(), positions.data(), positions.stride());
 
 		mesh->CreateVertexBuffer();
 
@@ -8,7 +8,6 @@ class Actor;
 class Serialiser;
 class BinarySerialiser;
 class Deserialiser;
-class BinaryDeserialiser;
 
 class IComponentSystem
 {
@@ -21,13 +20,16 @@ public:
 	virtual void Serialise(Serialiser& s) = 0;
 	virtual void SerialiseBinary(BinarySerialiser& s) = 0;
 	virtual void Deserialise(Deserialiser& s) = 0;
-	virtual void DeserialiseBinary(BinaryDeserialiser& d) = 0;
 	virtual Component* SpawnComponent(Actor* owner) = 0;
 	virtual std::vector<Component*> GetComponentsAsBaseClass() = 0;
 	virtual size_t GetNumComponents() = 0;
 	virtual bool Empty() = 0;
 	virtual Component* FindComponentByName(std::string componentName) = 0;
 
+	//Called by components so the system's tick list and UID index are rebuilt before they're next used.
+	virtual void OnComponentTickStateChanged() = 0;
+	virtual void OnComponentUIDChanged() = 0;
+
 	auto GetName() { return _name; }
 
 protected:
@@ -1,8 +1,15 @@
 #include "vpch.h"
 #include "InstanceMeshComponent.h"
+#include <algorithm>
+#include <cfloat>
+#include "Render/Renderer.h"
 #include "Render/RenderUtils.h"
 #include "Render/ShaderData/InstanceData.h"
 
+//Changed instances this close together are uploaded as one range, a few unchanged instances in between
+//cost less than another UpdateSubresource() call.
+static constexpr uint32_t maxUploadRangeGap = 8;
+
 InstanceMeshComponent::InstanceMeshComponent(uint32_t meshInstanceRenderCount_,
 	const std::string filename,
 	const std::string textureFilename,
@@ -12,30 +19,21 @@ InstanceMeshComponent::InstanceMeshComponent(uint32_t meshInstanceRenderCount_,
 	meshInstanceRenderCount = meshInstanceRenderCount_;
 
 	instanceData.resize(meshInstanceRenderCount);
+	MarkAllInstancesDirty();
 }
 
 void InstanceMeshComponent::Create()
 {
 	MeshComponent::Create();
 
+	//Keep at least one instance so that the SRV buffers don't blow up when creating them.
 	if (instanceData.empty())
 	{
 		instanceData.emplace_back(InstanceData());
 	}
 
-	uint32_t meshCount = meshInstanceRenderCount;
-
-	//Set a default of 1 if 0 so that the SRV buffers don't blow up when creating them.
-	if (meshCount == 0)
-	{
-		meshCount = 1;
-	}
-
-	//Setup shader buffers
-	RenderUtils::CreateStructuredBuffer(sizeof(InstanceData) * meshCount,
-		sizeof(InstanceData), instanceData.data(), structuredBuffer);
-
-	RenderUtils::CreateSRVForMeshInstance(structuredBuffer.Get(), meshCount, srv);
+	MarkAllInstancesDirty();
+	UploadInstanceData();
 }
 
 void InstanceMeshComponent::SetInstanceCount(uint32_t count)
@@ -48,10 +46,169 @@ uint32_t InstanceMeshComponent::GetInstanceCount()
 	return meshInstanceRenderCount;
 }
 
-void InstanceMeshComponent::SetInstanceData(std::vector<InstanceData>& instanceData_)
+void InstanceMeshComponent::SetInstanceData(const std::vector<InstanceData>& instanceData_)
 {
-	instanceData.clear();
 	instanceData = instanceData_;
+	MarkAllInstancesDirty();
+}
+
+InstanceData& InstanceMeshComponent::GetInstance(size_t index)
+{
+	InstanceData& instance = instanceData.at(index);
+
+	uint8_t& flags = instanceDirtyFlags[index];
+	if (!(flags & UploadDirty))
+	{
+		instancesToUpload.emplace_back(static_cast<uint32_t>(index));
+	}
+	if (!(flags & BoundsDirty))
+	{
+		instancesToUpdateBounds.emplace_back(static_cast<uint32_t>(index));
+	}
+	flags = UploadDirty | BoundsDirty;
+
+	return instance;
+}
+
+void InstanceMeshComponent::MarkAllInstancesDirty()
+{
+	//Per instance flags aren't needed while everything is going up anyway.
+	instanceDirtyFlags.assign(instanceData.size(), UploadDirty | BoundsDirty);
+	instancesToUpload.clear();
+	instancesToUpdateBounds.clear();
+	uploadAllInstances = true;
+	updateAllInstanceBounds = true;
+}
+
+bool InstanceMeshComponent::GrowBuffers()
+{
+	const uint32_t instanceCount = static_cast<uint32_t>(std::max<size_t>(instanceData.size(), 1));
+	if (structuredBuffer && instanceCount <= bufferCapacity)
+	{
+		return false;
+	}
+
+	//Grow geometrically so that instance data growing a bit at a time doesn't recreate buffers every time.
+	bufferCapacity = std::max(instanceCount, bufferCapacity * 2);
+
+	RenderUtils::CreateDefaultStructuredBuffer(sizeof(InstanceData) * bufferCapacity,
+		sizeof(InstanceData), nullptr, structuredBuffer);
+	RenderUtils::CreateSRVForMeshInstance(structuredBuffer.Get(), bufferCapacity, srv);
+
+	RenderUtils::CreateStructuredBuffer(sizeof(uint32_t) * bufferCapacity,
+		sizeof(uint32_t), nullptr, visibleInstanceBuffer);
+	RenderUtils::CreateSRVForMeshInstance(visibleInstanceBuffer.Get(), bufferCapacity, visibleInstanceSrv);
+
+	return true;
+}
+
+void InstanceMeshComponent::UploadInstanceRange(uint32_t begin, uint32_t end)
+{
+	D3D11_BOX box = {};
+	box.left = begin * sizeof(InstanceData);
+	box.right = end * sizeof(InstanceData);
+	box.bottom = 1;
+	box.back = 1;
+
+	Renderer::GetDeviceContext().UpdateSubresource(structuredBuffer.Get(), 0, &box, &instanceData[begin], 0, 0);
+}
+
+void InstanceMeshComponent::UploadInstanceData()
+{
+	if (instanceData.empty())
+	{
+		return;
+	}
+
+	if (GrowBuffers())
+	{
+		uploadAllInstances = true;
+	}
+
+	//Past half the instances, sorting and splitting into ranges isn't worth it.
+	if (uploadAllInstances || instancesToUpload.size() * 2 > instanceData.size())
+	{
+		UploadInstanceRange(0, static_cast<uint32_t>(instanceData.size()));
+
+		for (uint8_t& flags : instanceDirtyFlags)
+		{
+			flags &= ~UploadDirty;
+		}
+	}
+	else if (!instancesToUpload.empty())
+	{
+		std::sort(instancesToUpload.begin(), instancesToUpload.end());
+
+		uint32_t rangeBegin = instancesToUpload.front();
+		uint32_t rangeEnd = rangeBegin + 1;
+		for (const uint32_t index : instancesToUpload)
+		{
+			if (index > rangeEnd + maxUploadRangeGap)
+			{
+				UploadInstanceRange(rangeBegin, rangeEnd);
+				rangeBegin = index;
+			}
+			rangeEnd = index + 1;
+			instanceDirtyFlags[index] &= ~UploadDirty;
+		}
+		UploadInstanceRange(rangeBegin, rangeEnd);
+	}
+
+	instancesToUpload.clear();
+	uploadAllInstances = false;
+}
+
+void InstanceMeshComponent::SetInstanceBounds(size_t index)
+{
+	BoundingOrientedBox worldBounds;
+	boundingBox.Transform(worldBounds, instanceData[index].world);
+	instanceBounds.Set(index, worldBounds, cullDistance);
+}
+
+void InstanceMeshComponent::UpdateInstanceBounds()
+{
+	//Cull distance is baked into the bounds, so a change to it has to redo all of them.
+	if (instanceBoundsCullDistance != cullDistance)
+	{
+		instanceBoundsCullDistance = cullDistance;
+		updateAllInstanceBounds = true;
+	}
+
+	if (updateAllInstanceBounds)
+	{
+		instanceBounds.Resize(instanceData.size());
+		for (size_t i = 0; i < instanceData.size(); i++)
+		{
+			SetInstanceBounds(i);
+			instanceDirtyFlags[i] &= ~BoundsDirty;
+		}
+	}
+	else if (!instancesToUpdateBounds.empty())
+	{
+		for (const uint32_t index : instancesToUpdateBounds)
+		{
+			SetInstanceBounds(index);
+			instanceDirtyFlags[index] &= ~BoundsDirty;
+		}
+	}
+	else
+	{
+		return;
+	}
+
+	instancesToUpdateBounds.clear();
+	updateAllInstanceBounds = false;
+
+	XMVECTOR boundsMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR boundsMax = XMVectorReplicate(-FLT_MAX);
+	for (size_t i = 0; i < instanceBounds.count; i++)
+	{
+		const XMVECTOR center = XMVectorSet(instanceBounds.centerX[i], instanceBounds.centerY[i], instanceBounds.centerZ[i], 0.f);
+		const XMVECTOR extents = XMVectorSet(instanceBounds.extentsX[i], instanceBounds.extentsY[i], instanceBounds.extentsZ[i], 0.f);
+		boundsMin = XMVectorMin(boundsMin, center - extents);
+		boundsMax = XMVectorMax(boundsMax, center + extents);
+	}
+	BoundingBox::CreateFromPoints(combinedInstanceBounds, boundsMin, boundsMax);
 }
 
 Properties InstanceMeshComponent::GetProps()
@@ -71,4 +228,15 @@ void InstanceMeshComponent::ReleaseBuffers()
 	{
 		srv.Reset();
 	}
+	if (visibleInstanceBuffer)
+	{
+		visibleInstanceBuffer.Reset();
+	}
+	if (visibleInstanceSrv)
+	{
+		visibleInstanceSrv.Reset();
+	}
+
+	bufferCapacity = 0;
+	uploadAllInstances = true;
 }
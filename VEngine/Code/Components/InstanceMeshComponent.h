@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Components/MeshComponent.h"
+#include "Render/Culling.h"
 #include "Render/ShaderData/InstanceData.h"
 #include <wrl.h>
 
@@ -8,6 +9,8 @@ struct ID3D11Buffer;
 struct ID3D11ShaderResourceView;
 
 //InstanceMeshComponent doesn't have the individual meshes moved around in editor right now.
+//Only instances changed since the last upload are copied into the structured buffer, so edits have to go
+//through GetInstance() or SetInstanceData() to be seen by the GPU.
 class InstanceMeshComponent : public MeshComponent
 {
 public:
@@ -16,6 +19,14 @@ public:
 	Microsoft::WRL::ComPtr<ID3D11Buffer> structuredBuffer;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
 
+	//Indices of the instances that passed culling. The instance vertex shader looks up instance data through
+	//these, so only visible instances are drawn.
+	Microsoft::WRL::ComPtr<ID3D11Buffer> visibleInstanceBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> visibleInstanceSrv;
+
+	//Filled by Culling::CullFrame() each frame.
+	std::vector<uint32_t> visibleInstances;
+
 	InstanceMeshComponent() {}
 	InstanceMeshComponent(uint32_t meshInstanceRenderCount_,
 		const std::string filename,
@@ -28,13 +39,49 @@ public:
 	void SetInstanceCount(uint32_t count);
 	uint32_t GetInstanceCount();
 
-	void SetInstanceData(std::vector<InstanceData>& instanceData_);
-	auto& GetInstanceData() { return instanceData; }
+	void SetInstanceData(const std::vector<InstanceData>& instanceData_);
+	const std::vector<InstanceData>& GetInstanceData() const { return instanceData; }
+
+	//Flags the instance for upload, don't hold on to the reference past the edit.
+	InstanceData& GetInstance(size_t index);
+
+	//Copies changed instances into the structured buffer, growing the buffers first if the instance data
+	//has outgrown them.
+	void UploadInstanceData();
+
+	//Rebuilds the world space bounds of changed instances.
+	void UpdateInstanceBounds();
+	const Culling::BoundsSoA& GetInstanceBounds() const { return instanceBounds; }
+	const BoundingBox& GetCombinedInstanceBounds() const { return combinedInstanceBounds; }
 
 	void ReleaseBuffers();
 
 private:
+	enum InstanceDirtyFlags : uint8_t
+	{
+		UploadDirty = 1 << 0,
+		BoundsDirty = 1 << 1,
+	};
+
+	void MarkAllInstancesDirty();
+	bool GrowBuffers();
+	void UploadInstanceRange(uint32_t begin, uint32_t end);
+	void SetInstanceBounds(size_t index);
+
 	std::vector<InstanceData> instanceData;
 
+	std::vector<uint8_t> instanceDirtyFlags;
+	std::vector<uint32_t> instancesToUpload;
+	std::vector<uint32_t> instancesToUpdateBounds;
+	bool uploadAllInstances = true;
+	bool updateAllInstanceBounds = true;
+
+	//Instances the buffers have room for.
+	uint32_t bufferCapacity = 0;
+
+	Culling::BoundsSoA instanceBounds;
+	BoundingBox combinedInstanceBounds;
+	float instanceBoundsCullDistance = 0.f;
+
 	uint32_t meshInstanceRenderCount = 0;
 };
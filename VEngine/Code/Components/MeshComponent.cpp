@@ -8,6 +8,7 @@
 #include "Render/Renderer.h"
 #include "Render/TextureSystem.h"
 #include "Physics/PhysicsSystem.h"
+#include "Physics/WorldBVH.h"
 
 std::unordered_map<std::string, MeshComponent*> debugMeshes;
 
@@ -68,6 +69,17 @@ MeshComponent::MeshComponent(const std::string filename_,
 	material = &MaterialSystem::CreateMaterial(textureFilename_, shaderItemName);
 }
 
+MeshComponent::~MeshComponent()
+{
+	//Components can be deleted mid-frame, don't leave a dangling pointer in the raycast BVH.
+	WorldBVH::RemoveMesh(this);
+}
+
+void MeshComponent::OnWorldTransformDirty() const
+{
+	WorldBVH::QueueMeshUpdate(this);
+}
+
 void MeshComponent::Tick(float deltaTime)
 {
 	if (!isPhysicsStatic)
@@ -100,6 +112,7 @@ void MeshComponent::Destroy()
 	material = nullptr;
 
 	vertexBuffer.Destroy();
+	indexBuffer.Destroy();
 }
 
 static void ReassignMesh(Property& prop)
@@ -115,6 +128,7 @@ Properties MeshComponent::GetProps()
 
 	props.Add("Mesh", &meshComponentData).change = ReassignMesh;
 	props.Add("Casts Shadow", &castsShadow);
+	props.Add("Cull Distance", &cullDistance);
 	props.Add("Physics Static", &isPhysicsStatic);
 	props.Add("Render Static", &isRenderStatic);
 	props.Add("Trans. Occlude", &transparentOcclude);
@@ -147,15 +161,15 @@ void MeshComponent::SplitMeshCreate()
 
 	material->Create();
 
-	vertexBuffer.CreateDefault(meshDataProxy);
+	CreateVertexBuffer();
 
 	//Make sure bounds setup is before physics actor creation
 	BoundingBox bb;
-	BoundingBox::CreateFromPoints(bb, meshDataProxy.vertices.size(),
-		&meshDataProxy.vertices.at(0).pos, sizeof(Vertex));
+	const auto positions = meshDataProxy.GetPositions();
+	BoundingBox::CreateFromPoints(bb, positions.size(), positions.data(), positions.stride());
 
 	//This '255' I think is the limit on how many vertices PhysX can process for a convex mesh.
-	if (meshDataProxy.vertices.size() > 255)
+	if (meshDataProxy.GetVertexCount() > 255)
 	{
 		PhysicsSystem::CreatePhysicsActor(this);
 	}
@@ -261,27 +275,34 @@ VertexBuffer& MeshComponent::GetVertexBuffer()
 void MeshComponent::CreateVertexBuffer()
 {
 	vertexBuffer.CreateDefault(meshDataProxy);
+
+	const auto indices = meshDataProxy.GetIndices();
+	if (!indices.empty())
+	{
+		indexBuffer.CreateDefault(indices);
+	}
 }
 
 void MeshComponent::CreateNewVertexBuffer()
 {
 	vertexBuffer.Destroy();
-	vertexBuffer.CreateDefault(meshDataProxy);
+	indexBuffer.Destroy();
+	CreateVertexBuffer();
 }
 
-std::vector<Vertex>& MeshComponent::GetAllVertices()
+ArrayView<Vertex> MeshComponent::GetAllVertices() const
 {
-	return meshDataProxy.vertices;
+	return meshDataProxy.GetVertices();
+}
+
+std::vector<Vertex>& MeshComponent::GetMutableVertices()
+{
+	return meshDataProxy.GetMutableVertices();
 }
 
 std::vector<XMFLOAT3> MeshComponent::GetAllVertexPositions()
 {
-	std::vector<XMFLOAT3> positions;
-	for (auto& vertex : meshDataProxy.vertices)
-	{
-		positions.emplace_back(vertex.pos);
-	}
-	return positions;
+	return meshDataProxy.GetPositions().ToVector();
 }
 
 BlendState& MeshComponent::GetBlendState()
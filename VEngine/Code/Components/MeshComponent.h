@@ -4,6 +4,7 @@
 #include "ComponentSystem.h"
 #include "Render/ShaderItem.h"
 #include "Render/VertexBuffer.h"
+#include "Render/IndexBuffer.h"
 #include "Render/MeshDataProxy.h"
 #include "Physics/PhysicsActorShape.h"
 
@@ -15,7 +16,7 @@ class BlendState;
 class MeshComponent : public SpatialComponent
 {
 public:
-	COMPONENT_SYSTEM(MeshComponent);
+	COMPONENT_SYSTEM_POOLED(MeshComponent);
 
 	//Debug meshes are used by the renderer to display things like bounds, camera, lights, etc.
 	static void CreateDebugMeshes();
@@ -27,6 +28,7 @@ public:
 	MeshComponent(const std::string filename_,
 		const std::string textureFilename_,
 		std::string shaderItemName = "Default");
+	~MeshComponent();
 	void Tick(float deltaTime) override;
 	void Create() override;
 	void Destroy() override;
@@ -61,12 +63,17 @@ public:
 	void SetUVOffsetSpeed(XMFLOAT2 speed);
 
 	VertexBuffer& GetVertexBuffer();
+	IndexBuffer& GetIndexBuffer() { return indexBuffer; }
+
+	//Creates the index buffer alongside, for indexed meshes.
 	void CreateVertexBuffer();
 	void CreateNewVertexBuffer();
 
 	Material& GetMaterial() { return *material; }
 
-	std::vector<Vertex>& GetAllVertices();
+	ArrayView<Vertex> GetAllVertices() const;
+	//Copy-on-write, only call when the vertices are actually going to be changed (e.g. vertex painting).
+	std::vector<Vertex>& GetMutableVertices();
 	std::vector<XMFLOAT3> GetAllVertexPositions();
 
 	void SetCollisionMeshFilename(std::string_view filename) { collisionMeshFilename = filename; }
@@ -98,6 +105,12 @@ public:
 
 	VertexBuffer vertexBuffer;
 
+	//Empty for triangle soup, see MeshDataProxy::GetIndices().
+	IndexBuffer indexBuffer;
+
+protected:
+	void OnWorldTransformDirty() const override;
+
 private:
 	Material* material = nullptr;
 
@@ -119,6 +132,9 @@ public:
 
 	bool castsShadow = true;
 
+	//Distance from the camera past which the mesh isn't drawn (see Culling), 0 to only cull on the far plane.
+	float cullDistance = 0.f;
+
 	bool skipPhysicsCreation = false;
 
 	//Whether to make transparent when in between player and camera
@@ -3,6 +3,8 @@
 #include <algorithm>
 #include "Core/Core.h"
 #include "Core/Log.h"
+#include "Core/ParallelFor.h"
+#include "Core/Profile.h"
 #include "Asset/AssetSystem.h"
 #include "Animation/Skeleton.h"
 
@@ -28,7 +30,8 @@ void SkeletalMeshComponent::Create()
 void SkeletalMeshComponent::LoadAnimations(std::string animationFilename)
 {
 	Skeleton& skel = GetSkeleton();
-	std::vector<Animation> animations = AssetSystem::ReadVAnimAssetFromFile(animationFilename);
+	std::vector<Animation> animations = AssetSystem::ReadVAnimAssetFromFile(animationFilename,
+		(uint32_t)skel.GetNumJoints());
 	for (auto& anim : animations)
 	{
 		skel.GetAnimations().emplace(anim.GetName(), anim);
@@ -131,9 +134,56 @@ void SkeletalMeshComponent::StartAllAnimations()
 	}
 }
 
+void SkeletalMeshComponent::AnimateAllSkeletalMeshes()
+{
+	Profile::Start();
+
+	//Clips are built on first use, so get them here on the main thread and the workers only read them.
+	std::vector<SkeletalMeshComponent*> skeletalMeshesToAnimate;
+	for (auto& skeletalMesh : system.GetComponents())
+	{
+		if (!skeletalMesh->IsActive() || !skeletalMesh->IsVisible() ||
+			skeletalMesh->GetCurrentAnimationName().empty() || !skeletalMesh->HasJoints())
+		{
+			continue;
+		}
+
+		skeletalMesh->GetCurrentAnimation().GetClip();
+		if (!skeletalMesh->GetNextAnimationName().empty())
+		{
+			skeletalMesh->GetNextAnimation().GetClip();
+		}
+
+		skeletalMeshesToAnimate.emplace_back(skeletalMesh.get());
+	}
+
+	//Each component only writes to its own sampler and skinning data.
+	constexpr size_t minSkeletalMeshesPerJob = 4;
+	ParallelFor(skeletalMeshesToAnimate.size(), minSkeletalMeshesPerJob, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				skeletalMeshesToAnimate[i]->UpdateAnimation();
+			}
+		});
+
+	Profile::End();
+}
+
+void SkeletalMeshComponent::UpdateAnimation()
+{
+	if (!nextAnimationName.empty())
+	{
+		CrossFadeNextAnimation();
+	}
+	else
+	{
+		InterpolateCurrentAnimation();
+	}
+}
+
 void SkeletalMeshComponent::InterpolateCurrentAnimation()
 {
-	int skinningDataIndex = 0;
 	Animation& anim = GetCurrentAnimation();
 
 	if (anim.HasFrames())
@@ -148,21 +198,22 @@ void SkeletalMeshComponent::InterpolateCurrentAnimation()
 
 		IncrementAnimationTime(Core::GetDeltaTime());
 
-		//Move through and animate all joints on skeleton
-		auto& joints = GetAllJoints();
-		for (auto& joint : joints)
+		const AnimationClip& clip = anim.GetClip();
+		if (animationSampler.GetClip() != &clip)
 		{
-			if (GetCurrentAnimationTime() >= anim.GetEndTime(joint.index))
-			{
-				ResetAnimationTime();
-			}
-
-			anim.Interpolate(GetCurrentAnimationTime(), joint, GetAllJoints());
+			animationSampler.SetClip(&clip);
+		}
 
-			shaderSkinningData.skinningMatrices[skinningDataIndex] = joint.currentPose;
-			skinningDataIndex++;
-			assert(skinningDataIndex < ShaderSkinningData::MAX_SKINNING_DATA);
+		if (GetCurrentAnimationTime() >= clip.duration)
+		{
+			ResetAnimationTime();
 		}
+
+		//Move through and animate all joints on skeleton
+		auto& joints = GetAllJoints();
+		assert(joints.size() <= ShaderSkinningData::MAX_SKINNING_DATA);
+
+		animationSampler.Evaluate(GetCurrentAnimationTime(), joints, shaderSkinningData.skinningMatrices);
 	}
 	else
 	{
@@ -172,23 +223,16 @@ void SkeletalMeshComponent::InterpolateCurrentAnimation()
 
 void SkeletalMeshComponent::CrossFadeNextAnimation()
 {
-	Animation& currentAnim = GetCurrentAnimation();
-	Animation& nextAnim = GetNextAnimation();
-
-	const std::string name1 = currentAnim.GetName();
-	const std::string name2 = nextAnim.GetName();
-
 	//If crossfade is set to same animation, skip entire fade
-	if (name1 == name2)
+	if (currentAnimationName == nextAnimationName)
 	{
 		blendFactor = 0.f;
-		currentAnimationName = nextAnimationName;
 		nextAnimationName.clear();
-		Log("Cross fade for %s animation skipped for being the same Animation", name1.c_str());
 		return;
 	}
 
-	int skinningDataIndex = 0;
+	Animation& currentAnim = GetCurrentAnimation();
+	Animation& nextAnim = GetNextAnimation();
 
 	const float currentAnimTime = GetCurrentAnimationTime();
 
@@ -203,73 +247,56 @@ void SkeletalMeshComponent::CrossFadeNextAnimation()
 		return;
 	}
 
-	auto& joints = GetAllJoints();
-	for (auto& joint : joints)
+	const AnimationClip& currentClip = currentAnim.GetClip();
+	const AnimationClip& nextClip = nextAnim.GetClip();
+	if (animationSampler.GetClip() != &currentClip)
 	{
-		const auto& jointFramesCurrentAnim = currentAnim.GetFrame(joint.index);
-		const auto& jointFramesNextAnim = nextAnim.GetFrame(joint.index);
+		animationSampler.SetClip(&currentClip);
+	}
 
-		size_t jointEndFrameIndex = 0;
-		//Find joint frame index end closest to current animation time
-		for (size_t i = 0; i < (jointFramesCurrentAnim.size() - 1); i++)
-		{
-			if (jointFramesCurrentAnim[i].time <= currentAnimTime && jointFramesCurrentAnim[i + 1].time >= currentAnimTime)
-			{
-				jointEndFrameIndex = i;
-				break;
-			}
-		}
+	const float lerpPercent = std::clamp(blendFactor, 0.f, 1.f);
+	const XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
 
-		const float jointEndFramesLerpPercent = (currentAnimTime - jointFramesCurrentAnim[jointEndFrameIndex].time)
-			/ (jointFramesCurrentAnim[jointEndFrameIndex + 1].time - jointFramesCurrentAnim[jointEndFrameIndex].time);
+	auto& joints = GetAllJoints();
+	assert(joints.size() <= ShaderSkinningData::MAX_SKINNING_DATA);
 
-		const float lerpPercent = std::clamp(blendFactor, 0.f, 1.f);
+	animationSampler.BeginPose(currentAnimTime, joints);
 
+	for (size_t jointIndex = 0; jointIndex < joints.size(); jointIndex++)
+	{
 		//Because the initial animation keyframes can be distant in regards to time, get the interpolated
 		//values and use that to cross fade into the next animation instead.
-		XMVECTOR currentPos0 = XMLoadFloat3(&jointFramesCurrentAnim[jointEndFrameIndex].pos);
-		XMVECTOR currentScale0 = XMLoadFloat3(&jointFramesCurrentAnim[jointEndFrameIndex].scale);
-		XMVECTOR currentRot0 = XMLoadFloat4(&jointFramesCurrentAnim[jointEndFrameIndex].rot);
-
-		XMVECTOR currentPos1 = XMLoadFloat3(&jointFramesCurrentAnim[jointEndFrameIndex + 1].pos);
-		XMVECTOR currentScale1 = XMLoadFloat3(&jointFramesCurrentAnim[jointEndFrameIndex + 1].scale);
-		XMVECTOR currentRot1 = XMLoadFloat4(&jointFramesCurrentAnim[jointEndFrameIndex + 1].rot);
+		XMVECTOR currentScale, currentRot, currentPos;
+		const bool hasCurrentPose = animationSampler.SampleJoint((int)jointIndex, currentAnimTime,
+			currentScale, currentRot, currentPos);
+		const bool hasNextPose = jointIndex < nextClip.tracks.size() && nextClip.tracks[jointIndex].keyCount > 0;
 
-		XMVECTOR currentPos = XMVectorLerp(currentPos0, currentPos1, jointEndFramesLerpPercent);
-		XMVECTOR currentScale = XMVectorLerp(currentScale0, currentScale1, jointEndFramesLerpPercent);
-		XMVECTOR currentRot = XMQuaternionSlerp(currentRot0, currentRot1, jointEndFramesLerpPercent);
+		if (!hasCurrentPose || !hasNextPose)
+		{
+			animationSampler.SetJointPose(joints, jointIndex, nullptr, shaderSkinningData.skinningMatrices);
+			continue;
+		}
 
-		XMVECTOR nextPos = XMLoadFloat3(&jointFramesNextAnim[0].pos);
-		XMVECTOR nextScale = XMLoadFloat3(&jointFramesNextAnim[0].scale);
-		XMVECTOR nextRot = XMLoadFloat4(&jointFramesNextAnim[0].rot);
+		const uint32_t nextFirstKey = nextClip.tracks[jointIndex].firstKey;
+		XMVECTOR nextPos = XMLoadFloat3(&nextClip.translations[nextFirstKey]);
+		XMVECTOR nextScale = XMLoadFloat3(&nextClip.scales[nextFirstKey]);
+		XMVECTOR nextRot = XMLoadFloat4(&nextClip.rotations[nextFirstKey]);
 
 		XMVECTOR lerpedPos = XMVectorLerp(currentPos, nextPos, lerpPercent);
 		XMVECTOR lerpedScale = XMVectorLerp(currentScale, nextScale, lerpPercent);
 		XMVECTOR lerpedRot = XMQuaternionSlerp(currentRot, nextRot, lerpPercent);
-		XMVECTOR zero = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-
-		joint.currentPose = XMMatrixAffineTransformation(lerpedScale, zero, lerpedRot, lerpedPos);
-
-		XMMATRIX endPose = joint.currentPose;
-		int parentIndex = joint.parentIndex;
 
-		while (parentIndex > -1)
-		{
-			Joint& parentJoint = GetSkeleton().GetJoints()[parentIndex];
-			endPose *= parentJoint.currentPose;
-
-			parentIndex = parentJoint.parentIndex;
-		}
-
-		joint.currentPose = joint.inverseBindPose * endPose;
-
-		shaderSkinningData.skinningMatrices[skinningDataIndex] = joint.currentPose;
-		skinningDataIndex++;
-		assert(skinningDataIndex < ShaderSkinningData::MAX_SKINNING_DATA);
+		const XMMATRIX localPose = XMMatrixAffineTransformation(lerpedScale, zero, lerpedRot, lerpedPos);
+		animationSampler.SetJointPose(joints, jointIndex, &localPose, shaderSkinningData.skinningMatrices);
 	}
 }
 
 void SkeletalMeshComponent::SetCrossFade(std::string animationNameToBlendTo)
 {
+	if (animationNameToBlendTo == currentAnimationName)
+	{
+		Log("Cross fade for %s animation skipped for being the same Animation", animationNameToBlendTo.c_str());
+	}
+
 	nextAnimationName = animationNameToBlendTo;
 }
@@ -2,6 +2,7 @@
 
 #include "MeshComponent.h"
 #include "Animation/Joint.h"
+#include "Animation/AnimationSampler.h"
 #include "Render/ShaderData/ShaderSkinningData.h"
 
 class Animation;
@@ -26,6 +27,10 @@ public:
 	//Plays all SkeletalMeshComponents across system
 	static void StartAllAnimations();
 
+	//Animation update phase. Samples and blends every visible playing SkeletalMeshComponent's pose into its
+	//shaderSkinningData, spread across worker threads, for the renderer to upload.
+	static void AnimateAllSkeletalMeshes();
+
 	SkeletalMeshComponent() {}
 	SkeletalMeshComponent(std::string meshFilename, std::string textureFilename) :
 		MeshComponent(meshFilename, textureFilename) {}
@@ -56,6 +61,9 @@ public:
 	void PlayAnimation(std::string animationName, float speed = 1.f, bool loop = true);
 	void StopAnimation();
 	void SetPauseAnimationState();
+
+	//Either cross fades or interpolates, depending on whether a cross fade is set.
+	void UpdateAnimation();
 	void InterpolateCurrentAnimation();
 
 	//This cross fade implementation takes the current animation time point of the animation to fade from and
@@ -70,6 +78,8 @@ public:
 private:
 	std::vector<std::string> animationsToLoadOnCreate;
 
+	AnimationSampler animationSampler;
+
 	AnimationState animationState = AnimationState::Play;
 
 	std::string currentAnimationName;
@@ -17,4 +17,5 @@ void SocketMeshComponent::SetTransformFromLinkedSkeletonJoint()
 {
 	XMMATRIX jointMatrix = linkedSkeletalMesh->shaderSkinningData.skinningMatrices[jointIndex];
 	transform.Decompose(jointMatrix * linkedSkeletalMesh->GetWorldMatrix());
+	MarkTransformDirty();
 }
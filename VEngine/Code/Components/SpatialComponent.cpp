@@ -1,14 +1,20 @@
 #include "vpch.h"
 #include "SpatialComponent.h"
+#include <cstring>
+#include "Actors/Actor.h"
 #include "Core/VMath.h"
+#include "Core/World.h"
 #include "Editor/Editor.h"
 
+static_assert(sizeof(Transform) == sizeof(float) * 10, "Transform is compared with memcmp, it can't have padding");
+
 void SpatialComponent::AddChild(SpatialComponent* component)
 {
 	assert(component != this);
 	assert(component);
 	component->parent = this;
 	children.emplace_back(component);
+	component->MarkTransformDirty();
 }
 
 void SpatialComponent::RemoveChild(SpatialComponent* component)
@@ -18,6 +24,7 @@ void SpatialComponent::RemoveChild(SpatialComponent* component)
 		if (children[i] == component)
 		{
 			children.erase(children.begin() + i);
+			component->MarkTransformDirty();
 			return;
 		}
 	}
@@ -27,31 +34,147 @@ void SpatialComponent::RemoveChild(SpatialComponent* component)
 
 XMMATRIX SpatialComponent::GetWorldMatrix() const
 {
-	XMMATRIX parentWorld = XMMatrixIdentity();
+	RefreshWorldTransform();
+	return cachedWorldMatrix;
+}
+
+XMMATRIX SpatialComponent::GetCachedWorldMatrix() const
+{
+	assert(!IsWorldTransformStale() && "UpdateWorldMatrices() wasn't called before reading from a worker");
+	return cachedWorldMatrix;
+}
+
+BoundingOrientedBox SpatialComponent::GetCachedBoundsInWorldSpace() const
+{
+	BoundingOrientedBox outBounds;
+	boundingBox.Transform(outBounds, GetCachedWorldMatrix());
+	return outBounds;
+}
+
+void SpatialComponent::MarkTransformDirty()
+{
+	SetWorldTransformDirty();
+}
+
+void SpatialComponent::SetWorldTransformDirty() const
+{
+	//Children of a dirty component are always dirty, no need to walk them again.
+	if (isWorldTransformDirty)
+	{
+		return;
+	}
+
+	isWorldTransformDirty = true;
+	OnWorldTransformDirty();
+
+	for (SpatialComponent* child : children)
+	{
+		child->SetWorldTransformDirty();
+	}
+}
+
+bool SpatialComponent::HasLocalTransformChanged() const
+{
+	return memcmp(&transform, &cachedLocalTransform, sizeof(Transform)) != 0;
+}
+
+bool SpatialComponent::IsWorldTransformStale() const
+{
+	for (const SpatialComponent* component = this; component; component = component->parent)
+	{
+		if (component->isWorldTransformDirty || component->HasLocalTransformChanged())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void SpatialComponent::RefreshWorldTransform() const
+{
+	//Parents go first, a direct write to an ancestor's transform dirties everything under it from there.
 	if (parent)
 	{
-		parentWorld = parent->GetWorldMatrix();
+		parent->RefreshWorldTransform();
 	}
-	return GetParentWorldMatrix(parentWorld);
+
+	if (!isWorldTransformDirty && HasLocalTransformChanged())
+	{
+		SetWorldTransformDirty();
+	}
+
+	if (isWorldTransformDirty)
+	{
+		RebuildWorldTransform();
+	}
+}
+
+//Expects the parent's cache to be up to date.
+void SpatialComponent::RebuildWorldTransform() const
+{
+	cachedLocalTransform = transform;
+
+	XMMATRIX world = transform.GetAffine();
+	XMVECTOR worldRotation = GetLocalRotationV();
+	XMVECTOR worldScale = GetLocalScaleV();
+
+	if (parent)
+	{
+		world = world * parent->cachedWorldMatrix;
+
+		//Note: originally was under the impression here that relative rotations are inversed with quaternions
+		//i.e. ParentQuat(-1) * localRotation; but it looks like that isn't so. Leaving this comment here just
+		//in case rotations decide to blow up one day.
+		worldRotation = XMQuaternionMultiply(XMLoadFloat4(&parent->cachedWorldRotation), worldRotation);
+		worldScale = XMVectorMultiply(worldScale, XMLoadFloat3(&parent->cachedWorldScale));
+	}
+
+	cachedWorldMatrix = world;
+	XMStoreFloat4(&cachedWorldRotation, worldRotation);
+	XMStoreFloat3(&cachedWorldScale, worldScale);
+	isWorldTransformDirty = false;
 }
 
-XMMATRIX SpatialComponent::GetParentWorldMatrix(XMMATRIX parentWorld) const
+void SpatialComponent::UpdateWorldMatricesInHierarchy(bool parentRebuilt) const
 {
-	XMMATRIX world = transform.GetAffine() * parentWorld;
+	const bool rebuild = parentRebuilt || isWorldTransformDirty || HasLocalTransformChanged();
+	if (rebuild)
+	{
+		//Parent rebuilds and direct writes to 'transform' don't go through SetWorldTransformDirty().
+		if (!isWorldTransformDirty)
+		{
+			OnWorldTransformDirty();
+		}
+		RebuildWorldTransform();
+	}
+
 	for (SpatialComponent* child : children)
 	{
-		child->GetParentWorldMatrix(world);
+		child->UpdateWorldMatricesInHierarchy(rebuild);
+	}
+}
+
+void SpatialComponent::UpdateWorldMatrices()
+{
+	for (Actor* actor : World::GetAllActorsInWorld())
+	{
+		//Roots attached to another actor's component are reached through that actor's hierarchy.
+		const SpatialComponent& rootComponent = actor->GetRootComponent();
+		if (rootComponent.parent == nullptr)
+		{
+			rootComponent.UpdateWorldMatricesInHierarchy(false);
+		}
 	}
-	return world;
 }
 
 Properties SpatialComponent::GetProps()
 {
 	auto props = __super::GetProps();
 	props.title = GetTypeName();
-	props.Add(" Pos", &transform.position);
-	props.Add(" Rot", &transform.rotation);
-	props.Add(" Scale", &transform.scale);
+	const auto markTransformDirty = [this](Property&) { MarkTransformDirty(); };
+	props.Add(" Pos", &transform.position).change = markTransformDirty;
+	props.Add(" Rot", &transform.rotation).change = markTransformDirty;
+	props.Add(" Scale", &transform.scale).change = markTransformDirty;
 	return props;
 }
 
@@ -81,16 +204,19 @@ XMVECTOR SpatialComponent::GetLocalPositionV() const
 void SpatialComponent::SetLocalPosition(float x, float y, float z)
 {
 	transform.position = XMFLOAT3(x, y, z);
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalPosition(XMFLOAT3 newPosition)
 {
 	transform.position = newPosition;
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalPosition(XMVECTOR newPosition)
 {
 	XMStoreFloat3(&transform.position, newPosition);
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetWorldPosition(XMFLOAT3 position)
@@ -140,35 +266,32 @@ XMFLOAT3 SpatialComponent::GetWorldScale() const
 
 XMVECTOR SpatialComponent::GetWorldScaleV() const
 {
-	XMVECTOR relativeScale = GetLocalScaleV();
-
-	if (parent)
-	{
-		XMVECTOR parentScale = parent->GetWorldScaleV();
-		relativeScale = XMVectorMultiply(relativeScale, parentScale);
-	}
-
-	return relativeScale;
+	RefreshWorldTransform();
+	return XMLoadFloat3(&cachedWorldScale);
 }
 
 void SpatialComponent::SetLocalScale(float uniformScale)
 {
 	transform.scale = XMFLOAT3(uniformScale, uniformScale, uniformScale);
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalScale(float x, float y, float z)
 {
 	transform.scale = XMFLOAT3(x, y, z);
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalScale(XMFLOAT3 newScale)
 {
 	transform.scale = newScale;
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalScale(XMVECTOR newScale)
 {
 	XMStoreFloat3(&transform.scale, newScale);
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetWorldScale(float uniformScale)
@@ -208,23 +331,14 @@ XMFLOAT4 SpatialComponent::GetWorldRotation() const
 
 XMVECTOR SpatialComponent::GetWorldRotationV() const
 {
-	XMVECTOR relativeRotation = GetLocalRotationV();
-
-	if (parent)
-	{
-		//Note: originally was under the impression here that relative rotations are inversed with quaternions
-		//i.e. ParentQuat(-1) * localRotation; but it looks like that isn't so. Leaving this comment here just
-		//in case rotations decide to blow up one day.
-		XMVECTOR parentRot = parent->GetWorldRotationV();
-		relativeRotation = XMQuaternionMultiply(parentRot, relativeRotation);
-	}
-
-	return relativeRotation;
+	RefreshWorldTransform();
+	return XMLoadFloat4(&cachedWorldRotation);
 }
 
 void SpatialComponent::SetLocalRotation(float x, float y, float z, float w)
 {
 	transform.rotation = XMFLOAT4(x, y, z, w);
+	MarkTransformDirty();
 }
 
 XMFLOAT4 SpatialComponent::GetLocalRotation() const
@@ -235,11 +349,13 @@ XMFLOAT4 SpatialComponent::GetLocalRotation() const
 void SpatialComponent::SetLocalRotation(XMFLOAT4 newRotation)
 {
 	transform.rotation = newRotation;
+	MarkTransformDirty();
 }
 
 void SpatialComponent::SetLocalRotation(XMVECTOR newRotation)
 {
 	XMStoreFloat4(&transform.rotation, newRotation);
+	MarkTransformDirty();
 }
 
 XMFLOAT3 SpatialComponent::GetForwardVector() const
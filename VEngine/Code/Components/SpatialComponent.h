@@ -15,8 +15,25 @@ public:
 
 	Properties GetProps() override;
 
+	//World matrix, rotation and scale are cached and only rebuilt after the local transform or the parent
+	//chain changes. Writes straight to 'transform' are picked up by comparing against the transform the
+	//cache was built from, but call MarkTransformDirty() after them so children see the change right away.
+	//Not thread safe, it can rebuild the cache of this component and its parents.
 	XMMATRIX GetWorldMatrix() const;
 
+	//Read only versions for worker threads. UpdateWorldMatrices() has to have run on the main thread since the
+	//last transform change, asserts if the cache is stale.
+	XMMATRIX GetCachedWorldMatrix() const;
+	BoundingOrientedBox GetCachedBoundsInWorldSpace() const;
+
+	//Flags this component and everything under it for a world matrix rebuild.
+	void MarkTransformDirty();
+
+	//Rebuilds stale world matrices for every actor hierarchy in the world, parents before children, so that
+	//the renderer and physics only read cached matrices for the rest of the frame. Call it on the main thread
+	//before handing components to a ParallelFor that reads their transforms.
+	static void UpdateWorldMatrices();
+
 	XMFLOAT3 GetLocalPosition() const;
 	XMVECTOR GetLocalPositionV() const;
 	XMFLOAT3 GetWorldPosition() const;
@@ -67,10 +84,10 @@ public:
 	void SetBoundsExtents(XMFLOAT3 extents) { boundingBox.Extents = extents; }
 
 	auto GetTransform() const { return transform; }
-	void SetTransform(const Transform& transform_) { transform = transform_; }
+	void SetTransform(const Transform& transform_) { transform = transform_; MarkTransformDirty(); }
 
 	auto GetParent() { return parent; }
-	void SetParent(SpatialComponent* newParent) { parent = newParent; }
+	void SetParent(SpatialComponent* newParent) { parent = newParent; MarkTransformDirty(); }
 
 	auto GetChildren() { return children; }
 	void AddChild(SpatialComponent* component);
@@ -80,6 +97,9 @@ public:
 	void SetCollisionLayer(CollisionLayers layer_) { layer = layer_; }
 
 protected:
+	//Called on the main thread when the world transform goes from up to date to stale.
+	virtual void OnWorldTransformDirty() const {}
+
 	void Pitch(float angle);
 	void RotateY(float angle);
 	void FPSCameraRotation();
@@ -90,5 +110,20 @@ protected:
 	CollisionLayers layer = CollisionLayers::All;
 
 private:
-	XMMATRIX GetParentWorldMatrix(XMMATRIX parentWorld) const;
+	void SetWorldTransformDirty() const;
+	bool HasLocalTransformChanged() const;
+	bool IsWorldTransformStale() const;
+	void RefreshWorldTransform() const;
+	void RebuildWorldTransform() const;
+	void UpdateWorldMatricesInHierarchy(bool parentRebuilt) const;
+
+	mutable XMMATRIX cachedWorldMatrix = XMMatrixIdentity();
+	mutable XMFLOAT4 cachedWorldRotation = XMFLOAT4(0.f, 0.f, 0.f, 1.f);
+	mutable XMFLOAT3 cachedWorldScale = XMFLOAT3(1.f, 1.f, 1.f);
+
+	//Local transform the cache was built from.
+	mutable Transform cachedLocalTransform;
+
+	//If set, every child is dirty too.
+	mutable bool isWorldTransformDirty = true;
 };
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+//Read-only, non-owning view over elements. Used where data can either live in a std::vector
+//or in place in a memory-mapped file. Method names follow std::vector so it can stand in for a const ref to one.
+//A stride larger than sizeof(T) views one member of an array of structs (e.g. the positions in a Vertex array).
+template <typename T>
+class ArrayView
+{
+public:
+	class Iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T*;
+		using reference = const T&;
+
+		Iterator(const uint8_t* bytes_, size_t stride_) : bytes(bytes_), stride(stride_) {}
+
+		const T& operator*() const { return *reinterpret_cast<const T*>(bytes); }
+		const T* operator->() const { return reinterpret_cast<const T*>(bytes); }
+
+		Iterator& operator++()
+		{
+			bytes += stride;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			bytes += stride;
+			return previous;
+		}
+
+		bool operator==(const Iterator& other) const { return bytes == other.bytes; }
+		bool operator!=(const Iterator& other) const { return bytes != other.bytes; }
+
+	private:
+		const uint8_t* bytes = nullptr;
+		size_t stride = 0;
+	};
+
+	ArrayView() {}
+	ArrayView(const T* data_, size_t size_, size_t stride_ = sizeof(T)) :
+		elements(reinterpret_cast<const uint8_t*>(data_)), count(size_), byteStride(stride_) {}
+	ArrayView(const std::vector<T>& vector) :
+		elements(reinterpret_cast<const uint8_t*>(vector.data())), count(vector.size()) {}
+
+	//First element, pair with stride() when handing the view to APIs that take strided data.
+	const T* data() const { return reinterpret_cast<const T*>(elements); }
+	size_t size() const { return count; }
+	size_t stride() const { return byteStride; }
+	bool empty() const { return count == 0; }
+
+	const T& operator[](size_t index) const { return *reinterpret_cast<const T*>(elements + index * byteStride); }
+	const T& at(size_t index) const
+	{
+		assert(index < count);
+		return (*this)[index];
+	}
+
+	const T& front() const { return at(0); }
+	const T& back() const { return at(count - 1); }
+
+	Iterator begin() const { return Iterator(elements, byteStride); }
+	Iterator end() const { return Iterator(elements + count * byteStride, byteStride); }
+
+	std::vector<T> ToVector() const { return std::vector<T>(begin(), end()); }
+
+private:
+	const uint8_t* elements = nullptr;
+	size_t count = 0;
+	size_t byteStride = sizeof(T);
+};
@@ -0,0 +1,1111 @@
+#include "vpch.h"
+#include "Benchmarks.h"
+#include <bit>
+#include <filesystem>
+#include "BinarySerialiser.h"
+#include "FileSystem.h"
+#include "Log.h"
+#include "Profile.h"
+#include "Timer.h"
+#include "VMath.h"
+#include "World.h"
+#include "Physics/BVH.h"
+#include "Animation/Animation.h"
+#include "Animation/AnimationSampler.h"
+#include "Animation/AnimationCompression.h"
+#include "Asset/AnimationAssetHeader.h"
+#include "Render/Vertex.h"
+#include "Render/Culling.h"
+#include "Render/DrawList.h"
+#include "Render/ShaderData/InstanceData.h"
+#include "Render/ShaderData/ShaderMatrices.h"
+#include "Particle/Particle.h"
+#include "Particle/ParticleData.h"
+#include "Particle/ParticlePool.h"
+
+using namespace DirectX;
+
+//Builds a triangle soup sphere with roughly (rings * segments * 2) triangles.
+static std::vector<Vertex> CreateSphereTriangles(int rings, int segments)
+{
+	std::vector<Vertex> vertices;
+
+	const auto pointOnSphere = [&](int ring, int segment)
+		{
+			const float theta = XM_PI * ring / rings;
+			const float phi = XM_2PI * segment / segments;
+			Vertex v;
+			v.pos = XMFLOAT3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+			v.normal = v.pos;
+			return v;
+		};
+
+	for (int ring = 0; ring < rings; ring++)
+	{
+		for (int segment = 0; segment < segments; segment++)
+		{
+			const Vertex v0 = pointOnSphere(ring, segment);
+			const Vertex v1 = pointOnSphere(ring + 1, segment);
+			const Vertex v2 = pointOnSphere(ring + 1, segment + 1);
+			const Vertex v3 = pointOnSphere(ring, segment + 1);
+
+			vertices.insert(vertices.end(), { v0, v2, v1 });
+			vertices.insert(vertices.end(), { v0, v3, v2 });
+		}
+	}
+
+	return vertices;
+}
+
+void Benchmarks::RaycastBVH()
+{
+	constexpr int meshCount = 10000;
+	constexpr int rayCount = 1000;
+	constexpr float worldSize = 500.f;
+
+	struct SyntheticMesh
+	{
+		XMMATRIX world;
+		BoundingOrientedBox worldBounds;
+	};
+
+	const std::vector<Vertex> vertices = CreateSphereTriangles(16, 16);
+
+	BoundingBox localBounds;
+	BoundingBox::CreateFromPoints(localBounds, vertices.size(), &vertices[0].pos, sizeof(Vertex));
+
+	std::vector<SyntheticMesh> meshes(meshCount);
+	for (auto& mesh : meshes)
+	{
+		const float scale = VMath::RandomRange(0.5f, 3.f);
+		const XMVECTOR position = XMVectorSet(VMath::RandomRange(-worldSize, worldSize),
+			VMath::RandomRange(0.f, 20.f), VMath::RandomRange(-worldSize, worldSize), 1.f);
+		mesh.world = XMMatrixScaling(scale, scale, scale) *
+			XMMatrixRotationY(VMath::RandomRange(0.f, XM_2PI)) * XMMatrixTranslationFromVector(position);
+
+		BoundingOrientedBox localOrientedBounds;
+		BoundingOrientedBox::CreateFromBoundingBox(localOrientedBounds, localBounds);
+		localOrientedBounds.Transform(mesh.worldBounds, mesh.world);
+	}
+
+	//Downward rays like Grid::RecalcAllNodes()
+	std::vector<std::pair<XMVECTOR, XMVECTOR>> rays(rayCount);
+	for (auto& ray : rays)
+	{
+		ray.first = XMVectorSet(VMath::RandomRange(-worldSize, worldSize), 50.f,
+			VMath::RandomRange(-worldSize, worldSize), 1.f);
+		ray.second = XMVectorSet(0.f, -1.f, 0.f, 0.f);
+	}
+
+	const auto rayTriangle = [&](const SyntheticMesh& mesh, XMVECTOR origin, XMVECTOR direction,
+		uint32_t triangleIndex, float& nearest)
+		{
+			const XMVECTOR v0 = XMVector3TransformCoord(XMLoadFloat3(&vertices[triangleIndex * 3].pos), mesh.world);
+			const XMVECTOR v1 = XMVector3TransformCoord(XMLoadFloat3(&vertices[triangleIndex * 3 + 1].pos), mesh.world);
+			const XMVECTOR v2 = XMVector3TransformCoord(XMLoadFloat3(&vertices[triangleIndex * 3 + 2].pos), mesh.world);
+			float distance = 0.f;
+			if (TriangleTests::Intersects(origin, direction, v0, v1, v2, distance) && distance < nearest)
+			{
+				nearest = distance;
+			}
+		};
+
+	//Linear path
+	int linearHits = 0;
+	const auto linearStart = Profile::QuickStart();
+	for (const auto& [origin, direction] : rays)
+	{
+		float nearest = std::numeric_limits<float>::max();
+		for (const auto& mesh : meshes)
+		{
+			float boxDistance = 0.f;
+			if (!mesh.worldBounds.Intersects(origin, direction, boxDistance))
+			{
+				continue;
+			}
+
+			for (uint32_t i = 0; i < vertices.size() / 3; i++)
+			{
+				rayTriangle(mesh, origin, direction, i, nearest);
+			}
+		}
+		if (nearest < std::numeric_limits<float>::max()) linearHits++;
+	}
+	const double linearTime = Profile::QuickEnd(linearStart);
+
+	//BVH path, including build time
+	const auto buildStart = Profile::QuickStart();
+
+	TriangleBVH triangleBVH;
+	triangleBVH.Build(ArrayView<XMFLOAT3>(&vertices[0].pos, vertices.size(), sizeof(Vertex)));
+
+	DynamicAABBTree tree;
+	for (auto& mesh : meshes)
+	{
+		tree.CreateProxy(BVH::AABB::FromOrientedBox(mesh.worldBounds), &mesh);
+	}
+
+	const double buildTime = Profile::QuickEnd(buildStart);
+
+	int bvhHits = 0;
+	const auto bvhStart = Profile::QuickStart();
+	for (const auto& [origin, direction] : rays)
+	{
+		float nearest = std::numeric_limits<float>::max();
+		tree.QueryRay(BVH::Ray(origin, direction, std::numeric_limits<float>::max()), [&](void* userData)
+			{
+				const auto& mesh = *static_cast<SyntheticMesh*>(userData);
+
+				float boxDistance = 0.f;
+				if (!mesh.worldBounds.Intersects(origin, direction, boxDistance))
+				{
+					return true;
+				}
+
+				const XMMATRIX invWorld = XMMatrixInverse(nullptr, mesh.world);
+				const BVH::Ray localRay(XMVector3TransformCoord(origin, invWorld),
+					XMVector3TransformNormal(direction, invWorld), std::numeric_limits<float>::max());
+				triangleBVH.QueryRay(localRay, [&](uint32_t triangleIndex)
+					{
+						rayTriangle(mesh, origin, direction, triangleIndex, nearest);
+					});
+				return true;
+			});
+		if (nearest < std::numeric_limits<float>::max()) bvhHits++;
+	}
+	const double bvhTime = Profile::QuickEnd(bvhStart);
+
+	Log("Raycast BVH benchmark (%d meshes, %zu triangles each, %d rays)\n\tLinear: %f s (%d hits)\n\tBVH: %f s (%d hits), build %f s, tree height %d",
+		meshCount, vertices.size() / 3, rayCount, linearTime, linearHits, bvhTime, bvhHits, buildTime, tree.GetHeight());
+}
+
+void Benchmarks::SkeletalAnimation()
+{
+	constexpr int jointCount = 64;
+	constexpr int keyCount = 60;
+	constexpr float clipLength = 2.f;
+	constexpr int frameCount = 10000;
+	constexpr float deltaTime = 1.f / 60.f;
+
+	//Binary tree of joints, parents always come before children like imported skeletons.
+	std::vector<Joint> joints(jointCount);
+	for (int i = 0; i < jointCount; i++)
+	{
+		joints[i].index = i;
+		joints[i].parentIndex = i == 0 ? Joint::ROOT_JOINT_INDEX : (i - 1) / 2;
+		joints[i].inverseBindPose = XMMatrixTranslation(0.f, -0.1f * i, 0.f);
+	}
+
+	Animation animation("Benchmark");
+	for (int jointIndex = 0; jointIndex < jointCount; jointIndex++)
+	{
+		std::vector<AnimFrame> frames(keyCount);
+		for (int key = 0; key < keyCount; key++)
+		{
+			AnimFrame& frame = frames[key];
+			frame.time = clipLength * key / (keyCount - 1);
+			XMStoreFloat4(&frame.rot, XMQuaternionRotationRollPitchYaw(VMath::RandomRange(-0.2f, 0.2f),
+				VMath::RandomRange(-0.2f, 0.2f), VMath::RandomRange(-0.2f, 0.2f)));
+			frame.pos = XMFLOAT3(0.f, 0.1f, VMath::RandomRange(-0.01f, 0.01f));
+		}
+		animation.AddFrame(jointIndex, frames);
+	}
+
+	std::vector<Joint> legacyJoints = joints;
+	std::vector<XMMATRIX> samplerPoses(jointCount);
+
+	//Old path, including the per-joint end time check
+	float legacyTime = 0.f;
+	const auto legacyStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		legacyTime += deltaTime;
+		for (auto& joint : legacyJoints)
+		{
+			if (legacyTime >= animation.GetEndTime(joint.index))
+			{
+				legacyTime = 0.f;
+			}
+			animation.Interpolate(legacyTime, joint, legacyJoints);
+		}
+	}
+	const double legacyDuration = Profile::QuickEnd(legacyStart);
+
+	AnimationSampler sampler;
+	sampler.SetClip(&animation.GetClip());
+
+	float samplerTime = 0.f;
+	const auto samplerStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		samplerTime += deltaTime;
+		if (samplerTime >= animation.GetClip().duration)
+		{
+			samplerTime = 0.f;
+		}
+		sampler.Evaluate(samplerTime, joints, samplerPoses.data());
+	}
+	const double samplerDuration = Profile::QuickEnd(samplerStart);
+
+	//Both paths should land on the same poses
+	float maxDifference = 0.f;
+	for (int i = 0; i < jointCount; i++)
+	{
+		for (int row = 0; row < 4; row++)
+		{
+			const XMVECTOR difference = XMVectorAbs(legacyJoints[i].currentPose.r[row] - samplerPoses[i].r[row]);
+			maxDifference = std::max(maxDifference, XMVectorGetX(XMVector4Length(difference)));
+		}
+	}
+
+	Log("Skeletal animation benchmark (%d joints, %d keys per joint, %d frames)\n\tAnimation::Interpolate: %f s\n\tAnimationSampler: %f s\n\tMax pose difference: %f",
+		jointCount, keyCount, frameCount, legacyDuration, samplerDuration, maxDifference);
+}
+
+void Benchmarks::AnimationClipCompression()
+{
+	constexpr int jointCount = 64;
+	constexpr int keyCount = 120;
+	constexpr float clipLength = 4.f;
+	constexpr int decodeCount = 200;
+
+	//Smooth curves like sampled mocap, with scale left at 1 and a few joints not moving at all.
+	Animation animation("Benchmark");
+	for (int jointIndex = 0; jointIndex < jointCount; jointIndex++)
+	{
+		const bool isStill = jointIndex % 8 == 0;
+		const float frequency = VMath::RandomRange(0.5f, 2.f);
+		const float phase = VMath::RandomRange(0.f, XM_2PI);
+
+		std::vector<AnimFrame> frames(keyCount);
+		for (int key = 0; key < keyCount; key++)
+		{
+			AnimFrame& frame = frames[key];
+			frame.time = clipLength * key / (keyCount - 1);
+
+			const float wave = isStill ? 0.f : sinf((float)frame.time * frequency + phase);
+			XMStoreFloat4(&frame.rot, XMQuaternionRotationRollPitchYaw(0.3f * wave, 0.2f * wave, 0.1f));
+			frame.pos = XMFLOAT3(0.f, 0.1f + 0.02f * wave, 0.f);
+		}
+		animation.AddFrame(jointIndex, frames);
+	}
+
+	const AnimationClip& sourceClip = animation.GetClip();
+
+	//v1 layout, decoded the way ReadVAnimAssetFromFile() did
+	std::vector<uint8_t> v1Data;
+	for (auto& [jointIndex, frames] : animation.GetFrames())
+	{
+		const size_t frameCount = frames.size();
+		const auto jointBytes = reinterpret_cast<const uint8_t*>(&jointIndex);
+		const auto countBytes = reinterpret_cast<const uint8_t*>(&frameCount);
+		const auto frameBytes = reinterpret_cast<const uint8_t*>(frames.data());
+		v1Data.insert(v1Data.end(), jointBytes, jointBytes + sizeof(int));
+		v1Data.insert(v1Data.end(), countBytes, countBytes + sizeof(size_t));
+		v1Data.insert(v1Data.end(), frameBytes, frameBytes + sizeof(AnimFrame) * frameCount);
+	}
+
+	const auto v1Start = Profile::QuickStart();
+	for (int i = 0; i < decodeCount; i++)
+	{
+		Animation decoded("Decoded");
+		size_t offset = 0;
+		for (int track = 0; track < jointCount; track++)
+		{
+			int jointIndex = 0;
+			size_t frameCount = 0;
+			memcpy(&jointIndex, v1Data.data() + offset, sizeof(int));
+			memcpy(&frameCount, v1Data.data() + offset + sizeof(int), sizeof(size_t));
+			offset += sizeof(int) + sizeof(size_t);
+
+			std::vector<AnimFrame> frames(frameCount);
+			memcpy(frames.data(), v1Data.data() + offset, sizeof(AnimFrame) * frameCount);
+			offset += sizeof(AnimFrame) * frameCount;
+
+			decoded.AddFrame(jointIndex, frames);
+		}
+		decoded.GetClip();
+	}
+	const double v1Time = Profile::QuickEnd(v1Start);
+
+	Log("Animation compression benchmark (%d joints, %d keys per joint)\n\tv1: %zu bytes, decode %f ms",
+		jointCount, keyCount, v1Data.size(), v1Time * 1000.0 / decodeCount);
+
+	const auto benchmarkSettings = [&](const char* settingsName, const AnimationCompression::Settings& settings)
+		{
+			AnimationClipHeader header;
+			std::vector<uint8_t> v2Data;
+			AnimationCompression::CompressClip(sourceClip, settings, header, v2Data);
+
+			AnimationClip decodedClip;
+			const auto v2Start = Profile::QuickStart();
+			size_t bytesRead = 0;
+			for (int i = 0; i < decodeCount; i++)
+			{
+				AnimationCompression::DecompressClip(header, v2Data.data(), v2Data.size(), (uint32_t)sourceClip.tracks.size(),
+					decodedClip, bytesRead);
+			}
+			const double v2Time = Profile::QuickEnd(v2Start);
+
+			//Compare both clips sampled at 60hz
+			AnimationSampler sourceSampler, decodedSampler;
+			sourceSampler.SetClip(&sourceClip);
+			decodedSampler.SetClip(&decodedClip);
+
+			float maxTranslationError = 0.f;
+			float maxRotationError = 0.f;
+			for (float t = 0.f; t <= clipLength; t += 1.f / 60.f)
+			{
+				for (int jointIndex = 0; jointIndex < jointCount; jointIndex++)
+				{
+					XMVECTOR sourceScale, sourceRot, sourcePos, decodedScale, decodedRot, decodedPos;
+					sourceSampler.SampleJoint(jointIndex, t, sourceScale, sourceRot, sourcePos);
+					decodedSampler.SampleJoint(jointIndex, t, decodedScale, decodedRot, decodedPos);
+
+					maxTranslationError = std::max(maxTranslationError, XMVectorGetX(XMVector3Length(sourcePos - decodedPos)));
+					const float dot = std::min(1.f, fabsf(XMVectorGetX(XMQuaternionDot(sourceRot, decodedRot))));
+					maxRotationError = std::max(maxRotationError, 2.f * acosf(dot));
+				}
+			}
+
+			Log("\t%s: %zu bytes (%.1fx smaller), decode %f ms, max error %f translation %f radians",
+				settingsName, v2Data.size(), (double)v1Data.size() / v2Data.size(), v2Time * 1000.0 / decodeCount,
+				maxTranslationError, maxRotationError);
+		};
+
+	benchmarkSettings("v2 reduced keys", AnimationCompression::Settings());
+
+	AnimationCompression::Settings uniformSettings;
+	uniformSettings.uniformSampleRate = 30.f;
+	benchmarkSettings("v2 uniform 30hz", uniformSettings);
+}
+
+void Benchmarks::FrustumCulling()
+{
+	constexpr int meshCounts[] = { 5000, 20000, 50000 };
+	constexpr int iterationCount = 100;
+	constexpr float worldSize = 1000.f;
+	constexpr float cullDistance = 150.f;
+
+	//Camera at the world's center like a player would be, directional light looking down at an angle.
+	const XMVECTOR cameraPosition = XMVectorSet(0.f, 2.f, 0.f, 1.f);
+	const XMMATRIX cameraView = XMMatrixLookToLH(cameraPosition, XMVectorSet(0.3f, -0.1f, 1.f, 0.f),
+		XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX cameraProj = XMMatrixPerspectiveFovLH(XMConvertToRadians(60.f), 16.f / 9.f, 0.01f, 1000.f);
+
+	const XMMATRIX lightView = XMMatrixLookToLH(XMVectorSet(0.f, 100.f, -50.f, 1.f),
+		XMVectorSet(0.f, -1.f, 0.5f, 0.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	const XMMATRIX lightProj = XMMatrixOrthographicLH(200.f, 200.f, 1.f, 500.f);
+
+	const struct
+	{
+		const char* name;
+		XMMATRIX view;
+		XMMATRIX proj;
+	} passes[] =
+	{
+		{ "Camera", cameraView, cameraProj },
+		{ "Shadow", lightView, lightProj },
+	};
+
+	Log("Frustum culling benchmark (%d iterations per pass)", iterationCount);
+
+	for (const int meshCount : meshCounts)
+	{
+		std::vector<BoundingOrientedBox> worldBounds(meshCount);
+		std::vector<float> maxDistances(meshCount);
+
+		Culling::BoundsSoA bounds;
+		bounds.Resize(meshCount);
+
+		for (int i = 0; i < meshCount; i++)
+		{
+			const BoundingOrientedBox localBounds(XMFLOAT3(0.f, 0.f, 0.f),
+				XMFLOAT3(VMath::RandomRange(0.2f, 4.f), VMath::RandomRange(0.2f, 4.f), VMath::RandomRange(0.2f, 4.f)),
+				XMFLOAT4(0.f, 0.f, 0.f, 1.f));
+			const XMMATRIX world = XMMatrixRotationY(VMath::RandomRange(0.f, XM_2PI)) *
+				XMMatrixTranslation(VMath::RandomRange(-worldSize, worldSize), VMath::RandomRange(0.f, 20.f),
+					VMath::RandomRange(-worldSize, worldSize));
+			localBounds.Transform(worldBounds[i], world);
+
+			//Every 4th mesh is a small prop with a cull distance
+			maxDistances[i] = i % 4 == 0 ? cullDistance : 0.f;
+			bounds.Set(i, worldBounds[i], maxDistances[i]);
+		}
+
+		for (const auto& pass : passes)
+		{
+			const Culling::Frustum frustum = Culling::ExtractFrustum(pass.view * pass.proj);
+
+			std::vector<uint32_t> simdVisible;
+			simdVisible.reserve(meshCount);
+			const auto simdStart = Profile::QuickStart();
+			for (int iteration = 0; iteration < iterationCount; iteration++)
+			{
+				simdVisible.clear();
+				Culling::CullBounds(bounds, frustum, cameraPosition, simdVisible);
+			}
+			const double simdTime = Profile::QuickEnd(simdStart) / iterationCount;
+
+			//Same test one box at a time, straight off the oriented boxes. Sums are in the same order as the
+			//SIMD path so that rounding can't make boxes right on a plane go different ways.
+			std::vector<uint32_t> scalarVisible;
+			scalarVisible.reserve(meshCount);
+			const auto scalarStart = Profile::QuickStart();
+			for (int iteration = 0; iteration < iterationCount; iteration++)
+			{
+				scalarVisible.clear();
+				for (int i = 0; i < meshCount; i++)
+				{
+					const BoundingOrientedBox& box = worldBounds[i];
+					const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&box.Orientation));
+					XMFLOAT3 extents;
+					XMStoreFloat3(&extents, XMVectorAbs(rotation.r[0]) * box.Extents.x +
+						XMVectorAbs(rotation.r[1]) * box.Extents.y + XMVectorAbs(rotation.r[2]) * box.Extents.z);
+					const XMFLOAT3& center = box.Center;
+
+					bool inside = true;
+					for (const XMFLOAT4& plane : frustum.planes)
+					{
+						const float distance = center.z * plane.z + (center.y * plane.y + (center.x * plane.x + plane.w));
+						const float radius = extents.z * fabsf(plane.z) + (extents.y * fabsf(plane.y) + extents.x * fabsf(plane.x));
+						if (distance + radius < 0.f)
+						{
+							inside = false;
+							break;
+						}
+					}
+
+					if (inside && maxDistances[i] > 0.f)
+					{
+						const float deltaX = std::max(fabsf(center.x - XMVectorGetX(cameraPosition)) - extents.x, 0.f);
+						const float deltaY = std::max(fabsf(center.y - XMVectorGetY(cameraPosition)) - extents.y, 0.f);
+						const float deltaZ = std::max(fabsf(center.z - XMVectorGetZ(cameraPosition)) - extents.z, 0.f);
+						inside = deltaZ * deltaZ + (deltaY * deltaY + deltaX * deltaX) <= maxDistances[i] * maxDistances[i];
+					}
+
+					if (inside)
+					{
+						scalarVisible.emplace_back(i);
+					}
+				}
+			}
+			const double scalarTime = Profile::QuickEnd(scalarStart) / iterationCount;
+
+			//Exact frustum/box intersection, culling is allowed to keep more than this but never less.
+			//BoundingFrustum only takes perspective projections, an orthographic pass is a box in view space.
+			const XMMATRIX inverseView = XMMatrixInverse(nullptr, pass.view);
+			const bool isOrthographic = XMVectorGetW(pass.proj.r[2]) == 0.f;
+
+			BoundingFrustum referenceFrustum;
+			BoundingOrientedBox referenceBox;
+			if (isOrthographic)
+			{
+				//Clip x = x * _11 + _41 over [-1, 1], clip z = z * _33 + _43 over [0, 1].
+				XMFLOAT4X4 proj;
+				XMStoreFloat4x4(&proj, pass.proj);
+				const XMVECTOR viewCorner0 = XMVectorSet((-1.f - proj._41) / proj._11, (-1.f - proj._42) / proj._22,
+					-proj._43 / proj._33, 1.f);
+				const XMVECTOR viewCorner1 = XMVectorSet((1.f - proj._41) / proj._11, (1.f - proj._42) / proj._22,
+					(1.f - proj._43) / proj._33, 1.f);
+
+				BoundingBox viewBox;
+				BoundingBox::CreateFromPoints(viewBox, viewCorner0, viewCorner1);
+				BoundingOrientedBox::CreateFromBoundingBox(referenceBox, viewBox);
+				referenceBox.Transform(referenceBox, inverseView);
+			}
+			else
+			{
+				referenceFrustum = BoundingFrustum(pass.proj);
+				referenceFrustum.Transform(referenceFrustum, inverseView);
+			}
+
+			std::vector<bool> isSimdVisible(meshCount, false);
+			for (const uint32_t index : simdVisible)
+			{
+				isSimdVisible[index] = true;
+			}
+
+			int referenceVisibleCount = 0;
+			int missingCount = 0;
+			for (int i = 0; i < meshCount; i++)
+			{
+				const bool referenceVisible = isOrthographic ?
+					referenceBox.Intersects(worldBounds[i]) : referenceFrustum.Intersects(worldBounds[i]);
+				if (!referenceVisible)
+				{
+					continue;
+				}
+
+				if (maxDistances[i] > 0.f)
+				{
+					//Closest point on the box is at most its center distance, so this under-counts rather than over.
+					const float centerDistance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&worldBounds[i].Center) - cameraPosition));
+					if (centerDistance > maxDistances[i])
+					{
+						continue;
+					}
+				}
+
+				referenceVisibleCount++;
+				if (!isSimdVisible[i])
+				{
+					missingCount++;
+				}
+			}
+
+			const bool countsMatch = simdVisible == scalarVisible;
+
+			Log("\t%d meshes, %s pass: %zu visible (scalar %zu, reference %d)\n\t\tSIMD: %f ms | Scalar: %f ms | %s",
+				meshCount, pass.name, simdVisible.size(), scalarVisible.size(), referenceVisibleCount,
+				simdTime * 1000.0, scalarTime * 1000.0,
+				countsMatch && missingCount == 0 ? "OK" : "MISMATCH");
+
+			if (missingCount > 0)
+			{
+				Log("\t\t%d meshes visible to the reference test were culled.", missingCount);
+			}
+		}
+	}
+}
+
+void Benchmarks::DrawListSorting()
+{
+	constexpr int drawCount = 20000;
+	constexpr int shaderCount = 8;
+	constexpr int textureCount = 200;
+	constexpr int rastStateCount = 3;
+	constexpr int frameCount = 100;
+
+	//Stand-ins for the state objects, the draw list only looks at their addresses.
+	struct FakeState { int value = 0; };
+	std::vector<FakeState> shaders(shaderCount), textures(textureCount), rastStates(rastStateCount);
+	FakeState sampler, blendState, inputLayout;
+
+	struct FakeDraw
+	{
+		DrawState state;
+		XMVECTOR position;
+		bool transparent = false;
+		FakeState material;
+		FakeState vertexBuffer;
+	};
+
+	std::vector<FakeDraw> draws(drawCount);
+	for (auto& draw : draws)
+	{
+		draw.transparent = VMath::RandomRange(0.f, 1.f) < 0.1f;
+		draw.position = XMVectorSet(VMath::RandomRange(-500.f, 500.f), 0.f, VMath::RandomRange(-500.f, 500.f), 1.f);
+
+		draw.state.shader = &shaders[VMath::RandomRangeInt(0, shaderCount - 1)];
+		draw.state.inputLayout = &inputLayout;
+		draw.state.rastState = &rastStates[VMath::RandomRangeInt(0, rastStateCount - 1)];
+		draw.state.blendState = draw.transparent ? &blendState : nullptr;
+		draw.state.sampler = &sampler;
+		draw.state.texture = &textures[VMath::RandomRangeInt(0, textureCount - 1)];
+		draw.state.materialData = &draw.material;
+		draw.state.vertexBuffer = &draw.vertexBuffer;
+	}
+
+	const XMVECTOR cameraPosition = XMVectorZero();
+	std::vector<float> distances(drawCount);
+
+	//Old path, what RenderUtils::SortMeshesByDistanceToCamera() did with every state bound on every draw.
+	struct MeshPack
+	{
+		FakeDraw* draw;
+		float distance = 0.f;
+	};
+
+	size_t legacyDrawn = 0;
+	const auto legacyStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		std::vector<MeshPack> meshPacks;
+		for (auto& draw : draws)
+		{
+			meshPacks.push_back({ &draw, XMVectorGetX(XMVector3Length(cameraPosition - draw.position)) });
+		}
+		std::sort(meshPacks.begin(), meshPacks.end(), [](const MeshPack& l, const MeshPack& r) { return l.distance > r.distance; });
+
+		std::vector<FakeDraw*> sortedDraws;
+		for (auto& pack : meshPacks)
+		{
+			sortedDraws.emplace_back(pack.draw);
+		}
+		legacyDrawn = sortedDraws.size();
+	}
+	const double legacyTime = Profile::QuickEnd(legacyStart) / frameCount;
+	const uint32_t legacyBinds = static_cast<uint32_t>(legacyDrawn) * DrawState::Count;
+
+	DrawList drawList;
+	const auto drawListStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		drawList.Clear();
+		for (int i = 0; i < drawCount; i++)
+		{
+			distances[i] = XMVectorGetX(XMVector3Length(cameraPosition - draws[i].position));
+			drawList.Add(1, false, draws[i].transparent, draws[i].state, distances[i], &draws[i]);
+		}
+		drawList.Sort();
+		drawList.Submit([](const DrawList::Item&, uint32_t) {});
+	}
+	const double drawListTime = Profile::QuickEnd(drawListStart) / frameCount;
+
+	//Check the order of the last frame
+	bool orderValid = true;
+	bool inTransparent = false;
+	float previousTransparentDistance = std::numeric_limits<float>::max();
+	uint32_t opaqueShaderChanges = 0;
+	const void* previousOpaqueShader = nullptr;
+
+	for (size_t i = 0; i < drawList.Size(); i++)
+	{
+		const auto* draw = static_cast<const FakeDraw*>(drawList.GetSortedItem(i).userData);
+		const float distance = distances[draw - draws.data()];
+
+		if (draw->transparent)
+		{
+			inTransparent = true;
+			orderValid &= distance <= previousTransparentDistance;
+			previousTransparentDistance = distance;
+		}
+		else
+		{
+			orderValid &= !inTransparent;
+			if (draw->state.shader != previousOpaqueShader)
+			{
+				opaqueShaderChanges++;
+				previousOpaqueShader = draw->state.shader;
+			}
+		}
+	}
+	orderValid &= opaqueShaderChanges <= shaderCount;
+
+	const DrawListStats& stats = drawList.GetStats();
+
+	Log("Draw list benchmark (%d draws, %d shaders, %d textures, ~10%% transparent)\n\tDistance sort: %f ms, %u state binds\n\tDraw list: %f ms, %u state binds (%u skipped), %u shader binds, %u texture binds\n\tOrder: %s",
+		drawCount, shaderCount, textureCount,
+		legacyTime * 1000.0, legacyBinds,
+		drawListTime * 1000.0, stats.GetTotalBinds(), stats.bindsSaved,
+		stats.stateBinds[std::countr_zero(static_cast<uint32_t>(DrawState::Shader))],
+		stats.stateBinds[std::countr_zero(static_cast<uint32_t>(DrawState::Textures))],
+		orderValid ? "OK" : "INVALID");
+}
+
+void Benchmarks::TimerScheduling()
+{
+	const int timerCount = 100000;
+	const int legacyTimerCount = 10000;
+	const int frameCount = 60 * 30;
+	const float deltaTime = 1.f / 60.f;
+
+	struct FakeTimer
+	{
+		float duration = 0.f;
+		bool loop = false;
+		bool cleared = false;
+		double fireTime = -1.0;
+		int fireCount = 0;
+	};
+
+	std::vector<FakeTimer> fakeTimers(timerCount);
+	for (int i = 0; i < timerCount; i++)
+	{
+		fakeTimers[i].duration = VMath::RandomRange(0.05f, 40.f);
+		fakeTimers[i].loop = i % 10 == 0;
+		fakeTimers[i].cleared = i % 7 == 0;
+	}
+
+	double simulatedTime = 0.0;
+
+	//Old path, what Timer::Tick() did: scan every timer, then erase fired ones from the middle of the vector.
+	struct LegacyTimerItem
+	{
+		std::function<void()> functionToCall;
+		double endTime = 0.0;
+		double currentTime = 0.0;
+		bool loop = false;
+	};
+
+	std::vector<LegacyTimerItem> legacyTimers;
+	for (int i = 0; i < legacyTimerCount; i++)
+	{
+		LegacyTimerItem item;
+		item.endTime = fakeTimers[i].duration;
+		item.loop = fakeTimers[i].loop;
+		item.functionToCall = [&fakeTimers, i]() { fakeTimers[i].fireCount++; };
+		legacyTimers.emplace_back(item);
+	}
+
+	const auto legacyStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		for (auto& item : legacyTimers)
+		{
+			item.currentTime += deltaTime;
+			if (item.currentTime > item.endTime)
+			{
+				item.functionToCall();
+				if (item.loop)
+				{
+					item.currentTime = 0.0;
+				}
+			}
+		}
+
+		for (int timerIndex = 0; timerIndex < legacyTimers.size(); timerIndex++)
+		{
+			if (legacyTimers[timerIndex].currentTime > legacyTimers[timerIndex].endTime)
+			{
+				legacyTimers.erase(legacyTimers.begin() + timerIndex);
+			}
+		}
+	}
+	const double legacyTime = Profile::QuickEnd(legacyStart) / frameCount;
+
+	for (auto& fakeTimer : fakeTimers)
+	{
+		fakeTimer.fireCount = 0;
+	}
+
+	//Timer wheel over the same timers, ten times as many.
+	TimerWheel timerWheel;
+	std::vector<TimerHandle> handles(timerCount);
+
+	const auto addStart = Profile::QuickStart();
+	for (int i = 0; i < timerCount; i++)
+	{
+		handles[i] = timerWheel.Add(fakeTimers[i].duration, [&fakeTimers, &simulatedTime, i]()
+			{
+				fakeTimers[i].fireCount++;
+				if (fakeTimers[i].fireTime < 0.0)
+				{
+					fakeTimers[i].fireTime = simulatedTime;
+				}
+			}, fakeTimers[i].loop);
+	}
+	const double addTime = Profile::QuickEnd(addStart);
+
+	const auto clearStart = Profile::QuickStart();
+	for (int i = 0; i < timerCount; i++)
+	{
+		if (fakeTimers[i].cleared)
+		{
+			timerWheel.Remove(handles[i]);
+		}
+	}
+	const double clearTime = Profile::QuickEnd(clearStart);
+
+	double worstFrameTime = 0.0;
+	const auto wheelStart = Profile::QuickStart();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		simulatedTime += deltaTime;
+		const auto frameStart = Profile::QuickStart();
+		timerWheel.Advance(deltaTime);
+		worstFrameTime = std::max(worstFrameTime, Profile::QuickEnd(frameStart));
+	}
+	const double wheelTime = Profile::QuickEnd(wheelStart) / frameCount;
+
+	//Timers fire on the first frame their (millisecond rounded) duration has passed by.
+	int wrongTimers = 0;
+	int firedTimers = 0;
+	for (int i = 0; i < timerCount; i++)
+	{
+		const FakeTimer& fakeTimer = fakeTimers[i];
+		if (fakeTimer.cleared)
+		{
+			wrongTimers += fakeTimer.fireCount != 0 || timerWheel.IsActive(handles[i]);
+			continue;
+		}
+
+		const double durationTicks = std::max(std::ceil(fakeTimer.duration * 1000.0), 1.0) / 1000.0;
+		if (fakeTimer.loop)
+		{
+			const int expectedFires = static_cast<int>(simulatedTime / durationTicks);
+			wrongTimers += std::abs(fakeTimer.fireCount - expectedFires) > 1;
+		}
+		else if (durationTicks <= simulatedTime - deltaTime)
+		{
+			const double lateness = fakeTimer.fireTime - durationTicks;
+			wrongTimers += fakeTimer.fireCount != 1 || lateness < -0.001 || lateness > deltaTime + 0.001 ||
+				timerWheel.IsActive(handles[i]);
+		}
+		firedTimers += fakeTimer.fireCount > 0;
+	}
+
+	Log("Timer benchmark (%d frames at 60 FPS, timers of 0.05-40 seconds, 10%% looping)\n\tVector scan and erase (%d timers): %f ms per frame\n\tTimer wheel (%d timers): %f ms per frame (worst %f ms), %f ms to set all, %f ms to clear 1 in 7\n\t%d timers fired, %zu still active, %d wrong",
+		frameCount,
+		legacyTimerCount, legacyTime * 1000.0,
+		timerCount, wheelTime * 1000.0, worstFrameTime * 1000.0, addTime * 1000.0, clearTime * 1000.0,
+		firedTimers, timerWheel.GetActiveCount(), wrongTimers);
+}
+
+void Benchmarks::WorldLoading()
+{
+	const int mapCount = 3;
+	const int loadsPerFormat = 3;
+
+	std::vector<std::filesystem::directory_entry> maps;
+	for (const auto& entry : std::filesystem::directory_iterator("WorldMaps"))
+	{
+		if (entry.path().extension() == ".vmap")
+		{
+			maps.emplace_back(entry);
+		}
+	}
+	std::sort(maps.begin(), maps.end(), [](const auto& left, const auto& right) { return left.file_size() > right.file_size(); });
+	maps.resize(std::min<size_t>(maps.size(), mapCount));
+
+	const std::string startingWorld = World::worldFilename;
+	const bool useBinaryWorlds = FileSystem::useBinaryWorlds;
+
+	const auto timeLoads = [](const std::string& worldName)
+		{
+			double bestTime = DBL_MAX;
+			for (int i = 0; i < loadsPerFormat; i++)
+			{
+				const auto loadStart = Profile::QuickStart();
+				FileSystem::LoadWorld(worldName);
+				bestTime = std::min(bestTime, Profile::QuickEnd(loadStart));
+			}
+			return bestTime;
+		};
+
+	for (const auto& map : maps)
+	{
+		const std::string worldName = map.path().filename().string();
+
+		FileSystem::useBinaryWorlds = false;
+		const double textTime = timeLoads(worldName);
+
+		BinarySerialiser textLoaded;
+		FileSystem::SerialiseAllSystemsToBinary(textLoaded);
+		const std::vector<uint8_t> textLoadedData = textLoaded.GetFileData();
+
+		const auto saveStart = Profile::QuickStart();
+		FileSystem::WriteAllSystemsToBinary();
+		const double binarySaveTime = Profile::QuickEnd(saveStart);
+
+		FileSystem::useBinaryWorlds = true;
+		const double binaryTime = timeLoads(worldName);
+
+		BinarySerialiser binaryLoaded;
+		FileSystem::SerialiseAllSystemsToBinary(binaryLoaded);
+		const bool matches = binaryLoaded.GetFileData() == textLoadedData;
+
+		Log("World load benchmark [%s] (best of %d loads)\n\tText .vmap (%ju bytes): %f ms\n\tBinary (%zu bytes): %f ms, %f ms to save\n\tBinary load %s the text load",
+			worldName.c_str(), loadsPerFormat,
+			static_cast<uintmax_t>(map.file_size()), textTime * 1000.0,
+			textLoadedData.size(), binaryTime * 1000.0, binarySaveTime * 1000.0,
+			matches ? "matches" : "DOESN'T MATCH");
+	}
+
+	FileSystem::useBinaryWorlds = useBinaryWorlds;
+	if (!startingWorld.empty())
+	{
+		FileSystem::LoadWorld(startingWorld);
+	}
+}
+
+void Benchmarks::ParticleSimulation()
+{
+	const int emitterCount = 100;
+	const int particlesPerEmitter = 1000;
+	const int frameCount = 300;
+	const float deltaTime = 1.f / 60.f;
+	constexpr float lifetimeAlphaSpeed = 5.f;
+
+	ParticleData particleData;
+	particleData.minDirection = XMFLOAT3(-0.5f, 0.5f, -0.5f);
+	particleData.maxDirection = XMFLOAT3(0.5f, 1.f, 0.5f);
+	particleData.moveSpeed = XMFLOAT2(0.5f, 2.f);
+	particleData.lifetime = XMFLOAT2(1.f, 4.f);
+	particleData.rotation = XMFLOAT2(-XM_PI, XM_PI);
+	particleData.rotateSpeed = XMFLOAT2(-1.f, 1.f);
+
+	const XMVECTOR cameraPosition = XMVectorSet(0.f, 5.f, -20.f, 1.f);
+	ShaderMatrices shaderMatrices;
+	shaderMatrices.view = XMMatrixLookAtLH(cameraPosition, XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+	shaderMatrices.proj = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.f / 9.f, 0.01f, 1000.f);
+
+	std::vector<XMFLOAT3> emitterPositions(emitterCount);
+	for (auto& position : emitterPositions)
+	{
+		position = VMath::RandomRangeFloat3(XMFLOAT3(-50.f, 0.f, -50.f), XMFLOAT3(50.f, 10.f, 50.f));
+	}
+
+	//Old path, what ParticleEmitter::Tick() and Renderer::RenderParticleEmitters() did per particle. Removal is by
+	//index here, the old range-for kept reading past the element it had just popped.
+	std::vector<std::vector<Particle>> legacyEmitters(emitterCount);
+	XMVECTOR legacySink = XMVectorZero();
+	double legacyTickTime = 0.0;
+	double legacySubmitTime = 0.0;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		for (int e = 0; e < emitterCount; e++)
+		{
+			auto& particles = legacyEmitters[e];
+			while (particles.size() < particlesPerEmitter)
+			{
+				Particle particle = {};
+				particle.transform.position = emitterPositions[e];
+				particle.SetParticleRangeData(particleData);
+				particles.emplace_back(particle);
+			}
+		}
+
+		const auto tickStart = Profile::QuickStart();
+		for (auto& particles : legacyEmitters)
+		{
+			for (size_t i = 0; i < particles.size(); i++)
+			{
+				Particle& particle = particles[i];
+				particle.lifetime += deltaTime;
+
+				const float lifetimeRange = VMath::RandomRange(particleData.lifetime.x, particleData.lifetime.y);
+				if (particle.lifetime > (lifetimeRange / 1.5f))
+				{
+					particle.alpha -= deltaTime * lifetimeAlphaSpeed;
+				}
+				else
+				{
+					particle.alpha += deltaTime * lifetimeAlphaSpeed;
+				}
+				particle.alpha = std::clamp(particle.alpha, 0.f, 1.f);
+
+				particle.angle += particle.rotateSpeed * deltaTime;
+				particle.AddVelocity(deltaTime);
+
+				if (particle.lifetime > lifetimeRange)
+				{
+					std::swap(particle, particles.back());
+					particles.pop_back();
+					i--;
+				}
+			}
+		}
+		legacyTickTime += Profile::QuickEnd(tickStart);
+
+		const auto submitStart = Profile::QuickStart();
+		for (auto& particles : legacyEmitters)
+		{
+			for (auto& particle : particles)
+			{
+				const XMVECTOR rotation = VMath::LookAtRotation(cameraPosition, XMLoadFloat3(&particle.transform.position));
+				XMStoreFloat4(&particle.transform.rotation, rotation);
+				shaderMatrices.model = particle.transform.GetAffine();
+				shaderMatrices.MakeModelViewProjectionMatrix();
+				legacySink = XMVectorAdd(legacySink, shaderMatrices.mvp.r[3]);
+			}
+		}
+		legacySubmitTime += Profile::QuickEnd(submitStart);
+	}
+
+	//ParticlePool over the same emitters.
+	std::vector<ParticlePool> pools(emitterCount);
+	std::vector<ParticleInstanceData> instanceData;
+	float poolSink = 0.f;
+	double poolTickTime = 0.0;
+	double poolSubmitTime = 0.0;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		for (int e = 0; e < emitterCount; e++)
+		{
+			while (pools[e].GetCount() < particlesPerEmitter)
+			{
+				pools[e].Spawn(emitterPositions[e], particleData);
+			}
+		}
+
+		const auto tickStart = Profile::QuickStart();
+		for (auto& pool : pools)
+		{
+			pool.Update(deltaTime);
+		}
+		poolTickTime += Profile::QuickEnd(tickStart);
+
+		const auto submitStart = Profile::QuickStart();
+		for (auto& pool : pools)
+		{
+			instanceData.resize(pool.GetCount());
+			pool.WriteInstanceData(instanceData.data());
+			poolSink += instanceData.empty() ? 0.f : instanceData.back().angle;
+		}
+		poolSubmitTime += Profile::QuickEnd(submitStart);
+	}
+
+	//Check: one emitter spawning every frame with fixed ranges, against the same rules run one particle at a time.
+	struct ReferenceParticle
+	{
+		XMFLOAT3 position = XMFLOAT3(0.f, 0.f, 0.f);
+		float age = 0.f;
+		float alpha = 0.f;
+		float angle = 0.f;
+	};
+
+	ParticleData checkData;
+	checkData.minDirection = checkData.maxDirection = XMFLOAT3(0.25f, 1.f, -0.5f);
+	checkData.moveSpeed = XMFLOAT2(2.f, 2.f);
+	checkData.lifetime = XMFLOAT2(1.3f, 1.3f);
+	checkData.spawnRadius = XMFLOAT2(0.f, 0.f);
+	checkData.rotation = XMFLOAT2(0.5f, 0.5f);
+	checkData.rotateSpeed = XMFLOAT2(-2.f, -2.f);
+
+	const XMFLOAT3 checkEmitterPosition = XMFLOAT3(1.f, 2.f, 3.f);
+	ParticlePool checkPool;
+	std::vector<ReferenceParticle> reference;
+	int wrongFrames = 0;
+	float maxError = 0.f;
+
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		checkPool.Spawn(checkEmitterPosition, checkData);
+		ReferenceParticle& spawned = reference.emplace_back();
+		spawned.position = checkEmitterPosition;
+		spawned.angle = checkData.rotation.x;
+
+		checkPool.Update(deltaTime);
+		for (auto& particle : reference)
+		{
+			particle.age += deltaTime;
+			const float fade = deltaTime * lifetimeAlphaSpeed;
+			particle.alpha = std::clamp(particle.alpha + (particle.age > checkData.lifetime.x / 1.5f ? -fade : fade), 0.f, 1.f);
+			particle.angle += checkData.rotateSpeed.x * deltaTime;
+			particle.position.x += checkData.minDirection.x * checkData.moveSpeed.x * deltaTime;
+			particle.position.y += checkData.minDirection.y * checkData.moveSpeed.x * deltaTime;
+			particle.position.z += checkData.minDirection.z * checkData.moveSpeed.x * deltaTime;
+		}
+		std::erase_if(reference, [&](const ReferenceParticle& particle) { return particle.age > checkData.lifetime.x; });
+
+		if (checkPool.GetCount() != reference.size())
+		{
+			wrongFrames++;
+			continue;
+		}
+
+		instanceData.resize(checkPool.GetCount());
+		checkPool.WriteInstanceData(instanceData.data());
+		for (size_t i = 0; i < reference.size(); i++)
+		{
+			const ParticleInstanceData& instance = instanceData[i];
+			const ReferenceParticle& particle = reference[i];
+			maxError = std::max({ maxError,
+				std::abs(instance.position.x - particle.position.x),
+				std::abs(instance.position.y - particle.position.y),
+				std::abs(instance.position.z - particle.position.z),
+				std::abs(instance.colour.w - particle.alpha),
+				std::abs(instance.angle - particle.angle) });
+		}
+	}
+
+	Log("Particle benchmark (%d emitters of %d particles, %d frames at 60 FPS)\n\tAoS tick: %f ms, per particle matrices: %f ms per frame\n\tSoA pool update: %f ms, instance data: %f ms per frame (one draw per emitter)\n\tCheck against scalar rules: %d frames with wrong counts, max error %f (sinks %f %f)",
+		emitterCount, particlesPerEmitter, frameCount,
+		legacyTickTime * 1000.0 / frameCount, legacySubmitTime * 1000.0 / frameCount,
+		poolTickTime * 1000.0 / frameCount, poolSubmitTime * 1000.0 / frameCount,
+		wrongFrames, maxError, XMVectorGetX(legacySink), poolSink);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+//Headless benchmarks run from the console. They build their own synthetic data so they don't
+//touch the currently loaded world, and Log() their timings.
+namespace Benchmarks
+{
+	//Linear raycasting (every box, every triangle) against the world and triangle BVHs on 10k meshes.
+	void RaycastBVH();
+
+	//Per-joint Animation::Interpolate() (what SkeletalMeshComponent::InterpolateCurrentAnimation() used to do)
+	//against AnimationSampler on a synthetic 64 joint skeleton.
+	void SkeletalAnimation();
+
+	//.vanim v1 (raw AnimFrames) against v2 (quantised, reduced) sizes, decode times and error.
+	void AnimationClipCompression();
+
+	//Culling::CullBounds() on synthetic worlds of thousands of boxes, against the camera and a shadow frustum.
+	//Visible counts are checked against a scalar version of the same test and against DirectXMath's
+	//BoundingFrustum (which culling must never disagree with by dropping a box it says is visible).
+	void FrustumCulling();
+
+	//DrawList build/sort/submit against the old per-frame distance sort with every state bound per draw,
+	//on synthetic draws spread over a handful of shaders and textures. Checks opaque draws come first grouped
+	//by shader and that transparent draws go back to front.
+	void DrawListSorting();
+
+	//TimerWheel with 100k active timers (some looping, some cleared) against the old vector scan and erase on
+	//10k, over simulated frames at 60 FPS. Checks every timer fires on the frame it comes due and cleared
+	//timers never fire.
+	void TimerScheduling();
+
+	//Text LoadWorld() against loading the binary copy on the largest maps in WorldMaps/. Unlike the others this one
+	//loads real worlds (so unsaved changes are lost) and reloads the starting world at the end. Checks that
+	//saving the world to binary after each load gives the same bytes.
+	void WorldLoading();
+
+	//ParticlePool update and instance data writes against the old AoS Particle tick with a LookAtRotation and MVP
+	//per particle, on 100 emitters of 1000 particles. Checks the pool against a scalar version of the same rules
+	//(fixed lifetimes, stable removal) on one emitter.
+	void ParticleSimulation();
+}
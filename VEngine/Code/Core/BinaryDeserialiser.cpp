@@ -1,61 +1,271 @@
 #include "vpch.h"
 #include "BinaryDeserialiser.h"
+#include "BinarySerialiser.h"
+#include "Core/Log.h"
+#include "Core/Properties.h"
+#include "Core/PropertyTable.h"
 #include "Core/VEnum.h"
+#include "Core/VString.h"
 
-void BinaryDeserialiser::Deserialise(Properties& props)
+bool BinaryDeserialiser::Open(const std::string& filepath)
 {
-	for (auto& [name, prop] : props.propMap)
+	header = nullptr;
+
+	if (!mappedFile.Open(filepath))
+	{
+		Log("Couldn't open binary world %s.", filepath.c_str());
+		return false;
+	}
+
+	const size_t fileSize = mappedFile.GetSize();
+	const auto fileHeader = GetBlock<WorldBinaryHeader>(0);
+	if (fileSize < sizeof(WorldBinaryHeader) || fileHeader->magic != WorldBinaryHeader::MAGIC)
+	{
+		Log("%s is from before versioned binary worlds, save it to binary again.", filepath.c_str());
+		mappedFile.Close();
+		return false;
+	}
+
+	if (fileHeader->version != WorldBinaryHeader::CURRENT_VERSION || fileHeader->fileSize != fileSize ||
+		fileHeader->stringsOffset + sizeof(WorldBinaryString) * static_cast<size_t>(fileHeader->stringCount) > fileSize ||
+		fileHeader->stringDataOffset > fileSize ||
+		fileHeader->systemsOffset + sizeof(WorldBinarySystem) * static_cast<size_t>(fileHeader->systemCount) > fileSize)
 	{
-		if (props.CheckType<std::string>(name))
+		Log("Binary world %s is a different version or damaged.", filepath.c_str());
+		mappedFile.Close();
+		return false;
+	}
+
+	header = fileHeader;
+	strings = GetBlock<WorldBinaryString>(header->stringsOffset);
+	stringData = GetBlock<char>(header->stringDataOffset);
+	systems = GetBlock<WorldBinarySystem>(header->systemsOffset);
+
+	for (uint32_t i = 0; i < header->stringCount; i++)
+	{
+		if (header->stringDataOffset + static_cast<size_t>(strings[i].offset) + strings[i].length > fileSize)
 		{
-			auto str = props.GetData<std::string>(name);
-			ReadString(str);
+			Log("Binary world %s has a damaged string table.", filepath.c_str());
+			header = nullptr;
+			mappedFile.Close();
+			return false;
 		}
-		else if (props.CheckType<std::wstring>(name))
+	}
+
+	systemNames.clear();
+	propertyNames.clear();
+	propertyNameHashes.clear();
+
+	for (uint32_t systemIndex = 0; systemIndex < header->systemCount; systemIndex++)
+	{
+		const WorldBinarySystem& system = systems[systemIndex];
+		if (!ValidateSystem(system))
+		{
+			Log("Binary world %s has a damaged system block.", filepath.c_str());
+			header = nullptr;
+			mappedFile.Close();
+			return false;
+		}
+
+		systemNames.emplace_back(GetString(system.nameString));
+
+		std::vector<std::string>& names = propertyNames.emplace_back();
+		std::vector<uint64_t>& nameHashes = propertyNameHashes.emplace_back();
+		const auto schema = GetBlock<WorldBinaryProperty>(system.propertiesOffset);
+		for (uint32_t propertyIndex = 0; propertyIndex < system.propertyCount; propertyIndex++)
 		{
-			auto str = props.GetData<std::wstring>(name);
-			ReadWString(str);
+			names.emplace_back(GetString(schema[propertyIndex].nameString));
+			nameHashes.emplace_back(HashPropertyName(names.back()));
 		}
-		else if (props.CheckType<MeshComponentData>(name))
+	}
+
+	return true;
+}
+
+bool BinaryDeserialiser::ValidateSystem(const WorldBinarySystem& system) const
+{
+	const size_t fileSize = header->fileSize;
+	const size_t objectCount = system.objectCount;
+
+	const auto blockFits = [fileSize](uint32_t offset, size_t size) { return offset + size <= fileSize; };
+
+	if (system.nameString >= header->stringCount ||
+		!blockFits(system.propertiesOffset, sizeof(WorldBinaryProperty) * static_cast<size_t>(system.propertyCount)) ||
+		!blockFits(system.recordsOffset, static_cast<size_t>(system.recordSize) * objectCount) ||
+		!blockFits(system.stringIndicesOffset, sizeof(uint32_t) * static_cast<size_t>(system.stringPropertyCount) * objectCount))
+	{
+		return false;
+	}
+
+	if (system.kind == WorldBinarySystemKind::Component &&
+		(!blockFits(system.ownersOffset, sizeof(UID) * objectCount) ||
+		!blockFits(system.componentNamesOffset, sizeof(uint32_t) * objectCount)))
+	{
+		return false;
+	}
+
+	if (system.presenceMasksOffset != WorldBinarySystem::NO_PRESENCE_MASKS &&
+		!blockFits(system.presenceMasksOffset, sizeof(uint32_t) * ((system.propertyCount + 31) / 32) * objectCount))
+	{
+		return false;
+	}
+
+	const auto schema = GetBlock<WorldBinaryProperty>(system.propertiesOffset);
+	for (uint32_t i = 0; i < system.propertyCount; i++)
+	{
+		const WorldBinaryProperty& property = schema[i];
+		if (property.nameString >= header->stringCount)
 		{
-			auto meshComponentData = props.GetData<MeshComponentData>(name);
-			ReadString(&meshComponentData->filename);
+			return false;
 		}
-		else if (props.CheckType<TextureData>(name))
+		if (IsStringPropertyType(property.type) ? property.offset >= system.stringPropertyCount :
+			property.offset + static_cast<size_t>(property.size) > system.recordSize)
 		{
-			auto textureData = props.GetData<TextureData>(name);
-			ReadString(&textureData->filename);
+			return false;
 		}
-		else if (props.CheckType<VEnum>(name))
+	}
+
+	const auto stringIndices = GetBlock<uint32_t>(system.stringIndicesOffset);
+	for (size_t i = 0; i < static_cast<size_t>(system.stringPropertyCount) * objectCount; i++)
+	{
+		if (stringIndices[i] >= header->stringCount)
 		{
-			auto vEnum = props.GetData<VEnum>(name);
-			std::string readStr;
-			ReadString(&readStr);
-			vEnum->SetValue(readStr);
+			return false;
 		}
-		else
+	}
+
+	return true;
+}
+
+std::string_view BinaryDeserialiser::GetString(uint32_t stringIndex) const
+{
+	const WorldBinaryString& entry = strings[stringIndex];
+	return std::string_view(stringData + entry.offset, entry.length);
+}
+
+UID BinaryDeserialiser::GetComponentOwnerUID(uint32_t systemIndex, uint32_t objectIndex) const
+{
+	const WorldBinarySystem& system = systems[systemIndex];
+	assert(system.kind == WorldBinarySystemKind::Component && objectIndex < system.objectCount);
+	return GetBlock<UID>(system.ownersOffset)[objectIndex];
+}
+
+std::string BinaryDeserialiser::GetComponentName(uint32_t systemIndex, uint32_t objectIndex) const
+{
+	const WorldBinarySystem& system = systems[systemIndex];
+	assert(system.kind == WorldBinarySystemKind::Component && objectIndex < system.objectCount);
+	const uint32_t nameString = GetBlock<uint32_t>(system.componentNamesOffset)[objectIndex];
+	if (nameString >= header->stringCount)
+	{
+		return {};
+	}
+	return std::string(GetString(nameString));
+}
+
+template <typename Func>
+void BinaryDeserialiser::ForEachPresentProperty(uint32_t systemIndex, uint32_t objectIndex, Func&& func) const
+{
+	const WorldBinarySystem& system = systems[systemIndex];
+	assert(objectIndex < system.objectCount);
+
+	const auto schema = GetBlock<WorldBinaryProperty>(system.propertiesOffset);
+	const uint8_t* record = GetBlock<uint8_t>(system.recordsOffset) + static_cast<size_t>(system.recordSize) * objectIndex;
+	const uint32_t* objectStrings = GetBlock<uint32_t>(system.stringIndicesOffset) +
+		static_cast<size_t>(system.stringPropertyCount) * objectIndex;
+
+	const uint32_t* presenceMask = nullptr;
+	if (system.presenceMasksOffset != WorldBinarySystem::NO_PRESENCE_MASKS)
+	{
+		presenceMask = GetBlock<uint32_t>(system.presenceMasksOffset) + static_cast<size_t>((system.propertyCount + 31) / 32) * objectIndex;
+	}
+
+	for (uint32_t propertyIndex = 0; propertyIndex < system.propertyCount; propertyIndex++)
+	{
+		if (presenceMask && (presenceMask[propertyIndex / 32] & (1u << (propertyIndex % 32))) == 0)
 		{
-			fread(prop.data, prop.size, 1, file);
+			continue;
 		}
+
+		func(propertyIndex, schema[propertyIndex], record, objectStrings);
 	}
 }
 
-void BinaryDeserialiser::ReadString(std::string* str)
+void BinaryDeserialiser::ReadProperty(const WorldBinaryProperty& schemaProperty, const uint8_t* record,
+	const uint32_t* objectStrings, void* data) const
 {
-	size_t stringSize = 0;
-	fread(&stringSize, sizeof(size_t), 1, file);
+	if (!IsStringPropertyType(schemaProperty.type))
+	{
+		memcpy(data, record + schemaProperty.offset, schemaProperty.size);
+		return;
+	}
 
-	std::vector<char> buff(stringSize);
-	fread(buff.data(), stringSize, 1, file);
-	assert(buff.size() == stringSize);
+	const std::string_view value = GetString(objectStrings[schemaProperty.offset]);
+	switch (schemaProperty.type)
+	{
+	case WorldBinaryPropertyType::String:
+		static_cast<std::string*>(data)->assign(value);
+		break;
+	case WorldBinaryPropertyType::WString:
+		*static_cast<std::wstring*>(data) = VString::stows(std::string(value));
+		break;
+	case WorldBinaryPropertyType::Texture:
+		static_cast<TextureData*>(data)->filename.assign(value);
+		break;
+	case WorldBinaryPropertyType::Mesh:
+		static_cast<MeshComponentData*>(data)->filename.assign(value);
+		break;
+	case WorldBinaryPropertyType::Enum:
+		static_cast<VEnum*>(data)->SetValue(std::string(value));
+		break;
+	}
+}
 
-	const std::string newStr(buff.data(), stringSize);
-	*str = newStr;
+void BinaryDeserialiser::Deserialise(uint32_t systemIndex, uint32_t objectIndex, Properties& props) const
+{
+	const std::vector<std::string>& names = propertyNames[systemIndex];
+
+	ForEachPresentProperty(systemIndex, objectIndex,
+		[&](uint32_t propertyIndex, const WorldBinaryProperty& schemaProperty, const uint8_t* record, const uint32_t* objectStrings)
+		{
+			//Removed from the class since the file was saved.
+			auto propIt = props.propMap.find(names[propertyIndex]);
+			if (propIt == props.propMap.end())
+			{
+				return;
+			}
+
+			//Type changed since the file was saved, leave it at its default like a new property.
+			Property& prop = propIt->second;
+			if (BinarySerialiser::GetPropertyType(prop.info.value()) != schemaProperty.type ||
+				(!IsStringPropertyType(schemaProperty.type) && schemaProperty.size != prop.size))
+			{
+				return;
+			}
+
+			ReadProperty(schemaProperty, record, objectStrings, prop.data);
+		});
 }
 
-void BinaryDeserialiser::ReadWString(std::wstring* wstr)
+void BinaryDeserialiser::Deserialise(uint32_t systemIndex, uint32_t objectIndex, const PropertyView& view) const
 {
-	std::string str;
-	ReadString(&str);
-	*wstr = VString::stows(str);
+	const std::vector<std::string>& names = propertyNames[systemIndex];
+	const std::vector<uint64_t>& nameHashes = propertyNameHashes[systemIndex];
+
+	ForEachPresentProperty(systemIndex, objectIndex,
+		[&](uint32_t propertyIndex, const WorldBinaryProperty& schemaProperty, const uint8_t* record, const uint32_t* objectStrings)
+		{
+			const PropertyDescriptor* descriptor = view.table->Find(nameHashes[propertyIndex]);
+			if (descriptor == nullptr || descriptor->name != names[propertyIndex])
+			{
+				return;
+			}
+
+			if (BinarySerialiser::GetPropertyType(descriptor->type) != schemaProperty.type ||
+				(!IsStringPropertyType(schemaProperty.type) && schemaProperty.size != descriptor->size))
+			{
+				return;
+			}
+
+			ReadProperty(schemaProperty, record, objectStrings, view.GetData(*descriptor));
+		});
 }
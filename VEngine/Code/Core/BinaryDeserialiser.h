@@ -1,33 +1,63 @@
 #pragma once
 
-#include <cstdio>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "Core/MappedFile.h"
+#include "Core/UID.h"
+#include "Core/WorldBinaryFormat.h"
 
 struct Properties;
+struct PropertyView;
 
+//Reads a memory-mapped binary world file (see WorldBinaryFormat.h). Objects are read by index, so the caller
+//spawns actors and finds components the same way text deserialisation does and hands their props in here.
 class BinaryDeserialiser
 {
 public:
-	FILE* file = nullptr;
+	//Fails on missing or damaged files and on files from before the versioned format.
+	bool Open(const std::string& filepath);
 
-	BinaryDeserialiser(const std::string filename)
-	{
-		fopen_s(&file, filename.c_str(), "rb");
-	}
+	uint32_t GetSystemCount() const { return header->systemCount; }
+	const std::string& GetSystemName(uint32_t systemIndex) const { return systemNames[systemIndex]; }
+	WorldBinarySystemKind GetSystemKind(uint32_t systemIndex) const { return systems[systemIndex].kind; }
+	uint32_t GetObjectCount(uint32_t systemIndex) const { return systems[systemIndex].objectCount; }
 
-	~BinaryDeserialiser()
-	{
-		fclose(file);
-	}
+	//Component systems only.
+	UID GetComponentOwnerUID(uint32_t systemIndex, uint32_t objectIndex) const;
+	std::string GetComponentName(uint32_t systemIndex, uint32_t objectIndex) const;
 
-	void Deserialise(Properties& props);
+	//Sets every property in props that the file has a value of the same type for. Properties the file doesn't
+	//know about keep their current values.
+	void Deserialise(uint32_t systemIndex, uint32_t objectIndex, Properties& props) const;
+	void Deserialise(uint32_t systemIndex, uint32_t objectIndex, const PropertyView& view) const;
 
-	void ReadString(std::string* str);
-	void ReadWString(std::wstring* wstr);
+private:
+	std::string_view GetString(uint32_t stringIndex) const;
+	bool ValidateSystem(const WorldBinarySystem& system) const;
+
+	//Calls func(propertyIndex, schemaProperty, record, objectStrings) for each property the object has a value for.
+	template <typename Func>
+	void ForEachPresentProperty(uint32_t systemIndex, uint32_t objectIndex, Func&& func) const;
+
+	void ReadProperty(const WorldBinaryProperty& schemaProperty, const uint8_t* record, const uint32_t* objectStrings,
+		void* data) const;
 
 	template <typename T>
-	void Read(T* value)
+	const T* GetBlock(uint32_t offset) const
 	{
-		fread(value, sizeof(T), 1, file);
+		return reinterpret_cast<const T*>(mappedFile.GetData() + offset);
 	}
+
+	MappedFile mappedFile;
+	const WorldBinaryHeader* header = nullptr;
+	const WorldBinaryString* strings = nullptr;
+	const char* stringData = nullptr;
+	const WorldBinarySystem* systems = nullptr;
+
+	//std::map lookups in Properties need std::strings, so names are made once here and not per object.
+	std::vector<std::string> systemNames;
+	std::vector<std::vector<std::string>> propertyNames;
+	std::vector<std::vector<uint64_t>> propertyNameHashes; //For PropertyTable lookups
 };
@@ -1,52 +1,367 @@
 #include "vpch.h"
 #include "BinarySerialiser.h"
+#include <filesystem>
+#include "Core/Log.h"
+#include "Core/Properties.h"
+#include "Core/PropertyTable.h"
 #include "Core/VEnum.h"
+#include "Core/VString.h"
+
+static uint32_t AlignOffset(size_t offset)
+{
+	const size_t alignment = WorldBinaryHeader::SECTION_ALIGNMENT;
+	return static_cast<uint32_t>((offset + alignment - 1) & ~(alignment - 1));
+}
+
+static uint32_t GetFixedPropertySize(WorldBinaryPropertyType type)
+{
+	switch (type)
+	{
+	case WorldBinaryPropertyType::Bool: return sizeof(bool);
+	case WorldBinaryPropertyType::Int: return sizeof(int);
+	case WorldBinaryPropertyType::UID: return sizeof(UID);
+	case WorldBinaryPropertyType::Float: return sizeof(float);
+	case WorldBinaryPropertyType::Float2: return sizeof(XMFLOAT2);
+	case WorldBinaryPropertyType::Int2: return sizeof(XMINT2);
+	case WorldBinaryPropertyType::Float3: return sizeof(XMFLOAT3);
+	case WorldBinaryPropertyType::Float4: return sizeof(XMFLOAT4);
+	}
+	return 0;
+}
+
+static std::string GetStringPropertyValue(WorldBinaryPropertyType type, void* data)
+{
+	switch (type)
+	{
+	case WorldBinaryPropertyType::String: return *static_cast<std::string*>(data);
+	case WorldBinaryPropertyType::WString: return VString::wstos(*static_cast<std::wstring*>(data));
+	case WorldBinaryPropertyType::Texture: return static_cast<TextureData*>(data)->filename;
+	case WorldBinaryPropertyType::Mesh: return static_cast<MeshComponentData*>(data)->filename;
+	case WorldBinaryPropertyType::Enum: return static_cast<VEnum*>(data)->GetValue();
+	}
+	return {};
+}
+
+WorldBinaryPropertyType BinarySerialiser::GetPropertyType(const std::type_index& type)
+{
+	static const std::unordered_map<std::type_index, WorldBinaryPropertyType> propertyTypes = {
+		{ typeid(bool), WorldBinaryPropertyType::Bool },
+		{ typeid(int), WorldBinaryPropertyType::Int },
+		{ typeid(UID), WorldBinaryPropertyType::UID },
+		{ typeid(float), WorldBinaryPropertyType::Float },
+		{ typeid(XMFLOAT2), WorldBinaryPropertyType::Float2 },
+		{ typeid(XMINT2), WorldBinaryPropertyType::Int2 },
+		{ typeid(XMFLOAT3), WorldBinaryPropertyType::Float3 },
+		{ typeid(XMFLOAT4), WorldBinaryPropertyType::Float4 },
+		{ typeid(std::string), WorldBinaryPropertyType::String },
+		{ typeid(std::wstring), WorldBinaryPropertyType::WString },
+		{ typeid(TextureData), WorldBinaryPropertyType::Texture },
+		{ typeid(MeshComponentData), WorldBinaryPropertyType::Mesh },
+		{ typeid(VEnum), WorldBinaryPropertyType::Enum },
+	};
+
+	auto typeIt = propertyTypes.find(type);
+	if (typeIt == propertyTypes.end())
+	{
+		return WorldBinaryPropertyType::Unsupported;
+	}
+	return typeIt->second;
+}
+
+uint32_t BinarySerialiser::InternString(const std::string& str)
+{
+	auto [stringIt, inserted] = stringIndices.try_emplace(str, static_cast<uint32_t>(strings.size()));
+	if (inserted)
+	{
+		strings.emplace_back(str);
+	}
+	return stringIt->second;
+}
+
+void BinarySerialiser::BeginSystem(const std::string& systemName, WorldBinarySystemKind kind)
+{
+	assert(!systemOpen);
+	systemOpen = true;
+
+	currentSystem = PendingSystem();
+	currentSystem.nameString = InternString(systemName);
+	currentSystem.kind = kind;
+}
 
 void BinarySerialiser::Serialise(Properties& props)
 {
-	for (const auto& [name, prop] : props.propMap)
+	assert(systemOpen && currentSystem.kind == WorldBinarySystemKind::Actor);
+	AddObject(props, currentSystem.objects.emplace_back());
+}
+
+void BinarySerialiser::Serialise(const PropertyView& view)
+{
+	assert(systemOpen && currentSystem.kind == WorldBinarySystemKind::Actor);
+	AddObject(view, currentSystem.objects.emplace_back());
+}
+
+void BinarySerialiser::SerialiseComponent(UID ownerUID, const std::string& componentName, Properties& props)
+{
+	assert(systemOpen && currentSystem.kind == WorldBinarySystemKind::Component);
+
+	PendingObject& object = currentSystem.objects.emplace_back();
+	object.ownerUID = ownerUID;
+	object.componentNameString = InternString(componentName);
+	AddObject(props, object);
+}
+
+void BinarySerialiser::SerialiseComponent(UID ownerUID, const std::string& componentName, const PropertyView& view)
+{
+	assert(systemOpen && currentSystem.kind == WorldBinarySystemKind::Component);
+
+	PendingObject& object = currentSystem.objects.emplace_back();
+	object.ownerUID = ownerUID;
+	object.componentNameString = InternString(componentName);
+	AddObject(view, object);
+}
+
+void BinarySerialiser::AddObject(Properties& props, PendingObject& object)
+{
+	object.properties.reserve(props.propMap.size());
+
+	for (auto& [name, prop] : props.propMap)
+	{
+		AddProperty(name, prop.info.value(), prop.data, object);
+	}
+}
+
+void BinarySerialiser::AddObject(const PropertyView& view, PendingObject& object)
+{
+	const std::vector<PropertyDescriptor>& descriptors = view.table->GetDescriptors();
+	object.properties.reserve(descriptors.size());
+
+	for (const PropertyDescriptor& descriptor : descriptors)
 	{
-		if (props.CheckType<std::string>(name))
+		AddProperty(descriptor.name, descriptor.type, view.GetData(descriptor), object);
+	}
+}
+
+void BinarySerialiser::AddProperty(const std::string& name, const std::type_index& propertyType, const void* data,
+	PendingObject& object)
+{
+	const WorldBinaryPropertyType type = GetPropertyType(propertyType);
+	assert(type != WorldBinaryPropertyType::Unsupported && "Property type can't be serialised");
+
+	auto [schemaIt, inserted] = currentSystem.schemaIndices.try_emplace(name,
+		static_cast<uint32_t>(currentSystem.schema.size()));
+	if (inserted)
+	{
+		WorldBinaryProperty& schemaProperty = currentSystem.schema.emplace_back();
+		schemaProperty.nameString = InternString(name);
+		schemaProperty.type = type;
+	}
+	else if (currentSystem.schema[schemaIt->second].type != type)
+	{
+		Log("Property [%s] has different types across one system, skipping it on [%s].", name.c_str(),
+			strings[currentSystem.nameString].c_str());
+		return;
+	}
+
+	object.properties.push_back({ schemaIt->second, data });
+}
+
+void BinarySerialiser::EndSystem()
+{
+	assert(systemOpen);
+	systemOpen = false;
+
+	WorldBinarySystem system;
+	system.nameString = currentSystem.nameString;
+	system.kind = currentSystem.kind;
+	system.objectCount = static_cast<uint32_t>(currentSystem.objects.size());
+	system.propertyCount = static_cast<uint32_t>(currentSystem.schema.size());
+
+	for (WorldBinaryProperty& schemaProperty : currentSystem.schema)
+	{
+		if (IsStringPropertyType(schemaProperty.type))
 		{
-			auto str = props.GetData<std::string>(name);
-			WriteString(*str);
+			schemaProperty.offset = system.stringPropertyCount++;
 		}
-		else if (props.CheckType<std::wstring>(name))
+		else
 		{
-			auto wstr = props.GetData<std::wstring>(name);
-			WriteWString(*wstr);
+			schemaProperty.size = GetFixedPropertySize(schemaProperty.type);
+			schemaProperty.offset = system.recordSize;
+			system.recordSize += schemaProperty.size;
 		}
-		else if (props.CheckType<MeshComponentData>(name))
+	}
+
+	bool objectsDiffer = false;
+	for (const PendingObject& object : currentSystem.objects)
+	{
+		objectsDiffer |= object.properties.size() != currentSystem.schema.size();
+	}
+
+	const uint32_t emptyString = InternString("");
+	const uint32_t maskWords = (system.propertyCount + 31) / 32;
+
+	SystemBlocks systemBlocks;
+	systemBlocks.records.resize(static_cast<size_t>(system.recordSize) * system.objectCount);
+	systemBlocks.stringIndices.resize(static_cast<size_t>(system.stringPropertyCount) * system.objectCount, emptyString);
+	if (objectsDiffer)
+	{
+		systemBlocks.presenceMasks.resize(static_cast<size_t>(maskWords) * system.objectCount);
+	}
+
+	for (uint32_t objectIndex = 0; objectIndex < system.objectCount; objectIndex++)
+	{
+		const PendingObject& object = currentSystem.objects[objectIndex];
+
+		if (system.kind == WorldBinarySystemKind::Component)
 		{
-			auto meshComponentData = props.GetData<MeshComponentData>(name);
-			WriteString(meshComponentData->filename);
+			systemBlocks.owners.emplace_back(object.ownerUID);
+			systemBlocks.componentNames.emplace_back(object.componentNameString);
 		}
-		else if (props.CheckType<TextureData>(name))
+
+		uint8_t* record = systemBlocks.records.data() + static_cast<size_t>(system.recordSize) * objectIndex;
+		uint32_t* objectStrings = systemBlocks.stringIndices.data() + static_cast<size_t>(system.stringPropertyCount) * objectIndex;
+
+		for (const PendingProperty& pendingProperty : object.properties)
 		{
-			auto textureData = props.GetData<TextureData>(name);
-			WriteString(textureData->filename);
+			const WorldBinaryProperty& schemaProperty = currentSystem.schema[pendingProperty.schemaIndex];
+			void* data = const_cast<void*>(pendingProperty.data);
+
+			if (IsStringPropertyType(schemaProperty.type))
+			{
+				objectStrings[schemaProperty.offset] = InternString(GetStringPropertyValue(schemaProperty.type, data));
+			}
+			else
+			{
+				memcpy(record + schemaProperty.offset, data, schemaProperty.size);
+			}
+
+			if (objectsDiffer)
+			{
+				systemBlocks.presenceMasks[static_cast<size_t>(maskWords) * objectIndex + pendingProperty.schemaIndex / 32] |=
+					1u << (pendingProperty.schemaIndex % 32);
+			}
 		}
-		else if (props.CheckType<VEnum>(name))
+	}
+
+	systems.emplace_back(system);
+	schemas.emplace_back(std::move(currentSystem.schema));
+	blocks.emplace_back(std::move(systemBlocks));
+
+	currentSystem = PendingSystem();
+}
+
+const std::vector<uint8_t>& BinarySerialiser::GetFileData()
+{
+	assert(!systemOpen);
+
+	WorldBinaryHeader header;
+	header.stringCount = static_cast<uint32_t>(strings.size());
+	header.systemCount = static_cast<uint32_t>(systems.size());
+
+	std::vector<WorldBinaryString> stringEntries(strings.size());
+	size_t stringDataSize = 0;
+	for (size_t i = 0; i < strings.size(); i++)
+	{
+		stringEntries[i].offset = static_cast<uint32_t>(stringDataSize);
+		stringEntries[i].length = static_cast<uint32_t>(strings[i].size());
+		stringDataSize += strings[i].size();
+	}
+
+	header.stringsOffset = AlignOffset(sizeof(WorldBinaryHeader));
+	header.stringDataOffset = AlignOffset(header.stringsOffset + sizeof(WorldBinaryString) * stringEntries.size());
+	header.systemsOffset = AlignOffset(header.stringDataOffset + stringDataSize);
+
+	size_t offset = header.systemsOffset + sizeof(WorldBinarySystem) * systems.size();
+	const auto placeBlock = [&offset](size_t blockSize)
+		{
+			const uint32_t blockOffset = AlignOffset(offset);
+			offset = blockOffset + blockSize;
+			return blockOffset;
+		};
+
+	for (size_t i = 0; i < systems.size(); i++)
+	{
+		WorldBinarySystem& system = systems[i];
+		const SystemBlocks& systemBlocks = blocks[i];
+
+		system.propertiesOffset = placeBlock(sizeof(WorldBinaryProperty) * schemas[i].size());
+		system.ownersOffset = placeBlock(sizeof(UID) * systemBlocks.owners.size());
+		system.componentNamesOffset = placeBlock(sizeof(uint32_t) * systemBlocks.componentNames.size());
+		system.recordsOffset = placeBlock(systemBlocks.records.size());
+		system.stringIndicesOffset = placeBlock(sizeof(uint32_t) * systemBlocks.stringIndices.size());
+		if (!systemBlocks.presenceMasks.empty())
 		{
-			auto vEnum = props.GetData<VEnum>(name);
-			WriteString(vEnum->GetValue());
+			system.presenceMasksOffset = placeBlock(sizeof(uint32_t) * systemBlocks.presenceMasks.size());
 		}
-		else
+	}
+
+	header.fileSize = AlignOffset(offset);
+
+	fileData.assign(header.fileSize, 0);
+	uint8_t* data = fileData.data();
+
+	const auto copyBlock = [data](uint32_t blockOffset, const void* source, size_t size)
+		{
+			if (size > 0)
+			{
+				memcpy(data + blockOffset, source, size);
+			}
+		};
+
+	copyBlock(0, &header, sizeof(header));
+	copyBlock(header.stringsOffset, stringEntries.data(), sizeof(WorldBinaryString) * stringEntries.size());
+	for (size_t i = 0; i < strings.size(); i++)
+	{
+		copyBlock(header.stringDataOffset + stringEntries[i].offset, strings[i].data(), strings[i].size());
+	}
+	copyBlock(header.systemsOffset, systems.data(), sizeof(WorldBinarySystem) * systems.size());
+
+	for (size_t i = 0; i < systems.size(); i++)
+	{
+		const WorldBinarySystem& system = systems[i];
+		const SystemBlocks& systemBlocks = blocks[i];
+
+		copyBlock(system.propertiesOffset, schemas[i].data(), sizeof(WorldBinaryProperty) * schemas[i].size());
+		copyBlock(system.ownersOffset, systemBlocks.owners.data(), sizeof(UID) * systemBlocks.owners.size());
+		copyBlock(system.componentNamesOffset, systemBlocks.componentNames.data(), sizeof(uint32_t) * systemBlocks.componentNames.size());
+		copyBlock(system.recordsOffset, systemBlocks.records.data(), systemBlocks.records.size());
+		copyBlock(system.stringIndicesOffset, systemBlocks.stringIndices.data(), sizeof(uint32_t) * systemBlocks.stringIndices.size());
+		if (!systemBlocks.presenceMasks.empty())
 		{
-			fwrite(prop.data, prop.size, 1, file);
+			copyBlock(system.presenceMasksOffset, systemBlocks.presenceMasks.data(), sizeof(uint32_t) * systemBlocks.presenceMasks.size());
 		}
 	}
-}
 
-void BinarySerialiser::WriteString(const std::string str)
-{
-	const size_t stringSize = str.length();
-	fwrite(&stringSize, sizeof(size_t), 1, file);
-	fwrite(str.c_str(), stringSize, 1, file);
+	return fileData;
 }
 
-void BinarySerialiser::WriteWString(const std::wstring wstr)
+bool BinarySerialiser::WriteToFile(const std::string& filepath)
 {
-	const std::string str = VString::wstos(wstr);
-	WriteString(str);
+	const std::vector<uint8_t>& data = GetFileData();
+
+	const std::string tempFilepath = filepath + ".tmp";
+
+	FILE* file = nullptr;
+	fopen_s(&file, tempFilepath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		Log("Couldn't write binary world %s.", tempFilepath.c_str());
+		return false;
+	}
+	const size_t bytesWritten = fwrite(data.data(), 1, data.size(), file);
+	fclose(file);
+	if (bytesWritten != data.size())
+	{
+		Log("Couldn't write binary world %s.", tempFilepath.c_str());
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilepath, filepath, error);
+	if (error)
+	{
+		Log("Couldn't replace %s. New world data is in %s.", filepath.c_str(), tempFilepath.c_str());
+		return false;
+	}
+
+	return true;
 }
@@ -1,33 +1,83 @@
 #pragma once
 
-#include <cstdio>
+#include <cstdint>
 #include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+#include "Core/UID.h"
+#include "Core/WorldBinaryFormat.h"
 
 struct Properties;
+struct PropertyView;
 
+//Builds a binary world file in memory (see WorldBinaryFormat.h). Systems call BeginSystem(), then Serialise()
+//or SerialiseComponent() for each object, then EndSystem(). Property data is only read in EndSystem(), so the
+//objects have to stay alive until then.
 class BinarySerialiser
 {
-private:
-	FILE* file = nullptr;
-
 public:
-	BinarySerialiser(const char* filename)
+	void BeginSystem(const std::string& systemName, WorldBinarySystemKind kind);
+	void Serialise(Properties& props);
+	void Serialise(const PropertyView& view);
+	void SerialiseComponent(UID ownerUID, const std::string& componentName, Properties& props);
+	void SerialiseComponent(UID ownerUID, const std::string& componentName, const PropertyView& view);
+	void EndSystem();
+
+	//The finished file, valid until the next call to anything else.
+	const std::vector<uint8_t>& GetFileData();
+
+	//Writes to a temp file first and renames it, so a failed save doesn't leave a partial world behind.
+	bool WriteToFile(const std::string& filepath);
+
+	static WorldBinaryPropertyType GetPropertyType(const std::type_index& type);
+
+private:
+	struct PendingProperty
 	{
-		fopen_s(&file, filename, "wb");
-	}
+		uint32_t schemaIndex = 0;
+		const void* data = nullptr;
+	};
 
-	~BinarySerialiser()
+	struct PendingObject
 	{
-		fclose(file);
-	}
+		UID ownerUID = 0;
+		uint32_t componentNameString = 0;
+		std::vector<PendingProperty> properties;
+	};
 
-	void Serialise(Properties& props);
-	void WriteString(const std::string str);
-	void WriteWString(const std::wstring wstr);
+	struct PendingSystem
+	{
+		uint32_t nameString = 0;
+		WorldBinarySystemKind kind = WorldBinarySystemKind::Actor;
+		std::vector<WorldBinaryProperty> schema;
+		std::unordered_map<std::string, uint32_t> schemaIndices;
+		std::vector<PendingObject> objects;
+	};
 
-	template <typename T>
-	void Write(T* value)
+	struct SystemBlocks
 	{
-		fwrite(value, sizeof(T), 1, file);
-	}
+		std::vector<UID> owners;
+		std::vector<uint32_t> componentNames;
+		std::vector<uint8_t> records;
+		std::vector<uint32_t> stringIndices;
+		std::vector<uint32_t> presenceMasks;
+	};
+
+	uint32_t InternString(const std::string& str);
+	void AddObject(Properties& props, PendingObject& object);
+	void AddObject(const PropertyView& view, PendingObject& object);
+	void AddProperty(const std::string& name, const std::type_index& propertyType, const void* data, PendingObject& object);
+
+	std::vector<std::string> strings;
+	std::unordered_map<std::string, uint32_t> stringIndices;
+
+	PendingSystem currentSystem;
+	bool systemOpen = false;
+
+	std::vector<WorldBinarySystem> systems;
+	std::vector<std::vector<WorldBinaryProperty>> schemas;
+	std::vector<SystemBlocks> blocks;
+
+	std::vector<uint8_t> fileData;
 };
@@ -1,6 +1,7 @@
 #include "vpch.h"
 #include "Deserialiser.h"
 #include "Core/VEnum.h"
+#include "Core/PropertyTable.h"
 #include <locale>
 #include <bit>
 #include <codecvt>
@@ -19,82 +20,82 @@ Deserialiser::Deserialiser(const std::string filename, const OpenMode mode)
 	}
 
 	//Setup read map
-	typeToReadFuncMap.emplace(typeid(float), [&](Property& prop) {
-		is >> *prop.GetData<float>();
+	typeToReadFuncMap.emplace(typeid(float), [&](void* data) {
+		is >> *static_cast<float*>(data);
 		});
 
-	typeToReadFuncMap.emplace(typeid(XMFLOAT2), [&](Property& prop) {
-		auto float2 = prop.GetData<XMFLOAT2>();
+	typeToReadFuncMap.emplace(typeid(XMFLOAT2), [&](void* data) {
+		auto float2 = static_cast<XMFLOAT2*>(data);
 		is >> float2->x;
 		is >> float2->y;
 		});
 
-	typeToReadFuncMap.emplace(typeid(XMINT2), [&](Property& prop) {
-		auto int2 = prop.GetData<XMINT2>();
+	typeToReadFuncMap.emplace(typeid(XMINT2), [&](void* data) {
+		auto int2 = static_cast<XMINT2*>(data);
 		is >> int2->x;
 		is >> int2->y;
 		});
 
-	typeToReadFuncMap.emplace(typeid(XMFLOAT3), [&](Property& prop) {
-		auto float3 = prop.GetData<XMFLOAT3>();
+	typeToReadFuncMap.emplace(typeid(XMFLOAT3), [&](void* data) {
+		auto float3 = static_cast<XMFLOAT3*>(data);
 		is >> float3->x;
 		is >> float3->y;
 		is >> float3->z;
 		});
 
-	typeToReadFuncMap.emplace(typeid(XMFLOAT4), [&](Property& prop) {
-		auto float4 = prop.GetData<XMFLOAT4>();
+	typeToReadFuncMap.emplace(typeid(XMFLOAT4), [&](void* data) {
+		auto float4 = static_cast<XMFLOAT4*>(data);
 		is >> float4->x;
 		is >> float4->y;
 		is >> float4->z;
 		is >> float4->w;
 		});
 
-	typeToReadFuncMap.emplace(typeid(bool), [&](Property& prop) {
-		is >> *prop.GetData<bool>();
+	typeToReadFuncMap.emplace(typeid(bool), [&](void* data) {
+		is >> *static_cast<bool*>(data);
 		});
 
-	typeToReadFuncMap.emplace(typeid(int), [&](Property& prop) {
-		is >> *prop.GetData<int>();
+	typeToReadFuncMap.emplace(typeid(int), [&](void* data) {
+		is >> *static_cast<int*>(data);
 		});
 
-	typeToReadFuncMap.emplace(typeid(std::string), [&](Property& prop) {
+	typeToReadFuncMap.emplace(typeid(std::string), [&](void* data) {
 		wchar_t propString[512]{};
 		is.getline(propString, 512);
-		auto str = prop.GetData<std::string>();
+		auto str = static_cast<std::string*>(data);
 		str->assign(VString::wstos(propString));
 		});
 
-	typeToReadFuncMap.emplace(typeid(std::wstring), [&](Property& prop) {
+	typeToReadFuncMap.emplace(typeid(std::wstring), [&](void* data) {
 		wchar_t propString[512]{};
 		is.getline(propString, 512);
-		auto str = prop.GetData<std::wstring>();
+		auto str = static_cast<std::wstring*>(data);
 		str->assign(propString);
 		});
 
-	typeToReadFuncMap.emplace(typeid(TextureData), [&](Property& prop) {
+	typeToReadFuncMap.emplace(typeid(TextureData), [&](void* data) {
 		wchar_t propString[512]{};
 		is.getline(propString, 512);
-		auto textureData = prop.GetData<TextureData>();
+		auto textureData = static_cast<TextureData*>(data);
 		textureData->filename.assign(VString::wstos(propString));
 		});
 
-	typeToReadFuncMap.emplace(typeid(MeshComponentData), [&](Property& prop) {
+	typeToReadFuncMap.emplace(typeid(MeshComponentData), [&](void* data) {
 		wchar_t propString[512]{};
 		is.getline(propString, 512);
-		auto meshComponentData = prop.GetData<MeshComponentData>();
+		auto meshComponentData = static_cast<MeshComponentData*>(data);
 		meshComponentData->filename.assign(VString::wstos(propString));
 		});
 
-	typeToReadFuncMap.emplace(typeid(UID), [&](Property& prop) {
-		UID* uid = prop.GetData<UID>();
+	typeToReadFuncMap.emplace(typeid(UID), [&](void* data) {
+		UID* uid = static_cast<UID*>(data);
 		is >> *uid;
 		});
 
-	typeToReadFuncMap.emplace(typeid(VEnum), [&](Property& prop) {
+	typeToReadFuncMap.emplace(typeid(VEnum), [&](void* data) {
 		wchar_t propString[512]{};
 		is.getline(propString, 512);
-		auto vEnum = prop.GetData<VEnum>();
+		auto vEnum = static_cast<VEnum*>(data);
 		vEnum->SetValue(VString::wstos(propString));
 		});
 }
@@ -135,6 +136,39 @@ void Deserialiser::Deserialise(Properties& props)
 		auto funcIt = typeToReadFuncMap.find(prop.info.value());
 		assert(funcIt != typeToReadFuncMap.end() && "Matching type_info not found");
 		auto& func = funcIt->second;
-		func(prop);
+		func(prop.data);
+	}
+}
+
+void Deserialiser::Deserialise(const PropertyView& view)
+{
+	wchar_t line[512];
+	while (!is.eof())
+	{
+		is.getline(line, 512);
+
+		const std::wstring wStrLine = line;
+
+		if (wStrLine.empty())
+		{
+			continue;
+		}
+
+		if (wStrLine.find(L"next") != wStrLine.npos) //Move to next Object
+		{
+			return;
+		}
+
+		const std::string strLine = VString::wstos(wStrLine);
+		const PropertyDescriptor* descriptor = view.table->Find(HashPropertyName(strLine));
+		if (descriptor == nullptr || descriptor->name != strLine)
+		{
+			continue;
+		}
+
+		auto funcIt = typeToReadFuncMap.find(descriptor->type);
+		assert(funcIt != typeToReadFuncMap.end() && "Matching type_info not found");
+		auto& func = funcIt->second;
+		func(view.GetData(*descriptor));
 	}
 }
@@ -5,13 +5,14 @@
 #include "Core/OpenMode.h"
 
 struct Properties;
+struct PropertyView;
 
 class Deserialiser
 {
 private:
 	//@Todo: there's a bad bug here with std::wifstream where if the textual type of of the property doesn't match
 	//(e.g. a bool value is '205') then the whole program will loop infinitely. Maybe find a way to catch this.
-	std::unordered_map<std::type_index, std::function<void(Property& prop)>> typeToReadFuncMap;
+	std::unordered_map<std::type_index, std::function<void(void* data)>> typeToReadFuncMap;
 
 public:
 	std::wifstream is;
@@ -19,6 +20,7 @@ public:
 	Deserialiser(const std::string filename, const OpenMode mode);
 	~Deserialiser();
 	void Deserialise(Properties& props);
+	void Deserialise(const PropertyView& view);
 
 	template <typename T>
 	void ReadLine(T& arg)
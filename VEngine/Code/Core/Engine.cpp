@@ -24,20 +24,16 @@
 #include "Commands/CommandSystem.h"
 #include "Audio/AudioSystem.h"
 #include "Physics/PhysicsSystem.h"
+#include "Physics/TriggerSystem.h"
+#include "Components/SkeletalMeshComponent.h"
 #include "Gameplay/WorldFunctions.h"
-
-static void ClearLog()
-{
-	std::ofstream ofs;
-	ofs.open("Log.txt", std::ofstream::out | std::ofstream::trunc);
-	ofs.close();
-}
+#include "Localisation/Localisation.h"
 
 void Engine::Init(int argc, char* argv[])
 {
 	const auto startTime = Profile::QuickStart();
 
-	ClearLog();
+	Logger::Init();
 	Input::Init();
 	PropertyTypes::SetupPropertyTypesVEnum();
 
@@ -56,6 +52,7 @@ void Engine::Init(int argc, char* argv[])
 
 	auto physicsInit = std::async(std::launch::async, []() { PhysicsSystem::Init(); });
 	auto fbxInit = std::async(std::launch::async, []() { FBXLoader::Init(); });
+	auto localisationInit = std::async(std::launch::async, []() { Localise::Init(); });
 
 	Editor::Get().Init(argc, argv);
 	auto rendererInit = std::async(std::launch::async, []() { Renderer::Init(Editor::Get().windowHwnd, Editor::Get().GetViewportWidth(), Editor::Get().GetViewportHeight()); });
@@ -69,6 +66,7 @@ void Engine::Init(int argc, char* argv[])
 	physicsInit.wait();
 	fbxInit.wait();
 	uiInit.wait();
+	localisationInit.wait();
 
 	World::Init();
 
@@ -84,6 +82,7 @@ void Engine::Init(int argc, char* argv[])
 
 void Engine::TickSystems(float deltaTime)
 {
+	Logger::Tick();
 	Editor::Get().Tick();
 	Core::Tick();
 	CommandSystem::Get().Tick();
@@ -104,9 +103,16 @@ void Engine::TickSystems(float deltaTime)
 
 	if (Core::gameplayOn && !Core::IsGameWorldPaused())
 	{
+		TriggerSystem::Tick();
 		World::TickAllActorSystems(deltaTime);
 		World::TickAllComponentSystems(deltaTime);
 	}
+
+	//After actor ticks so that animations they've just set are posed this frame.
+	SkeletalMeshComponent::AnimateAllSkeletalMeshes();
+
+	//Last so that everything read while rendering comes out of the world matrix cache.
+	SpatialComponent::UpdateWorldMatrices();
 }
 
 void Engine::ResetSystems()
@@ -165,4 +171,6 @@ void Engine::Cleanup()
 	UISystem::Cleanup();
 
 	Renderer::Cleanup();
+
+	Logger::Shutdown();
 }
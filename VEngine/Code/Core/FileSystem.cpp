@@ -1,8 +1,12 @@
 #include "vpch.h"
 #include "FileSystem.h"
 #include <filesystem>
+#include <future>
 #include "World.h"
 #include "Serialiser.h"
+#include "BinarySerialiser.h"
+#include "BinaryDeserialiser.h"
+#include "WorldTextParser.h"
 #include "Asset/AssetSystem.h"
 #include "Actors/IActorSystem.h"
 #include "Actors/ActorSystemCache.h"
@@ -25,70 +29,203 @@
 #include "UI/ScreenFadeWidget.h"
 #include <Asset/AssetBaseFolders.h>
 
+bool FileSystem::useBinaryWorlds = true;
+
 static std::string defferedWorldLoadFilename;
 static std::string previousWorldMovedFromFilename;
 static std::string entranceTriggerTag;
 
 void MovePlayerToEntranceTriggerFromPreviousWorldFilename();
 
-std::pair<UID, std::string> GetComponentOwnerUIDAndNameOnDeserialise(Deserialiser& d)
+static std::string GetBinaryWorldPath(const std::string& worldName)
 {
-	UID ownerUID = 0;
-	d.is >> ownerUID;
-
-	std::wstring componentWName;
-	d.is >> componentWName;
-	std::string componentName = VString::wstos(componentWName);
+	return AssetBaseFolders::worldMap + "Binary/" + worldName;
+}
 
-	return std::pair<UID, std::string>(ownerUID, componentName);
+//Binary worlds are a copy of the text .vmap, only trust them if they were written after it.
+static bool IsBinaryWorldUpToDate(const std::string& textPath, const std::string& binaryPath)
+{
+	std::error_code error;
+	const auto binaryWriteTime = std::filesystem::last_write_time(binaryPath, error);
+	if (error)
+	{
+		return false;
+	}
+	const auto textWriteTime = std::filesystem::last_write_time(textPath, error);
+	return !error && binaryWriteTime >= textWriteTime;
 }
 
-void FileSystem::SerialiseAllSystems()
+static bool WriteBinaryWorld(const std::string& worldName)
 {
-	const auto start = Profile::QuickStart();
+	BinarySerialiser s;
+	FileSystem::SerialiseAllSystemsToBinary(s);
 
-	auto lastOf = World::worldFilename.find_last_of("/\\");
-	std::string str = World::worldFilename.substr(lastOf + 1);
+	const std::string binaryPath = GetBinaryWorldPath(worldName);
+	std::filesystem::create_directories(std::filesystem::path(binaryPath).parent_path());
+	return s.WriteToFile(binaryPath);
+}
 
-	std::string file = "WorldMaps/" + str;
+static void DeserialiseBinaryWorld(const BinaryDeserialiser& d)
+{
+	std::vector<Actor*> loadedActors;
 
-	if (GameInstance::useGameSaves)
+	for (uint32_t systemIndex = 0; systemIndex < d.GetSystemCount(); systemIndex++)
 	{
-		const std::string previousFilePath = file;
-		file = "GameSaves/" + str;
-		if (!std::filesystem::exists(file))
+		const uint32_t numObjectsToSpawn = d.GetObjectCount(systemIndex);
+
+		if (d.GetSystemKind(systemIndex) == WorldBinarySystemKind::Actor)
 		{
-			Log("No game save file found for [%s].", file.c_str());
-			file = previousFilePath;
+			IActorSystem* actorSystem = ActorSystemCache::Get().GetSystem(d.GetSystemName(systemIndex));
+			if (actorSystem == nullptr)
+			{
+				Log("Actor system [%s] no longer exists, skipping its %u actors.",
+					d.GetSystemName(systemIndex).c_str(), numObjectsToSpawn);
+				continue;
+			}
+
+			for (uint32_t i = 0; i < numObjectsToSpawn; i++)
+			{
+				Actor* actor = actorSystem->SpawnActorForWorldLoad();
+
+				const PropertyView view = actor->GetPropertyView();
+				if (view.IsValid())
+				{
+					d.Deserialise(systemIndex, i, view);
+				}
+				else
+				{
+					auto props = actor->GetProps();
+					d.Deserialise(systemIndex, i, props);
+				}
+
+				actor->ResetOwnerUIDToComponents();
+
+				loadedActors.emplace_back(actor);
+			}
+		}
+		else
+		{
+			//Components look their owners up by UID.
+			World::AddActorsToWorld(loadedActors);
+			loadedActors.clear();
+
+			//Deserialise the existing components created in Actor constructors
+			for (uint32_t i = 0; i < numObjectsToSpawn; i++)
+			{
+				const UID ownerUID = d.GetComponentOwnerUID(systemIndex, i);
+				const std::string componentName = d.GetComponentName(systemIndex, i);
+
+				Actor* owner = World::GetActorByUIDAllowNull(ownerUID);
+				if (owner == nullptr)
+				{
+					Log("Owner %s not found in world for components. Skipping component creations.",
+						componentName.c_str());
+					continue;
+				}
+
+				Component* foundComponent = owner->FindComponentAllowNull(componentName);
+				if (foundComponent)
+				{
+					const PropertyView view = foundComponent->GetPropertyView();
+					if (view.IsValid())
+					{
+						d.Deserialise(systemIndex, i, view);
+					}
+					else
+					{
+						auto props = foundComponent->GetProps();
+						d.Deserialise(systemIndex, i, props);
+					}
+				}
+			}
 		}
 	}
 
-	Serialiser s(file, OpenMode::Out);
+	World::AddActorsToWorld(loadedActors);
+}
 
-	for (IActorSystem* actorSystem : World::activeActorSystems)
+static WorldTextParser::BlockType GetWorldBlockType(const std::string& systemName)
+{
+	if (ActorSystemCache::Get().GetSystem(systemName))
 	{
-		if (actorSystem->GetNumActors() > 0)
-		{
-			actorSystem->Serialise(s);
-		}
+		return WorldTextParser::BlockType::Actor;
+	}
+	if (ComponentSystemCache::Get().GetSystem(systemName))
+	{
+		return WorldTextParser::BlockType::Component;
 	}
+	return WorldTextParser::BlockType::Unknown;
+}
+
+//Last stage of a text load, on the main thread. Properties were already parsed on the loading threads.
+static void ApplyParsedWorld(const WorldTextParser::ParsedWorld& parsedWorld)
+{
+	std::vector<Actor*> loadedActors;
 
-	for (IComponentSystem* componentSystem : World::activeComponentSystems)
+	for (const WorldTextParser::ParsedSystem& system : parsedWorld.systems)
 	{
-		if (componentSystem->GetNumComponents() > 0)
+		if (system.type == WorldTextParser::BlockType::Actor)
 		{
-			componentSystem->Serialise(s);
+			IActorSystem* actorSystem = ActorSystemCache::Get().GetSystem(system.name);
+
+			for (const WorldTextParser::ParsedObject& object : system.objects)
+			{
+				Actor* actor = actorSystem->SpawnActorForWorldLoad();
+
+				const PropertyView view = actor->GetPropertyView();
+				if (view.IsValid())
+				{
+					WorldTextParser::Apply(parsedWorld, object, view);
+				}
+				else
+				{
+					auto props = actor->GetProps();
+					WorldTextParser::Apply(parsedWorld, object, props);
+				}
+
+				actor->ResetOwnerUIDToComponents();
+
+				loadedActors.emplace_back(actor);
+			}
 		}
-	}
+		else if (system.type == WorldTextParser::BlockType::Component)
+		{
+			//Components look their owners up by UID.
+			World::AddActorsToWorld(loadedActors);
+			loadedActors.clear();
 
-	s.WriteLine(L"end");
+			//Deserialise the existing components created in Actor constructors
+			for (const WorldTextParser::ParsedObject& object : system.objects)
+			{
+				const std::string componentName(object.componentName);
 
-	//AssetSystem::WriteOutAllVertexColourData();
+				Actor* owner = World::GetActorByUIDAllowNull(object.ownerUID);
+				if (owner == nullptr)
+				{
+					Log("Owner %s not found in world for components. Skipping component creations.",
+						componentName.c_str());
+					continue;
+				}
 
-	debugMenu.AddNotification(VString::wformat(L"%S world saved", World::worldFilename.c_str()));
+				Component* foundComponent = owner->FindComponentAllowNull(componentName);
+				if (foundComponent)
+				{
+					const PropertyView view = foundComponent->GetPropertyView();
+					if (view.IsValid())
+					{
+						WorldTextParser::Apply(parsedWorld, object, view);
+					}
+					else
+					{
+						auto props = foundComponent->GetProps();
+						WorldTextParser::Apply(parsedWorld, object, props);
+					}
+				}
+			}
+		}
+	}
 
-	const auto end = Profile::QuickEnd(start);
-	Log("Text save for [%s] took [%f].", str.c_str(), end);
+	World::AddActorsToWorld(loadedActors);
 }
 
 void FileSystem::WriteAllSystemsToBinary()
@@ -98,24 +235,9 @@ void FileSystem::WriteAllSystemsToBinary()
 	auto lastOf = World::worldFilename.find_last_of("/\\");
 	std::string str = World::worldFilename.substr(lastOf + 1);
 
-	std::string file = "WorldMaps/Binary/" + str;
-
-	BinarySerialiser s(file.c_str());
-
-	for (IActorSystem* actorSystem : World::activeActorSystems)
-	{
-		if (actorSystem->GetNumActors() > 0)
-		{
-			actorSystem->SerialiseBinary(s);
-		}
-	}
-
-	for (IComponentSystem* componentSystem : World::activeComponentSystems)
+	if (!WriteBinaryWorld(str))
 	{
-		if (componentSystem->GetNumComponents() > 0)
-		{
-			componentSystem->SerialiseBinary(s);
-		}
+		return;
 	}
 
 	debugMenu.AddNotification(VString::wformat(L"%S world saved to binary", World::worldFilename.c_str()));
@@ -130,65 +252,15 @@ void FileSystem::ReadAllSystemsFromBinary()
 
 	std::string worldName = World::worldFilename;
 
-	std::string path = "WorldMaps/Binary/" + worldName;
-
-	assert(std::filesystem::exists(path) && "Map file doesn't exist");
-
-	World::Cleanup();
-
-	BinaryDeserialiser d(path);
-
-	while (!feof(d.file))
+	BinaryDeserialiser d;
+	if (!d.Open(GetBinaryWorldPath(worldName)))
 	{
-		std::string systemName;
-		d.ReadString(&systemName);
-
-		size_t numObjectsToSpawn = 0;
-		d.Read(&numObjectsToSpawn);
-
-		if (numObjectsToSpawn == 0)
-		{
-			continue;
-		}
-
-		auto actorSystem = ActorSystemCache::Get().GetSystem(systemName);
-		auto componentSystem = ComponentSystemCache::Get().GetSystem(systemName);
-
-		if (actorSystem != nullptr)
-		{
-			for (int i = 0; i < numObjectsToSpawn; i++)
-			{
-				Actor* actor = actorSystem->SpawnActor(Transform());
-				World::RemoveActorFromWorld(actor);
-
-				auto props = actor->GetProps();
-				d.Deserialise(props);
-
-				actor->ResetOwnerUIDToComponents();
-
-				World::AddActorToWorld(actor);
-			}
-		}
-		else if (componentSystem != nullptr)
-		{
-			for (int i = 0; i < numObjectsToSpawn; i++)
-			{
-				UID ownerUID = 0;
-				d.Read(&ownerUID);
+		return;
+	}
 
-				std::string componentName;
-				d.ReadString(&componentName);
+	World::Cleanup();
 
-				Actor* owner = World::GetActorByUID(ownerUID);
-				Component* foundComponent = owner->FindComponentAllowNull(componentName);
-				if (foundComponent)
-				{
-					auto props = foundComponent->GetProps();
-					d.Deserialise(props);
-				}
-			}
-		}
-	}
+	DeserialiseBinaryWorld(d);
 
 	ResetWorldState();
 
@@ -217,114 +289,31 @@ void FileSystem::LoadWorld(std::string worldName)
 
 	assert(std::filesystem::exists(path));
 
-	GameUtils::SaveGameInstanceData();
-
-	World::Cleanup();
-
-	Deserialiser d(path, OpenMode::In);
-
-	std::wstring systemName;
+	//Game saves are only written as text.
+	BinaryDeserialiser binaryWorld;
+	const std::string binaryPath = GetBinaryWorldPath(worldName);
+	const bool loadFromBinary = useBinaryWorlds && !GameInstance::useGameSaves &&
+		IsBinaryWorldUpToDate(path, binaryPath) && binaryWorld.Open(binaryPath);
 
-	while (d.is >> systemName)
+	//Text is read and parsed while the previous world is cleaned up, neither stage touches the world.
+	WorldTextParser::ParsedWorld parsedWorld;
+	std::future<bool> parseJob;
+	if (!loadFromBinary)
 	{
-		if (systemName == L"end")
-		{
-			break;
-		}
-
-		size_t numObjectsToSpawn = 0;
-		d.is >> numObjectsToSpawn;
-		assert(numObjectsToSpawn != 0);
-
-		const std::string stdSystemName = VString::wstos(systemName);
-
-		auto actorSystem = ActorSystemCache::Get().GetSystem(stdSystemName);
-		auto componentSystem = ComponentSystemCache::Get().GetSystem(stdSystemName);
-
-		assert(actorSystem != nullptr || componentSystem != nullptr);
-
-		if (actorSystem)
-		{
-			for (int i = 0; i < numObjectsToSpawn; i++)
-			{
-				Actor* actor = actorSystem->SpawnActor(Transform());
-
-				//ActorSystem will add in actor. Remove it here before getting correct UID and name on serialise.
-				World::RemoveActorFromWorld(actor);
-
-				auto props = actor->GetProps();
-				d.Deserialise(props);
-
-				actor->ResetOwnerUIDToComponents();
-
-				World::AddActorToWorld(actor);
-			}
-		}
-		else if (componentSystem)
-		{
-			//Deserialise the existing components created in Actor constructors
-			for (int i = 0; i < numObjectsToSpawn; i++)
-			{
-				auto ownerUIDAndName = GetComponentOwnerUIDAndNameOnDeserialise(d);
-
-				Actor* owner = World::GetActorByUIDAllowNull(ownerUIDAndName.first);
-				if (owner == nullptr)
-				{
-					Log("Owner %s not found in world for components. Skipping component creations.",
-						ownerUIDAndName.second.c_str());
-
-					std::wstring nextToken;
-					while (nextToken != L"next" && nextToken != L"end")
-					{
-						d.is >> nextToken;
-					}
-				}
-				else
-				{
-					Component* foundComponent = owner->FindComponentAllowNull(ownerUIDAndName.second);
-					if (foundComponent)
-					{
-						auto props = foundComponent->GetProps();
-						d.Deserialise(props);
-					}
-					else //Component doesn't exist on any actor, skip its props
-					{
-						std::wstring nextToken;
-						while (nextToken != L"next" && nextToken != L"end")
-						{
-							d.is >> nextToken;
-						}
-					}
-				}
-			}
-		}
-		else
-		{
-			//This will loop over the missing component from an actor.
-			//It won't remove the component from the .vmap file though, subsequent 
-			//saves will overwrite that missing component instead.
-
-			//Get the previous post so subsequent system name reads work
-			std::streampos lastPos = d.is.tellg();
-
-			std::wstring missingProp;
-
-			while (ComponentSystemCache::Get().GetSystem(VString::wstos(missingProp)) ||
-				ActorSystemCache::Get().GetSystem(VString::wstos(missingProp)) == nullptr)
-			{
-				if (missingProp == L"end")
-				{
-					break;
-				}
+		parseJob = std::async(std::launch::async, [&]() { return WorldTextParser::Parse(path, GetWorldBlockType, parsedWorld); });
+	}
 
-				lastPos = d.is.tellg();
-				d.is >> missingProp;
-			}
+	GameUtils::SaveGameInstanceData();
 
-			d.is.seekg(lastPos);
-		}
+	World::Cleanup();
 
-		systemName.clear();
+	if (loadFromBinary)
+	{
+		DeserialiseBinaryWorld(binaryWorld);
+	}
+	else if (parseJob.get())
+	{
+		ApplyParsedWorld(parsedWorld);
 	}
 
 	ResetWorldState();
@@ -337,7 +326,7 @@ void FileSystem::LoadWorld(std::string worldName)
 	debugMenu.AddNotification(VString::wformat(L"%S world loaded", World::worldFilename.c_str()));
 
 	double endTime = Profile::QuickEnd(startTime);
-	Log("World load took %f sec.", endTime);
+	Log("World load took %f sec%s.", endTime, loadFromBinary ? " (binary)" : "");
 }
 
 void FileSystem::ReloadCurrentWorld()
@@ -2,10 +2,19 @@
 
 #include <string>
 
+class BinarySerialiser;
+
 namespace FileSystem
 {
+	//LoadWorld() reads the binary copy of a world (WorldMaps/Binary/) when it's newer than the .vmap.
+	extern bool useBinaryWorlds;
+
+	//Writes the text .vmap, and the binary copy when saving to WorldMaps/.
 	void SerialiseAllSystems();
 
+	//Feeds every active system to s, to write out or to compare worlds in memory.
+	void SerialiseAllSystemsToBinary(BinarySerialiser& s);
+
 	void WriteAllSystemsToBinary();
 	void ReadAllSystemsFromBinary();
 
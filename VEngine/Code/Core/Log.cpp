@@ -1,39 +1,376 @@
 #include "vpch.h"
 #include "Log.h"
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vadefs.h>
 #include "Editor/Editor.h"
 
-void Log(std::string logMessage, ...)
+//Power of two so that positions wrap with a mask.
+static constexpr uint64_t slotCount = 2048;
+static constexpr size_t maxMessageLength = 1024;
+
+//How long the writer thread sleeps when there's nothing queued.
+static constexpr auto writerSleepTime = std::chrono::milliseconds(10);
+
+//Bounded MPMC queue (Dmitry Vyukov's), used with many producers and one consumer at a time.
+//A slot's sequence says whose turn it is: position when it's free for the producer claiming that position,
+//position + 1 once the message is in and it's the consumer's.
+struct LogSlot
 {
-	va_list args;
-	va_start(args, logMessage.c_str());
+	std::atomic<uint64_t> sequence;
+	std::chrono::system_clock::time_point time;
+	LogLevel level = LogLevel::Info;
+	char message[maxMessageLength];
+};
 
-	char msg[1024];
-	_vsnprintf_s(msg, 1024, logMessage.c_str(), args);
-	va_end(args);
+struct LogQueue
+{
+	LogSlot slots[slotCount];
+	alignas(64) std::atomic<uint64_t> enqueuePosition = 0;
+	alignas(64) uint64_t dequeuePosition = 0;
 
-	Editor::Get().Log(msg);
+	std::atomic<uint64_t> droppedMessages = 0;
 
-	std::ofstream os;
-	os.open("Log.txt", std::ios_base::app);
-	os << std::chrono::system_clock::now() << " | " << msg << std::endl;
+	//Only taken by the consumer side (writer thread, Flush() and the crash handler), producers never lock.
+	std::mutex consumerMutex;
+	std::ofstream logFile;
 
-	OutputDebugString(logMessage.c_str());
+	std::mutex editorMessagesMutex;
+	std::vector<std::string> editorMessages;
+
+	std::thread writerThread;
+	std::atomic<bool> writerRunning = false;
+	std::mutex writerWakeMutex;
+	std::condition_variable writerWake;
+
+	LPTOP_LEVEL_EXCEPTION_FILTER previousExceptionFilter = nullptr;
+
+	LogQueue()
+	{
+		for (uint64_t i = 0; i < slotCount; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+};
+
+//Function static so that logging from other statics' constructors is safe, and never destroyed so that
+//logging from other statics' destructors is too.
+static LogQueue& GetLogQueue()
+{
+	static LogQueue* queue = new LogQueue();
+	return *queue;
 }
 
-void Log(std::wstring logMessage, ...)
+//Writes out whatever is still queued if the process exits without calling Logger::Shutdown().
+static struct LogShutdownOnExit
+{
+	~LogShutdownOnExit() { Logger::Shutdown(); }
+} logShutdownOnExit;
+
+//Returns null if the queue is full, otherwise a slot that's the caller's until PublishSlot().
+static LogSlot* ClaimSlot(LogQueue& queue, uint64_t& outPosition)
+{
+	uint64_t position = queue.enqueuePosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		LogSlot& slot = queue.slots[position & (slotCount - 1)];
+		const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+		const int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+		if (difference == 0)
+		{
+			if (queue.enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				outPosition = position;
+				return &slot;
+			}
+		}
+		else if (difference < 0)
+		{
+			return nullptr;
+		}
+		else
+		{
+			position = queue.enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+static LogSlot* ClaimSlotOrWait(LogQueue& queue, uint64_t& outPosition)
+{
+	for (;;)
+	{
+		LogSlot* slot = ClaimSlot(queue, outPosition);
+		if (slot)
+		{
+			return slot;
+		}
+
+		//Only blocks when the writer is a whole ring behind. Without a writer there's nobody to wait for.
+		if (!queue.writerRunning.load(std::memory_order_acquire))
+		{
+			queue.droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		queue.writerWake.notify_one();
+		std::this_thread::yield();
+	}
+}
+
+static void PublishSlot(LogSlot& slot, uint64_t position)
+{
+	slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+static void EnqueueMessage(LogLevel level, const char* format, va_list args)
+{
+	LogQueue& queue = GetLogQueue();
+
+	uint64_t position = 0;
+	LogSlot* slot = ClaimSlotOrWait(queue, position);
+	if (slot == nullptr)
+	{
+		return;
+	}
+
+	slot->time = std::chrono::system_clock::now();
+	slot->level = level;
+	_vsnprintf_s(slot->message, maxMessageLength, _TRUNCATE, format, args);
+
+	PublishSlot(*slot, position);
+}
+
+static void EnqueueWideMessage(LogLevel level, const wchar_t* format, va_list args)
+{
+	LogQueue& queue = GetLogQueue();
+
+	wchar_t wideMessage[maxMessageLength];
+	_vsnwprintf_s(wideMessage, maxMessageLength, _TRUNCATE, format, args);
+
+	uint64_t position = 0;
+	LogSlot* slot = ClaimSlotOrWait(queue, position);
+	if (slot == nullptr)
+	{
+		return;
+	}
+
+	slot->time = std::chrono::system_clock::now();
+	slot->level = level;
+
+	//Stored as UTF-8 so that narrow and wide messages share the ring buffer.
+	const int length = WideCharToMultiByte(CP_UTF8, 0, wideMessage, -1,
+		slot->message, static_cast<int>(maxMessageLength), nullptr, nullptr);
+	if (length == 0)
+	{
+		slot->message[0] = '\0';
+	}
+
+	PublishSlot(*slot, position);
+}
+
+static const char* GetLevelPrefix(LogLevel level)
+{
+	switch (level)
+	{
+	case LogLevel::Verbose: return "[Verbose] ";
+	case LogLevel::Warning: return "[Warning] ";
+	case LogLevel::Error: return "[Error] ";
+	default: return "";
+	}
+}
+
+//Caller holds consumerMutex. Stops at the first slot that hasn't been published yet.
+static void DrainQueue(LogQueue& queue, bool passToEditor)
+{
+	std::vector<std::string> drainedMessages;
+	size_t drainedCount = 0;
+
+	for (;;)
+	{
+		LogSlot& slot = queue.slots[queue.dequeuePosition & (slotCount - 1)];
+		if (slot.sequence.load(std::memory_order_acquire) != queue.dequeuePosition + 1)
+		{
+			break;
+		}
+
+		const char* levelPrefix = GetLevelPrefix(slot.level);
+		if (queue.logFile.is_open())
+		{
+			queue.logFile << slot.time << " | " << levelPrefix << slot.message << '\n';
+		}
+
+		//Visual Studio's output window, done here so producers never pay for the debugger round trip.
+		std::string message = std::string(levelPrefix) + slot.message;
+		OutputDebugStringA((message + '\n').c_str());
+
+		if (passToEditor)
+		{
+			drainedMessages.emplace_back(std::move(message));
+		}
+
+		slot.sequence.store(queue.dequeuePosition + slotCount, std::memory_order_release);
+		queue.dequeuePosition++;
+		drainedCount++;
+	}
+
+	if (drainedCount == 0)
+	{
+		return;
+	}
+
+	queue.logFile.flush();
+
+	std::lock_guard lock(queue.editorMessagesMutex);
+	for (auto& message : drainedMessages)
+	{
+		queue.editorMessages.emplace_back(std::move(message));
+	}
+}
+
+static void WriterThreadMain()
+{
+	LogQueue& queue = GetLogQueue();
+
+	while (queue.writerRunning.load(std::memory_order_acquire))
+	{
+		{
+			std::lock_guard lock(queue.consumerMutex);
+			DrainQueue(queue, true);
+		}
+
+		std::unique_lock wakeLock(queue.writerWakeMutex);
+		queue.writerWake.wait_for(wakeLock, writerSleepTime);
+	}
+}
+
+static LONG WINAPI FlushLogOnCrash(EXCEPTION_POINTERS* exceptionInfo)
+{
+	LogQueue& queue = GetLogQueue();
+
+	//The writer only holds the lock for a drain. If it doesn't let go, it's the thread that crashed.
+	for (int attempt = 0; attempt < 100; attempt++)
+	{
+		if (queue.consumerMutex.try_lock())
+		{
+			DrainQueue(queue, false);
+			queue.logFile.flush();
+			queue.consumerMutex.unlock();
+			break;
+		}
+		Sleep(1);
+	}
+
+	if (queue.previousExceptionFilter)
+	{
+		return queue.previousExceptionFilter(exceptionInfo);
+	}
+	return EXCEPTION_CONTINUE_SEARCH;
+}
+
+void Logger::Init()
+{
+	LogQueue& queue = GetLogQueue();
+	if (queue.writerRunning)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock(queue.consumerMutex);
+		queue.logFile.open("Log.txt", std::ofstream::out | std::ofstream::trunc);
+	}
+
+	queue.previousExceptionFilter = SetUnhandledExceptionFilter(FlushLogOnCrash);
+
+	queue.writerRunning = true;
+	queue.writerThread = std::thread(WriterThreadMain);
+}
+
+void Logger::Shutdown()
+{
+	LogQueue& queue = GetLogQueue();
+
+	if (queue.writerThread.joinable())
+	{
+		queue.writerRunning = false;
+		queue.writerWake.notify_one();
+		queue.writerThread.join();
+	}
+
+	std::lock_guard lock(queue.consumerMutex);
+	DrainQueue(queue, false);
+	queue.logFile.close();
+}
+
+void Logger::Flush()
+{
+	LogQueue& queue = GetLogQueue();
+	std::lock_guard lock(queue.consumerMutex);
+	DrainQueue(queue, true);
+}
+
+void Logger::Tick()
+{
+	LogQueue& queue = GetLogQueue();
+
+	std::vector<std::string> messages;
+	{
+		std::lock_guard lock(queue.editorMessagesMutex);
+		messages.swap(queue.editorMessages);
+	}
+
+	for (const auto& message : messages)
+	{
+		Editor::Get().Log(message);
+	}
+}
+
+uint64_t Logger::GetDroppedMessageCount()
+{
+	return GetLogQueue().droppedMessages.load(std::memory_order_relaxed);
+}
+
+void Log(const char* format, ...)
 {
 	va_list args;
-	va_start(args, logMessage.c_str());
+	va_start(args, format);
+	EnqueueMessage(LogLevel::Info, format, args);
+	va_end(args);
+}
 
-	wchar_t msg[1024];
-	_vsnwprintf_s(msg, 1024, logMessage.c_str(), args);
+void Log(const wchar_t* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	EnqueueWideMessage(LogLevel::Info, format, args);
 	va_end(args);
+}
 
-	Editor::Get().Log(msg);
+void Log(std::string logMessage, ...)
+{
+	va_list args;
+	va_start(args, logMessage.c_str());
+	EnqueueMessage(LogLevel::Info, logMessage.c_str(), args);
+	va_end(args);
+}
 
-	std::wofstream os;
-	os.open("Log.txt", std::ios_base::app);
-	os << std::chrono::system_clock::now() << " | " << msg << std::endl;
+void Log(std::wstring logMessage, ...)
+{
+	va_list args;
+	va_start(args, logMessage.c_str());
+	EnqueueWideMessage(LogLevel::Info, logMessage.c_str(), args);
+	va_end(args);
+}
+
+void LogMessage(LogLevel level, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	EnqueueMessage(level, format, args);
+	va_end(args);
 }
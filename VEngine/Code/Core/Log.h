@@ -1,6 +1,81 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+enum class LogLevel : uint8_t
+{
+	Verbose,
+	Info,
+	Warning,
+	Error,
+};
+
+//LogVerbose(), LogWarning() and LogError() calls below this level compile to nothing. Defaults to keeping
+//everything in debug builds and dropping verbose messages otherwise, define LOG_MIN_LEVEL to override.
+#ifndef LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define LOG_MIN_LEVEL 0
+#else
+#define LOG_MIN_LEVEL 1
+#endif
+#endif
+
+constexpr LogLevel minLogLevel = static_cast<LogLevel>(LOG_MIN_LEVEL);
+
+//printf style, logged at LogLevel::Info.
+//The message is formatted on the calling thread straight into a slot of a lock-free ring buffer and that's
+//all the caller pays for. Logger's writer thread timestamps it into Log.txt and Logger::Tick() hands it to
+//the editor's log on the main thread.
+void Log(const char* format, ...);
+void Log(const wchar_t* format, ...);
 void Log(std::string msg, ...);
 void Log(std::wstring msg, ...);
+
+void LogMessage(LogLevel level, const char* format, ...);
+
+template <typename... Args>
+void LogVerbose(const char* format, Args... args)
+{
+	if constexpr (LogLevel::Verbose >= minLogLevel)
+	{
+		LogMessage(LogLevel::Verbose, format, args...);
+	}
+}
+
+template <typename... Args>
+void LogWarning(const char* format, Args... args)
+{
+	if constexpr (LogLevel::Warning >= minLogLevel)
+	{
+		LogMessage(LogLevel::Warning, format, args...);
+	}
+}
+
+template <typename... Args>
+void LogError(const char* format, Args... args)
+{
+	if constexpr (LogLevel::Error >= minLogLevel)
+	{
+		LogMessage(LogLevel::Error, format, args...);
+	}
+}
+
+namespace Logger
+{
+	//Truncates Log.txt, starts the writer thread and flushes what's queued if the process crashes.
+	//Messages logged before this are kept in the ring buffer and written once it's called.
+	void Init();
+
+	//Joins the writer thread after writing out everything queued.
+	void Shutdown();
+
+	//Writes out everything queued so far from the calling thread.
+	void Flush();
+
+	//Passes messages written since the last call to the editor's log. Main thread only.
+	void Tick();
+
+	//Messages lost because the ring buffer was full with no writer thread running to empty it.
+	uint64_t GetDroppedMessageCount();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+//Read-only memory mapping of a whole file. Data stays valid until Close() or destruction.
+//While mapped the file can't be overwritten in place.
+class MappedFile
+{
+public:
+	MappedFile() {}
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& filepath);
+	void Close();
+
+	bool IsOpen() const { return data != nullptr; }
+	const uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+};
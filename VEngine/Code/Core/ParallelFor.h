@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+//Splits [0, count) into contiguous ranges and calls func(begin, end) for each range on std::async workers.
+//The calling thread takes the first range itself and returns once every range is done.
+//Runs everything inline when there aren't at least two jobs' worth of minPerJob items.
+template <typename Func>
+void ParallelFor(size_t count, size_t minPerJob, Func func)
+{
+	const size_t maxJobCount = std::max(1u, std::thread::hardware_concurrency());
+	const size_t jobCount = std::min(maxJobCount, count / std::max<size_t>(minPerJob, 1));
+	if (jobCount <= 1)
+	{
+		func((size_t)0, count);
+		return;
+	}
+
+	const size_t countPerJob = (count + jobCount - 1) / jobCount;
+
+	std::vector<std::future<void>> jobs;
+	for (size_t job = 1; job < jobCount; job++)
+	{
+		const size_t begin = job * countPerJob;
+		const size_t end = std::min(count, begin + countPerJob);
+		if (begin >= end)
+		{
+			break;
+		}
+		jobs.emplace_back(std::async(std::launch::async, [&func, begin, end]() { func(begin, end); }));
+	}
+
+	func((size_t)0, std::min(count, countPerJob));
+
+	for (auto& job : jobs)
+	{
+		job.get();
+	}
+}
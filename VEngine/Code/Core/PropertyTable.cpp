@@ -0,0 +1,103 @@
+#include "vpch.h"
+#include "PropertyTable.h"
+#include <algorithm>
+#include "Core/Properties.h"
+#include "Core/Transform.h"
+#include "Core/Log.h"
+
+//FNV-1a
+uint64_t HashPropertyName(std::string_view name)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c : name)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static bool IsInside(const void* data, const void* base, size_t size)
+{
+	const auto address = reinterpret_cast<uintptr_t>(data);
+	const auto start = reinterpret_cast<uintptr_t>(base);
+	return base != nullptr && address >= start && address < start + size;
+}
+
+void PropertyTable::Build(Properties& props, const void* object, size_t objectSize, const Transform* rootTransform)
+{
+	assert(!built);
+	built = true;
+	complete = true;
+
+	title = props.title;
+	descriptors.reserve(props.propMap.size());
+
+	for (auto& [name, prop] : props.propMap)
+	{
+		PropertyDescriptor& descriptor = descriptors.emplace_back();
+		descriptor.nameHash = HashPropertyName(name);
+		descriptor.name = name;
+		descriptor.autoCompletePath = prop.autoCompletePath;
+		descriptor.type = prop.info.value();
+		descriptor.size = prop.size;
+
+		if (IsInside(prop.data, object, objectSize))
+		{
+			descriptor.base = PropertyBase::Object;
+			descriptor.offset = static_cast<uint32_t>(static_cast<uint8_t*>(prop.data) - static_cast<const uint8_t*>(object));
+		}
+		else if (IsInside(prop.data, rootTransform, sizeof(Transform)))
+		{
+			descriptor.base = PropertyBase::RootTransform;
+			descriptor.offset = static_cast<uint32_t>(static_cast<uint8_t*>(prop.data) - reinterpret_cast<const uint8_t*>(rootTransform));
+		}
+		else
+		{
+			complete = false;
+		}
+
+		if (prop.readOnly) descriptor.flags |= PropertyFlags::ReadOnly;
+		if (prop.hide) descriptor.flags |= PropertyFlags::Hide;
+		if (prop.useActorsAutoComplete) descriptor.flags |= PropertyFlags::ActorsAutoComplete;
+		if (prop.change) descriptor.flags |= PropertyFlags::HasChange;
+	}
+
+	hashOrder.resize(descriptors.size());
+	for (uint32_t i = 0; i < hashOrder.size(); i++)
+	{
+		hashOrder[i] = i;
+	}
+	std::sort(hashOrder.begin(), hashOrder.end(), [this](uint32_t a, uint32_t b) {
+		return descriptors[a].nameHash < descriptors[b].nameHash;
+		});
+
+	for (size_t i = 1; i < hashOrder.size(); i++)
+	{
+		if (descriptors[hashOrder[i]].nameHash == descriptors[hashOrder[i - 1]].nameHash)
+		{
+			Log("Properties [%s] and [%s] on [%s] have the same name hash, falling back to GetProps().",
+				descriptors[hashOrder[i]].name.c_str(), descriptors[hashOrder[i - 1]].name.c_str(), title.c_str());
+			complete = false;
+		}
+	}
+}
+
+const PropertyDescriptor* PropertyTable::Find(uint64_t nameHash) const
+{
+	auto it = std::lower_bound(hashOrder.begin(), hashOrder.end(), nameHash, [this](uint32_t index, uint64_t hash) {
+		return descriptors[index].nameHash < hash;
+		});
+	if (it == hashOrder.end() || descriptors[*it].nameHash != nameHash)
+	{
+		return nullptr;
+	}
+	return &descriptors[*it];
+}
+
+void* PropertyView::GetData(const PropertyDescriptor& descriptor) const
+{
+	uint8_t* base = descriptor.base == PropertyBase::RootTransform ?
+		reinterpret_cast<uint8_t*>(rootTransform) : static_cast<uint8_t*>(object);
+	return base + descriptor.offset;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <typeindex>
+#include <vector>
+#include "Core/UID.h"
+
+struct Properties;
+struct Transform;
+
+uint64_t HashPropertyName(std::string_view name);
+
+//Where a descriptor's offset is measured from.
+enum class PropertyBase : uint8_t
+{
+	Object,
+	RootTransform //Actor transform props live in the root component, not the actor.
+};
+
+namespace PropertyFlags
+{
+	constexpr uint8_t ReadOnly = 1 << 0;
+	constexpr uint8_t Hide = 1 << 1;
+	constexpr uint8_t ActorsAutoComplete = 1 << 2;
+	constexpr uint8_t HasChange = 1 << 3;
+}
+
+struct PropertyDescriptor
+{
+	uint64_t nameHash = 0;
+	std::string name;
+	std::string autoCompletePath;
+	std::type_index type = typeid(void);
+	uint64_t size = 0; //Only meaningful for fixed size types, strings were their length on the first instance.
+	uint32_t offset = 0;
+	PropertyBase base = PropertyBase::Object;
+	uint8_t flags = 0;
+};
+
+//Name, type and offset of every property of one actor or component type, so serialisation and undo can walk
+//an object's properties without building a Properties map for it.
+//Built from the first instance's GetProps(), since that's still where types declare their properties. Props
+//that don't point into the object (e.g. Material props merged into MeshComponent) can't be stored as an
+//offset, those types are left incomplete and callers go back to GetProps().
+class PropertyTable
+{
+public:
+	void Build(Properties& props, const void* object, size_t objectSize, const Transform* rootTransform);
+
+	bool IsBuilt() const { return built; }
+	bool IsComplete() const { return complete; }
+
+	const std::vector<PropertyDescriptor>& GetDescriptors() const { return descriptors; }
+	const PropertyDescriptor* Find(uint64_t nameHash) const;
+
+	std::string title;
+
+private:
+	//Same order as the Properties map the table was built from, so text files come out the same.
+	std::vector<PropertyDescriptor> descriptors;
+
+	//Descriptor indices sorted by name hash for Find().
+	std::vector<uint32_t> hashOrder;
+
+	bool built = false;
+	bool complete = false;
+};
+
+//A PropertyTable bound to one instance. Nothing is allocated to make one.
+struct PropertyView
+{
+	const PropertyTable* table = nullptr;
+	void* object = nullptr;
+	Transform* rootTransform = nullptr;
+	UID ownerUID = 0;
+
+	bool IsValid() const { return table && table->IsComplete(); }
+
+	void* GetData(const PropertyDescriptor& descriptor) const;
+
+	template <typename T>
+	T* GetDataAllowNull(std::string_view name) const
+	{
+		const PropertyDescriptor* descriptor = table->Find(HashPropertyName(name));
+		if (descriptor && descriptor->type == typeid(T) && descriptor->name == name)
+		{
+			return static_cast<T*>(GetData(*descriptor));
+		}
+		return nullptr;
+	}
+};
@@ -1,6 +1,7 @@
 #include "vpch.h"
 #include "Serialiser.h"
 #include "Properties.h"
+#include "PropertyTable.h"
 #include "Render/RenderPropertyStructs.h"
 #include "VString.h"
 #include "VEnum.h"
@@ -16,66 +17,66 @@ Serialiser::Serialiser(const std::string filename_, const OpenMode mode_) :
 	std::locale loc(std::locale::classic(), new std::codecvt_utf8<wchar_t, 0x10ffff, std::little_endian>);
 	ofs.imbue(loc);
 
-	typeToWriteFuncMap.emplace(typeid(bool), [&](Property& prop, std::wstring& name) {
-		ss << name << "\n" << *prop.GetData<bool>() << "\n";
+	typeToWriteFuncMap.emplace(typeid(bool), [&](void* data, std::wstring& name) {
+		ss << name << "\n" << *static_cast<bool*>(data) << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(float), [&](Property& prop, std::wstring& name) {
-		ss << name << "\n" << *prop.GetData<float>() << "\n";
+	typeToWriteFuncMap.emplace(typeid(float), [&](void* data, std::wstring& name) {
+		ss << name << "\n" << *static_cast<float*>(data) << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(XMFLOAT2), [&](Property& prop, std::wstring& name) {
-		auto value = prop.GetData<XMFLOAT2>();
+	typeToWriteFuncMap.emplace(typeid(XMFLOAT2), [&](void* data, std::wstring& name) {
+		auto value = static_cast<XMFLOAT2*>(data);
 		ss << name << "\n" << value->x << " " << value->y << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(XMINT2), [&](Property& prop, std::wstring& name) {
-		auto value = prop.GetData<XMINT2>();
+	typeToWriteFuncMap.emplace(typeid(XMINT2), [&](void* data, std::wstring& name) {
+		auto value = static_cast<XMINT2*>(data);
 		ss << name << "\n" << value->x << " " << value->y << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(XMFLOAT3), [&](Property& prop, std::wstring& name) {
-		auto value = prop.GetData<XMFLOAT3>();
+	typeToWriteFuncMap.emplace(typeid(XMFLOAT3), [&](void* data, std::wstring& name) {
+		auto value = static_cast<XMFLOAT3*>(data);
 		ss << name << "\n" << value->x << " " << value->y << " " << value->z << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(XMFLOAT4), [&](Property& prop, std::wstring& name) {
-		auto value = prop.GetData<XMFLOAT4>();
+	typeToWriteFuncMap.emplace(typeid(XMFLOAT4), [&](void* data, std::wstring& name) {
+		auto value = static_cast<XMFLOAT4*>(data);
 		ss << name << "\n" << value->x << " " << value->y << " " << value->z << " " << value->w << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(int), [&](Property& prop, std::wstring& name) {
-		ss << name << "\n" << *prop.GetData<int>() << "\n";
+	typeToWriteFuncMap.emplace(typeid(int), [&](void* data, std::wstring& name) {
+		ss << name << "\n" << *static_cast<int*>(data) << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(std::string), [&](Property& prop, std::wstring& name) {
-		auto str = prop.GetData<std::string>();
+	typeToWriteFuncMap.emplace(typeid(std::string), [&](void* data, std::wstring& name) {
+		auto str = static_cast<std::string*>(data);
 		ss << name << "\n" << str->c_str() << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(std::wstring), [&](Property& prop, std::wstring& name) {
-		auto wstr = prop.GetData<std::wstring>();
+	typeToWriteFuncMap.emplace(typeid(std::wstring), [&](void* data, std::wstring& name) {
+		auto wstr = static_cast<std::wstring*>(data);
 		ss << name << "\n" << wstr->data() << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(TextureData), [&](Property& prop, std::wstring& name) {
-		auto textureData = prop.GetData<TextureData>();
+	typeToWriteFuncMap.emplace(typeid(TextureData), [&](void* data, std::wstring& name) {
+		auto textureData = static_cast<TextureData*>(data);
 		ss << name << "\n" << textureData->filename.c_str() << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(MeshComponentData), [&](Property& prop, std::wstring& name) {
-		auto meshComponentData = prop.GetData<MeshComponentData>();
+	typeToWriteFuncMap.emplace(typeid(MeshComponentData), [&](void* data, std::wstring& name) {
+		auto meshComponentData = static_cast<MeshComponentData*>(data);
 		ss << name << "\n" << meshComponentData->filename.c_str() << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(UID), [&](Property& prop, std::wstring& name) {
-		auto uid = prop.GetData<UID>();
+	typeToWriteFuncMap.emplace(typeid(UID), [&](void* data, std::wstring& name) {
+		auto uid = static_cast<UID*>(data);
 		ss << name << "\n";
 		ss << *uid << "\n";
 		});
 
-	typeToWriteFuncMap.emplace(typeid(VEnum), [&](Property& prop, std::wstring& name) {
-		auto vEnum = prop.GetData<VEnum>();
+	typeToWriteFuncMap.emplace(typeid(VEnum), [&](void* data, std::wstring& name) {
+		auto vEnum = static_cast<VEnum*>(data);
 		ss << name << "\n";
 		ss << vEnum->GetValue().c_str() << "\n";
 		});
@@ -104,6 +105,18 @@ void Serialiser::Serialise(Properties& props)
 
 		auto typeIt = typeToWriteFuncMap.find(prop.info.value());
 		assert(typeIt != typeToWriteFuncMap.end() && "Matching type_info won't be found in map");
-		typeIt->second(prop, wname);
+		typeIt->second(prop.data, wname);
+	}
+}
+
+void Serialiser::Serialise(const PropertyView& view)
+{
+	for (const PropertyDescriptor& descriptor : view.table->GetDescriptors())
+	{
+		std::wstring wname = VString::stows(descriptor.name);
+
+		auto typeIt = typeToWriteFuncMap.find(descriptor.type);
+		assert(typeIt != typeToWriteFuncMap.end() && "Matching type_info won't be found in map");
+		typeIt->second(view.GetData(descriptor), wname);
 	}
 }
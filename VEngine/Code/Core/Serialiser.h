@@ -3,6 +3,8 @@
 #include <fstream>
 #include "Core/OpenMode.h"
 
+struct PropertyView;
+
 class Serialiser
 {
 private:
@@ -15,12 +17,13 @@ private:
 	const std::string filename;
 	const OpenMode mode;
 
-	std::unordered_map<std::type_index, std::function<void(Property& prop, std::wstring& name)>> typeToWriteFuncMap;
+	std::unordered_map<std::type_index, std::function<void(void* data, std::wstring& name)>> typeToWriteFuncMap;
 
 public:
 	Serialiser(const std::string filename_, const OpenMode mode_);
 	~Serialiser();
 	void Serialise(Properties& props);
+	void Serialise(const PropertyView& view);
 
 	template <typename T>
 	void WriteLine(T arg)
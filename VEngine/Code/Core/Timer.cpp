@@ -1,50 +1,260 @@
 #include "vpch.h"
 #include "Timer.h"
+#include <algorithm>
+#include <cmath>
 
-std::vector<TimerItem> timerItems;
+TimerWheel timerWheel;
 
-void Timer::Tick(float deltaTime)
+TimerWheel::TimerWheel()
+{
+	std::fill(std::begin(slotHeads), std::end(slotHeads), invalidIndex);
+}
+
+TimerHandle TimerWheel::Add(float duration, std::function<void()> functionToCall, bool loop)
+{
+	uint32_t nodeIndex = invalidIndex;
+	if (!freeNodes.empty())
+	{
+		nodeIndex = freeNodes.back();
+		freeNodes.pop_back();
+	}
+	else
+	{
+		nodeIndex = static_cast<uint32_t>(nodes.size());
+		nodes.emplace_back();
+	}
+
+	Node& node = nodes[nodeIndex];
+	node.functionToCall = std::move(functionToCall);
+
+	//At least one tick, so that a timer set from a callback never fires in the step that set it.
+	const double durationTicks = std::ceil(static_cast<double>(duration) * ticksPerSecond);
+	node.durationTicks = static_cast<uint64_t>(std::max(durationTicks, 1.0));
+	node.expiryTick = currentTick + node.durationTicks;
+	node.loop = loop;
+	node.active = true;
+
+	activeCount++;
+	Link(nodeIndex);
+
+	return TimerHandle{ nodeIndex, node.generation };
+}
+
+bool TimerWheel::Remove(TimerHandle handle)
 {
-	for(auto& timerItem : timerItems)
+	if (!IsActive(handle))
+	{
+		return false;
+	}
+
+	//A firing timer isn't in a slot, Step() sees the generation change once its callback returns.
+	if (nodes[handle.index].slot != invalidIndex)
 	{
-		timerItem.currentTime += deltaTime;
+		Unlink(handle.index);
+	}
+	FreeNode(handle.index);
+	return true;
+}
+
+bool TimerWheel::IsActive(TimerHandle handle) const
+{
+	return handle.index < nodes.size() &&
+		nodes[handle.index].generation == handle.generation &&
+		nodes[handle.index].active;
+}
 
-		if (timerItem.currentTime > timerItem.endTime)
+void TimerWheel::Advance(float deltaTime)
+{
+	pendingTime += deltaTime;
+	const uint64_t ticks = static_cast<uint64_t>(pendingTime * ticksPerSecond);
+	pendingTime -= static_cast<double>(ticks) / ticksPerSecond;
+
+	for (uint64_t tick = 0; tick < ticks; tick++)
+	{
+		//Slots are all empty, nothing to cascade or fire.
+		if (activeCount == 0)
 		{
-			timerItem.functionToCall();
+			currentTick += ticks - tick;
+			return;
+		}
+
+		Step();
+	}
+}
 
-			if (timerItem.loop)
-			{
-				timerItem.currentTime = 0.0;
-			}
+void TimerWheel::Clear()
+{
+	freeNodes.clear();
+	for (uint32_t i = 0; i < nodes.size(); i++)
+	{
+		Node& node = nodes[i];
+		if (node.active)
+		{
+			node.functionToCall = nullptr;
+			node.active = false;
+			node.generation++;
 		}
+		node.slot = invalidIndex;
+		node.previous = invalidIndex;
+		node.next = invalidIndex;
+		freeNodes.emplace_back(i);
 	}
 
-	//This looks stupid, but the erase call has to be below the timer function call
-	//for when world's load and all timers are cleared.
-	for (int timerIndex = 0; timerIndex < timerItems.size(); timerIndex++)
+	std::fill(std::begin(slotHeads), std::end(slotHeads), invalidIndex);
+	activeCount = 0;
+	clearCount++;
+}
+
+void TimerWheel::Link(uint32_t nodeIndex)
+{
+	Node& node = nodes[nodeIndex];
+
+	//Cascaded timers can be due on this very tick, they go in the level 0 slot that's about to fire.
+	const uint64_t delta = node.expiryTick > currentTick ? node.expiryTick - currentTick : 0;
+
+	uint32_t level = 0;
+	while (level < levelCount - 1 && delta >= (1ull << (levelBits * (level + 1))))
 	{
-		if (timerItems[timerIndex].currentTime > timerItems[timerIndex].endTime)
+		level++;
+	}
+
+	//Past the top level's range the timer is parked in its furthest slot and linked again when that comes round.
+	const uint64_t maxDelta = (1ull << (levelBits * levelCount)) - 1;
+	const uint64_t placementTick = currentTick + std::min(delta, maxDelta);
+
+	const uint32_t slot = level * slotsPerLevel +
+		static_cast<uint32_t>((placementTick >> (levelBits * level)) & (slotsPerLevel - 1));
+
+	node.slot = slot;
+	node.previous = invalidIndex;
+	node.next = slotHeads[slot];
+	if (node.next != invalidIndex)
+	{
+		nodes[node.next].previous = nodeIndex;
+	}
+	slotHeads[slot] = nodeIndex;
+}
+
+void TimerWheel::Unlink(uint32_t nodeIndex)
+{
+	Node& node = nodes[nodeIndex];
+
+	if (node.previous != invalidIndex)
+	{
+		nodes[node.previous].next = node.next;
+	}
+	else
+	{
+		slotHeads[node.slot] = node.next;
+	}
+
+	if (node.next != invalidIndex)
+	{
+		nodes[node.next].previous = node.previous;
+	}
+
+	node.slot = invalidIndex;
+	node.previous = invalidIndex;
+	node.next = invalidIndex;
+}
+
+void TimerWheel::FreeNode(uint32_t nodeIndex)
+{
+	Node& node = nodes[nodeIndex];
+	node.functionToCall = nullptr;
+	node.active = false;
+	node.generation++;
+
+	freeNodes.emplace_back(nodeIndex);
+	activeCount--;
+}
+
+void TimerWheel::Step()
+{
+	currentTick++;
+
+	//Cascade from the top down, so timers coming down more than one level land in slots that are
+	//emptied later in this same step.
+	uint32_t topLevel = 0;
+	while (topLevel < levelCount - 1 && (currentTick & ((1ull << (levelBits * (topLevel + 1))) - 1)) == 0)
+	{
+		topLevel++;
+	}
+
+	for (uint32_t level = topLevel; level > 0; level--)
+	{
+		const uint32_t slot = level * slotsPerLevel +
+			static_cast<uint32_t>((currentTick >> (levelBits * level)) & (slotsPerLevel - 1));
+
+		uint32_t nodeIndex = slotHeads[slot];
+		slotHeads[slot] = invalidIndex;
+		while (nodeIndex != invalidIndex)
+		{
+			const uint32_t next = nodes[nodeIndex].next;
+			Link(nodeIndex);
+			nodeIndex = next;
+		}
+	}
+
+	const uint32_t slot = static_cast<uint32_t>(currentTick & (slotsPerLevel - 1));
+	const uint32_t clearCountBefore = clearCount;
+
+	while (slotHeads[slot] != invalidIndex)
+	{
+		const uint32_t nodeIndex = slotHeads[slot];
+		Unlink(nodeIndex);
+
+		//Moved out for the call, callbacks can add timers (reallocating nodes) or remove this one.
+		const uint32_t generation = nodes[nodeIndex].generation;
+		std::function<void()> functionToCall = std::move(nodes[nodeIndex].functionToCall);
+		functionToCall();
+
+		//World loads clear every timer from inside a callback.
+		if (clearCount != clearCountBefore)
+		{
+			return;
+		}
+
+		Node& node = nodes[nodeIndex];
+		if (node.generation != generation)
 		{
-			timerItems.erase(timerItems.begin() + timerIndex);
+			continue;
+		}
+
+		if (node.loop)
+		{
+			node.functionToCall = std::move(functionToCall);
+			node.expiryTick = currentTick + node.durationTicks;
+			Link(nodeIndex);
+		}
+		else
+		{
+			FreeNode(nodeIndex);
 		}
 	}
 }
 
+void Timer::Tick(float deltaTime)
+{
+	timerWheel.Advance(deltaTime);
+}
+
 void Timer::Cleanup()
 {
-	timerItems.clear();
+	timerWheel.Clear();
 }
 
-TimerItem* Timer::SetTimer(float duration, std::function<void()> functionToCall, bool loop)
+TimerHandle Timer::SetTimer(float duration, std::function<void()> functionToCall, bool loop)
 {
-	TimerItem timerItem = {};
-	timerItem.endTime = duration;
-	timerItem.currentTime = 0.0f;
-	timerItem.loop = loop;
-	timerItem.functionToCall = functionToCall;
+	return timerWheel.Add(duration, std::move(functionToCall), loop);
+}
 
-	timerItems.emplace_back(timerItem);
+bool Timer::ClearTimer(TimerHandle handle)
+{
+	return timerWheel.Remove(handle);
+}
 
-	return &timerItems.back();
+bool Timer::IsTimerActive(TimerHandle handle)
+{
+	return timerWheel.IsActive(handle);
 }
@@ -1,18 +1,93 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
+#include <vector>
 
-struct TimerItem
+//Refers to a timer set with Timer::SetTimer(). Once the timer has fired (and doesn't loop) or has been cleared,
+//the handle's generation no longer matches its node and the timer functions treat it as gone.
+struct TimerHandle
 {
-	std::function<void()> functionToCall;
-	double endTime = 0.0;
-	double currentTime = 0.0;
-	bool loop = false;
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	uint32_t index = invalidIndex;
+	uint32_t generation = 0;
+
+	bool IsNull() const { return index == invalidIndex; }
+};
+
+//Hierarchical timer wheel. Time is counted in 1ms ticks and every level has 64 slots, each covering 64 times
+//the ticks of a slot on the level below. A timer sits in the slot of the lowest level its expiry fits in and
+//drops down a level whenever that slot comes round, so setting and clearing are O(1), a timer is moved at most
+//once per level before it fires and a tick with nothing due only looks at one slot.
+class TimerWheel
+{
+public:
+	TimerWheel();
+
+	TimerHandle Add(float duration, std::function<void()> functionToCall, bool loop);
+
+	//Returns false if the timer had already fired or been removed.
+	bool Remove(TimerHandle handle);
+	bool IsActive(TimerHandle handle) const;
+
+	//Fires every timer that comes due in the next deltaTime seconds. Callbacks can add, remove and clear timers.
+	void Advance(float deltaTime);
+
+	void Clear();
+
+	size_t GetActiveCount() const { return activeCount; }
+
+private:
+	static constexpr uint32_t ticksPerSecond = 1000;
+	static constexpr uint32_t levelBits = 6;
+	static constexpr uint32_t slotsPerLevel = 1 << levelBits;
+	static constexpr uint32_t levelCount = 4;
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	struct Node
+	{
+		std::function<void()> functionToCall;
+		uint64_t expiryTick = 0;
+		uint64_t durationTicks = 0;
+		uint32_t generation = 0;
+
+		//Index into slotHeads, invalidIndex while the node isn't in a slot (free or firing).
+		uint32_t slot = invalidIndex;
+		uint32_t previous = invalidIndex;
+		uint32_t next = invalidIndex;
+
+		bool loop = false;
+		bool active = false;
+	};
+
+	void Link(uint32_t nodeIndex);
+	void Unlink(uint32_t nodeIndex);
+	void FreeNode(uint32_t nodeIndex);
+	void Step();
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> freeNodes;
+	uint32_t slotHeads[levelCount * slotsPerLevel];
+
+	uint64_t currentTick = 0;
+
+	//Time that hasn't added up to a whole tick yet.
+	double pendingTime = 0.0;
+
+	size_t activeCount = 0;
+
+	//Bumped by Clear() so that Step() can tell a callback cleared everything out from under it.
+	uint32_t clearCount = 0;
 };
 
 namespace Timer
 {
 	void Tick(float deltaTime);
 	void Cleanup();
-	TimerItem* SetTimer(float duration, std::function<void()> functionToCall, bool loop = false);
+	TimerHandle SetTimer(float duration, std::function<void()> functionToCall, bool loop = false);
+
+	//Returns false if the timer had already fired or been cleared.
+	bool ClearTimer(TimerHandle handle);
+	bool IsTimerActive(TimerHandle handle);
 };
@@ -547,7 +547,7 @@ namespace VMath
 		b2 = t;
 	}
 
-	void TriangleXYZToUV(Vertex& v0, Vertex& v1, Vertex& v2, XMVECTOR hitPoint, float& u, float& v)
+	void TriangleXYZToUV(const Vertex& v0, const Vertex& v1, const Vertex& v2, XMVECTOR hitPoint, float& u, float& v)
 	{
 		XMVECTOR p0 = XMLoadFloat3(&v0.pos);
 		XMVECTOR p1 = XMLoadFloat3(&v1.pos);
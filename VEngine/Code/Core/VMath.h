@@ -94,7 +94,7 @@ namespace VMath
 	XMVECTOR TriangleUVToXYZ(XMFLOAT2 uv, Vertex tri[3]);
 	bool IsUVInTriangleUVs(XMFLOAT2 pt, XMFLOAT2 v1, XMFLOAT2 v2, XMFLOAT2 v3);
 	void GetBarycentricCoords(XMVECTOR p0, XMVECTOR p1, XMVECTOR p2, XMVECTOR hitPoint, float& b1, float& b2);
-	void TriangleXYZToUV(Vertex& v0, Vertex& v1, Vertex& v2, XMVECTOR hitPoint, float& u, float& v);
+	void TriangleXYZToUV(const Vertex& v0, const Vertex& v1, const Vertex& v2, XMVECTOR hitPoint, float& u, float& v);
 	int GetIndexOfClosestVertexFromTriangleIntersect(std::unordered_map<int, XMVECTOR>& vertexPositions, XMVECTOR hitPoint);
 
 	void HomogenousWorldPosToScreenSpaceCoords(XMVECTOR worldPos, int& screenX, int& screenY);
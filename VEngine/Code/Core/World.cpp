@@ -24,6 +24,7 @@
 #include "Gameplay/GameInstance.h"
 #include "Gameplay/GameUtils.h"
 #include "Physics/PhysicsSystem.h"
+#include "Physics/WorldBVH.h"
 
 std::string World::worldFilename;
 
@@ -239,7 +240,7 @@ Actor* World::GetActorByNameAllowNull(std::string actorName)
 	auto foundActorIt = actorNameMap.find(actorName);
 	if (foundActorIt == actorNameMap.end())
 	{
-		Log("%s actor not found.", actorName.c_str());
+		LogVerbose("%s actor not found.", actorName.c_str());
 		return nullptr;
 	}
 	return foundActorIt->second;
@@ -264,6 +265,23 @@ void World::AddActorToWorld(Actor* actor)
 
 	actorUIDMap.emplace(actorUID, actor);
 	actorNameMap.emplace(actorName, actor);
+
+	//Make sure the actor's meshes can be hit by raycasts in the same frame it was spawned in.
+	WorldBVH::MarkStale();
+}
+
+void World::AddActorsToWorld(const std::vector<Actor*>& actors)
+{
+	actorUIDMap.reserve(actorUIDMap.size() + actors.size());
+	actorNameMap.reserve(actorNameMap.size() + actors.size());
+
+	for (Actor* actor : actors)
+	{
+		actorUIDMap.emplace(actor->GetUID(), actor);
+		actorNameMap.emplace(actor->GetName(), actor);
+	}
+
+	WorldBVH::MarkStale();
 }
 
 void World::RemoveActorFromWorld(Actor* actor)
@@ -342,6 +360,7 @@ void World::Cleanup()
 
 	Timer::Cleanup();
 	PhysicsSystem::Reset();
+	WorldBVH::Reset();
 	AudioSystem::DeleteLoadedAudioAndChannels();
 	TextureSystem::Cleanup();
 	MaterialSystem::Cleanup();
@@ -54,6 +54,9 @@ namespace World
 
 	void AddActorToWorld(Actor* actor);
 
+	//Registration pass for world loads, after every actor has its saved name and UID.
+	void AddActorsToWorld(const std::vector<Actor*>& actors);
+
 	void RemoveActorFromWorld(Actor* actor);
 	void RemoveActorFromWorld(UID actorUID);
 	void RemoveActorFromWorld(std::string actorName);
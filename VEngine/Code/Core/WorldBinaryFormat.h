@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+
+//Layout of binary world files (WorldMaps/Binary/). Written by BinarySerialiser, read by BinaryDeserialiser.
+//
+//	WorldBinaryHeader
+//	WorldBinaryString[stringCount], then the UTF-8 bytes they point at. Every name and string value is stored once.
+//	WorldBinarySystem[systemCount]
+//	Per system: WorldBinaryProperty[propertyCount] (the schema), then per object blocks:
+//		Component systems only: owner UIDs and component name string indices
+//		Records: the fixed size properties of each object packed back to back, recordSize bytes per object
+//		String indices: stringPropertyCount per object, for the string, texture, mesh and enum properties
+//		Presence masks: only when objects in the system don't all have the same properties
+//
+//Properties are matched by name and type on load, so properties added to or removed from a class since the
+//file was written are skipped or left at their defaults instead of breaking everything after them.
+//All offsets are from the start of the file and 8 byte aligned so the file can be memory-mapped and read in place.
+struct WorldBinaryHeader
+{
+	inline static const uint32_t MAGIC = 0x444C5756; //"VWLD" in file order
+	inline static const uint32_t CURRENT_VERSION = 1;
+	inline static const uint32_t SECTION_ALIGNMENT = 8;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = CURRENT_VERSION;
+	uint32_t stringCount = 0;
+	uint32_t systemCount = 0;
+	uint32_t stringsOffset = 0;
+	uint32_t stringDataOffset = 0;
+	uint32_t systemsOffset = 0;
+	uint32_t fileSize = 0;
+};
+
+struct WorldBinaryString
+{
+	uint32_t offset = 0; //Bytes from stringDataOffset
+	uint32_t length = 0;
+};
+
+enum class WorldBinarySystemKind : uint32_t
+{
+	Actor,
+	Component
+};
+
+struct WorldBinarySystem
+{
+	inline static const uint32_t NO_PRESENCE_MASKS = UINT32_MAX;
+
+	uint32_t nameString = 0;
+	WorldBinarySystemKind kind = WorldBinarySystemKind::Actor;
+	uint32_t objectCount = 0;
+	uint32_t propertyCount = 0;
+	uint32_t recordSize = 0;
+	uint32_t stringPropertyCount = 0;
+	uint32_t propertiesOffset = 0;
+	uint32_t ownersOffset = 0; //Component systems only, UID[objectCount]
+	uint32_t componentNamesOffset = 0; //Component systems only, string index[objectCount]
+	uint32_t recordsOffset = 0;
+	uint32_t stringIndicesOffset = 0;
+	uint32_t presenceMasksOffset = NO_PRESENCE_MASKS; //uint32_t[(propertyCount + 31) / 32] per object
+};
+
+//Stable ids for the property types serialisation supports. Never reorder, only append.
+enum class WorldBinaryPropertyType : uint32_t
+{
+	Bool,
+	Int,
+	UID,
+	Float,
+	Float2,
+	Int2,
+	Float3,
+	Float4,
+	String,
+	WString,
+	Texture,
+	Mesh,
+	Enum,
+
+	Unsupported = UINT32_MAX
+};
+
+inline bool IsStringPropertyType(WorldBinaryPropertyType type)
+{
+	return type >= WorldBinaryPropertyType::String && type <= WorldBinaryPropertyType::Enum;
+}
+
+struct WorldBinaryProperty
+{
+	uint32_t nameString = 0;
+	WorldBinaryPropertyType type = WorldBinaryPropertyType::Bool;
+	uint32_t size = 0; //Bytes in the record, 0 for string types
+	uint32_t offset = 0; //Byte offset into the record, or index into the object's string indices for string types
+};
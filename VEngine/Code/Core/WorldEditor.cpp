@@ -231,7 +231,7 @@ void DuplicateActor()
 					auto matchingMesh = gPickedActor->GetComponent<MeshComponent>(mesh->GetName());
 					if (matchingMesh)
 					{
-						mesh->meshDataProxy.vertices = matchingMesh->meshDataProxy.vertices;
+						mesh->meshDataProxy = matchingMesh->meshDataProxy;
 					}
 					mesh->CreateNewVertexBuffer();
 				}
@@ -402,7 +402,7 @@ void VertexPainting()
 				{
 					for (auto& vertIndex : hit.hitVertIndexes)
 					{
-						Vertex v = mesh->meshDataProxy.vertices.at(vertIndex);
+						Vertex v = mesh->meshDataProxy.GetVertices().at(vertIndex);
 						WorldEditor::vertexPaintColour = v.colour;
 					}
 				}
@@ -424,8 +424,8 @@ void VertexPainting()
 				auto meshes = hit.hitActor->GetComponents<MeshComponent>();
 				for (auto mesh : meshes)
 				{
-					const auto numVerts = mesh->meshDataProxy.vertices.size();
-					auto& vertices = mesh->meshDataProxy.GetVertices();
+					const auto numVerts = mesh->meshDataProxy.GetVertexCount();
+					auto& vertices = mesh->meshDataProxy.GetMutableVertices();
 
 					//Set indicies based on face fill or single vertex
 					std::vector<int> vertIndexes;
@@ -473,7 +473,7 @@ void UVPainting()
 			auto meshes = hit.hitActor->GetComponents<MeshComponent>();
 			for (auto mesh : meshes)
 			{
-				auto& vertices = mesh->meshDataProxy.GetVertices();
+				auto& vertices = mesh->meshDataProxy.GetMutableVertices();
 
 				assert(hit.vertIndexesOfHitTriangleFace.size() == 3);
 				std::vector<XMFLOAT2*> newUVs;
@@ -0,0 +1,318 @@
+#include "vpch.h"
+#include "WorldTextParser.h"
+#include <charconv>
+#include <typeindex>
+#include "Core/Log.h"
+#include "Core/ParallelFor.h"
+#include "Core/Properties.h"
+#include "Core/PropertyTable.h"
+#include "Core/VEnum.h"
+#include "Core/VString.h"
+
+using namespace WorldTextParser;
+
+//Lines are handed out without their line ending, files saved on Windows have \r\n.
+class LineReader
+{
+public:
+	LineReader(std::string_view text_) : text(text_) {}
+
+	bool Next(std::string_view& outLine)
+	{
+		if (position >= text.size())
+		{
+			return false;
+		}
+
+		size_t lineEnd = text.find('\n', position);
+		if (lineEnd == std::string_view::npos)
+		{
+			lineEnd = text.size();
+		}
+
+		outLine = text.substr(position, lineEnd - position);
+		if (!outLine.empty() && outLine.back() == '\r')
+		{
+			outLine.remove_suffix(1);
+		}
+
+		position = lineEnd + 1;
+		return true;
+	}
+
+private:
+	std::string_view text;
+	size_t position = 0;
+};
+
+static std::string_view TrimSpaces(std::string_view str)
+{
+	while (!str.empty() && (str.front() == ' ' || str.front() == '\t'))
+	{
+		str.remove_prefix(1);
+	}
+	while (!str.empty() && (str.back() == ' ' || str.back() == '\t'))
+	{
+		str.remove_suffix(1);
+	}
+	return str;
+}
+
+template <typename T>
+static bool ParseNumber(std::string_view str, T& outValue)
+{
+	str = TrimSpaces(str);
+	const auto result = std::from_chars(str.data(), str.data() + str.size(), outValue);
+	return result.ec == std::errc() && result.ptr == str.data() + str.size();
+}
+
+static void ParseNumbers(ParsedProperty& property)
+{
+	std::string_view remaining = property.text;
+
+	for (int i = 0; i < 4; i++)
+	{
+		remaining = TrimSpaces(remaining);
+		if (remaining.empty())
+		{
+			return;
+		}
+
+		const size_t tokenEnd = std::min(remaining.find(' '), remaining.size());
+		const std::string_view token = remaining.substr(0, tokenEnd);
+		remaining.remove_prefix(tokenEnd);
+
+		if (!ParseNumber(token, property.floats[i]))
+		{
+			return;
+		}
+		property.floatCount++;
+
+		if (property.integerCount == i && ParseNumber(token, property.integers[i]))
+		{
+			property.integerCount++;
+		}
+	}
+}
+
+//Properties run until a "next" line, each one a name line followed by a value line. Values are never split
+//over lines, so a string value that happens to be "next" doesn't end the object early.
+static void ReadObjectProperties(LineReader& reader, ParsedWorld& world, ParsedObject& object)
+{
+	object.firstProperty = static_cast<uint32_t>(world.properties.size());
+
+	std::string_view nameLine;
+	while (reader.Next(nameLine))
+	{
+		if (nameLine == "next")
+		{
+			break;
+		}
+
+		if (nameLine.empty())
+		{
+			continue;
+		}
+
+		ParsedProperty property;
+		property.name = nameLine;
+		if (!reader.Next(property.text))
+		{
+			break;
+		}
+		world.properties.emplace_back(property);
+	}
+
+	object.propertyCount = static_cast<uint32_t>(world.properties.size()) - object.firstProperty;
+}
+
+bool WorldTextParser::Parse(const std::string& path, const std::function<BlockType(const std::string&)>& getBlockType,
+	ParsedWorld& outWorld)
+{
+	outWorld = ParsedWorld();
+
+	{
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			Log("Couldn't open world file [%s].", path.c_str());
+			return false;
+		}
+
+		outWorld.text.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(outWorld.text.data(), outWorld.text.size());
+	}
+
+	std::string_view text = outWorld.text;
+	if (text.starts_with("\xEF\xBB\xBF"))
+	{
+		text.remove_prefix(3);
+	}
+
+	//Roughly one property per two lines, keeps the vector from moving while it fills up.
+	outWorld.properties.reserve(std::count(text.begin(), text.end(), '\n') / 2 + 1);
+
+	LineReader reader(text);
+	std::string_view line;
+
+	while (reader.Next(line))
+	{
+		line = TrimSpaces(line);
+		if (line.empty())
+		{
+			continue;
+		}
+
+		if (line == "end")
+		{
+			break;
+		}
+
+		ParsedSystem& system = outWorld.systems.emplace_back();
+		system.name = line;
+		system.type = getBlockType(system.name);
+
+		std::string_view countLine;
+		size_t objectCount = 0;
+		if (!reader.Next(countLine) || !ParseNumber(countLine, objectCount))
+		{
+			Log("Object count missing for [%s] in [%s], stopping the load there.", system.name.c_str(), path.c_str());
+			outWorld.systems.pop_back();
+			break;
+		}
+
+		if (system.type == BlockType::Unknown)
+		{
+			//It won't remove the system from the .vmap file though, subsequent saves will drop it instead.
+			Log("System [%s] in [%s] no longer exists, skipping its %zu objects.", system.name.c_str(), path.c_str(), objectCount);
+			for (size_t i = 0; i < objectCount; i++)
+			{
+				while (reader.Next(line) && line != "next") {}
+			}
+			continue;
+		}
+
+		system.objects.reserve(objectCount);
+
+		for (size_t i = 0; i < objectCount; i++)
+		{
+			ParsedObject& object = system.objects.emplace_back();
+
+			if (system.type == BlockType::Component)
+			{
+				std::string_view ownerLine;
+				reader.Next(ownerLine);
+				ParseNumber(ownerLine, object.ownerUID);
+
+				reader.Next(object.componentName);
+				object.componentName = TrimSpaces(object.componentName);
+			}
+
+			ReadObjectProperties(reader, outWorld, object);
+		}
+	}
+
+	ParallelFor(outWorld.properties.size(), 1024, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				ParsedProperty& property = outWorld.properties[i];
+				property.nameHash = HashPropertyName(property.name);
+				ParseNumbers(property);
+			}
+		});
+
+	return true;
+}
+
+using ApplyFunc = void(*)(const ParsedProperty& parsed, void* data);
+
+static const std::unordered_map<std::type_index, ApplyFunc>& GetApplyFuncs()
+{
+	static const std::unordered_map<std::type_index, ApplyFunc> applyFuncs = {
+		{ typeid(bool), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.integerCount >= 1) *static_cast<bool*>(data) = parsed.integers[0] != 0;
+		} },
+		{ typeid(int), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.integerCount >= 1) *static_cast<int*>(data) = static_cast<int>(parsed.integers[0]);
+		} },
+		{ typeid(UID), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.integerCount >= 1) *static_cast<UID*>(data) = static_cast<UID>(parsed.integers[0]);
+		} },
+		{ typeid(float), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.floatCount >= 1) *static_cast<float*>(data) = parsed.floats[0];
+		} },
+		{ typeid(XMFLOAT2), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.floatCount >= 2) *static_cast<XMFLOAT2*>(data) = XMFLOAT2(parsed.floats[0], parsed.floats[1]);
+		} },
+		{ typeid(XMINT2), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.integerCount >= 2) *static_cast<XMINT2*>(data) = XMINT2(static_cast<int>(parsed.integers[0]), static_cast<int>(parsed.integers[1]));
+		} },
+		{ typeid(XMFLOAT3), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.floatCount >= 3) *static_cast<XMFLOAT3*>(data) = XMFLOAT3(parsed.floats[0], parsed.floats[1], parsed.floats[2]);
+		} },
+		{ typeid(XMFLOAT4), [](const ParsedProperty& parsed, void* data) {
+			if (parsed.floatCount >= 4) *static_cast<XMFLOAT4*>(data) = XMFLOAT4(parsed.floats[0], parsed.floats[1], parsed.floats[2], parsed.floats[3]);
+		} },
+		{ typeid(std::string), [](const ParsedProperty& parsed, void* data) {
+			static_cast<std::string*>(data)->assign(parsed.text);
+		} },
+		{ typeid(std::wstring), [](const ParsedProperty& parsed, void* data) {
+			*static_cast<std::wstring*>(data) = VString::stows(std::string(parsed.text));
+		} },
+		{ typeid(TextureData), [](const ParsedProperty& parsed, void* data) {
+			static_cast<TextureData*>(data)->filename.assign(parsed.text);
+		} },
+		{ typeid(MeshComponentData), [](const ParsedProperty& parsed, void* data) {
+			static_cast<MeshComponentData*>(data)->filename.assign(parsed.text);
+		} },
+		{ typeid(VEnum), [](const ParsedProperty& parsed, void* data) {
+			static_cast<VEnum*>(data)->SetValue(std::string(parsed.text));
+		} },
+	};
+	return applyFuncs;
+}
+
+void WorldTextParser::Apply(const ParsedWorld& world, const ParsedObject& object, Properties& props)
+{
+	const auto& applyFuncs = GetApplyFuncs();
+
+	std::string name;
+	for (uint32_t i = 0; i < object.propertyCount; i++)
+	{
+		const ParsedProperty& parsed = world.properties[object.firstProperty + i];
+
+		name.assign(parsed.name);
+		auto propIt = props.propMap.find(name);
+		if (propIt == props.propMap.end())
+		{
+			continue;
+		}
+
+		Property& prop = propIt->second;
+		auto funcIt = applyFuncs.find(prop.info.value());
+		assert(funcIt != applyFuncs.end() && "Matching type_info not found");
+		funcIt->second(parsed, prop.data);
+	}
+}
+
+void WorldTextParser::Apply(const ParsedWorld& world, const ParsedObject& object, const PropertyView& view)
+{
+	const auto& applyFuncs = GetApplyFuncs();
+
+	for (uint32_t i = 0; i < object.propertyCount; i++)
+	{
+		const ParsedProperty& parsed = world.properties[object.firstProperty + i];
+
+		const PropertyDescriptor* descriptor = view.table->Find(parsed.nameHash);
+		if (descriptor == nullptr || descriptor->name != parsed.name)
+		{
+			continue;
+		}
+
+		auto funcIt = applyFuncs.find(descriptor->type);
+		assert(funcIt != applyFuncs.end() && "Matching type_info not found");
+		funcIt->second(parsed, view.GetData(*descriptor));
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Core/UID.h"
+
+struct Properties;
+struct PropertyView;
+
+//First two stages of loading a text .vmap, neither of which touch the world:
+//	1. The whole file is read in one go and split into system and object blocks on the calling thread.
+//	2. Every "name\nvalue" line pair is parsed into a ParsedProperty on worker threads, numbers included.
+//The last stage, spawning actors and applying the records to their props, has to run on the main thread and is
+//left to FileSystem, where Apply() is only a map lookup and a copy per property.
+namespace WorldTextParser
+{
+	enum class BlockType
+	{
+		Actor,
+		Component, //Owner UID and component name lines come before the properties
+		Unknown //System no longer exists, its block is skipped
+	};
+
+	struct ParsedProperty
+	{
+		std::string_view name;
+		uint64_t nameHash = 0; //For PropertyTable lookups
+		std::string_view text; //The whole value line, used as is for string types
+
+		//Space separated numbers at the start of the value, parsed both ways so vectors and UIDs stay exact.
+		float floats[4]{};
+		int64_t integers[4]{};
+		uint8_t floatCount = 0;
+		uint8_t integerCount = 0;
+	};
+
+	struct ParsedObject
+	{
+		//Component blocks only
+		UID ownerUID = 0;
+		std::string_view componentName;
+
+		uint32_t firstProperty = 0; //Into ParsedWorld::properties
+		uint32_t propertyCount = 0;
+	};
+
+	struct ParsedSystem
+	{
+		std::string name;
+		BlockType type = BlockType::Actor;
+		std::vector<ParsedObject> objects;
+	};
+
+	struct ParsedWorld
+	{
+		std::string text; //Every string_view points into this
+		std::vector<ParsedSystem> systems;
+		std::vector<ParsedProperty> properties;
+	};
+
+	bool Parse(const std::string& path, const std::function<BlockType(const std::string&)>& getBlockType,
+		ParsedWorld& outWorld);
+
+	//Sets each property in props that the object has a value for.
+	void Apply(const ParsedWorld& world, const ParsedObject& object, Properties& props);
+	void Apply(const ParsedWorld& world, const ParsedObject& object, const PropertyView& view);
+}
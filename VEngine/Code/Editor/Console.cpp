@@ -14,6 +14,10 @@
 #include "Core/FileSystem.h"
 #include "Core/World.h"
 #include "Core/WorldEditor.h"
+#include "Core/Benchmarks.h"
+#include "Render/Culling.h"
+#include "Render/LightBake.h"
+#include "Render/ProbeBake.h"
 
 std::map<std::wstring, std::pair<std::function<void()>, std::string>> Console::executeMap;
 
@@ -59,6 +63,50 @@ void Console::Init()
 		std::make_pair([]() { RunWorldLoadTest(); },
 			"Load every world in the world maps folder in sequence."));
 
+	executeMap.emplace(L"BENCH BVH",
+		std::make_pair([]() { Benchmarks::RaycastBVH(); },
+			"Benchmark linear raycasts against the world and triangle BVHs on a synthetic 10k mesh world."));
+
+	executeMap.emplace(L"BENCH ANIM",
+		std::make_pair([]() { Benchmarks::SkeletalAnimation(); },
+			"Benchmark keyframe search and pose evaluation of skeletal animation on a synthetic skeleton."));
+
+	executeMap.emplace(L"BENCH VANIM",
+		std::make_pair([]() { Benchmarks::AnimationClipCompression(); },
+			"Benchmark .vanim v1 against compressed v2 clip sizes, decode times and error."));
+
+	executeMap.emplace(L"BENCH CULLING",
+		std::make_pair([]() { Benchmarks::FrustumCulling(); },
+			"Benchmark and check SIMD frustum culling against scalar and DirectXMath tests on synthetic 50k mesh worlds."));
+
+	executeMap.emplace(L"BENCH DRAWLIST",
+		std::make_pair([]() { Benchmarks::DrawListSorting(); },
+			"Benchmark sort-key draw lists against the per-frame distance sort on 20k synthetic draws."));
+
+	executeMap.emplace(L"BENCH TIMERS",
+		std::make_pair([]() { Benchmarks::TimerScheduling(); },
+			"Benchmark and check the timer wheel with 100k active timers against the old vector scan."));
+
+	executeMap.emplace(L"BENCH WORLD LOAD",
+		std::make_pair([]() { Benchmarks::WorldLoading(); },
+			"Benchmark text against binary world loads on the largest maps. Loads those worlds, so save first."));
+
+	executeMap.emplace(L"BENCH PARTICLES",
+		std::make_pair([]() { Benchmarks::ParticleSimulation(); },
+			"Benchmark and check SoA particle updates and instance data against the old per particle tick and matrices."));
+
+	executeMap.emplace(L"CULLING",
+		std::make_pair([]() { Culling::enabled = !Culling::enabled; },
+			"Toggle CPU frustum and distance culling of meshes (stats are in the FPS menu)."));
+
+	executeMap.emplace(L"BAKE LIGHTS",
+		std::make_pair([]() { LightBake::BakeAll(); },
+			"Bake light occlusion into the vertex colours of every static mesh (F4 only re-bakes around changed lights)."));
+
+	executeMap.emplace(L"BAKE AO",
+		std::make_pair([]() { LightBake::settings.aoSamples = LightBake::settings.aoSamples > 0 ? 0 : 16; },
+			"Toggle ambient occlusion in light bakes."));
+
 	executeMap.emplace(L"WIDGET",
 		std::make_pair([]() { debugMenu.widgetDetailsMenuOpen = !debugMenu.widgetDetailsMenuOpen; },
 			"Mouse-over debug details for all rendered widgets in viewport."));
@@ -119,6 +167,10 @@ void Console::Init()
 		std::make_pair([]() { Renderer::RenderLightProbeViews(); },
 			"Work through light probes in map and get their RBG values from a cubemap rendering"));
 
+	executeMap.emplace(L"BAKE CPU",
+		std::make_pair([]() { ProbeBake::BakeDiffuseProbeMap(); },
+			"Bake the light probes in map by tracing them on the CPU instead of rendering cubemaps"));
+
 	executeMap.emplace(L"BIN",
 		std::make_pair([]() { FileSystem::WriteAllSystemsToBinary(); },
 			"Save current world to binary format"));
@@ -131,6 +183,10 @@ void Console::Init()
 		std::make_pair([]() { AssetSystem::BuildAllVMeshDataFromFBXImport(); },
 			"Build meshes as their engine specific file format."));
 
+	executeMap.emplace(L"BUILD MESH COMPRESSED",
+		std::make_pair([]() { AssetSystem::BuildAllVMeshDataFromFBXImport(VertexFormat::Compressed); },
+			"Build meshes with packed normals, colours, half float UVs and 8 bit bone indices."));
+
 	executeMap.emplace(L"BUILD ANIM",
 		std::make_pair([]() { AssetSystem::BuildAllAnimationFilesFromFBXImport(); },
 			"Build meshes as their engine specific file format."));
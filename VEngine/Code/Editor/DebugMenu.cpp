@@ -7,6 +7,8 @@
 #include "Core/VMath.h"
 #include "Editor.h"
 #include "Render/Renderer.h"
+#include "Render/Culling.h"
+#include "Render/DrawList.h"
 #include "Render/TextureSystem.h"
 #include "TransformGizmo.h"
 #include "Core/Core.h"
@@ -21,6 +23,8 @@
 #include "UI/UVPaintWidget.h"
 #include "UI/Layout.h"
 #include "Physics/Raycast.h"
+#include "Physics/WorldBVH.h"
+#include "Physics/TriggerSystem.h"
 #include "Core/World.h"
 #include "Gameplay/GameUtils.h"
 #include "Console.h"
@@ -229,12 +233,12 @@ void DebugMenu::RenderWorldStats()
 
 	for (auto& mesh : MeshComponent::system.GetComponents())
 	{
-		totalVerticesInWorld += mesh->meshDataProxy.vertices.size();
+		totalVerticesInWorld += mesh->meshDataProxy.GetVertexCount();
 	}
 
 	for (auto& instanceMesh : InstanceMeshComponent::system.GetComponents())
 	{
-		totalVerticesInWorld += instanceMesh->meshDataProxy.vertices.size();
+		totalVerticesInWorld += instanceMesh->meshDataProxy.GetVertexCount();
 	}
 
 	ImGui::Text("Vertex Count: %d", totalVerticesInWorld);
@@ -257,6 +261,37 @@ void DebugMenu::RenderWorldStats()
 
 	ImGui::Text("Active Components: %d", componentCount);
 
+	//Mesh cache
+	const auto meshCacheStats = AssetSystem::GetMeshCacheStats();
+	ImGui::Text("Cached Meshes: %llu", meshCacheStats.cachedMeshCount);
+	ImGui::Text("Mesh Cache Hits: %llu | Misses: %llu", meshCacheStats.hits, meshCacheStats.misses);
+	ImGui::Text("Mesh Cache Resident: %.2f KB | Mapped: %.2f KB", meshCacheStats.residentBytes / 1024.0,
+		meshCacheStats.mappedBytes / 1024.0);
+
+	//Meshes that have been vertex painted and hold their own copy of the vertices
+	uint64_t uniqueVertexBytes = 0;
+	for (auto& mesh : MeshComponent::system.GetComponents())
+	{
+		if (mesh->meshDataProxy.HasUniqueVertices())
+		{
+			uniqueVertexBytes += mesh->meshDataProxy.GetVerticesByteWidth();
+		}
+	}
+
+	ImGui::Text("Unique Mesh Vertices: %.2f KB", uniqueVertexBytes / 1024.0);
+
+	//Raycast BVH
+	const auto bvhStats = WorldBVH::GetStats();
+	ImGui::Text("BVH Meshes: %d | Height: %d", bvhStats.proxyCount, bvhStats.treeHeight);
+	ImGui::Text("BVH Refreshes: %llu | Moved: %llu | Reinserts: %llu", bvhStats.refreshCount,
+		bvhStats.movedUpdateCount, bvhStats.reinsertCount);
+
+	//Trigger broadphase
+	const auto triggerStats = TriggerSystem::GetStats();
+	ImGui::Text("Triggers: %d (%d large) | Actors: %d | Cells: %d", triggerStats.triggerCount,
+		triggerStats.largeTriggerCount, triggerStats.actorCount, triggerStats.occupiedCells);
+	ImGui::Text("Trigger Tests: %llu | Overlaps: %llu", triggerStats.containsTests, triggerStats.overlapCount);
+
 	ImGui::End();
 }
 
@@ -493,7 +528,7 @@ void DebugMenu::RenderVertexPaintMenu()
 		{
 			for (auto& mesh : MeshComponent::system.GetComponents())
 			{
-				for (auto& vertex : mesh->GetAllVertices())
+				for (auto& vertex : mesh->GetMutableVertices())
 				{
 					vertex.colour = colour;
 				}
@@ -514,7 +549,7 @@ void DebugMenu::RenderVertexPaintMenu()
 		{
 			for (auto* mesh : pickedActor->GetComponents<MeshComponent>())
 			{
-				for (auto& vertex : mesh->GetAllVertices())
+				for (auto& vertex : mesh->GetMutableVertices())
 				{
 					vertex.colour = WorldEditor::vertexPaintColour;
 				}
@@ -534,7 +569,7 @@ void DebugMenu::RenderVertexPaintMenu()
 		for (auto& mesh : MeshComponent::system.GetComponents())
 		{
 			const auto fillColour = XMLoadFloat4(&WorldEditor::vertexPaintColour);
-			for (auto& vertex : mesh->GetAllVertices())
+			for (auto& vertex : mesh->GetMutableVertices())
 			{
 				auto vertexColour = XMLoadFloat4(&vertex.colour);
 				vertexColour *= fillColour;
@@ -798,6 +833,19 @@ void DebugMenu::RenderFPSMenu(float deltaTime)
 		ImGui::Text("FPS: %d", Core::finalFrameCount);
 		ImGui::Text("Total Frame Time %f | (60 FPS) %f", Profile::GetTotalFrameTime(), 60.0 / 1000.0);
 		ImGui::Text("GPU Render Time: %f", Renderer::frameTime);
+
+		const Culling::Stats& cullingStats = Culling::GetStats();
+		ImGui::Text("Culling (%s): %u/%u meshes visible | %u/%u shadow casters | %f",
+			Culling::enabled ? "ON" : "OFF",
+			cullingStats.visibleMeshes, cullingStats.testedMeshes,
+			cullingStats.visibleShadowCasters, cullingStats.testedShadowCasters, cullingStats.cullTime);
+		ImGui::Text("Instance Culling: %u/%u instances visible",
+			cullingStats.visibleInstances, cullingStats.testedInstances);
+
+		const DrawListStats drawStats = Renderer::GetDrawListStats();
+		ImGui::Text("Draw Lists: %u draws | %u state binds | %u redundant binds skipped",
+			drawStats.draws, drawStats.GetTotalBinds(), drawStats.bindsSaved);
+
 		ImGui::Text("Delta Time (ms): %f", deltaTime);
 		ImGui::Text("Time Since Startup: %f", Core::timeSinceStartup);
 
@@ -24,7 +24,7 @@ bool gBigActorLinkUpgrade;
 
 //...
 
-Properties GameInstance::GetGlobalProps()
+static Properties BuildGlobalProps()
 {
 	Properties props("GameInstance");
 
@@ -36,6 +36,13 @@ Properties GameInstance::GetGlobalProps()
 	return props;
 }
 
+Properties& GameInstance::GetGlobalProps()
+{
+	//Everything in here points at statics, so the map only has to be built once.
+	static Properties props = BuildGlobalProps();
+	return props;
+}
+
 std::string GameInstance::GetHeldPlayerItem()
 {
 	return heldPlayerItem;
@@ -15,7 +15,7 @@ namespace GameInstance
 	extern bool useGameSaves;
 
 	//Global save data
-	Properties GetGlobalProps();
+	Properties& GetGlobalProps();
 
 	//GAME SPECIFIC FUNCS
 	std::string GetHeldPlayerItem();
@@ -27,7 +27,7 @@ namespace GameInstance
 	template <typename T>
 	T* GetGlobalProp(const std::string name)
 	{
-		Properties globalProps = GetGlobalProps();
+		Properties& globalProps = GetGlobalProps();
 		if (globalProps.Find(name))
 		{
 			T* data = globalProps.GetData<T>(name);
@@ -41,7 +41,7 @@ namespace GameInstance
 	template <typename T>
 	void SetGlobalProp(const std::string name, T value)
 	{
-		Properties globalProps = GetGlobalProps();
+		Properties& globalProps = GetGlobalProps();
 		T* data = globalProps.GetData<T>(name);
 		*data = value;
 	}
@@ -83,14 +83,14 @@ namespace GameUtils
 
 	void SaveGameInstanceData()
 	{
-		Properties instanceProps = GameInstance::GetGlobalProps();
+		Properties& instanceProps = GameInstance::GetGlobalProps();
 		Serialiser s(gameInstanceSaveFile, OpenMode::Out);
 		s.Serialise(instanceProps);
 	}
 
 	void LoadGameInstanceData()
 	{
-		Properties instanceProps = GameInstance::GetGlobalProps();
+		Properties& instanceProps = GameInstance::GetGlobalProps();
 		Deserialiser d(gameInstanceSaveFile, OpenMode::In);
 		d.Deserialise(instanceProps);
 	}
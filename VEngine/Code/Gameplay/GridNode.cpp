@@ -22,7 +22,7 @@ void GridNode::Show()
 void GridNode::DisplayHide() const
 {
 	auto grid = Grid::system.GetFirstActor();
-	auto& meshInstanceData = grid->GetNodeMeshInstanceData().at(instancedMeshIndex);
+	auto& meshInstanceData = grid->GetNodeMeshInstance(instancedMeshIndex);
 
 	meshInstanceData.world.r[0].m128_f32[0] = 0.f;
 	meshInstanceData.world.r[1].m128_f32[1] = 0.f;
@@ -32,7 +32,7 @@ void GridNode::DisplayHide() const
 void GridNode::DisplayShow() const
 {
 	auto grid = Grid::system.GetFirstActor();
-	auto& meshInstanceData = grid->GetNodeMeshInstanceData().at(instancedMeshIndex);
+	auto& meshInstanceData = grid->GetNodeMeshInstance(instancedMeshIndex);
 
 	meshInstanceData.world.r[0].m128_f32[0] = 0.9f;
 	meshInstanceData.world.r[1].m128_f32[1] = 0.9f;
@@ -47,6 +47,7 @@ void GridNode::RecalcNodeHeight(HitResult& hitResult)
 	hitResult.AddActorsToIgnore(waterVolumes);
 	hitResult.actorsToIgnore.emplace_back(Player::system.GetOnlyActor());
 
+	//Single node updates happen during gameplay, the batch setup is only worth it for Grid::RecalcAllNodes().
 	if (Physics::Raycast(hitResult, origin, -VMath::GlobalUpVector(), 40.f))
 	{
 		for (auto mesh : hitResult.hitActor->GetComponents<MeshComponent>())
@@ -59,7 +60,7 @@ void GridNode::RecalcNodeHeight(HitResult& hitResult)
 		}
 
 		auto grid = Grid::system.GetFirstActor();
-		auto& meshInstanceData = grid->GetNodeMeshInstanceData().at(instancedMeshIndex);
+		auto& meshInstanceData = grid->GetNodeMeshInstance(instancedMeshIndex);
 
 		XMFLOAT3 hitPos = hitResult.hitPos;
 		hitPos.y += 0.1f;
@@ -76,7 +77,7 @@ void GridNode::RecalcNodeHeight(HitResult& hitResult)
 void GridNode::SetColour(XMFLOAT4 newColour) const
 {
 	auto grid = Grid::system.GetFirstActor();
-	auto& meshInstanceData = grid->GetNodeMeshInstanceData().at(instancedMeshIndex);
+	auto& meshInstanceData = grid->GetNodeMeshInstance(instancedMeshIndex);
 
 	meshInstanceData.colour = newColour;
 }
@@ -16,7 +16,7 @@ void TownStart()
 			for (auto& mesh : MeshComponent::system.GetComponents())
 			{
 				const auto fillColour = XMLoadFloat4(&colour);
-				for (auto& vertex : mesh->GetAllVertices())
+				for (auto& vertex : mesh->GetMutableVertices())
 				{
 					auto vertexColour = XMLoadFloat4(&vertex.colour);
 					vertexColour *= fillColour;
@@ -7,4 +7,7 @@ namespace Locales
 	inline static const std::string english = "EN";
 	inline static const std::string japanese = "JP";
 	inline static const std::string french = "FR";
+
+	//Every locale gets a compiled string table per localisation file, even when the file has no strings for it.
+	inline static const std::string all[] = { english, japanese, french };
 }
@@ -1,69 +1,214 @@
 #include "vpch.h"
 #include "Localisation.h"
+#include "StringTable.h"
 #include "Core/Log.h"
+#include "Core/Profile.h"
+#include <filesystem>
 #include <qfile.h>
 #include <qjsonarray.h>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
 #include "Asset/AssetBaseFolders.h"
+#include "Asset/AssetFileExtensions.h"
+
+//String tables for one locale, keyed by localisation filename. A null table means the file couldn't be loaded.
+using LocaleTables = std::unordered_map<std::string, std::unique_ptr<StringTable>>;
 
 std::string gLanguage = Locales::english;
 
-std::unordered_map<std::string, std::wstring> gLocalisedStringsCache;
+std::unordered_map<std::string, LocaleTables> gLocaleTables;
+LocaleTables* gActiveLocaleTables = &gLocaleTables[Locales::english];
 
-std::wstring Localise::GetString(const std::string& key, const std::string& filename)
+static std::string GetStringTablePath(const std::string& filename, const std::string& locale)
+{
+	const std::string stem = std::filesystem::path(filename).stem().string();
+	return AssetBaseFolders::dialogue + stem + "." + locale + AssetFileExtensions::stringTable;
+}
+
+//0 when the JSON file doesn't exist, in which case existing tables are used as they are.
+static int64_t GetSourceWriteTime(const std::string& filePath)
 {
-	auto stringCacheIt = gLocalisedStringsCache.find(key);
-	if (stringCacheIt != gLocalisedStringsCache.end())
+	std::error_code error;
+	const auto writeTime = std::filesystem::last_write_time(filePath, error);
+	if (error)
 	{
-		return stringCacheIt->second;
+		return 0;
 	}
+	return writeTime.time_since_epoch().count();
+}
 
+//Parses the JSON file once and writes a string table for each locale.
+static bool CompileStringTables(const std::string& filename, int64_t sourceWriteTime)
+{
 	const std::string filePath = AssetBaseFolders::dialogue + filename;
 	QFile file(filePath.c_str());
 
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) 
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
 	{
 		Log("Json file [%s] not found for localisation", filePath.c_str());
-		return L"JSON_FILE_NOT_FOUND";
+		return false;
 	}
 
 	QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+	file.close();
 
 	//Get the root JSON element in the file
 	QJsonObject rootObject = doc.object();
 
-	//Find object with matching key
-	if (!rootObject.contains(key.c_str()))
+	bool compiled = true;
+
+	for (const std::string& locale : Locales::all)
 	{
-		Log("Localisation key [%s] not found in file [%s]", key.c_str(), filePath.c_str());
-		return L"LOCALISATION_KEY_NOT_FOUND";
+		std::vector<StringTable::Entry> entries;
+		entries.reserve(rootObject.size());
+
+		for (auto it = rootObject.constBegin(); it != rootObject.constEnd(); ++it)
+		{
+			QJsonObject stringObject = it.value().toArray()[0].toObject();
+			if (!stringObject.contains(locale.c_str()))
+			{
+				continue;
+			}
+
+			const QString value = stringObject.value(locale.c_str()).toString();
+
+			StringTable::Entry entry;
+			entry.key = it.key().toStdString();
+			entry.string.assign(reinterpret_cast<const char16_t*>(value.utf16()), value.size());
+			if (!entry.key.empty())
+			{
+				entries.emplace_back(std::move(entry));
+			}
+		}
+
+		compiled &= StringTable::Write(GetStringTablePath(filename, locale), sourceWriteTime, entries);
 	}
-	QJsonArray stringArray = rootObject.value(key.c_str()).toArray();
 
-	//Make sure the language entry exists for this string
-	QJsonObject stringObject = stringArray[0].toObject();
-	if (!stringObject.contains(gLanguage.c_str()))
+	Log("Compiled string tables for %s", filePath.c_str());
+	return compiled;
+}
+
+//Maps the tables for every locale of a localisation file, compiling them first if the JSON is newer.
+static void LoadStringTables(const std::string& filename)
+{
+	const int64_t sourceWriteTime = GetSourceWriteTime(AssetBaseFolders::dialogue + filename);
+
+	bool needsCompile = false;
+	for (const std::string& locale : Locales::all)
+	{
+		auto table = std::make_unique<StringTable>();
+		if (!table->Open(GetStringTablePath(filename, locale)))
+		{
+			table.reset();
+		}
+
+		if (sourceWriteTime != 0 && (table == nullptr || table->GetSourceWriteTime() != sourceWriteTime))
+		{
+			needsCompile = true;
+		}
+
+		gLocaleTables[locale][filename] = std::move(table);
+	}
+
+	if (!needsCompile)
 	{
-		Log("Language key [%s] not found for in file [%s] in key [%s]", gLanguage.c_str(), filePath.c_str(), key.c_str());
-		return L"LANGUAGE_KEY_NOT_FOUND";
+		return;
 	}
 
-	std::wstring ouputValue = stringObject.value(gLanguage.c_str()).toString().toStdWString();
+	//Mapped files can't be replaced.
+	for (const std::string& locale : Locales::all)
+	{
+		gLocaleTables[locale][filename].reset();
+	}
 
-	gLocalisedStringsCache.emplace(key, ouputValue);
+	CompileStringTables(filename, sourceWriteTime);
 
-	file.close();
+	for (const std::string& locale : Locales::all)
+	{
+		auto table = std::make_unique<StringTable>();
+		if (table->Open(GetStringTablePath(filename, locale)))
+		{
+			gLocaleTables[locale][filename] = std::move(table);
+		}
+	}
+}
+
+void Localise::Init()
+{
+	const auto startTime = Profile::QuickStart();
+
+	size_t fileCount = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(AssetBaseFolders::dialogue))
+	{
+		if (entry.path().extension() == ".json")
+		{
+			LoadStringTables(entry.path().filename().string());
+			fileCount++;
+		}
+	}
+
+	gActiveLocaleTables = &gLocaleTables[gLanguage];
+
+	const double elapsed = Profile::QuickEnd(startTime);
+	Log("Localisation string tables for %zu files loaded in %f seconds", fileCount, elapsed);
+}
+
+std::wstring Localise::GetString(const std::string& key, const std::string& filename)
+{
+	auto tableIt = gActiveLocaleTables->find(filename);
+	if (tableIt == gActiveLocaleTables->end())
+	{
+		//Files added after Init().
+		LoadStringTables(filename);
+		tableIt = gActiveLocaleTables->try_emplace(filename).first;
+	}
+
+	const StringTable* table = tableIt->second.get();
+
+	std::u16string_view value;
+	if (table != nullptr && table->Find(key, value))
+	{
+		return std::wstring(value.begin(), value.end());
+	}
 
-	return ouputValue;
+	const std::string filePath = AssetBaseFolders::dialogue + filename;
+
+	//Misses only happen for broken keys, so it's fine to look through the other locales to tell which kind it is.
+	bool foundInAnyTable = false;
+	bool foundInOtherLocale = false;
+	for (const auto& [locale, localeTables] : gLocaleTables)
+	{
+		auto otherTableIt = localeTables.find(filename);
+		if (otherTableIt != localeTables.end() && otherTableIt->second != nullptr)
+		{
+			foundInAnyTable = true;
+			std::u16string_view otherValue;
+			foundInOtherLocale |= otherTableIt->second->Find(key, otherValue);
+		}
+	}
+
+	if (!foundInAnyTable)
+	{
+		Log("Json file [%s] not found for localisation", filePath.c_str());
+		return L"JSON_FILE_NOT_FOUND";
+	}
+
+	if (!foundInOtherLocale)
+	{
+		Log("Localisation key [%s] not found in file [%s]", key.c_str(), filePath.c_str());
+		return L"LOCALISATION_KEY_NOT_FOUND";
+	}
+
+	Log("Language key [%s] not found for in file [%s] in key [%s]", gLanguage.c_str(), filePath.c_str(), key.c_str());
+	return L"LANGUAGE_KEY_NOT_FOUND";
 }
 
 void Localise::SetLanguage(const std::string_view language)
 {
 	gLanguage = language;
-	Log("Locale set to [%s]", language.data());
-	
-	//Clear out the string cache because if locales are changed, keys will be fetching 
-	//previous values from the previously set locale.
-	gLocalisedStringsCache.clear();
+	Log("Locale set to [%s]", gLanguage.c_str());
+
+	//Every locale's tables are already mapped, so this is just a swap. Unknown locales get an empty set of tables
+	//and every lookup reports the missing language.
+	gActiveLocaleTables = &gLocaleTables[gLanguage];
 }
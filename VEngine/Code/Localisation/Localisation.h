@@ -9,8 +9,14 @@
 //work for once off static text. Think about where a JSON string localisation system can go and
 //whether it can replace .dialogue files entirely.
 
+//Strings are read from compiled per-locale tables (see StringTable.h) that are built from the JSON files in
+//the Dialogue folder the first time they're needed and again whenever the JSON changes.
 namespace Localise
 {
+	//Compiles out of date string tables and maps every locale's tables so that lookups never touch the JSON.
+	void Init();
+
 	std::wstring GetString(const std::string& key, const std::string& filename);
+	//Only swaps which locale's tables are searched.
 	void SetLanguage(const std::string_view language);
 };
@@ -0,0 +1,201 @@
+#include "vpch.h"
+#include "StringTable.h"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include "Core/Log.h"
+
+static constexpr uint32_t tableAlignment = 8;
+
+static uint32_t AlignOffset(size_t offset)
+{
+	return static_cast<uint32_t>((offset + tableAlignment - 1) & ~static_cast<size_t>(tableAlignment - 1));
+}
+
+//64-bit FNV-1a, keys are short ASCII identifiers.
+uint64_t StringTable::HashKey(std::string_view key)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (const char c : key)
+	{
+		hash ^= static_cast<uint8_t>(c);
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool StringTable::Write(const std::string& filepath, int64_t sourceWriteTime, const std::vector<Entry>& entries)
+{
+	StringTableHeader header;
+	header.sourceWriteTime = sourceWriteTime;
+	header.entryCount = static_cast<uint32_t>(entries.size());
+	header.bucketCount = std::bit_ceil(std::max<uint32_t>(header.entryCount * 2, 8));
+
+	std::vector<StringTableBucket> buckets(header.bucketCount);
+	std::string keyData;
+	std::u16string stringData;
+
+	for (const Entry& entry : entries)
+	{
+		assert(!entry.key.empty());
+
+		const uint64_t hash = HashKey(entry.key);
+		uint32_t bucketIndex = static_cast<uint32_t>(hash) & (header.bucketCount - 1);
+		while (buckets[bucketIndex].keyLength != 0)
+		{
+			const StringTableBucket& existing = buckets[bucketIndex];
+			if (existing.keyHash == hash && keyData.compare(existing.keyOffset, existing.keyLength, entry.key) == 0)
+			{
+				Log("Duplicate localisation key [%s] in %s, keeping the first one.", entry.key.c_str(), filepath.c_str());
+				break;
+			}
+			bucketIndex = (bucketIndex + 1) & (header.bucketCount - 1);
+		}
+
+		StringTableBucket& bucket = buckets[bucketIndex];
+		if (bucket.keyLength != 0)
+		{
+			header.entryCount--;
+			continue;
+		}
+
+		bucket.keyHash = hash;
+		bucket.keyOffset = static_cast<uint32_t>(keyData.size());
+		bucket.keyLength = static_cast<uint32_t>(entry.key.size());
+		bucket.stringOffset = static_cast<uint32_t>(stringData.size());
+		bucket.stringLength = static_cast<uint32_t>(entry.string.size());
+		keyData += entry.key;
+		stringData += entry.string;
+	}
+
+	header.bucketsOffset = AlignOffset(sizeof(StringTableHeader));
+	header.keysOffset = AlignOffset(header.bucketsOffset + sizeof(StringTableBucket) * buckets.size());
+	header.stringsOffset = AlignOffset(header.keysOffset + keyData.size());
+	header.fileSize = AlignOffset(header.stringsOffset + stringData.size() * sizeof(char16_t));
+
+	std::vector<uint8_t> fileData(header.fileSize);
+	memcpy(fileData.data(), &header, sizeof(StringTableHeader));
+	memcpy(fileData.data() + header.bucketsOffset, buckets.data(), sizeof(StringTableBucket) * buckets.size());
+	memcpy(fileData.data() + header.keysOffset, keyData.data(), keyData.size());
+	memcpy(fileData.data() + header.stringsOffset, stringData.data(), stringData.size() * sizeof(char16_t));
+
+	const std::string tempFilepath = filepath + ".tmp";
+
+	FILE* file = nullptr;
+	fopen_s(&file, tempFilepath.c_str(), "wb");
+	if (file == nullptr)
+	{
+		Log("Couldn't write string table %s.", tempFilepath.c_str());
+		return false;
+	}
+	const size_t bytesWritten = fwrite(fileData.data(), 1, fileData.size(), file);
+	fclose(file);
+	if (bytesWritten != fileData.size())
+	{
+		Log("Couldn't write string table %s.", tempFilepath.c_str());
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempFilepath, filepath, error);
+	if (error)
+	{
+		Log("Couldn't replace %s, it's probably loaded. New strings are in %s.", filepath.c_str(), tempFilepath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool StringTable::Open(const std::string& filepath)
+{
+	Close();
+
+	if (!mappedFile.Open(filepath))
+	{
+		return false;
+	}
+
+	const uint8_t* data = mappedFile.GetData();
+	const size_t size = mappedFile.GetSize();
+
+	const auto fileHeader = reinterpret_cast<const StringTableHeader*>(data);
+	if (size < sizeof(StringTableHeader) ||
+		fileHeader->magic != StringTableHeader::MAGIC ||
+		fileHeader->version != StringTableHeader::CURRENT_VERSION ||
+		fileHeader->fileSize != size ||
+		!std::has_single_bit(fileHeader->bucketCount) ||
+		fileHeader->bucketsOffset + sizeof(StringTableBucket) * fileHeader->bucketCount > fileHeader->keysOffset ||
+		fileHeader->keysOffset > fileHeader->stringsOffset || fileHeader->stringsOffset > size ||
+		fileHeader->bucketsOffset % tableAlignment != 0 || fileHeader->stringsOffset % tableAlignment != 0)
+	{
+		Log("String table %s is out of date or damaged.", filepath.c_str());
+		mappedFile.Close();
+		return false;
+	}
+
+	//Every bucket is read in place by Find(), so make sure none of them point outside the file.
+	const auto fileBuckets = reinterpret_cast<const StringTableBucket*>(data + fileHeader->bucketsOffset);
+	const uint64_t keyDataSize = fileHeader->stringsOffset - fileHeader->keysOffset;
+	const uint64_t stringDataLength = (size - fileHeader->stringsOffset) / sizeof(char16_t);
+	for (uint32_t bucketIndex = 0; bucketIndex < fileHeader->bucketCount; bucketIndex++)
+	{
+		const StringTableBucket& bucket = fileBuckets[bucketIndex];
+		if (bucket.keyLength != 0 &&
+			((uint64_t)bucket.keyOffset + bucket.keyLength > keyDataSize ||
+			(uint64_t)bucket.stringOffset + bucket.stringLength > stringDataLength))
+		{
+			Log("String table %s is out of date or damaged.", filepath.c_str());
+			mappedFile.Close();
+			return false;
+		}
+	}
+
+	header = fileHeader;
+	buckets = fileBuckets;
+	keys = reinterpret_cast<const char*>(data + header->keysOffset);
+	strings = reinterpret_cast<const char16_t*>(data + header->stringsOffset);
+	return true;
+}
+
+void StringTable::Close()
+{
+	mappedFile.Close();
+	header = nullptr;
+	buckets = nullptr;
+	keys = nullptr;
+	strings = nullptr;
+}
+
+bool StringTable::Find(std::string_view key, std::u16string_view& outString) const
+{
+	if (header == nullptr || key.empty())
+	{
+		return false;
+	}
+
+	const uint64_t hash = HashKey(key);
+	const uint32_t mask = header->bucketCount - 1;
+
+	//Written tables are at most half full and stop on an empty bucket, the probe count only stops a damaged
+	//full table from looping forever.
+	uint32_t bucketIndex = static_cast<uint32_t>(hash) & mask;
+	for (uint32_t probe = 0; probe < header->bucketCount; probe++)
+	{
+		const StringTableBucket& bucket = buckets[bucketIndex];
+		if (bucket.keyLength == 0)
+		{
+			return false;
+		}
+
+		if (bucket.keyHash == hash && std::string_view(keys + bucket.keyOffset, bucket.keyLength) == key)
+		{
+			outString = std::u16string_view(strings + bucket.stringOffset, bucket.stringLength);
+			return true;
+		}
+
+		bucketIndex = (bucketIndex + 1) & mask;
+	}
+
+	return false;
+}
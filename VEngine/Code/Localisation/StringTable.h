@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Core/MappedFile.h"
+
+//Compiled .vloc files hold every string of one localisation JSON file for one locale. The header is
+//followed by an open-addressed hash index, the keys (UTF-8, each stored once) and the strings (UTF-16).
+//Everything is at 8 byte aligned offsets so the file is memory-mapped and read in place.
+struct StringTableHeader
+{
+	inline static const uint32_t MAGIC = 0x434F4C56; //"VLOC" in file order
+	inline static const uint32_t CURRENT_VERSION = 1;
+
+	uint32_t magic = MAGIC;
+	uint32_t version = CURRENT_VERSION;
+
+	//Last write time of the JSON file the table was compiled from, the table is rebuilt when they differ.
+	int64_t sourceWriteTime = 0;
+
+	uint32_t entryCount = 0;
+	uint32_t bucketCount = 0; //Power of two, at most half full so probes stay short
+	uint32_t bucketsOffset = 0;
+	uint32_t keysOffset = 0;
+	uint32_t stringsOffset = 0;
+	uint32_t fileSize = 0;
+};
+
+//Empty buckets have a keyLength of 0, empty keys are never written.
+struct StringTableBucket
+{
+	uint64_t keyHash = 0;
+	uint32_t keyOffset = 0; //Bytes from keysOffset
+	uint32_t keyLength = 0;
+	uint32_t stringOffset = 0; //char16_t elements from stringsOffset
+	uint32_t stringLength = 0;
+};
+
+//Read-only view of a mapped .vloc file.
+class StringTable
+{
+public:
+	struct Entry
+	{
+		std::string key;
+		std::u16string string;
+	};
+
+	static uint64_t HashKey(std::string_view key);
+
+	static bool Write(const std::string& filepath, int64_t sourceWriteTime, const std::vector<Entry>& entries);
+
+	//Fails on missing, truncated or old version files, in which case the table should be compiled again.
+	bool Open(const std::string& filepath);
+	void Close();
+
+	bool IsOpen() const { return header != nullptr; }
+	int64_t GetSourceWriteTime() const { return header->sourceWriteTime; }
+	uint32_t GetEntryCount() const { return header->entryCount; }
+
+	bool Find(std::string_view key, std::u16string_view& outString) const;
+
+private:
+	MappedFile mappedFile;
+	const StringTableHeader* header = nullptr;
+	const StringTableBucket* buckets = nullptr;
+	const char* keys = nullptr;
+	const char16_t* strings = nullptr;
+};
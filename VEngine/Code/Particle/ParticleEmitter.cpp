@@ -3,6 +3,7 @@
 #include "Core/VMath.h"
 #include "Render/Material.h"
 #include "Render/MaterialSystem.h"
+#include "Render/RenderUtils.h"
 
 ParticleEmitter::ParticleEmitter(std::string textureFilename, std::string shaderItemName)
 {
@@ -17,6 +18,10 @@ void ParticleEmitter::Create()
 void ParticleEmitter::Destroy()
 {
 	_material->Destroy();
+
+	instanceBuffer.Reset();
+	instanceSrv.Reset();
+	instanceBufferCapacity = 0;
 }
 
 void ParticleEmitter::Start()
@@ -31,46 +36,15 @@ void ParticleEmitter::Tick(float deltaTime)
 	const float spawnRateRange = VMath::RandomRange(particleData.spawnRate.x, particleData.spawnRate.y);
 	if (spawnTimer > spawnRateRange)
 	{
-		Particle particle = {};
-
 		//Get the world position instead of relative
-		const XMMATRIX worldMatrix = this->GetWorldMatrix();
-		XMStoreFloat3(&particle.transform.position, worldMatrix.r[3]);
-
-		particle.SetParticleRangeData(particleData);
-
-		particles.emplace_back(particle);
+		XMFLOAT3 emitterPosition;
+		XMStoreFloat3(&emitterPosition, GetWorldMatrix().r[3]);
+		particlePool.Spawn(emitterPosition, particleData);
 
 		spawnTimer = 0.f;
 	}
 
-	for (auto& particle : particles)
-	{
-		particle.lifetime += deltaTime;
-
-		//Get random range between lifetimes
-		const float lifetimeRange = VMath::RandomRange(particleData.lifetime.x, particleData.lifetime.y);
-
-		constexpr float lifetimeAlphaSpeed = 5.f;
-		if (particle.lifetime > (lifetimeRange / 1.5f))
-		{
-			particle.alpha -= deltaTime * lifetimeAlphaSpeed;
-		}
-		else
-		{
-			particle.alpha += deltaTime * lifetimeAlphaSpeed;
-		}
-		particle.alpha = std::clamp(particle.alpha, 0.f, 1.f);
-
-		if (particle.lifetime > lifetimeRange)
-		{
-			std::swap(particle, particles.back());
-			particles.pop_back();
-		}
-
-		particle.angle += particle.rotateSpeed * deltaTime;
-		particle.AddVelocity(deltaTime);
-	}
+	particlePool.Update(deltaTime);
 
 	emitterLifetimeTimer += deltaTime;
 	if (emitterLifetime > 0.f && emitterLifetimeTimer > emitterLifetime)
@@ -79,6 +53,25 @@ void ParticleEmitter::Tick(float deltaTime)
 	}
 }
 
+void ParticleEmitter::BuildInstanceData()
+{
+	const uint32_t particleCount = static_cast<uint32_t>(particlePool.GetCount());
+	instanceData.resize(particleCount);
+	particlePool.WriteInstanceData(instanceData.data());
+
+	if (instanceBuffer && particleCount <= instanceBufferCapacity)
+	{
+		return;
+	}
+
+	//Grow geometrically, emitters spawn a particle at a time and would otherwise recreate the buffer every spawn.
+	instanceBufferCapacity = std::max({ particleCount, instanceBufferCapacity * 2, 16u });
+
+	RenderUtils::CreateStructuredBuffer(sizeof(ParticleInstanceData) * instanceBufferCapacity,
+		sizeof(ParticleInstanceData), nullptr, instanceBuffer);
+	RenderUtils::CreateSRVForMeshInstance(instanceBuffer.Get(), instanceBufferCapacity, instanceSrv);
+}
+
 Properties ParticleEmitter::GetProps()
 {
 	auto props = __super::GetProps();
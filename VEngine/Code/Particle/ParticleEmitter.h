@@ -2,11 +2,15 @@
 
 #include "Components/SpatialComponent.h"
 #include "Components/ComponentSystem.h"
-#include "Particle.h"
+#include "ParticlePool.h"
 #include "Render/ShaderItem.h"
+#include "Render/ShaderData/InstanceData.h"
 #include "ParticleData.h"
+#include <wrl.h>
 
 class Material;
+struct ID3D11Buffer;
+struct ID3D11ShaderResourceView;
 
 class ParticleEmitter : public SpatialComponent
 {
@@ -26,8 +30,15 @@ public:
 
 	void SetTexture(std::string_view textureFilename);
 
-	auto GetParticleCount() const { return particles.size(); }
-	std::vector<Particle> particles;
+	auto GetParticleCount() const { return particlePool.GetCount(); }
+	ParticlePool particlePool;
+
+	//Fills instanceData from the pool and grows instanceBuffer to fit it. The renderer maps the buffer and draws
+	//every particle in the emitter with one instanced draw.
+	void BuildInstanceData();
+	std::vector<ParticleInstanceData> instanceData;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> instanceSrv;
 
 	ParticleData particleData;
 
@@ -39,4 +50,6 @@ private:
 
 	float spawnTimer = 0.f;
 	float emitterLifetimeTimer = 0.f;
+
+	uint32_t instanceBufferCapacity = 0;
 };
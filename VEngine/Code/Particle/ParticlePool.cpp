@@ -0,0 +1,116 @@
+#include "vpch.h"
+#include "ParticlePool.h"
+#include "Core/VMath.h"
+#include "ParticleData.h"
+#include "Render/ShaderData/InstanceData.h"
+
+//How fast particles fade in at the start of their life and out at the end, alpha per second.
+static constexpr float lifetimeAlphaSpeed = 5.f;
+
+void ParticlePool::Spawn(const XMFLOAT3& emitterPosition, const ParticleData& particleData)
+{
+	if (count == streams[0].size())
+	{
+		const size_t capacity = std::max<size_t>(16, count * 2);
+		for (auto& stream : streams)
+		{
+			stream.resize(capacity);
+		}
+	}
+
+	const size_t i = count++;
+
+	//Same order of rolls as the old Particle::SetParticleRangeData()
+	streams[PositionX][i] = emitterPosition.x + VMath::RandomRange(particleData.spawnRadius.x, particleData.spawnRadius.y);
+	streams[PositionY][i] = emitterPosition.y + VMath::RandomRange(particleData.spawnRadius.x, particleData.spawnRadius.y);
+	streams[PositionZ][i] = emitterPosition.z + VMath::RandomRange(particleData.spawnRadius.x, particleData.spawnRadius.y);
+
+	const float moveSpeed = VMath::RandomRange(particleData.moveSpeed.x, particleData.moveSpeed.y);
+	streams[Angle][i] = VMath::RandomRange(particleData.rotation.x, particleData.rotation.y);
+	streams[RotateSpeed][i] = VMath::RandomRange(particleData.rotateSpeed.x, particleData.rotateSpeed.y);
+
+	const XMFLOAT3 direction = VMath::RandomRangeFloat3(particleData.minDirection, particleData.maxDirection);
+	streams[VelocityX][i] = direction.x * moveSpeed;
+	streams[VelocityY][i] = direction.y * moveSpeed;
+	streams[VelocityZ][i] = direction.z * moveSpeed;
+
+	const float lifetime = VMath::RandomRange(particleData.lifetime.x, particleData.lifetime.y);
+	streams[Lifetime][i] = lifetime;
+	streams[FadeOutAge][i] = lifetime / 1.5f;
+	streams[Age][i] = 0.f;
+	streams[Alpha][i] = 0.f;
+}
+
+void ParticlePool::Update(float deltaTime)
+{
+	const auto load = [this](Stream stream, size_t index)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&streams[stream][index]));
+		};
+	const auto store = [this](Stream stream, size_t index, FXMVECTOR value)
+		{
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&streams[stream][index]), value);
+		};
+
+	const XMVECTOR dt = XMVectorReplicate(deltaTime);
+	const XMVECTOR fadeIn = XMVectorReplicate(deltaTime * lifetimeAlphaSpeed);
+	const XMVECTOR fadeOut = XMVectorNegate(fadeIn);
+
+	for (size_t i = 0; i < count; i += 4)
+	{
+		const XMVECTOR age = load(Age, i) + dt;
+		store(Age, i, age);
+
+		const XMVECTOR fadingOut = XMVectorGreater(age, load(FadeOutAge, i));
+		store(Alpha, i, XMVectorSaturate(load(Alpha, i) + XMVectorSelect(fadeIn, fadeOut, fadingOut)));
+
+		store(Angle, i, XMVectorMultiplyAdd(load(RotateSpeed, i), dt, load(Angle, i)));
+
+		store(PositionX, i, XMVectorMultiplyAdd(load(VelocityX, i), dt, load(PositionX, i)));
+		store(PositionY, i, XMVectorMultiplyAdd(load(VelocityY, i), dt, load(PositionY, i)));
+		store(PositionZ, i, XMVectorMultiplyAdd(load(VelocityZ, i), dt, load(PositionZ, i)));
+	}
+
+	Compact();
+}
+
+void ParticlePool::Compact()
+{
+	const float* age = streams[Age].data();
+	const float* lifetime = streams[Lifetime].data();
+
+	//Most frames nothing expires, or only the oldest few at the front.
+	size_t firstExpired = 0;
+	while (firstExpired < count && age[firstExpired] <= lifetime[firstExpired])
+	{
+		firstExpired++;
+	}
+
+	size_t alive = firstExpired;
+	for (size_t i = firstExpired; i < count; i++)
+	{
+		if (age[i] > lifetime[i])
+		{
+			continue;
+		}
+
+		for (auto& stream : streams)
+		{
+			stream[alive] = stream[i];
+		}
+		alive++;
+	}
+
+	count = alive;
+}
+
+void ParticlePool::WriteInstanceData(ParticleInstanceData* outInstances) const
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		ParticleInstanceData& instance = outInstances[i];
+		instance.position = XMFLOAT3(streams[PositionX][i], streams[PositionY][i], streams[PositionZ][i]);
+		instance.angle = streams[Angle][i];
+		instance.colour = XMFLOAT4(1.f, 1.f, 1.f, streams[Alpha][i]);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+
+struct ParticleData;
+struct ParticleInstanceData;
+
+//Live particles for one ParticleEmitter, stored as a structure of arrays so Update() can step four particles
+//per DirectXMath vector instead of one Particle (and its Transform) at a time.
+//Every stream is sized to a multiple of four, lanes past GetCount() are padding and never read back.
+class ParticlePool
+{
+public:
+	//Ranges in particleData, lifetime included, are rolled once here and kept for the particle's life.
+	void Spawn(const DirectX::XMFLOAT3& emitterPosition, const ParticleData& particleData);
+
+	//Ages, fades, rotates and moves every particle, then drops expired ones. Survivors keep their spawn order
+	//so draw order (and so transparency) doesn't jump around between frames.
+	void Update(float deltaTime);
+
+	void WriteInstanceData(ParticleInstanceData* outInstances) const;
+
+	void Clear() { count = 0; }
+	size_t GetCount() const { return count; }
+
+private:
+	enum Stream
+	{
+		PositionX,
+		PositionY,
+		PositionZ,
+		VelocityX,
+		VelocityY,
+		VelocityZ,
+		Age,
+		Lifetime,
+		FadeOutAge, //Alpha fades in until here, then back out
+		Alpha,
+		Angle,
+		RotateSpeed,
+		StreamCount
+	};
+
+	void Compact();
+
+	std::vector<float> streams[StreamCount];
+	size_t count = 0;
+};
@@ -0,0 +1,504 @@
+#include "vpch.h"
+#include "BVH.h"
+#include <algorithm>
+#include <limits>
+
+using namespace DirectX;
+
+//Past this depth triangles are left in whatever leaf they're in. Keeps TriangleBVH::QueryRay()'s stack fixed.
+static constexpr uint32_t maxTriangleBVHDepth = 48;
+static constexpr uint32_t maxTrianglesPerLeaf = 4;
+
+BVH::AABB BVH::AABB::FromBoundingBox(const BoundingBox& bb)
+{
+	AABB box;
+	box.min = XMFLOAT3(bb.Center.x - bb.Extents.x, bb.Center.y - bb.Extents.y, bb.Center.z - bb.Extents.z);
+	box.max = XMFLOAT3(bb.Center.x + bb.Extents.x, bb.Center.y + bb.Extents.y, bb.Center.z + bb.Extents.z);
+	return box;
+}
+
+BVH::AABB BVH::AABB::FromOrientedBox(const BoundingOrientedBox& obb)
+{
+	XMFLOAT3 corners[BoundingOrientedBox::CORNER_COUNT];
+	obb.GetCorners(corners);
+
+	BoundingBox bb;
+	BoundingBox::CreateFromPoints(bb, BoundingOrientedBox::CORNER_COUNT, corners, sizeof(XMFLOAT3));
+	return FromBoundingBox(bb);
+}
+
+BVH::AABB BVH::AABB::Union(const AABB& a, const AABB& b)
+{
+	AABB box;
+	box.min = XMFLOAT3(std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z));
+	box.max = XMFLOAT3(std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z));
+	return box;
+}
+
+bool BVH::AABB::Contains(const AABB& other) const
+{
+	return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+		max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+}
+
+bool BVH::AABB::Overlaps(const AABB& other) const
+{
+	return min.x <= other.max.x && max.x >= other.min.x &&
+		min.y <= other.max.y && max.y >= other.min.y &&
+		min.z <= other.max.z && max.z >= other.min.z;
+}
+
+float BVH::AABB::SurfaceArea() const
+{
+	const float x = max.x - min.x;
+	const float y = max.y - min.y;
+	const float z = max.z - min.z;
+	return 2.f * (x * y + y * z + z * x);
+}
+
+void BVH::AABB::Expand(float margin)
+{
+	min.x -= margin; min.y -= margin; min.z -= margin;
+	max.x += margin; max.y += margin; max.z += margin;
+}
+
+BVH::Ray::Ray(FXMVECTOR origin_, FXMVECTOR direction_, float maxDistance_) : maxDistance(maxDistance_)
+{
+	XMStoreFloat3(&origin, origin_);
+
+	//Division by a zero component gives +/-inf which the slab test below handles.
+	XMFLOAT3 direction;
+	XMStoreFloat3(&direction, direction_);
+	invDirection = XMFLOAT3(1.f / direction.x, 1.f / direction.y, 1.f / direction.z);
+}
+
+bool BVH::Ray::Intersects(const AABB& box, float& tNear) const
+{
+	float tMin = 0.f;
+	float tMax = maxDistance;
+
+	const float* o = &origin.x;
+	const float* inv = &invDirection.x;
+	const float* bMin = &box.min.x;
+	const float* bMax = &box.max.x;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float t0 = (bMin[axis] - o[axis]) * inv[axis];
+		float t1 = (bMax[axis] - o[axis]) * inv[axis];
+		if (t0 > t1)
+		{
+			std::swap(t0, t1);
+		}
+
+		//NaN (0 * inf) fails both compares and leaves the range as is, which is what's wanted for
+		//a ray running along a slab's plane.
+		if (t0 > tMin) tMin = t0;
+		if (t1 < tMax) tMax = t1;
+
+		if (tMin > tMax)
+		{
+			return false;
+		}
+	}
+
+	tNear = tMin;
+	return true;
+}
+
+//DynamicAABBTree
+
+int DynamicAABBTree::AllocateNode()
+{
+	if (freeList == nullNode)
+	{
+		nodes.emplace_back();
+		return static_cast<int>(nodes.size() - 1);
+	}
+
+	const int nodeId = freeList;
+	freeList = nodes[nodeId].parentOrNext;
+	nodes[nodeId] = Node();
+	return nodeId;
+}
+
+void DynamicAABBTree::FreeNode(int nodeId)
+{
+	nodes[nodeId].parentOrNext = freeList;
+	nodes[nodeId].height = -1;
+	nodes[nodeId].userData = nullptr;
+	freeList = nodeId;
+}
+
+int DynamicAABBTree::CreateProxy(const BVH::AABB& bounds, void* userData)
+{
+	const int proxyId = AllocateNode();
+
+	Node& node = nodes[proxyId];
+	node.box = bounds;
+	node.box.Expand(fatMargin);
+	node.userData = userData;
+	node.height = 0;
+
+	InsertLeaf(proxyId);
+	proxyCount++;
+
+	return proxyId;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxyId)
+{
+	assert(nodes[proxyId].IsLeaf());
+	RemoveLeaf(proxyId);
+	FreeNode(proxyId);
+	proxyCount--;
+}
+
+bool DynamicAABBTree::MoveProxy(int proxyId, const BVH::AABB& bounds)
+{
+	assert(nodes[proxyId].IsLeaf());
+
+	if (nodes[proxyId].box.Contains(bounds))
+	{
+		return false;
+	}
+
+	RemoveLeaf(proxyId);
+
+	nodes[proxyId].box = bounds;
+	nodes[proxyId].box.Expand(fatMargin);
+
+	InsertLeaf(proxyId);
+
+	return true;
+}
+
+void DynamicAABBTree::Clear()
+{
+	nodes.clear();
+	root = nullNode;
+	freeList = nullNode;
+	proxyCount = 0;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf)
+{
+	if (root == nullNode)
+	{
+		root = leaf;
+		nodes[root].parentOrNext = nullNode;
+		return;
+	}
+
+	//Walk down the tree picking the child that gives the cheapest surface area increase.
+	const BVH::AABB leafBox = nodes[leaf].box;
+	int index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const int child1 = nodes[index].child1;
+		const int child2 = nodes[index].child2;
+
+		const float area = nodes[index].box.SurfaceArea();
+		const float combinedArea = BVH::AABB::Union(nodes[index].box, leafBox).SurfaceArea();
+
+		//Cost of making a new parent for this node and the leaf
+		const float cost = 2.f * combinedArea;
+
+		//Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.f * (combinedArea - area);
+
+		const auto childCost = [&](int child)
+			{
+				const float newArea = BVH::AABB::Union(leafBox, nodes[child].box).SurfaceArea();
+				if (nodes[child].IsLeaf())
+				{
+					return newArea + inheritanceCost;
+				}
+				return (newArea - nodes[child].box.SurfaceArea()) + inheritanceCost;
+			};
+
+		const float cost1 = childCost(child1);
+		const float cost2 = childCost(child2);
+
+		if (cost < cost1 && cost < cost2)
+		{
+			break;
+		}
+
+		index = cost1 < cost2 ? child1 : child2;
+	}
+
+	const int sibling = index;
+
+	const int oldParent = nodes[sibling].parentOrNext;
+	const int newParent = AllocateNode();
+	nodes[newParent].parentOrNext = oldParent;
+	nodes[newParent].box = BVH::AABB::Union(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parentOrNext = newParent;
+	nodes[leaf].parentOrNext = newParent;
+
+	if (oldParent != nullNode)
+	{
+		if (nodes[oldParent].child1 == sibling)
+		{
+			nodes[oldParent].child1 = newParent;
+		}
+		else
+		{
+			nodes[oldParent].child2 = newParent;
+		}
+	}
+	else
+	{
+		root = newParent;
+	}
+
+	RefitAncestors(nodes[leaf].parentOrNext);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = nullNode;
+		return;
+	}
+
+	const int parent = nodes[leaf].parentOrNext;
+	const int grandParent = nodes[parent].parentOrNext;
+	const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+	if (grandParent != nullNode)
+	{
+		if (nodes[grandParent].child1 == parent)
+		{
+			nodes[grandParent].child1 = sibling;
+		}
+		else
+		{
+			nodes[grandParent].child2 = sibling;
+		}
+
+		nodes[sibling].parentOrNext = grandParent;
+		FreeNode(parent);
+
+		RefitAncestors(grandParent);
+	}
+	else
+	{
+		root = sibling;
+		nodes[sibling].parentOrNext = nullNode;
+		FreeNode(parent);
+	}
+}
+
+void DynamicAABBTree::RefitAncestors(int nodeId)
+{
+	int index = nodeId;
+	while (index != nullNode)
+	{
+		index = Balance(index);
+
+		const int child1 = nodes[index].child1;
+		const int child2 = nodes[index].child2;
+
+		nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[index].box = BVH::AABB::Union(nodes[child1].box, nodes[child2].box);
+
+		index = nodes[index].parentOrNext;
+	}
+}
+
+//Single left or right tree rotation if the node is imbalanced. Returns the new root of the subtree.
+int DynamicAABBTree::Balance(int iA)
+{
+	Node& A = nodes[iA];
+	if (A.IsLeaf() || A.height < 2)
+	{
+		return iA;
+	}
+
+	const int iB = A.child1;
+	const int iC = A.child2;
+	const int balance = nodes[iC].height - nodes[iB].height;
+
+	//Rotates the taller child 'iUp' above A, handing one of its children down to A.
+	const auto rotate = [&](int iUp, int iOther, bool upIsChild2)
+		{
+			Node& up = nodes[iUp];
+			const int iF = up.child1;
+			const int iG = up.child2;
+
+			up.child1 = iA;
+			up.parentOrNext = A.parentOrNext;
+			A.parentOrNext = iUp;
+
+			if (up.parentOrNext != nullNode)
+			{
+				if (nodes[up.parentOrNext].child1 == iA)
+				{
+					nodes[up.parentOrNext].child1 = iUp;
+				}
+				else
+				{
+					nodes[up.parentOrNext].child2 = iUp;
+				}
+			}
+			else
+			{
+				root = iUp;
+			}
+
+			//Keep the taller grandchild up top
+			int iKeep = iF;
+			int iGive = iG;
+			if (nodes[iF].height < nodes[iG].height)
+			{
+				iKeep = iG;
+				iGive = iF;
+			}
+
+			up.child2 = iKeep;
+			if (upIsChild2)
+			{
+				A.child2 = iGive;
+			}
+			else
+			{
+				A.child1 = iGive;
+			}
+			nodes[iGive].parentOrNext = iA;
+
+			A.box = BVH::AABB::Union(nodes[iOther].box, nodes[iGive].box);
+			A.height = 1 + std::max(nodes[iOther].height, nodes[iGive].height);
+
+			up.box = BVH::AABB::Union(A.box, nodes[iKeep].box);
+			up.height = 1 + std::max(A.height, nodes[iKeep].height);
+
+			return iUp;
+		};
+
+	if (balance > 1)
+	{
+		return rotate(iC, iB, true);
+	}
+
+	if (balance < -1)
+	{
+		return rotate(iB, iC, false);
+	}
+
+	return iA;
+}
+
+std::vector<int>& DynamicAABBTree::GetQueryStack()
+{
+	thread_local std::vector<int> stack;
+	return stack;
+}
+
+//TriangleBVH
+
+void TriangleBVH::Build(ArrayView<XMFLOAT3> positions, ArrayView<uint32_t> indices)
+{
+	nodes.clear();
+	triangleIndices.clear();
+
+	const bool indexed = !indices.empty();
+	const uint32_t triangleCount = static_cast<uint32_t>((indexed ? indices.size() : positions.size()) / 3);
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<BVH::AABB> triangleBounds(triangleCount);
+	std::vector<XMFLOAT3> centroids(triangleCount);
+	triangleIndices.resize(triangleCount);
+
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		const XMFLOAT3& p0 = positions[indexed ? indices[i * 3] : i * 3];
+		const XMFLOAT3& p1 = positions[indexed ? indices[i * 3 + 1] : i * 3 + 1];
+		const XMFLOAT3& p2 = positions[indexed ? indices[i * 3 + 2] : i * 3 + 2];
+
+		BVH::AABB& box = triangleBounds[i];
+		box.min = XMFLOAT3(std::min({ p0.x, p1.x, p2.x }), std::min({ p0.y, p1.y, p2.y }), std::min({ p0.z, p1.z, p2.z }));
+		box.max = XMFLOAT3(std::max({ p0.x, p1.x, p2.x }), std::max({ p0.y, p1.y, p2.y }), std::max({ p0.z, p1.z, p2.z }));
+
+		centroids[i] = XMFLOAT3((p0.x + p1.x + p2.x) / 3.f, (p0.y + p1.y + p2.y) / 3.f, (p0.z + p1.z + p2.z) / 3.f);
+		triangleIndices[i] = i;
+	}
+
+	nodes.reserve(triangleCount * 2);
+	nodes.emplace_back();
+	nodes[0].leftOrFirst = 0;
+	nodes[0].triangleCount = triangleCount;
+
+	Subdivide(0, triangleBounds, centroids, 0);
+
+	nodes.shrink_to_fit();
+}
+
+void TriangleBVH::Subdivide(uint32_t nodeIndex, const std::vector<BVH::AABB>& triangleBounds,
+	const std::vector<XMFLOAT3>& centroids, uint32_t depth)
+{
+	const uint32_t first = nodes[nodeIndex].leftOrFirst;
+	const uint32_t count = nodes[nodeIndex].triangleCount;
+
+	BVH::AABB box = triangleBounds[triangleIndices[first]];
+	BVH::AABB centroidBox;
+	centroidBox.min = centroidBox.max = centroids[triangleIndices[first]];
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		box = BVH::AABB::Union(box, triangleBounds[triangleIndices[i]]);
+
+		BVH::AABB centroidPoint;
+		centroidPoint.min = centroidPoint.max = centroids[triangleIndices[i]];
+		centroidBox = BVH::AABB::Union(centroidBox, centroidPoint);
+	}
+	nodes[nodeIndex].box = box;
+
+	if (count <= maxTrianglesPerLeaf || depth >= maxTriangleBVHDepth)
+	{
+		return;
+	}
+
+	//Median split on the longest axis of the centroid bounds
+	const float extent[3] = {
+		centroidBox.max.x - centroidBox.min.x,
+		centroidBox.max.y - centroidBox.min.y,
+		centroidBox.max.z - centroidBox.min.z };
+	int axis = 0;
+	if (extent[1] > extent[axis]) axis = 1;
+	if (extent[2] > extent[axis]) axis = 2;
+
+	if (extent[axis] <= 0.f)
+	{
+		return; //All centroids on top of each other, can't split.
+	}
+
+	const uint32_t mid = first + count / 2;
+	std::nth_element(triangleIndices.begin() + first, triangleIndices.begin() + mid,
+		triangleIndices.begin() + first + count, [&](uint32_t a, uint32_t b)
+		{
+			return (&centroids[a].x)[axis] < (&centroids[b].x)[axis];
+		});
+
+	const uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+	nodes.emplace_back();
+	nodes.emplace_back();
+
+	nodes[leftIndex].leftOrFirst = first;
+	nodes[leftIndex].triangleCount = mid - first;
+	nodes[leftIndex + 1].leftOrFirst = mid;
+	nodes[leftIndex + 1].triangleCount = first + count - mid;
+
+	nodes[nodeIndex].leftOrFirst = leftIndex;
+	nodes[nodeIndex].triangleCount = 0;
+
+	Subdivide(leftIndex, triangleBounds, centroids, depth + 1);
+	Subdivide(leftIndex + 1, triangleBounds, centroids, depth + 1);
+}
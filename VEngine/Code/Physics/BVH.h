@@ -0,0 +1,279 @@
+#pragma once
+
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include "Core/ArrayView.h"
+
+//Bounding volume hierarchies used to speed up raycasts and box casts.
+//DynamicAABBTree is the world-level structure over component bounds, TriangleBVH is built once per mesh asset.
+
+namespace BVH
+{
+	struct AABB
+	{
+		DirectX::XMFLOAT3 min = DirectX::XMFLOAT3(0.f, 0.f, 0.f);
+		DirectX::XMFLOAT3 max = DirectX::XMFLOAT3(0.f, 0.f, 0.f);
+
+		static AABB FromBoundingBox(const DirectX::BoundingBox& bb);
+		static AABB FromOrientedBox(const DirectX::BoundingOrientedBox& obb);
+		static AABB Union(const AABB& a, const AABB& b);
+
+		bool Contains(const AABB& other) const;
+		bool Overlaps(const AABB& other) const;
+		float SurfaceArea() const;
+		void Expand(float margin);
+	};
+
+	//Ray setup shared by both tree types. The direction doesn't need to be normalised, distances come back in
+	//multiples of its length (so transforming a world ray into mesh space keeps world distances).
+	struct Ray
+	{
+		Ray(DirectX::FXMVECTOR origin_, DirectX::FXMVECTOR direction_, float maxDistance_);
+
+		DirectX::XMFLOAT3 origin;
+		DirectX::XMFLOAT3 invDirection;
+		float maxDistance;
+
+		bool Intersects(const AABB& box, float& tNear) const;
+	};
+}
+
+class DynamicAABBTree
+{
+public:
+	static constexpr int nullNode = -1;
+
+	//Leaves are enlarged by this much so that small movements don't cause a reinsert.
+	float fatMargin = 0.25f;
+
+	int CreateProxy(const BVH::AABB& bounds, void* userData);
+	void DestroyProxy(int proxyId);
+
+	//Returns true if the proxy's bounds had moved outside its fat box and it was reinserted.
+	bool MoveProxy(int proxyId, const BVH::AABB& bounds);
+
+	void* GetUserData(int proxyId) const { return nodes[proxyId].userData; }
+	const BVH::AABB& GetFatBounds(int proxyId) const { return nodes[proxyId].box; }
+
+	void Clear();
+
+	int GetHeight() const { return root == nullNode ? 0 : nodes[root].height; }
+	int GetProxyCount() const { return proxyCount; }
+
+	//Callback is bool(void* userData), return false to stop the query.
+	template <typename Callback>
+	void QueryOverlap(const BVH::AABB& bounds, Callback callback) const
+	{
+		if (root == nullNode)
+		{
+			return;
+		}
+
+		std::vector<int>& stack = GetQueryStack();
+		stack.clear();
+		stack.emplace_back(root);
+
+		while (!stack.empty())
+		{
+			const int nodeId = stack.back();
+			stack.pop_back();
+
+			const Node& node = nodes[nodeId];
+			if (!node.box.Overlaps(bounds))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!callback(node.userData))
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.emplace_back(node.child1);
+				stack.emplace_back(node.child2);
+			}
+		}
+	}
+
+	//Callback is bool(void* userData), return false to stop the query.
+	template <typename Callback>
+	void QueryRay(const BVH::Ray& ray, Callback callback) const
+	{
+		if (root == nullNode)
+		{
+			return;
+		}
+
+		std::vector<int>& stack = GetQueryStack();
+		stack.clear();
+		stack.emplace_back(root);
+
+		while (!stack.empty())
+		{
+			const int nodeId = stack.back();
+			stack.pop_back();
+
+			const Node& node = nodes[nodeId];
+			float tNear = 0.f;
+			if (!ray.Intersects(node.box, tNear))
+			{
+				continue;
+			}
+
+			if (node.IsLeaf())
+			{
+				if (!callback(node.userData))
+				{
+					return;
+				}
+			}
+			else
+			{
+				stack.emplace_back(node.child1);
+				stack.emplace_back(node.child2);
+			}
+		}
+	}
+
+private:
+	struct Node
+	{
+		BVH::AABB box;
+		void* userData = nullptr;
+		int parentOrNext = nullNode; //Parent in the tree, next in the free list.
+		int child1 = nullNode;
+		int child2 = nullNode;
+		int height = -1; //-1 for free nodes, 0 for leaves.
+
+		bool IsLeaf() const { return child1 == nullNode; }
+	};
+
+	int AllocateNode();
+	void FreeNode(int nodeId);
+	void InsertLeaf(int leaf);
+	void RemoveLeaf(int leaf);
+	int Balance(int nodeId);
+	void RefitAncestors(int nodeId);
+
+	//Queries may run on worker threads, so each thread keeps its own traversal stack.
+	static std::vector<int>& GetQueryStack();
+
+	std::vector<Node> nodes;
+	int root = nullNode;
+	int freeList = nullNode;
+	int proxyCount = 0;
+};
+
+//Static BVH over a mesh's triangle list, built once when the mesh asset is loaded.
+//Triangle i is (indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]) into positions, or the position triple
+//(positions[i * 3], ...) when indices is empty.
+class TriangleBVH
+{
+public:
+	void Build(ArrayView<DirectX::XMFLOAT3> positions, ArrayView<uint32_t> indices = {});
+
+	bool Empty() const { return nodes.empty(); }
+	size_t GetNodeCount() const { return nodes.size(); }
+
+	//Ray needs to be in mesh local space. Callback is void(uint32_t triangleIndex) and is called for
+	//every triangle in every leaf the ray passes through.
+	template <typename Callback>
+	void QueryRay(const BVH::Ray& ray, Callback callback) const
+	{
+		if (nodes.empty())
+		{
+			return;
+		}
+
+		uint32_t stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+
+			float tNear = 0.f;
+			if (!ray.Intersects(node.box, tNear))
+			{
+				continue;
+			}
+
+			if (node.triangleCount > 0)
+			{
+				for (uint32_t i = 0; i < node.triangleCount; i++)
+				{
+					callback(triangleIndices[node.leftOrFirst + i]);
+				}
+			}
+			else
+			{
+				stack[stackSize++] = node.leftOrFirst;
+				stack[stackSize++] = node.leftOrFirst + 1;
+			}
+		}
+	}
+
+	//Same walk as QueryRay(), but stops as soon as callback (bool(uint32_t triangleIndex)) returns true.
+	//For occlusion rays, where any hit will do and the nearest one doesn't matter.
+	template <typename Callback>
+	bool QueryRayAny(const BVH::Ray& ray, Callback callback) const
+	{
+		if (nodes.empty())
+		{
+			return false;
+		}
+
+		uint32_t stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& node = nodes[stack[--stackSize]];
+
+			float tNear = 0.f;
+			if (!ray.Intersects(node.box, tNear))
+			{
+				continue;
+			}
+
+			if (node.triangleCount > 0)
+			{
+				for (uint32_t i = 0; i < node.triangleCount; i++)
+				{
+					if (callback(triangleIndices[node.leftOrFirst + i]))
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				stack[stackSize++] = node.leftOrFirst;
+				stack[stackSize++] = node.leftOrFirst + 1;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	struct Node
+	{
+		BVH::AABB box;
+		uint32_t leftOrFirst = 0; //Left child index for inner nodes (right is +1), first triangle for leaves.
+		uint32_t triangleCount = 0;
+	};
+
+	void Subdivide(uint32_t nodeIndex, const std::vector<BVH::AABB>& triangleBounds,
+		const std::vector<DirectX::XMFLOAT3>& centroids, uint32_t depth);
+
+	std::vector<Node> nodes;
+	std::vector<uint32_t> triangleIndices;
+};
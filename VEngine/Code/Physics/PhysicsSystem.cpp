@@ -294,9 +294,10 @@ void PhysicsSystem::CreateCharacterController(CharacterControllerComponent* char
 void PhysicsSystem::CreateConvexPhysicsMesh(MeshComponent* mesh)
 {
 	PxConvexMeshDesc convexDesc;
-	convexDesc.points.count = mesh->meshDataProxy.GetVertices().size();
-	convexDesc.points.stride = sizeof(Vertex);
-	convexDesc.points.data = mesh->meshDataProxy.GetVertices().data();
+	const auto positions = mesh->meshDataProxy.GetPositions();
+	convexDesc.points.count = positions.size();
+	convexDesc.points.stride = positions.stride();
+	convexDesc.points.data = positions.data();
 	convexDesc.flags = PxConvexFlag::eCOMPUTE_CONVEX |
 		PxConvexFlag::eDISABLE_MESH_VALIDATION | PxConvexFlag::eFAST_INERTIA_COMPUTATION;
 
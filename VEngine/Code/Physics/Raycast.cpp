@@ -9,6 +9,7 @@
 #include "Editor/Editor.h"
 #include "Core/VMath.h"
 #include "Core/Core.h"
+#include "Core/ParallelFor.h"
 #include "Actors/Actor.h"
 #include "Components/MeshComponent.h"
 #include "Components/BoxTriggerComponent.h"
@@ -17,6 +18,7 @@
 #include "Components/Lights/DirectionalLightComponent.h"
 #include "Core/World.h"
 #include "Physics/PhysicsSystem.h"
+#include "Physics/WorldBVH.h"
 
 using namespace DirectX;
 
@@ -51,6 +53,17 @@ static bool IsIgnoredSpatialComponent(SpatialComponent* component, HitResult& hi
 	return false;
 }
 
+//Gets the owning actor of a mesh returned from the world BVH, null if the owner isn't in world anymore.
+static Actor* GetMeshOwnerForCast(MeshComponent* mesh, HitResult& hitResult)
+{
+	auto actor = World::GetActorByUIDAllowNull(mesh->GetOwnerUID());
+	if (actor == nullptr || IsIgnoredActor(actor, hitResult))
+	{
+		return nullptr;
+	}
+	return actor;
+}
+
 static bool CollisionLayerCheck(CollisionLayers collisionLayer, CollisionLayers hitResultIgnoreLayer)
 {
 	if (collisionLayer == CollisionLayers::None ||
@@ -114,24 +127,19 @@ bool Physics::Raycast(HitResult& hitResult, XMVECTOR origin, XMVECTOR direction,
 			}
 		};
 
-	auto actorsInWorld = World::GetAllActorsInWorld();
-	for (auto actor : actorsInWorld)
-	{
-		if (!actor->IsActive())
-		{
-			continue;
-		}
-
-		if (IsIgnoredActor(actor, hitResult))
-		{
-			continue;
-		}
+	WorldBVH::EnsureUpToDate();
 
-		for (auto mesh : actor->GetComponents<MeshComponent>())
+	const BVH::Ray worldRay(hitResult.origin, hitResult.direction, std::numeric_limits<float>::max());
+	WorldBVH::GetTree().QueryRay(worldRay, [&](void* userData)
 		{
-			checkSpatialComponentCollision(mesh);
-		}
-	}
+			auto mesh = static_cast<MeshComponent*>(userData);
+			auto actor = GetMeshOwnerForCast(mesh, hitResult);
+			if (actor && actor->IsActive())
+			{
+				checkSpatialComponentCollision(mesh);
+			}
+			return true;
+		});
 
 	//Only add editor mesh components in when gameplay off
 	if (!Core::gameplayOn)
@@ -180,97 +188,168 @@ bool Physics::Raycast(HitResult& hitResult, XMVECTOR origin, XMVECTOR end)
 	return Raycast(hitResult, origin, direction, range);
 }
 
-bool Physics::RaycastTriangleIntersect(HitResult& hitResult)
+//Tests the ray in hitResult against every triangle of the mesh (through its triangle BVH if it has one),
+//appending a HitResult per triangle hit. Doesn't write to any shared state so it's safe to call from workers.
+//meshWorldMatrix is passed in so batch workers can use the cached one.
+static void RaycastMeshTriangles(MeshComponent& mesh, FXMMATRIX meshWorldMatrix, const HitResult& hitResult,
+	bool ignoreBackFaceHits, std::vector<HitResult>& hitResults)
 {
-	std::vector<HitResult> hitResults;
 
-	const auto checkMeshVerticesCollision = [&](MeshComponent& mesh)
+	bool ignoreBackFacHits = ignoreBackFaceHits;
+	if (mesh.GetRastState().GetName() == RastStates::noBackCull)
+	{
+		ignoreBackFacHits = false;
+	}
+
+	const auto positions = mesh.meshDataProxy.GetPositions();
+	const auto indices = mesh.meshDataProxy.GetIndices();
+
+	const auto checkTriangle = [&](uint32_t triangleIndex)
 		{
-			const XMMATRIX meshWorldMatrix = mesh.GetWorldMatrix();
+			const bool indexed = !indices.empty();
+			const int index0 = indexed ? indices[triangleIndex * 3] : triangleIndex * 3;
+			const int index1 = indexed ? indices[triangleIndex * 3 + 1] : triangleIndex * 3 + 1;
+			const int index2 = indexed ? indices[triangleIndex * 3 + 2] : triangleIndex * 3 + 2;
 
-			bool ignoreBackFacHits = hitResult.ignoreBackFaceHits;
-			if (mesh.GetRastState().GetName() == RastStates::noBackCull)
-			{
-				ignoreBackFacHits = false;
-			}
+			XMVECTOR v0 = XMLoadFloat3(&positions[index0]);
+			v0 = XMVector3TransformCoord(v0, meshWorldMatrix);
 
-			const auto& vertices = mesh.meshDataProxy.GetVertices();
-			const size_t vertexTriangleCount = vertices.size() / 3;
-			for (int i = 0; i < vertexTriangleCount; i++)
+			XMVECTOR v1 = XMLoadFloat3(&positions[index1]);
+			v1 = XMVector3TransformCoord(v1, meshWorldMatrix);
+
+			XMVECTOR v2 = XMLoadFloat3(&positions[index2]);
+			v2 = XMVector3TransformCoord(v2, meshWorldMatrix);
+
+			float hitDistance = 0.f;
+			if (DirectX::TriangleTests::Intersects(hitResult.origin, hitResult.direction, v0, v1, v2, hitDistance))
 			{
-				const int index0 = i * 3;
-				const int index1 = i * 3 + 1;
-				const int index2 = i * 3 + 2;
+				HitResult tempHitResult = hitResult;
+				tempHitResult.hitDistance = hitDistance;
+
+				//Get normal for triangle
+				const XMFLOAT3 vertexNormal = mesh.meshDataProxy.GetNormal(index0);
+				XMVECTOR normal = XMLoadFloat3(&vertexNormal);
+				normal = XMVector3TransformNormal(normal, meshWorldMatrix);
+				normal = XMVector3Normalize(normal);
+				XMStoreFloat3(&tempHitResult.hitNormal, normal);
+
+				//Check if back facing triangle
+				if (ignoreBackFacHits)
+				{
+					const float angleBetweenRaycastDirectionAndTriangleNormal =
+						XMConvertToDegrees(XMVector3AngleBetweenNormals(
+							normal,
+							hitResult.direction).m128_f32[0]);
+					if (angleBetweenRaycastDirectionAndTriangleNormal < 90.f)
+					{
+						//has hit the back face of a triangle, so skip
+						return;
+					}
+				}
 
-				XMVECTOR v0 = XMLoadFloat3(&vertices[index0].pos);
-				v0 = XMVector3TransformCoord(v0, meshWorldMatrix);
+				//hit position
+				const XMVECTOR hitPosition = hitResult.origin + (hitResult.direction * tempHitResult.hitDistance);
 
-				XMVECTOR v1 = XMLoadFloat3(&vertices[index1].pos);
-				v1 = XMVector3TransformCoord(v1, meshWorldMatrix);
+				//Hit vertex indices
+				std::unordered_map<int, XMVECTOR> indexToVertMap;
+				indexToVertMap.emplace(index0, v0);
+				indexToVertMap.emplace(index1, v1);
+				indexToVertMap.emplace(index2, v2);
+				tempHitResult.hitVertIndexes.emplace_back(VMath::GetIndexOfClosestVertexFromTriangleIntersect(indexToVertMap, hitPosition));
 
-				XMVECTOR v2 = XMLoadFloat3(&vertices[index2].pos);
-				v2 = XMVector3TransformCoord(v2, meshWorldMatrix);
+				tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index0);
+				tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index1);
+				tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index2);
 
-				float hitDistance = 0.f;
-				if (DirectX::TriangleTests::Intersects(hitResult.origin, hitResult.direction, v0, v1, v2, hitDistance))
+				//Get hit UV
+				Vertex triangleVertices[3];
+				const int triangleIndices[3] = { index0, index1, index2 };
+				for (int i = 0; i < 3; i++)
 				{
-					HitResult tempHitResult = hitResult;
-					tempHitResult.hitDistance = hitDistance;
+					triangleVertices[i].pos = positions[triangleIndices[i]];
+					triangleVertices[i].uv = mesh.meshDataProxy.GetUV(triangleIndices[i]);
+				}
 
-					//Get normal for triangle
-					XMVECTOR normal = XMLoadFloat3(&mesh.meshDataProxy.vertices[index0].normal);
-					normal = XMVector3TransformNormal(normal, meshWorldMatrix);
-					normal = XMVector3Normalize(normal);
-					XMStoreFloat3(&tempHitResult.hitNormal, normal);
+				float hitU, hitV;
+				VMath::TriangleXYZToUV(triangleVertices[0],
+					triangleVertices[1],
+					triangleVertices[2], hitPosition, hitU, hitV);
+				tempHitResult.uv = XMFLOAT2(hitU, hitV);
 
-					//Check if back facing triangle
-					if (ignoreBackFacHits)
-					{
-						const float angleBetweenRaycastDirectionAndTriangleNormal =
-							XMConvertToDegrees(XMVector3AngleBetweenNormals(
-								normal,
-								hitResult.direction).m128_f32[0]);
-						if (angleBetweenRaycastDirectionAndTriangleNormal < 90.f)
-						{
-							//has hit the back face of a triangle, so skip
-							continue;
-						}
-					}
+				//Set hit component and actor
+				tempHitResult.hitComponent = &mesh;
+				tempHitResult.hitActor = World::GetActorByUID(mesh.GetOwnerUID());
 
-					//hit position
-					const XMVECTOR hitPosition = hitResult.origin + (hitResult.direction * tempHitResult.hitDistance);
+				hitResults.emplace_back(tempHitResult);
+			}
+		};
 
-					//Hit vertex indices
-					std::unordered_map<int, XMVECTOR> indexToVertMap;
-					indexToVertMap.emplace(index0, v0);
-					indexToVertMap.emplace(index1, v1);
-					indexToVertMap.emplace(index2, v2);
-					tempHitResult.hitVertIndexes.emplace_back(VMath::GetIndexOfClosestVertexFromTriangleIntersect(indexToVertMap, hitPosition));
+	//Walk the mesh's triangle BVH in local space. The ray direction isn't renormalised after the
+	//transform so that BVH distances stay in world units.
+	XMVECTOR worldDeterminant = XMMatrixDeterminant(meshWorldMatrix);
+	if (mesh.meshDataProxy.triangleBVH && XMVectorGetX(worldDeterminant) != 0.f)
+	{
+		const XMMATRIX invWorldMatrix = XMMatrixInverse(&worldDeterminant, meshWorldMatrix);
+		const BVH::Ray localRay(XMVector3TransformCoord(hitResult.origin, invWorldMatrix),
+			XMVector3TransformNormal(hitResult.direction, invWorldMatrix),
+			std::numeric_limits<float>::max());
+		mesh.meshDataProxy.triangleBVH->QueryRay(localRay, checkTriangle);
+	}
+	else
+	{
+		const size_t triangleCount = mesh.meshDataProxy.GetTriangleCount();
+		for (uint32_t i = 0; i < triangleCount; i++)
+		{
+			checkTriangle(i);
+		}
+	}
+}
 
-					tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index0);
-					tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index1);
-					tempHitResult.vertIndexesOfHitTriangleFace.emplace_back(index2);
+//Copies the closest of the triangle hits into hitResult, with every hit actor in hitResult.hitActors.
+static bool SetNearestTriangleHit(HitResult& hitResult, std::vector<HitResult>& hitResults)
+{
+	//Get all hit actors
+	std::vector<Actor*> hitActors;
+	for (auto& lHitResult : hitResults)
+	{
+		hitActors.emplace_back(lHitResult.hitActor);
+	}
 
-					//Get hit UV
-					float hitU, hitV;
-					VMath::TriangleXYZToUV(mesh.meshDataProxy.vertices[index0],
-						mesh.meshDataProxy.vertices[index1],
-						mesh.meshDataProxy.vertices[index2], hitPosition, hitU, hitV);
-					tempHitResult.uv = XMFLOAT2(hitU, hitV);
+	//Set nearest hit actor
+	float lowestDistance = std::numeric_limits<float>::max();
+	int rayIndex = -1;
+	for (int i = 0; i < hitResults.size(); i++)
+	{
+		if (hitResults[i].hitDistance < lowestDistance)
+		{
+			lowestDistance = hitResults[i].hitDistance;
+			rayIndex = i;
+		}
+	}
 
-					//Set hit component and actor
-					tempHitResult.hitComponent = &mesh;
-					tempHitResult.hitActor = World::GetActorByUID(mesh.GetOwnerUID());
+	if (rayIndex > -1)
+	{
+		hitResult = std::move(hitResults[rayIndex]);
+		hitResult.hitActors = std::move(hitActors);
+		return true;
+	}
 
-					hitResults.emplace_back(tempHitResult);
-				}
-			}
+	return false;
+}
+
+bool Physics::RaycastTriangleIntersect(HitResult& hitResult)
+{
+	std::vector<HitResult> hitResults;
+
+	const auto checkMeshVerticesCollision = [&](MeshComponent& mesh)
+		{
+			RaycastMeshTriangles(mesh, mesh.GetWorldMatrix(), hitResult, hitResult.ignoreBackFaceHits, hitResults);
 		};
 
 	const auto setDebugMesh = [&](SpatialComponent* component, std::string_view debugMeshName)
 		{
 			auto debugMesh = MeshComponent::GetDebugMesh("DebugIcoSphere");
-			debugMesh->transform = component->transform;
+			debugMesh->SetTransform(component->transform);
 			debugMesh->SetOwnerUID(component->GetOwnerUID());
 			checkMeshVerticesCollision(*debugMesh);
 		};
@@ -316,33 +395,7 @@ bool Physics::RaycastTriangleIntersect(HitResult& hitResult)
 		}
 	}
 
-	//Get all hit actors
-	std::vector<Actor*> hitActors;
-	for (auto& lHitResult : hitResults)
-	{
-		hitActors.emplace_back(lHitResult.hitActor);
-	}
-
-	//Set nearest hit actor
-	float lowestDistance = std::numeric_limits<float>::max();
-	int rayIndex = -1;
-	for (int i = 0; i < hitResults.size(); i++)
-	{
-		if (hitResults[i].hitDistance < lowestDistance)
-		{
-			lowestDistance = hitResults[i].hitDistance;
-			rayIndex = i;
-		}
-	}
-
-	if (rayIndex > -1)
-	{
-		hitResult = hitResults[rayIndex];
-		hitResult.hitActors = hitActors;
-		return true;
-	}
-
-	return false;
+	return SetNearestTriangleHit(hitResult, hitResults);
 }
 
 bool Physics::RaycastFromScreen(HitResult& hitResult)
@@ -379,33 +432,31 @@ bool Physics::OrientedBoxCast(HitResult& hit, BoundingOrientedBox& boundsInWorld
 		Renderer::AddDebugDrawOrientedBox(boundsInWorldSpace, clearDebugDrawWithTimer);
 	}
 
-	for (auto actor : World::GetAllActorsInWorld())
-	{
-		if (!actor->IsActive())
-		{
-			continue;
-		}
+	WorldBVH::EnsureUpToDate();
 
-		if (IsIgnoredActor(actor, hit))
+	WorldBVH::GetTree().QueryOverlap(BVH::AABB::FromOrientedBox(boundsInWorldSpace), [&](void* userData)
 		{
-			continue;
-		}
+			auto mesh = static_cast<MeshComponent*>(userData);
+
+			auto actor = GetMeshOwnerForCast(mesh, hit);
+			if (actor == nullptr || !actor->IsActive())
+			{
+				return true;
+			}
 
-		for (auto mesh : actor->GetComponents<MeshComponent>())
-		{
 			if (!mesh->IsActive())
 			{
-				continue;
+				return true;
 			}
 
 			if (!CollisionLayerCheck(mesh->GetCollisionLayer(), hit.ignoreLayer))
 			{
-				continue;
+				return true;
 			}
 
 			if (IsIgnoredSpatialComponent(mesh, hit))
 			{
-				continue;
+				return true;
 			}
 
 			const auto meshBoundsInWorld = mesh->GetBoundsInWorldSpace();
@@ -414,8 +465,9 @@ bool Physics::OrientedBoxCast(HitResult& hit, BoundingOrientedBox& boundsInWorld
 				hit.hitComponents.emplace_back(mesh);
 				hit.hitActors.emplace_back(actor);
 			}
-		}
-	}
+
+			return true;
+		});
 
 	return hit.hitActors.size();
 }
@@ -441,23 +493,26 @@ bool Physics::OrientedBoxCast(HitResult& hitResult, XMVECTOR origin, XMVECTOR en
 		Renderer::AddDebugDrawOrientedBox(boundingOrientedBox, clearDebugDrawWithTimer);
 	}
 
-	for (auto actor : World::GetAllActorsInWorld())
-	{
-		if (IsIgnoredActor(actor, hitResult))
-		{
-			continue;
-		}
+	WorldBVH::EnsureUpToDate();
 
-		for (auto mesh : actor->GetComponents<MeshComponent>())
+	WorldBVH::GetTree().QueryOverlap(BVH::AABB::FromOrientedBox(boundingOrientedBox), [&](void* userData)
 		{
+			auto mesh = static_cast<MeshComponent*>(userData);
+
+			auto actor = GetMeshOwnerForCast(mesh, hitResult);
+			if (actor == nullptr)
+			{
+				return true;
+			}
+
 			if (!mesh->IsActive())
 			{
-				continue;
+				return true;
 			}
 
 			if (!CollisionLayerCheck(mesh->GetCollisionLayer(), hitResult.ignoreLayer))
 			{
-				continue;
+				return true;
 			}
 
 			const auto meshBoundsInWorld = mesh->GetBoundsInWorldSpace();
@@ -466,8 +521,9 @@ bool Physics::OrientedBoxCast(HitResult& hitResult, XMVECTOR origin, XMVECTOR en
 				hitResult.hitComponents.emplace_back(mesh);
 				hitResult.hitActors.emplace_back(actor);
 			}
-		}
-	}
+
+			return true;
+		});
 
 	return hitResult.hitActors.size();
 }
@@ -485,23 +541,26 @@ bool Physics::SimpleBoxCast(XMVECTOR center, XMFLOAT3 extents, HitResult& hit, b
 		Renderer::AddDebugDrawOrientedBox(orientedBox, clearDebugDrawWithTimer);
 	}
 
-	for (auto actor : World::GetAllActorsInWorld())
-	{
-		if (IsIgnoredActor(actor, hit))
-		{
-			continue;
-		}
+	WorldBVH::EnsureUpToDate();
 
-		for (auto mesh : actor->GetComponents<MeshComponent>())
+	WorldBVH::GetTree().QueryOverlap(BVH::AABB::FromBoundingBox(boundingBox), [&](void* userData)
 		{
+			auto mesh = static_cast<MeshComponent*>(userData);
+
+			auto actor = GetMeshOwnerForCast(mesh, hit);
+			if (actor == nullptr)
+			{
+				return true;
+			}
+
 			if (!mesh->IsActive())
 			{
-				continue;
+				return true;
 			}
 
 			if (!CollisionLayerCheck(mesh->GetCollisionLayer(), hit.ignoreLayer))
 			{
-				continue;
+				return true;
 			}
 
 			const BoundingOrientedBox meshWorldBounds = mesh->GetBoundsInWorldSpace();
@@ -511,8 +570,94 @@ bool Physics::SimpleBoxCast(XMVECTOR center, XMFLOAT3 extents, HitResult& hit, b
 				hit.hitComponents.emplace_back(mesh);
 				hit.hitActors.emplace_back(actor);
 			}
-		}
-	}
+
+			return true;
+		});
 
 	return hit.hitActors.size();
 }
+
+Physics::RaycastFilter::RaycastFilter(const HitResult& hitResult)
+{
+	actorsToIgnore.insert(hitResult.actorsToIgnore.begin(), hitResult.actorsToIgnore.end());
+	componentsToIgnore.insert(hitResult.componentsToIgnore.begin(), hitResult.componentsToIgnore.end());
+	ignoreLayer = hitResult.ignoreLayer;
+	ignoreBackFaceHits = hitResult.ignoreBackFaceHits;
+}
+
+//Single ray of a batch. Only reads from the world and the BVHs so multiple can run at once.
+static bool RaycastBatchRay(const Physics::BatchRay& ray, const Physics::RaycastFilter& filter, HitResult& hitResult)
+{
+	hitResult.origin = ray.origin;
+	hitResult.direction = ray.direction;
+	hitResult.range = ray.range;
+
+	std::vector<HitResult> triangleHits;
+
+	const BVH::Ray worldRay(ray.origin, ray.direction, ray.range);
+	WorldBVH::GetTree().QueryRay(worldRay, [&](void* userData)
+		{
+			auto mesh = static_cast<MeshComponent*>(userData);
+
+			if (!mesh->IsActive() || !CollisionLayerCheck(mesh->GetCollisionLayer(), filter.ignoreLayer))
+			{
+				return true;
+			}
+
+			if (filter.componentsToIgnore.find(mesh) != filter.componentsToIgnore.end())
+			{
+				return true;
+			}
+
+			auto actor = World::GetActorByUIDAllowNull(mesh->GetOwnerUID());
+			if (actor == nullptr || !actor->IsActive() || actor->FlaggedForDeferredDestroy() ||
+				filter.actorsToIgnore.find(actor) != filter.actorsToIgnore.end())
+			{
+				return true;
+			}
+
+			float hitDistance = 0.f;
+			if (mesh->GetCachedBoundsInWorldSpace().Intersects(ray.origin, ray.direction, hitDistance))
+			{
+				RaycastMeshTriangles(*mesh, mesh->GetCachedWorldMatrix(), hitResult, filter.ignoreBackFaceHits, triangleHits);
+			}
+
+			return true;
+		});
+
+	if (!SetNearestTriangleHit(hitResult, triangleHits) || hitResult.hitDistance > ray.range)
+	{
+		return false;
+	}
+
+	const XMVECTOR hitPos = hitResult.origin + (hitResult.direction * hitResult.hitDistance);
+	XMStoreFloat3(&hitResult.hitPos, hitPos);
+	return true;
+}
+
+int Physics::RaycastBatch(const std::vector<BatchRay>& rays, const RaycastFilter& filter, std::vector<HitResult>& hitResults)
+{
+	hitResults.clear();
+	hitResults.resize(rays.size());
+
+	//Matrices and the tree have to be refreshed here on the main thread, the workers only read them.
+	SpatialComponent::UpdateWorldMatrices();
+	WorldBVH::EnsureUpToDate();
+
+	//Small batches (e.g. a single grid node) aren't worth the thread overhead.
+	constexpr size_t minRaysPerJob = 64;
+	ParallelFor(rays.size(), minRaysPerJob, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				hitResults[i].bHit = RaycastBatchRay(rays[i], filter, hitResults[i]);
+			}
+		});
+
+	int hitCount = 0;
+	for (const auto& hitResult : hitResults)
+	{
+		hitCount += hitResult.bHit;
+	}
+	return hitCount;
+}
@@ -2,10 +2,42 @@
 
 #include <DirectXMath.h>
 #include <DirectXCollision.h>
+#include <unordered_set>
+#include <vector>
 #include "HitResult.h"
 
 namespace Physics
 {
+	//Ignore sets shared by every ray in a RaycastBatch(). Built once per batch so each candidate is a hash
+	//lookup instead of a scan over HitResult's ignore lists.
+	struct RaycastFilter
+	{
+		std::unordered_set<Actor*> actorsToIgnore;
+		std::unordered_set<SpatialComponent*> componentsToIgnore;
+
+		//Layer to ignore on raycast, same rules as HitResult::ignoreLayer.
+		CollisionLayers ignoreLayer = CollisionLayers::None;
+
+		bool ignoreBackFaceHits = true;
+
+		RaycastFilter() {}
+		//Takes the ignore lists and flags from a HitResult set up for a single raycast.
+		RaycastFilter(const HitResult& hitResult);
+	};
+
+	struct BatchRay
+	{
+		DirectX::XMVECTOR origin;
+		DirectX::XMVECTOR direction; //Needs to be normalised.
+		float range = 0.f;
+	};
+
+	//Casts every ray against the world's mesh components, splitting the rays across worker threads when
+	//there are enough of them. hitResults is resized to match rays and hitResults[i].bHit is set for rays that
+	//hit something in range. Editor-only components (lights, triggers) aren't tested.
+	//Returns the number of rays that hit.
+	int RaycastBatch(const std::vector<BatchRay>& rays, const RaycastFilter& filter, std::vector<HitResult>& hitResults);
+
 	bool Raycast(HitResult& hitResult, DirectX::XMVECTOR origin, DirectX::XMVECTOR direction, float range, bool fromScreen = false);
 	bool Raycast(HitResult& hitResult, DirectX::XMVECTOR origin, DirectX::XMVECTOR end);
 	bool RaycastTriangleIntersect(HitResult& hitResult);
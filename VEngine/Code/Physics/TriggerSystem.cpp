@@ -0,0 +1,183 @@
+#include "vpch.h"
+#include "TriggerSystem.h"
+#include <unordered_map>
+#include "BVH.h"
+#include "Core/World.h"
+#include "Actors/Actor.h"
+#include "Components/BoxTriggerComponent.h"
+
+float TriggerSystem::cellSize = 4.f;
+
+//Triggers covering more cells than this skip the grid, so a huge volume doesn't fill thousands of cells.
+static constexpr int64_t maxCellsPerTrigger = 64;
+
+struct TriggerEntry
+{
+	UID uid = 0;
+	BoundingOrientedBox bounds;
+	std::vector<UID> actorsInside;
+};
+
+//Kept between frames so the buffers don't reallocate.
+static std::vector<TriggerEntry> triggers;
+static std::vector<uint32_t> largeTriggers;
+static std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+static std::vector<UID> inactiveTriggers;
+static TriggerSystem::Stats stats;
+
+static int32_t ToCell(float value)
+{
+	return static_cast<int32_t>(floorf(value / TriggerSystem::cellSize));
+}
+
+//21 bits per axis, enough for about a million cells either side of the origin.
+static uint64_t CellKey(int32_t x, int32_t y, int32_t z)
+{
+	constexpr uint64_t mask = (1 << 21) - 1;
+	return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
+
+static void AddTriggerToGrid(uint32_t triggerIndex)
+{
+	const BVH::AABB box = BVH::AABB::FromOrientedBox(triggers[triggerIndex].bounds);
+	const int32_t minX = ToCell(box.min.x), maxX = ToCell(box.max.x);
+	const int32_t minY = ToCell(box.min.y), maxY = ToCell(box.max.y);
+	const int32_t minZ = ToCell(box.min.z), maxZ = ToCell(box.max.z);
+
+	const int64_t cellCount = int64_t(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1);
+	if (cellCount > maxCellsPerTrigger)
+	{
+		largeTriggers.emplace_back(triggerIndex);
+		return;
+	}
+
+	for (int32_t x = minX; x <= maxX; x++)
+	{
+		for (int32_t y = minY; y <= maxY; y++)
+		{
+			for (int32_t z = minZ; z <= maxZ; z++)
+			{
+				cells[CellKey(x, y, z)].emplace_back(triggerIndex);
+			}
+		}
+	}
+}
+
+static void TestActor(uint32_t triggerIndex, UID actorUID, FXMVECTOR position)
+{
+	stats.containsTests++;
+
+	TriggerEntry& trigger = triggers[triggerIndex];
+	if (trigger.bounds.Contains(position) != DISJOINT)
+	{
+		trigger.actorsInside.emplace_back(actorUID);
+		stats.overlapCount++;
+	}
+}
+
+void TriggerSystem::Tick()
+{
+	stats = {};
+
+	triggers.clear();
+	largeTriggers.clear();
+	inactiveTriggers.clear();
+
+	//Cells nothing was in last frame are dropped, so triggers moving through the world don't grow the map forever.
+	for (auto cellIt = cells.begin(); cellIt != cells.end();)
+	{
+		if (cellIt->second.empty())
+		{
+			cellIt = cells.erase(cellIt);
+		}
+		else
+		{
+			cellIt->second.clear();
+			cellIt++;
+		}
+	}
+
+	for (auto& boxTrigger : BoxTriggerComponent::system.GetComponents())
+	{
+		if (!boxTrigger->IsActive())
+		{
+			//Actors inside when it was deactivated still have to get their exit.
+			if (!boxTrigger->GetOverlappingActorUIDs().empty() || boxTrigger->ContainsTarget())
+			{
+				inactiveTriggers.emplace_back(boxTrigger->GetUID());
+			}
+			continue;
+		}
+
+		TriggerEntry& trigger = triggers.emplace_back();
+		trigger.uid = boxTrigger->GetUID();
+		trigger.bounds = boxTrigger->GetBoundsInWorldSpace();
+		AddTriggerToGrid(static_cast<uint32_t>(triggers.size() - 1));
+	}
+
+	for (const UID triggerUID : inactiveTriggers)
+	{
+		BoxTriggerComponent* boxTrigger = BoxTriggerComponent::system.GetComponentByUID(triggerUID);
+		if (boxTrigger != nullptr)
+		{
+			std::vector<UID> noActors;
+			boxTrigger->UpdateOverlaps(noActors);
+		}
+	}
+
+	if (triggers.empty())
+	{
+		return;
+	}
+
+	for (auto actor : World::GetAllActorsInWorld())
+	{
+		//Removed actors are only deactivated at first, they leave triggers from here.
+		if (!actor->IsActive())
+		{
+			continue;
+		}
+
+		stats.actorCount++;
+
+		const XMFLOAT3 p = actor->GetPosition();
+		const XMVECTOR position = XMLoadFloat3(&p);
+		const UID actorUID = actor->GetUID();
+
+		auto cellIt = cells.find(CellKey(ToCell(p.x), ToCell(p.y), ToCell(p.z)));
+		if (cellIt != cells.end())
+		{
+			for (const uint32_t triggerIndex : cellIt->second)
+			{
+				TestActor(triggerIndex, actorUID, position);
+			}
+		}
+
+		for (const uint32_t triggerIndex : largeTriggers)
+		{
+			TestActor(triggerIndex, actorUID, position);
+		}
+	}
+
+	stats.triggerCount = static_cast<int>(triggers.size());
+	stats.largeTriggerCount = static_cast<int>(largeTriggers.size());
+	for (const auto& [key, cellTriggers] : cells)
+	{
+		stats.occupiedCells += !cellTriggers.empty();
+	}
+
+	//Looked up again by UID, an event handler might have removed other triggers.
+	for (TriggerEntry& trigger : triggers)
+	{
+		BoxTriggerComponent* boxTrigger = BoxTriggerComponent::system.GetComponentByUID(trigger.uid);
+		if (boxTrigger != nullptr)
+		{
+			boxTrigger->UpdateOverlaps(trigger.actorsInside);
+		}
+	}
+}
+
+TriggerSystem::Stats TriggerSystem::GetStats()
+{
+	return stats;
+}
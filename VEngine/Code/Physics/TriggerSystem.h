@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+//Works out which actors are inside which BoxTriggerComponents once per frame and hands each trigger its
+//enter/stay/exit events, instead of every trigger (or its owning actor) testing every actor it cares about.
+//Triggers are binned into a uniform grid by their world bounds, then every actor's position is looked up in its
+//one cell and only tested against the triggers there. Like Contains(), an actor is inside a trigger when its
+//position is.
+namespace TriggerSystem
+{
+	struct Stats
+	{
+		int triggerCount = 0;
+		int largeTriggerCount = 0; //Too big for the grid, tested against every actor
+		int actorCount = 0;
+		int occupiedCells = 0;
+		uint64_t containsTests = 0;
+		uint64_t overlapCount = 0;
+	};
+
+	//Width of a grid cell in world units. Grid actors sit on 1 unit spacing and triggers mostly fit inside one.
+	extern float cellSize;
+
+	//Called once per gameplay frame, before actors tick.
+	void Tick();
+
+	Stats GetStats();
+}
@@ -0,0 +1,177 @@
+#include "vpch.h"
+#include "WorldBVH.h"
+#include "Core/World.h"
+#include "Actors/Actor.h"
+#include "Components/MeshComponent.h"
+
+struct MeshProxy
+{
+	MeshComponent* mesh = nullptr;
+	int proxyId = DynamicAABBTree::nullNode;
+	uint64_t lastSeenRefresh = 0;
+	bool queued = false;
+};
+
+struct WorldBVHState
+{
+	DynamicAABBTree tree;
+	std::unordered_map<const MeshComponent*, MeshProxy> meshProxies;
+	std::vector<const MeshComponent*> movedMeshes;
+
+	~WorldBVHState();
+};
+
+//Pooled MeshComponents can outlive the state at program exit, their destructors check this first.
+//A plain bool with static storage is never destroyed, so it's safe to read at any point.
+static bool stateDestroyed = false;
+
+WorldBVHState::~WorldBVHState()
+{
+	stateDestroyed = true;
+}
+
+static WorldBVHState state;
+static WorldBVH::Stats stats;
+static bool stale = true;
+
+void WorldBVH::MarkStale()
+{
+	stale = true;
+}
+
+void WorldBVH::QueueMeshUpdate(const MeshComponent* mesh)
+{
+	if (stateDestroyed || stale)
+	{
+		return;
+	}
+
+	//Meshes without a proxy aren't in world yet, MarkStale() picks them up once they are.
+	auto proxyIt = state.meshProxies.find(mesh);
+	if (proxyIt == state.meshProxies.end() || proxyIt->second.queued)
+	{
+		return;
+	}
+
+	proxyIt->second.queued = true;
+	state.movedMeshes.emplace_back(mesh);
+}
+
+void WorldBVH::EnsureUpToDate()
+{
+	if (stale)
+	{
+		Refresh();
+	}
+	else if (!state.movedMeshes.empty())
+	{
+		UpdateMovedMeshes();
+	}
+}
+
+static void MoveProxy(MeshProxy& proxy)
+{
+	const auto bounds = BVH::AABB::FromOrientedBox(proxy.mesh->GetBoundsInWorldSpace());
+	if (state.tree.MoveProxy(proxy.proxyId, bounds))
+	{
+		stats.reinsertCount++;
+	}
+}
+
+void WorldBVH::UpdateMovedMeshes()
+{
+	//Meshes destroyed since they were queued have already lost their proxy, so they're never dereferenced.
+	for (const MeshComponent* mesh : state.movedMeshes)
+	{
+		auto proxyIt = state.meshProxies.find(mesh);
+		if (proxyIt == state.meshProxies.end())
+		{
+			continue;
+		}
+
+		proxyIt->second.queued = false;
+		MoveProxy(proxyIt->second);
+		stats.movedUpdateCount++;
+	}
+
+	state.movedMeshes.clear();
+}
+
+void WorldBVH::Refresh()
+{
+	stats.refreshCount++;
+
+	for (auto actor : World::GetAllActorsInWorld())
+	{
+		for (auto mesh : actor->GetComponents<MeshComponent>())
+		{
+			auto proxyIt = state.meshProxies.find(mesh);
+			if (proxyIt == state.meshProxies.end())
+			{
+				MeshProxy proxy;
+				proxy.mesh = mesh;
+				proxy.proxyId = state.tree.CreateProxy(BVH::AABB::FromOrientedBox(mesh->GetBoundsInWorldSpace()), mesh);
+				proxy.lastSeenRefresh = stats.refreshCount;
+				state.meshProxies.emplace(mesh, proxy);
+				continue;
+			}
+
+			MoveProxy(proxyIt->second);
+			proxyIt->second.lastSeenRefresh = stats.refreshCount;
+			proxyIt->second.queued = false;
+		}
+	}
+
+	//Meshes that have been detached from their actor since the last refresh
+	for (auto proxyIt = state.meshProxies.begin(); proxyIt != state.meshProxies.end();)
+	{
+		if (proxyIt->second.lastSeenRefresh != stats.refreshCount)
+		{
+			state.tree.DestroyProxy(proxyIt->second.proxyId);
+			proxyIt = state.meshProxies.erase(proxyIt);
+		}
+		else
+		{
+			proxyIt++;
+		}
+	}
+
+	state.movedMeshes.clear();
+	stale = false;
+}
+
+void WorldBVH::RemoveMesh(MeshComponent* mesh)
+{
+	if (stateDestroyed)
+	{
+		return;
+	}
+
+	auto proxyIt = state.meshProxies.find(mesh);
+	if (proxyIt != state.meshProxies.end())
+	{
+		state.tree.DestroyProxy(proxyIt->second.proxyId);
+		state.meshProxies.erase(proxyIt);
+	}
+}
+
+void WorldBVH::Reset()
+{
+	state.tree.Clear();
+	state.meshProxies.clear();
+	state.movedMeshes.clear();
+	stats = {};
+	stale = true;
+}
+
+const DynamicAABBTree& WorldBVH::GetTree()
+{
+	return state.tree;
+}
+
+WorldBVH::Stats WorldBVH::GetStats()
+{
+	stats.proxyCount = state.tree.GetProxyCount();
+	stats.treeHeight = state.tree.GetHeight();
+	return stats;
+}
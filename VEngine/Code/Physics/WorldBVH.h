@@ -0,0 +1,37 @@
+#pragma once
+
+#include "BVH.h"
+
+class MeshComponent;
+
+//World-level dynamic BVH over the bounds of every actor owned MeshComponent in world.
+//Used by Physics::Raycast() and the box casts to cull meshes before the narrow phase.
+namespace WorldBVH
+{
+	struct Stats
+	{
+		int proxyCount = 0;
+		int treeHeight = 0;
+		uint64_t refreshCount = 0;
+		uint64_t movedUpdateCount = 0;
+		uint64_t reinsertCount = 0;
+	};
+
+	//Meshes added to or removed from the world. The next query does a full sync with the world.
+	void MarkStale();
+
+	//Called by MeshComponent when its world transform goes stale, only those proxies are moved on the next query.
+	void QueueMeshUpdate(const MeshComponent* mesh);
+
+	//Does a full Refresh() if stale, otherwise moves the queued meshes. Meshes still inside their fat bounds
+	//aren't reinserted. Has to run on the main thread.
+	void EnsureUpToDate();
+	void Refresh();
+	void UpdateMovedMeshes();
+
+	void RemoveMesh(MeshComponent* mesh);
+	void Reset();
+
+	const DynamicAABBTree& GetTree();
+	Stats GetStats();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <DirectXMath.h>
+
+//Low discrepancy sample points and direction warps shared by the CPU bakers (LightBake, ProbeBake).
+namespace BakeSampling
+{
+	inline uint32_t Hash(uint32_t x)
+	{
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	//A point in [0, 1)^2 from a hash of index. Used to shift GetSample() per bake point, so neighbouring points
+	//don't band the same way, and as a plain random sample where a sequence doesn't fit.
+	inline DirectX::XMFLOAT2 HashSample(uint32_t index)
+	{
+		const uint32_t hash = Hash(index);
+		return DirectX::XMFLOAT2((hash & 0xFFFF) / 65536.f, (hash >> 16) / 65536.f);
+	}
+
+	inline float RadicalInverse(uint32_t bits)
+	{
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		return static_cast<float>(bits) * 2.3283064365386963e-10f;
+	}
+
+	//Hammersley points in [0, 1)^2, shifted with wrap around.
+	inline DirectX::XMFLOAT2 GetSample(uint32_t sampleIndex, uint32_t sampleCount, const DirectX::XMFLOAT2& shift)
+	{
+		const float u = (sampleIndex + 0.5f) / sampleCount + shift.x;
+		const float v = RadicalInverse(sampleIndex) + shift.y;
+		return DirectX::XMFLOAT2(u - floorf(u), v - floorf(v));
+	}
+
+	inline void GetTangentBasis(DirectX::FXMVECTOR axis, DirectX::XMVECTOR& tangent, DirectX::XMVECTOR& bitangent)
+	{
+		using namespace DirectX;
+		const XMVECTOR helper = fabsf(XMVectorGetY(axis)) < 0.99f ? XMVectorSet(0.f, 1.f, 0.f, 0.f) : XMVectorSet(1.f, 0.f, 0.f, 0.f);
+		tangent = XMVector3Normalize(XMVector3Cross(helper, axis));
+		bitangent = XMVector3Cross(axis, tangent);
+	}
+
+	//Uniform over the cap of directions within acos(cosMaxAngle) of axis.
+	inline DirectX::XMVECTOR SampleCone(DirectX::FXMVECTOR axis, float cosMaxAngle, const DirectX::XMFLOAT2& sample)
+	{
+		using namespace DirectX;
+		XMVECTOR tangent, bitangent;
+		GetTangentBasis(axis, tangent, bitangent);
+
+		const float cosTheta = 1.f - sample.x * (1.f - cosMaxAngle);
+		const float sinTheta = sqrtf(std::max(0.f, 1.f - cosTheta * cosTheta));
+		const float phi = XM_2PI * sample.y;
+		return tangent * (cosf(phi) * sinTheta) + bitangent * (sinf(phi) * sinTheta) + axis * cosTheta;
+	}
+
+	//Uniform over the unit sphere, pdf is 1 / 4pi.
+	inline DirectX::XMVECTOR SampleSphere(const DirectX::XMFLOAT2& sample)
+	{
+		using namespace DirectX;
+		const float z = 1.f - 2.f * sample.x;
+		const float r = sqrtf(std::max(0.f, 1.f - z * z));
+		const float phi = XM_2PI * sample.y;
+		return XMVectorSet(r * cosf(phi), r * sinf(phi), z, 0.f);
+	}
+
+	//Cosine weighted around normal, pdf is cos / pi.
+	inline DirectX::XMVECTOR SampleHemisphere(DirectX::FXMVECTOR normal, const DirectX::XMFLOAT2& sample)
+	{
+		using namespace DirectX;
+		XMVECTOR tangent, bitangent;
+		GetTangentBasis(normal, tangent, bitangent);
+
+		const float r = sqrtf(sample.x);
+		const float phi = XM_2PI * sample.y;
+		return tangent * (r * cosf(phi)) + bitangent * (r * sinf(phi)) + normal * sqrtf(std::max(0.f, 1.f - sample.x));
+	}
+}
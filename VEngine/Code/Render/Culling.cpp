@@ -0,0 +1,344 @@
+#include "vpch.h"
+#include "Culling.h"
+#include <algorithm>
+#include <cfloat>
+#include "Core/ParallelFor.h"
+#include "Core/Profile.h"
+#include "Components/MeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/InstanceMeshComponent.h"
+
+using namespace DirectX;
+
+bool Culling::enabled = true;
+
+//Skeletal mesh bounds come from the bind pose, animation can take joints well outside of them.
+static constexpr float skinnedBoundsScale = 1.5f;
+
+static constexpr size_t minBoundsPerJob = 1024;
+
+static Culling::BoundsSoA packedBounds;
+static std::vector<uint32_t> visibleIndices;
+static Culling::VisibleLists visibleLists;
+static Culling::Stats stats;
+
+Culling::Frustum Culling::ExtractFrustum(FXMMATRIX viewProjection)
+{
+	//Ref: https://www.gamedevs.org/uploads/fast-extraction-viewing-frustum-planes-from-world-view-projection-matrix.pdf
+	//Rows of the transpose are the columns that clip space x, y, z and w come from.
+	const XMMATRIX m = XMMatrixTranspose(viewProjection);
+
+	const XMVECTOR planes[6] =
+	{
+		m.r[3] + m.r[0], //Left
+		m.r[3] - m.r[0], //Right
+		m.r[3] + m.r[1], //Bottom
+		m.r[3] - m.r[1], //Top
+		m.r[2], //Near
+		m.r[3] - m.r[2], //Far
+	};
+
+	Frustum frustum;
+	for (int i = 0; i < 6; i++)
+	{
+		XMStoreFloat4(&frustum.planes[i], XMPlaneNormalize(planes[i]));
+	}
+	return frustum;
+}
+
+void Culling::BoundsSoA::Resize(size_t newCount)
+{
+	count = newCount;
+
+	const size_t paddedCount = (newCount + 3) & ~static_cast<size_t>(3);
+	for (auto* values : { &centerX, &centerY, &centerZ, &extentsX, &extentsY, &extentsZ, &maxDistanceSq })
+	{
+		values->resize(paddedCount, 0.f);
+	}
+}
+
+void Culling::BoundsSoA::Set(size_t index, const BoundingBox& worldBounds, float maxDistance)
+{
+	centerX[index] = worldBounds.Center.x;
+	centerY[index] = worldBounds.Center.y;
+	centerZ[index] = worldBounds.Center.z;
+	extentsX[index] = worldBounds.Extents.x;
+	extentsY[index] = worldBounds.Extents.y;
+	extentsZ[index] = worldBounds.Extents.z;
+	maxDistanceSq[index] = maxDistance > 0.f ? maxDistance * maxDistance : FLT_MAX;
+}
+
+void Culling::BoundsSoA::Set(size_t index, const BoundingOrientedBox& worldBounds, float maxDistance)
+{
+	//AABB around the oriented box, each world axis takes the extents projected onto it.
+	const XMMATRIX rotation = XMMatrixRotationQuaternion(XMLoadFloat4(&worldBounds.Orientation));
+	const XMVECTOR extents = XMVectorAbs(rotation.r[0]) * worldBounds.Extents.x +
+		XMVectorAbs(rotation.r[1]) * worldBounds.Extents.y +
+		XMVectorAbs(rotation.r[2]) * worldBounds.Extents.z;
+
+	BoundingBox axisAlignedBounds;
+	axisAlignedBounds.Center = worldBounds.Center;
+	XMStoreFloat3(&axisAlignedBounds.Extents, extents);
+	Set(index, axisAlignedBounds, maxDistance);
+}
+
+void Culling::CullBounds(const BoundsSoA& bounds, const Frustum& frustum, FXMVECTOR viewPosition,
+	std::vector<uint32_t>& outVisibleIndices)
+{
+	//Planes splatted across lanes, so each batch tests 4 boxes against one plane at a time.
+	XMVECTOR planeX[6], planeY[6], planeZ[6], planeW[6];
+	XMVECTOR absPlaneX[6], absPlaneY[6], absPlaneZ[6];
+	for (int p = 0; p < 6; p++)
+	{
+		const XMVECTOR plane = XMLoadFloat4(&frustum.planes[p]);
+		planeX[p] = XMVectorSplatX(plane);
+		planeY[p] = XMVectorSplatY(plane);
+		planeZ[p] = XMVectorSplatZ(plane);
+		planeW[p] = XMVectorSplatW(plane);
+		absPlaneX[p] = XMVectorAbs(planeX[p]);
+		absPlaneY[p] = XMVectorAbs(planeY[p]);
+		absPlaneZ[p] = XMVectorAbs(planeZ[p]);
+	}
+
+	const XMVECTOR viewX = XMVectorSplatX(viewPosition);
+	const XMVECTOR viewY = XMVectorSplatY(viewPosition);
+	const XMVECTOR viewZ = XMVectorSplatZ(viewPosition);
+	const XMVECTOR zero = XMVectorZero();
+
+	const auto load = [](const std::vector<float>& values, size_t index)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+		};
+
+	for (size_t i = 0; i < bounds.count; i += 4)
+	{
+		const XMVECTOR centerX = load(bounds.centerX, i);
+		const XMVECTOR centerY = load(bounds.centerY, i);
+		const XMVECTOR centerZ = load(bounds.centerZ, i);
+		const XMVECTOR extentsX = load(bounds.extentsX, i);
+		const XMVECTOR extentsY = load(bounds.extentsY, i);
+		const XMVECTOR extentsZ = load(bounds.extentsZ, i);
+
+		//A box is outside a plane when its center is further behind it than the box's projected radius.
+		XMVECTOR inside = XMVectorTrueInt();
+		for (int p = 0; p < 6; p++)
+		{
+			const XMVECTOR distance = XMVectorMultiplyAdd(centerZ, planeZ[p],
+				XMVectorMultiplyAdd(centerY, planeY[p], XMVectorMultiplyAdd(centerX, planeX[p], planeW[p])));
+			const XMVECTOR radius = XMVectorMultiplyAdd(extentsZ, absPlaneZ[p],
+				XMVectorMultiplyAdd(extentsY, absPlaneY[p], extentsX * absPlaneX[p]));
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(distance + radius, zero));
+		}
+
+		//Distance from the view position to the closest point on the box.
+		const XMVECTOR deltaX = XMVectorMax(XMVectorAbs(centerX - viewX) - extentsX, zero);
+		const XMVECTOR deltaY = XMVectorMax(XMVectorAbs(centerY - viewY) - extentsY, zero);
+		const XMVECTOR deltaZ = XMVectorMax(XMVectorAbs(centerZ - viewZ) - extentsZ, zero);
+		const XMVECTOR distanceSq = XMVectorMultiplyAdd(deltaZ, deltaZ,
+			XMVectorMultiplyAdd(deltaY, deltaY, deltaX * deltaX));
+		inside = XMVectorAndInt(inside, XMVectorLessOrEqual(distanceSq, load(bounds.maxDistanceSq, i)));
+
+		uint32_t laneMask[4];
+		XMStoreInt4(laneMask, inside);
+
+		const size_t laneCount = std::min<size_t>(4, bounds.count - i);
+		for (size_t lane = 0; lane < laneCount; lane++)
+		{
+			if (laneMask[lane])
+			{
+				outVisibleIndices.emplace_back(static_cast<uint32_t>(i + lane));
+			}
+		}
+	}
+}
+
+//Packs the bounds of every candidate and fills outVisible (and outShadowCasters if given) with the ones
+//the camera and light can see.
+template <typename T, typename IsDrawnFunc, typename CastsShadowFunc>
+static void CullMeshes(const std::vector<T*>& candidates, float boundsScale,
+	const Culling::Frustum& cameraFrustum, const Culling::Frustum* lightFrustum, FXMVECTOR cameraPosition,
+	IsDrawnFunc isDrawn, CastsShadowFunc castsShadow,
+	std::vector<T*>& outVisible, std::vector<T*>* outShadowCasters)
+{
+	if (!Culling::enabled)
+	{
+		for (T* mesh : candidates)
+		{
+			if (isDrawn(mesh)) outVisible.emplace_back(mesh);
+			if (outShadowCasters && castsShadow(mesh)) outShadowCasters->emplace_back(mesh);
+		}
+		return;
+	}
+
+	//Workers only read the cached world matrices, GatherCandidates() brings them up to date first.
+	packedBounds.Resize(candidates.size());
+	ParallelFor(candidates.size(), minBoundsPerJob, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				T* mesh = candidates[i];
+				BoundingOrientedBox worldBounds = mesh->GetCachedBoundsInWorldSpace();
+				worldBounds.Extents.x *= boundsScale;
+				worldBounds.Extents.y *= boundsScale;
+				worldBounds.Extents.z *= boundsScale;
+				packedBounds.Set(i, worldBounds, mesh->cullDistance);
+			}
+		});
+
+	visibleIndices.clear();
+	Culling::CullBounds(packedBounds, cameraFrustum, cameraPosition, visibleIndices);
+	for (const uint32_t index : visibleIndices)
+	{
+		if (isDrawn(candidates[index])) outVisible.emplace_back(candidates[index]);
+	}
+
+	if (outShadowCasters && lightFrustum)
+	{
+		//Distance culling still goes off the camera, a mesh that's too far away to draw doesn't cast either.
+		visibleIndices.clear();
+		Culling::CullBounds(packedBounds, *lightFrustum, cameraPosition, visibleIndices);
+		for (const uint32_t index : visibleIndices)
+		{
+			if (castsShadow(candidates[index])) outShadowCasters->emplace_back(candidates[index]);
+		}
+	}
+}
+
+template <typename T>
+static void GatherCandidates(std::vector<T*>& outCandidates)
+{
+	outCandidates.clear();
+	for (auto& mesh : T::system.GetComponents())
+	{
+		if (mesh->IsVisible())
+		{
+			//Gameplay or the editor can have moved things since the end of the last tick, refreshed here on
+			//the main thread as the bounds are packed in parallel.
+			mesh->GetWorldMatrix();
+			outCandidates.emplace_back(mesh.get());
+		}
+	}
+}
+
+void Culling::CullFrame(FXMMATRIX cameraViewProjection, FXMVECTOR cameraPosition,
+	bool cullShadowCasters, CXMMATRIX lightViewProjection)
+{
+	const auto startTime = Profile::QuickStart();
+
+	visibleLists.meshes.clear();
+	visibleLists.skeletalMeshes.clear();
+	visibleLists.instanceMeshes.clear();
+	visibleLists.shadowMeshes.clear();
+	visibleLists.shadowSkeletalMeshes.clear();
+
+	const Frustum cameraFrustum = ExtractFrustum(cameraViewProjection);
+	const Frustum lightFrustum = ExtractFrustum(lightViewProjection);
+	const Frustum* shadowFrustum = cullShadowCasters ? &lightFrustum : nullptr;
+
+	const auto castsShadow = [](MeshComponent* mesh) { return mesh->castsShadow && mesh->IsActive(); };
+
+	static std::vector<MeshComponent*> meshCandidates;
+	GatherCandidates(meshCandidates);
+	CullMeshes(meshCandidates, 1.f, cameraFrustum, shadowFrustum, cameraPosition,
+		[](MeshComponent* mesh) { return mesh->IsActive(); }, castsShadow,
+		visibleLists.meshes, cullShadowCasters ? &visibleLists.shadowMeshes : nullptr);
+
+	//Skeletal meshes have never checked IsActive() for the main pass.
+	static std::vector<SkeletalMeshComponent*> skeletalMeshCandidates;
+	GatherCandidates(skeletalMeshCandidates);
+	CullMeshes(skeletalMeshCandidates, skinnedBoundsScale, cameraFrustum, shadowFrustum, cameraPosition,
+		[](SkeletalMeshComponent*) { return true; }, castsShadow,
+		visibleLists.skeletalMeshes, cullShadowCasters ? &visibleLists.shadowSkeletalMeshes : nullptr);
+
+	//Instances can be anywhere in the world, so the whole component is tested against the box around all of
+	//them first, then each of its instances. Visible instances are packed into visibleInstances for the draw.
+	static std::vector<InstanceMeshComponent*> instanceMeshCandidates;
+	instanceMeshCandidates.clear();
+	for (auto& instanceMesh : InstanceMeshComponent::system.GetComponents())
+	{
+		if (instanceMesh->IsVisible() && instanceMesh->IsActive())
+		{
+			instanceMesh->UpdateInstanceBounds();
+			instanceMeshCandidates.emplace_back(instanceMesh.get());
+		}
+	}
+
+	stats.testedInstances = 0;
+	stats.visibleInstances = 0;
+
+	const auto cullInstances = [&](InstanceMeshComponent* instanceMesh)
+		{
+			const auto& instanceBounds = instanceMesh->GetInstanceBounds();
+			auto& visibleInstances = instanceMesh->visibleInstances;
+			visibleInstances.clear();
+
+			if (enabled)
+			{
+				CullBounds(instanceBounds, cameraFrustum, cameraPosition, visibleInstances);
+			}
+			else
+			{
+				for (uint32_t i = 0; i < instanceBounds.count; i++)
+				{
+					visibleInstances.emplace_back(i);
+				}
+			}
+
+			//Instance data can be longer than the instance count the component draws.
+			const auto drawnEnd = std::lower_bound(visibleInstances.begin(), visibleInstances.end(),
+				instanceMesh->GetInstanceCount());
+			visibleInstances.erase(drawnEnd, visibleInstances.end());
+
+			stats.testedInstances += static_cast<uint32_t>(instanceBounds.count);
+			stats.visibleInstances += static_cast<uint32_t>(visibleInstances.size());
+
+			if (!visibleInstances.empty())
+			{
+				visibleLists.instanceMeshes.emplace_back(instanceMesh);
+			}
+		};
+
+	if (enabled)
+	{
+		packedBounds.Resize(instanceMeshCandidates.size());
+		for (size_t i = 0; i < instanceMeshCandidates.size(); i++)
+		{
+			InstanceMeshComponent* instanceMesh = instanceMeshCandidates[i];
+			packedBounds.Set(i, instanceMesh->GetCombinedInstanceBounds(), instanceMesh->cullDistance);
+		}
+
+		visibleIndices.clear();
+		CullBounds(packedBounds, cameraFrustum, cameraPosition, visibleIndices);
+		for (const uint32_t index : visibleIndices)
+		{
+			cullInstances(instanceMeshCandidates[index]);
+		}
+	}
+	else
+	{
+		for (InstanceMeshComponent* instanceMesh : instanceMeshCandidates)
+		{
+			cullInstances(instanceMesh);
+		}
+	}
+
+	stats.testedMeshes = static_cast<uint32_t>(meshCandidates.size() + skeletalMeshCandidates.size() +
+		instanceMeshCandidates.size());
+	stats.visibleMeshes = static_cast<uint32_t>(visibleLists.meshes.size() + visibleLists.skeletalMeshes.size() +
+		visibleLists.instanceMeshes.size());
+	stats.testedShadowCasters = cullShadowCasters ?
+		static_cast<uint32_t>(meshCandidates.size() + skeletalMeshCandidates.size()) : 0;
+	stats.visibleShadowCasters = static_cast<uint32_t>(visibleLists.shadowMeshes.size() +
+		visibleLists.shadowSkeletalMeshes.size());
+	stats.cullTime = Profile::QuickEnd(startTime);
+}
+
+const Culling::VisibleLists& Culling::GetVisibleLists()
+{
+	return visibleLists;
+}
+
+const Culling::Stats& Culling::GetStats()
+{
+	return stats;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+
+class MeshComponent;
+class SkeletalMeshComponent;
+class InstanceMeshComponent;
+
+//CPU visibility culling that runs ahead of mesh submission.
+//World space bounds are packed into structure of arrays and tested 4 at a time against the planes of a
+//view-projection matrix. Renderer calls CullFrame() once a frame, for the camera and for the shadow casting
+//light, and each pass then walks its own visible list instead of every component in the world.
+namespace Culling
+{
+	struct Frustum
+	{
+		//Normalised, xyz points into the frustum.
+		DirectX::XMFLOAT4 planes[6];
+	};
+
+	//Works for perspective and orthographic matrices (D3D clip space, 0 <= z <= w).
+	Frustum ExtractFrustum(DirectX::FXMMATRIX viewProjection);
+
+	//World space AABBs, padded out to a multiple of 4 so that the last batch can be loaded whole.
+	struct BoundsSoA
+	{
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentsX, extentsY, extentsZ;
+		std::vector<float> maxDistanceSq;
+		size_t count = 0;
+
+		void Resize(size_t newCount);
+
+		//maxDistance is how far from the view position the box can be before it's culled, 0 for no limit.
+		void Set(size_t index, const DirectX::BoundingBox& worldBounds, float maxDistance = 0.f);
+		void Set(size_t index, const DirectX::BoundingOrientedBox& worldBounds, float maxDistance = 0.f);
+	};
+
+	//Appends the indices of boxes that intersect the frustum and are within their max distance of viewPosition.
+	//Plane/box tests are conservative, boxes near frustum corners can be let through.
+	void CullBounds(const BoundsSoA& bounds, const Frustum& frustum, DirectX::FXMVECTOR viewPosition,
+		std::vector<uint32_t>& outVisibleIndices);
+
+	struct VisibleLists
+	{
+		std::vector<MeshComponent*> meshes;
+		std::vector<SkeletalMeshComponent*> skeletalMeshes;
+		std::vector<InstanceMeshComponent*> instanceMeshes;
+
+		std::vector<MeshComponent*> shadowMeshes;
+		std::vector<SkeletalMeshComponent*> shadowSkeletalMeshes;
+	};
+
+	struct Stats
+	{
+		uint32_t testedMeshes = 0;
+		uint32_t visibleMeshes = 0;
+		uint32_t testedShadowCasters = 0;
+		uint32_t visibleShadowCasters = 0;
+		uint32_t testedInstances = 0;
+		uint32_t visibleInstances = 0;
+		double cullTime = 0.0;
+	};
+
+	//When off, CullFrame() still fills the visible lists, just without any frustum or distance tests.
+	extern bool enabled;
+
+	void CullFrame(DirectX::FXMMATRIX cameraViewProjection, DirectX::FXMVECTOR cameraPosition,
+		bool cullShadowCasters, DirectX::CXMMATRIX lightViewProjection);
+
+	const VisibleLists& GetVisibleLists();
+	const Stats& GetStats();
+}
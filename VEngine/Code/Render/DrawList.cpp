@@ -0,0 +1,150 @@
+#include "vpch.h"
+#include "DrawList.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+static constexpr uint32_t passBits = 4;
+static constexpr uint32_t shaderBits = 12;
+static constexpr uint32_t textureBits = 16;
+static constexpr uint32_t otherStateBits = 7;
+static constexpr uint32_t depthBits = 23;
+
+static_assert(passBits + 2 + shaderBits + textureBits + otherStateBits + depthBits == 64, "Sort key has to fill 64 bits");
+
+//Forget old states once this many have been seen, textures and meshes come and go between worlds.
+static constexpr size_t maxStateIds = 1 << 16;
+
+uint32_t DrawState::Compare(const DrawState& other) const
+{
+	uint32_t changes = 0;
+	if (shader != other.shader) changes |= Shader;
+	if (inputLayout != other.inputLayout) changes |= InputLayout;
+	if (rastState != other.rastState) changes |= RastState;
+	if (blendState != other.blendState) changes |= BlendState;
+	if (sampler != other.sampler) changes |= Sampler;
+	if (texture != other.texture || secondaryTexture != other.secondaryTexture) changes |= Textures;
+	if (materialData != other.materialData) changes |= MaterialData;
+	if (vertexBuffer != other.vertexBuffer) changes |= VertexBuffer;
+	return changes;
+}
+
+uint32_t DrawListStats::GetTotalBinds() const
+{
+	uint32_t total = 0;
+	for (const uint32_t binds : stateBinds)
+	{
+		total += binds;
+	}
+	return total;
+}
+
+void DrawListStats::Add(const DrawListStats& other)
+{
+	draws += other.draws;
+	for (int i = 0; i < DrawState::Count; i++)
+	{
+		stateBinds[i] += other.stateBinds[i];
+	}
+	bindsSaved += other.bindsSaved;
+}
+
+//Positive floats compare the same as their bits, so the top bits of the float are an order preserving depth
+//that doesn't need to know the depth range.
+static uint64_t QuantiseDepth(float depth)
+{
+	depth = std::max(depth, 0.f);
+	uint32_t bits = 0;
+	memcpy(&bits, &depth, sizeof(bits));
+	return bits >> (32 - depthBits);
+}
+
+uint64_t DrawList::MakeSortKey(uint32_t pass, bool sortLast, bool transparent, uint32_t shaderId, uint32_t textureId,
+	uint32_t otherStateId, float depth)
+{
+	const uint64_t depthMask = (1ull << depthBits) - 1;
+
+	uint64_t key = static_cast<uint64_t>(pass & ((1u << passBits) - 1)) << (64 - passBits);
+
+	if (sortLast)
+	{
+		key |= 1ull << (63 - passBits);
+	}
+
+	const uint64_t state = (static_cast<uint64_t>(shaderId) << (textureBits + otherStateBits)) |
+		(static_cast<uint64_t>(textureId) << otherStateBits) | otherStateId;
+
+	if (transparent)
+	{
+		key |= 1ull << (62 - passBits);
+		key |= (~QuantiseDepth(depth) & depthMask) << (shaderBits + textureBits + otherStateBits);
+		key |= state;
+	}
+	else
+	{
+		key |= state << depthBits;
+		key |= QuantiseDepth(depth);
+	}
+
+	return key;
+}
+
+uint32_t DrawList::StateIds::Get(const void* state, uint32_t bitCount)
+{
+	if (ids.size() >= maxStateIds)
+	{
+		ids.clear();
+	}
+
+	const auto it = ids.try_emplace(state, static_cast<uint32_t>(ids.size())).first;
+	return it->second & ((1u << bitCount) - 1);
+}
+
+void DrawList::Clear()
+{
+	items.clear();
+	sortedEntries.clear();
+	stats = DrawListStats();
+}
+
+void DrawList::Add(uint32_t pass, bool sortLast, bool transparent, const DrawState& state, float depth, void* userData)
+{
+	Item item;
+	item.state = state;
+	item.userData = userData;
+	item.sortKey = MakeSortKey(pass, sortLast, transparent,
+		shaderIds.Get(state.shader, shaderBits),
+		textureIds.Get(state.texture, textureBits),
+		otherStateIds.Get(state.rastState, otherStateBits),
+		depth);
+
+	items.emplace_back(item);
+}
+
+void DrawList::Sort()
+{
+	//Sorting 16 byte entries and not the items themselves keeps the swaps cheap.
+	sortedEntries.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		sortedEntries[i] = { items[i].sortKey, static_cast<uint32_t>(i) };
+	}
+
+	std::sort(sortedEntries.begin(), sortedEntries.end(), [](const SortEntry& left, const SortEntry& right)
+		{
+			return left.sortKey < right.sortKey || (left.sortKey == right.sortKey && left.itemIndex < right.itemIndex);
+		});
+}
+
+void DrawList::CountBinds(uint32_t stateChanges)
+{
+	stats.draws++;
+	for (int i = 0; i < DrawState::Count; i++)
+	{
+		if (stateChanges & (1u << i))
+		{
+			stats.stateBinds[i]++;
+		}
+	}
+	stats.bindsSaved += DrawState::Count - std::popcount(stateChanges);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+//Everything a draw binds before it's submitted. The draw list only compares these for equality and never
+//dereferences them, so it doesn't depend on D3D and can be run and benchmarked without a device.
+struct DrawState
+{
+	enum Flags : uint32_t
+	{
+		Shader = 1 << 0,
+		InputLayout = 1 << 1,
+		RastState = 1 << 2,
+		BlendState = 1 << 3,
+		Sampler = 1 << 4,
+		Textures = 1 << 5,
+		MaterialData = 1 << 6,
+		VertexBuffer = 1 << 7,
+
+		All = (1 << 8) - 1,
+		Count = 8,
+	};
+
+	const void* shader = nullptr;
+	const void* inputLayout = nullptr;
+	const void* rastState = nullptr;
+	const void* blendState = nullptr;
+	const void* sampler = nullptr;
+	const void* texture = nullptr;
+	const void* secondaryTexture = nullptr;
+	const void* materialData = nullptr;
+	const void* vertexBuffer = nullptr;
+
+	//Returns the Flags of the states that differ from other.
+	uint32_t Compare(const DrawState& other) const;
+};
+
+struct DrawListStats
+{
+	uint32_t draws = 0;
+	uint32_t stateBinds[DrawState::Count]{};
+
+	//Binds that didn't need to happen because the previous draw had already bound the same state.
+	uint32_t bindsSaved = 0;
+
+	uint32_t GetTotalBinds() const;
+	void Add(const DrawListStats& other);
+};
+
+//Builds a list of draws with a 64-bit sort key each, sorts them and submits them with redundant binds filtered.
+//Key layout, most significant bits first:
+//	Opaque:			pass (4) | sort last (1) | 0 (1) | shader (12) | texture (16) | other state (7) | depth front to back (23)
+//	Transparent:	pass (4) | sort last (1) | 1 (1) | depth back to front (23) | shader (12) | texture (16) | other state (7)
+//Opaque draws are grouped by state and only go front to back inside a group, transparent draws only care about depth.
+//Sort last draws go after every other draw in their pass, opaque or not.
+class DrawList
+{
+public:
+	struct Item
+	{
+		uint64_t sortKey = 0;
+		DrawState state;
+		void* userData = nullptr;
+	};
+
+	static uint64_t MakeSortKey(uint32_t pass, bool sortLast, bool transparent, uint32_t shaderId, uint32_t textureId,
+		uint32_t otherStateId, float depth);
+
+	void Clear();
+
+	//depth is the distance from the camera (or anything else that grows away from it).
+	void Add(uint32_t pass, bool sortLast, bool transparent, const DrawState& state, float depth, void* userData);
+
+	void Sort();
+
+	//Calls submit(item, stateChanges) for every draw in key order. stateChanges holds the DrawState::Flags
+	//that differ from the previous draw, and is DrawState::All for the first one since nothing is known about
+	//what was bound before the list.
+	template <typename Func>
+	void Submit(Func submit)
+	{
+		const DrawState* previousState = nullptr;
+		for (const SortEntry& entry : sortedEntries)
+		{
+			const Item& item = items[entry.itemIndex];
+			const uint32_t stateChanges = previousState ? item.state.Compare(*previousState) : DrawState::All;
+			CountBinds(stateChanges);
+			submit(item, stateChanges);
+			previousState = &item.state;
+		}
+	}
+
+	size_t Size() const { return items.size(); }
+	const std::vector<Item>& GetItems() const { return items; }
+
+	//Items in submission order, valid after Sort().
+	const Item& GetSortedItem(size_t index) const { return items[sortedEntries[index].itemIndex]; }
+
+	//Counts from the last Submit() since Clear().
+	const DrawListStats& GetStats() const { return stats; }
+
+private:
+	struct SortEntry
+	{
+		uint64_t sortKey;
+		uint32_t itemIndex;
+	};
+
+	//Small ids for state pointers so that they fit in the key. Ids stay the same across frames so that draw
+	//order doesn't shuffle around, and wrap once there are more states than bits (which only costs grouping).
+	class StateIds
+	{
+	public:
+		uint32_t Get(const void* state, uint32_t bitCount);
+
+	private:
+		std::unordered_map<const void*, uint32_t> ids;
+	};
+
+	void CountBinds(uint32_t stateChanges);
+
+	std::vector<Item> items;
+	std::vector<SortEntry> sortedEntries;
+
+	StateIds shaderIds;
+	StateIds textureIds;
+	StateIds otherStateIds;
+
+	DrawListStats stats;
+};
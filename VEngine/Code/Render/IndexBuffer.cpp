@@ -2,7 +2,7 @@
 #include "IndexBuffer.h"
 #include "Render/RenderUtils.h"
 
-void IndexBuffer::CreateDefault(std::vector<MeshData::indexDataType>& indices)
+void IndexBuffer::CreateDefault(ArrayView<MeshData::indexDataType> indices)
 {
 	RenderUtils::CreateIndexBuffer(indices, data);
 }
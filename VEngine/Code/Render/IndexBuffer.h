@@ -8,11 +8,13 @@
 class IndexBuffer
 {
 public:
-	void CreateDefault(std::vector<MeshData::indexDataType>& indices);
+	void CreateDefault(ArrayView<MeshData::indexDataType> indices);
 	void CreateDynamic(std::vector<MeshData::indexDataType>& indices);
 	void CreateDynamicCapped(std::vector<MeshData::indexDataType>& indexData, uint32_t cappedSize);
 	void Destroy();
 
+	bool Empty() const { return data == nullptr; }
+
 	auto GetDataAddress() { return data.GetAddressOf(); }
 	auto GetData() { return data.Get(); }
 
@@ -0,0 +1,528 @@
+#include "vpch.h"
+#include "LightBake.h"
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
+#include "Asset/AssetSystem.h"
+#include "Components/MeshComponent.h"
+#include "Components/Lights/DirectionalLightComponent.h"
+#include "Components/Lights/PointLightComponent.h"
+#include "Components/Lights/SpotLightComponent.h"
+#include "Core/Log.h"
+#include "Core/ParallelFor.h"
+#include "Core/Profile.h"
+#include "Core/World.h"
+#include "Physics/BVH.h"
+#include "BakeSampling.h"
+
+LightBake::Settings LightBake::settings;
+
+//Ray origins are pushed this far off the surface along the vertex normal so vertices don't shadow themselves.
+static constexpr float surfaceOffset = 0.1f;
+static constexpr float directionalShadowDistance = 50.f;
+
+enum class BakeLightType
+{
+	Directional,
+	Point,
+	Spot
+};
+
+struct BakeLight
+{
+	UID uid = 0;
+	BakeLightType type = BakeLightType::Directional;
+	XMFLOAT3 position = XMFLOAT3(0.f, 0.f, 0.f);
+	XMFLOAT3 direction = XMFLOAT3(0.f, 0.f, 1.f); //Where the light shines, normalised
+	float range = 0.f;
+	float spotAngle = 0.f; //Degrees
+};
+
+//World space and already pushed off the surface.
+struct BakePoint
+{
+	XMFLOAT3 position;
+	XMFLOAT3 normal;
+};
+
+struct BakeMesh
+{
+	UID uid = 0;
+	std::vector<XMFLOAT4> baseColours; //What the bake multiplies, one per vertex
+	std::vector<uint32_t> vertexPoints; //Into BakeJob::points, one per vertex
+	std::vector<XMFLOAT4> bakedColours; //Filled in by the job
+};
+
+//Everything the job needs, copied out of the world on the main thread so tracing never touches components.
+struct BakeJob
+{
+	std::string worldFilename;
+	LightBake::Settings settings;
+	std::vector<BakeLight> lights;
+
+	//World space triangles of every static mesh, three positions each.
+	std::vector<XMFLOAT3> sceneTriangles;
+	TriangleBVH sceneBVH;
+
+	std::vector<BakePoint> points;
+	std::vector<BakeMesh> meshes;
+	size_t vertexCount = 0;
+
+	double gatherTime = 0.0;
+	double traceTime = 0.0;
+};
+
+//What the last applied bake saw, for BakeChangedLights().
+struct BakeState
+{
+	std::string worldFilename;
+	std::unordered_map<UID, BakeLight> lights;
+
+	//A mesh still holding its baked colours is baked from its base colours again, instead of darkening the
+	//baked ones a second time. Colours painted over since the last bake become the new base.
+	struct MeshColours
+	{
+		std::vector<XMFLOAT4> base;
+		std::vector<XMFLOAT4> baked;
+	};
+	std::unordered_map<UID, MeshColours> meshes;
+};
+
+static BakeState bakeState;
+static std::future<std::unique_ptr<BakeJob>> runningBake;
+
+//Vertices split for UVs (or triangle soup) share a position and normal, and so share a result.
+struct PointKey
+{
+	XMFLOAT3 position;
+	XMFLOAT3 normal;
+
+	bool operator==(const PointKey& other) const { return memcmp(this, &other, sizeof(PointKey)) == 0; }
+};
+
+struct PointKeyHash
+{
+	size_t operator()(const PointKey& key) const
+	{
+		uint32_t words[6];
+		memcpy(words, &key, sizeof(words));
+
+		size_t hash = 0;
+		for (const uint32_t word : words)
+		{
+			hash = hash * 31 + std::hash<uint32_t>()(word);
+		}
+		return hash;
+	}
+};
+
+static bool SameLight(const BakeLight& a, const BakeLight& b)
+{
+	return a.type == b.type &&
+		memcmp(&a.position, &b.position, sizeof(XMFLOAT3)) == 0 &&
+		memcmp(&a.direction, &b.direction, sizeof(XMFLOAT3)) == 0 &&
+		a.range == b.range && a.spotAngle == b.spotAngle;
+}
+
+//Point and spot lights only shadow what's in range, directional lights reach everything.
+static bool LightReaches(const BakeLight& light, const BoundingOrientedBox& bounds)
+{
+	if (light.type == BakeLightType::Directional)
+	{
+		return true;
+	}
+	return BoundingSphere(light.position, light.range).Intersects(bounds);
+}
+
+static void GatherLights(std::vector<BakeLight>& outLights)
+{
+	for (const auto& directionalLight : DirectionalLightComponent::system.GetComponents())
+	{
+		BakeLight& light = outLights.emplace_back();
+		light.uid = directionalLight->GetUID();
+		light.type = BakeLightType::Directional;
+		XMStoreFloat3(&light.direction, XMVector3Normalize(directionalLight->GetForwardVectorV()));
+	}
+
+	for (const auto& pointLight : PointLightComponent::system.GetComponents())
+	{
+		BakeLight& light = outLights.emplace_back();
+		light.uid = pointLight->GetUID();
+		light.type = BakeLightType::Point;
+		XMStoreFloat3(&light.position, pointLight->GetWorldPositionV());
+		light.range = pointLight->GetLightData().range;
+	}
+
+	for (const auto& spotLight : SpotLightComponent::system.GetComponents())
+	{
+		BakeLight& light = outLights.emplace_back();
+		light.uid = spotLight->GetUID();
+		light.type = BakeLightType::Spot;
+		XMStoreFloat3(&light.position, spotLight->GetWorldPositionV());
+		XMStoreFloat3(&light.direction, XMVector3Normalize(spotLight->GetForwardVectorV()));
+		light.range = spotLight->GetLightData().range;
+		light.spotAngle = spotLight->GetLightData().spotAngle;
+	}
+}
+
+static void AddOccluder(MeshComponent& mesh, std::vector<XMFLOAT3>& sceneTriangles)
+{
+	const XMMATRIX worldMatrix = mesh.GetWorldMatrix();
+	const ArrayView<XMFLOAT3> positions = mesh.meshDataProxy.GetPositions();
+	const size_t triangleCount = mesh.meshDataProxy.GetTriangleCount();
+
+	for (size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+	{
+		uint32_t vertexIndices[3];
+		mesh.meshDataProxy.GetTriangleVertexIndices(triangleIndex, vertexIndices);
+		for (const uint32_t vertexIndex : vertexIndices)
+		{
+			XMStoreFloat3(&sceneTriangles.emplace_back(),
+				XMVector3TransformCoord(XMLoadFloat3(&positions[vertexIndex]), worldMatrix));
+		}
+	}
+}
+
+static void AddReceiver(MeshComponent& mesh, BakeJob& job)
+{
+	const MeshDataProxy& proxy = mesh.meshDataProxy;
+	const size_t vertexCount = proxy.GetVertexCount();
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	BakeMesh& bakeMesh = job.meshes.emplace_back();
+	bakeMesh.uid = mesh.GetUID();
+
+	bakeMesh.baseColours.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		bakeMesh.baseColours[i] = proxy.GetColour(i);
+	}
+
+	auto previousColours = bakeState.meshes.find(bakeMesh.uid);
+	if (previousColours != bakeState.meshes.end() && previousColours->second.baked.size() == vertexCount &&
+		memcmp(previousColours->second.baked.data(), bakeMesh.baseColours.data(), sizeof(XMFLOAT4) * vertexCount) == 0)
+	{
+		bakeMesh.baseColours = previousColours->second.base;
+	}
+
+	const XMMATRIX worldMatrix = mesh.GetWorldMatrix();
+	const ArrayView<XMFLOAT3> positions = proxy.GetPositions();
+
+	std::unordered_map<PointKey, uint32_t, PointKeyHash> uniquePoints;
+	uniquePoints.reserve(vertexCount);
+	bakeMesh.vertexPoints.resize(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		const PointKey key = { positions[i], proxy.GetNormal(i) };
+		auto [pointIt, inserted] = uniquePoints.try_emplace(key, static_cast<uint32_t>(job.points.size()));
+		if (inserted)
+		{
+			const XMVECTOR normal = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&key.normal), worldMatrix));
+			const XMVECTOR position = XMVector3TransformCoord(XMLoadFloat3(&key.position), worldMatrix);
+
+			BakePoint& point = job.points.emplace_back();
+			XMStoreFloat3(&point.position, position + normal * surfaceOffset);
+			XMStoreFloat3(&point.normal, normal);
+		}
+		bakeMesh.vertexPoints[i] = pointIt->second;
+	}
+
+	job.vertexCount += vertexCount;
+}
+
+//Back faces occlude too, like the old bake's raycasts.
+static bool IsOccluded(const BakeJob& job, FXMVECTOR origin, FXMVECTOR direction, float distance)
+{
+	const BVH::Ray ray(origin, direction, distance);
+	return job.sceneBVH.QueryRayAny(ray, [&](uint32_t triangleIndex)
+		{
+			const XMFLOAT3* triangle = &job.sceneTriangles[triangleIndex * 3];
+			float hitDistance = 0.f;
+			return TriangleTests::Intersects(origin, direction, XMLoadFloat3(&triangle[0]),
+				XMLoadFloat3(&triangle[1]), XMLoadFloat3(&triangle[2]), hitDistance) && hitDistance < distance;
+		});
+}
+
+//What the point's colour gets multiplied by.
+static float BakePointFactor(const BakeJob& job, uint32_t pointIndex)
+{
+	const LightBake::Settings& bakeSettings = job.settings;
+	const BakePoint& point = job.points[pointIndex];
+	const XMVECTOR origin = XMLoadFloat3(&point.position);
+	const XMVECTOR normal = XMLoadFloat3(&point.normal);
+
+	const XMFLOAT2 shift = BakeSampling::HashSample(pointIndex);
+
+	const uint32_t shadowSamples = static_cast<uint32_t>(std::max(1, bakeSettings.shadowSamples));
+	const bool softShadows = shadowSamples > 1;
+	const float cosDirectionalLightAngle = cosf(XMConvertToRadians(bakeSettings.directionalLightAngle));
+
+	float factor = 1.f;
+
+	for (const BakeLight& light : job.lights)
+	{
+		const XMVECTOR lightPosition = XMLoadFloat3(&light.position);
+		const XMVECTOR lightDirection = XMLoadFloat3(&light.direction);
+
+		if (light.type != BakeLightType::Directional)
+		{
+			const XMVECTOR toLight = lightPosition - origin;
+			if (XMVectorGetX(XMVector3Length(toLight)) > light.range)
+			{
+				continue;
+			}
+
+			if (light.type == BakeLightType::Spot)
+			{
+				const float angle = XMConvertToDegrees(XMVectorGetX(
+					XMVector3AngleBetweenNormals(lightDirection, XMVector3Normalize(-toLight))));
+				if (angle > light.spotAngle)
+				{
+					continue;
+				}
+			}
+		}
+
+		uint32_t occludedSamples = 0;
+		for (uint32_t sampleIndex = 0; sampleIndex < shadowSamples; sampleIndex++)
+		{
+			const XMFLOAT2 sample = BakeSampling::GetSample(sampleIndex, shadowSamples, shift);
+
+			if (light.type == BakeLightType::Directional)
+			{
+				XMVECTOR direction = -lightDirection;
+				if (softShadows)
+				{
+					direction = BakeSampling::SampleCone(direction, cosDirectionalLightAngle, sample);
+				}
+				occludedSamples += IsOccluded(job, origin, direction, directionalShadowDistance);
+			}
+			else
+			{
+				XMVECTOR target = lightPosition;
+				if (softShadows)
+				{
+					target += BakeSampling::SampleSphere(sample) * bakeSettings.pointLightRadius;
+				}
+
+				const XMVECTOR toTarget = target - origin;
+				const float distance = XMVectorGetX(XMVector3Length(toTarget));
+				if (distance > 0.f)
+				{
+					occludedSamples += IsOccluded(job, origin, toTarget / distance, distance);
+				}
+			}
+		}
+
+		const float occlusion = static_cast<float>(occludedSamples) / shadowSamples;
+		factor *= 1.f - occlusion * (1.f - bakeSettings.shadowColour);
+	}
+
+	if (bakeSettings.aoSamples > 0)
+	{
+		const uint32_t aoSamples = static_cast<uint32_t>(bakeSettings.aoSamples);
+		uint32_t occludedSamples = 0;
+		for (uint32_t sampleIndex = 0; sampleIndex < aoSamples; sampleIndex++)
+		{
+			const XMVECTOR direction = BakeSampling::SampleHemisphere(normal, BakeSampling::GetSample(sampleIndex, aoSamples, shift));
+			occludedSamples += IsOccluded(job, origin, direction, bakeSettings.aoDistance);
+		}
+
+		factor *= 1.f - bakeSettings.aoStrength * occludedSamples / aoSamples;
+	}
+
+	return factor;
+}
+
+static std::unique_ptr<BakeJob> RunBake(std::unique_ptr<BakeJob> job)
+{
+	const auto traceStart = Profile::QuickStart();
+
+	job->sceneBVH.Build(job->sceneTriangles);
+
+	std::vector<float> pointFactors(job->points.size());
+	ParallelFor(job->points.size(), 64, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				pointFactors[i] = BakePointFactor(*job, static_cast<uint32_t>(i));
+			}
+		});
+
+	for (BakeMesh& bakeMesh : job->meshes)
+	{
+		bakeMesh.bakedColours.resize(bakeMesh.baseColours.size());
+		for (size_t i = 0; i < bakeMesh.baseColours.size(); i++)
+		{
+			const float factor = pointFactors[bakeMesh.vertexPoints[i]];
+			const XMFLOAT4& base = bakeMesh.baseColours[i];
+			bakeMesh.bakedColours[i] = XMFLOAT4(base.x * factor, base.y * factor, base.z * factor, base.w);
+		}
+	}
+
+	job->traceTime = Profile::QuickEnd(traceStart);
+	return job;
+}
+
+static void StartBake(bool onlyChangedLights)
+{
+	if (LightBake::IsBaking())
+	{
+		Log("Light bake already running.");
+		return;
+	}
+
+	if (bakeState.worldFilename != World::worldFilename)
+	{
+		bakeState = BakeState();
+		bakeState.worldFilename = World::worldFilename;
+	}
+
+	const auto gatherStart = Profile::QuickStart();
+
+	auto job = std::make_unique<BakeJob>();
+	job->worldFilename = World::worldFilename;
+	job->settings = LightBake::settings;
+	GatherLights(job->lights);
+
+	const bool bakeEverything = !onlyChangedLights || bakeState.meshes.empty();
+
+	//Both where a changed light is now and where it was, so moving a light away un-shadows what it left.
+	std::vector<BakeLight> changedLights;
+	if (!bakeEverything)
+	{
+		std::unordered_set<UID> currentLights;
+		for (const BakeLight& light : job->lights)
+		{
+			currentLights.emplace(light.uid);
+
+			auto previous = bakeState.lights.find(light.uid);
+			if (previous == bakeState.lights.end())
+			{
+				changedLights.emplace_back(light);
+			}
+			else if (!SameLight(light, previous->second))
+			{
+				changedLights.emplace_back(light);
+				changedLights.emplace_back(previous->second);
+			}
+		}
+
+		for (const auto& [uid, light] : bakeState.lights)
+		{
+			if (!currentLights.contains(uid))
+			{
+				changedLights.emplace_back(light);
+			}
+		}
+	}
+
+	for (auto& mesh : MeshComponent::system.GetComponents())
+	{
+		if (!mesh->IsRenderStatic())
+		{
+			continue;
+		}
+
+		//Same meshes the old bake's raycasts could hit.
+		const CollisionLayers layer = mesh->GetCollisionLayer();
+		if (mesh->IsActive() && layer != CollisionLayers::None && layer != CollisionLayers::Editor)
+		{
+			AddOccluder(*mesh, job->sceneTriangles);
+		}
+
+		bool rebake = bakeEverything || !bakeState.meshes.contains(mesh->GetUID());
+		if (!rebake)
+		{
+			const BoundingOrientedBox bounds = mesh->GetBoundsInWorldSpace();
+			rebake = std::any_of(changedLights.begin(), changedLights.end(),
+				[&](const BakeLight& light) { return LightReaches(light, bounds); });
+		}
+
+		if (rebake)
+		{
+			AddReceiver(*mesh, *job);
+		}
+	}
+
+	if (job->meshes.empty())
+	{
+		Log("Light bake: no meshes need re-baking.");
+		return;
+	}
+
+	job->gatherTime = Profile::QuickEnd(gatherStart);
+
+	Log("Light bake started on %zu meshes (%zu vertices, %zu unique), %zu lights, %zu scene triangles.",
+		job->meshes.size(), job->vertexCount, job->points.size(), job->lights.size(), job->sceneTriangles.size() / 3);
+
+	runningBake = std::async(std::launch::async, RunBake, std::move(job));
+}
+
+void LightBake::BakeAll()
+{
+	StartBake(false);
+}
+
+void LightBake::BakeChangedLights()
+{
+	StartBake(true);
+}
+
+bool LightBake::IsBaking()
+{
+	return runningBake.valid();
+}
+
+void LightBake::Tick()
+{
+	if (!runningBake.valid() || runningBake.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return;
+	}
+
+	std::unique_ptr<BakeJob> job = runningBake.get();
+	if (job->worldFilename != World::worldFilename)
+	{
+		Log("Light bake for [%s] discarded, a different world was loaded while it ran.", job->worldFilename.c_str());
+		return;
+	}
+
+	size_t skippedMeshes = 0;
+	for (BakeMesh& bakeMesh : job->meshes)
+	{
+		//Deleted or changed while the bake ran.
+		MeshComponent* mesh = MeshComponent::system.GetComponentByUID(bakeMesh.uid);
+		if (mesh == nullptr || mesh->meshDataProxy.GetVertexCount() != bakeMesh.bakedColours.size())
+		{
+			skippedMeshes++;
+			continue;
+		}
+
+		auto& vertices = mesh->meshDataProxy.GetMutableVertices();
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			vertices[i].colour = bakeMesh.bakedColours[i];
+		}
+		mesh->CreateNewVertexBuffer();
+
+		BakeState::MeshColours& colours = bakeState.meshes[bakeMesh.uid];
+		colours.base = std::move(bakeMesh.baseColours);
+		colours.baked = std::move(bakeMesh.bakedColours);
+	}
+
+	bakeState.lights.clear();
+	for (const BakeLight& light : job->lights)
+	{
+		bakeState.lights.emplace(light.uid, light);
+	}
+
+	AssetSystem::WriteOutAllVertexColourData();
+
+	Log("Light bake finished: gathered in [%f] seconds, traced in [%f] seconds, %zu meshes skipped.",
+		job->gatherTime, job->traceTime, skippedMeshes);
+}
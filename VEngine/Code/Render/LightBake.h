@@ -0,0 +1,40 @@
+#pragma once
+
+//Bakes light occlusion into the vertex colours of render static meshes, like a coarse ambient occlusion that
+//only looks towards the lights. The usual light calculations are left to the pixel shaders.
+//The world is gathered on the main thread into one triangle BVH of the static scene and the vertices to bake,
+//then traced on a background job across every core. Tick() applies a finished bake and writes the world's
+//vertex colour data file, so the editor stays usable while it runs.
+namespace LightBake
+{
+	struct Settings
+	{
+		//Shadow rays per light per vertex, spread over the light's size for soft shadows. 1 gives hard shadows.
+		int shadowSamples = 8;
+		float pointLightRadius = 0.25f;
+		float directionalLightAngle = 1.f; //Half angle in degrees, the sun's disc
+
+		//Vertices fully shadowed from a light are multiplied by this once per light.
+		float shadowColour = 0.3f;
+
+		//Hemisphere rays per vertex, 0 turns ambient occlusion off.
+		int aoSamples = 0;
+		float aoDistance = 2.f;
+		float aoStrength = 0.6f;
+	};
+
+	extern Settings settings;
+
+	//Re-bakes every render static mesh.
+	void BakeAll();
+
+	//Only re-bakes meshes whose bounds are inside the range of a light added, removed or changed since the last
+	//bake, and meshes that weren't part of it. A changed directional light re-bakes everything, as does the first
+	//bake after loading a world. Moved static meshes aren't picked up, use BakeAll() for those.
+	void BakeChangedLights();
+
+	//Applies a finished bake on the main thread.
+	void Tick();
+
+	bool IsBaking();
+}
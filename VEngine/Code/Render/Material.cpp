@@ -213,7 +213,7 @@ ID3D11PixelShader* Material::GetPixelShader()
 	return shaderItem->GetPixelShader();
 }
 
-ID3D11InputLayout* Material::GetInputLayout()
+ID3D11InputLayout* Material::GetInputLayout(VertexFormat format)
 {
-	return shaderItem->GetInputLayout();
+	return shaderItem->GetInputLayout(format);
 }
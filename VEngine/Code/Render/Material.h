@@ -3,6 +3,7 @@
 #include "Core/Properties.h"
 #include "Core/VEnum.h"
 #include "Render/ShaderData/MaterialShaderData.h"
+#include "Render/VertexStreams.h"
 
 class Texture2D;
 class Sampler;
@@ -59,7 +60,7 @@ public:
 
 	ID3D11VertexShader* GetVertexShader();
 	ID3D11PixelShader* GetPixelShader();
-	ID3D11InputLayout* GetInputLayout();
+	ID3D11InputLayout* GetInputLayout(VertexFormat format = VertexFormat::Full);
 
 	auto GetUID() const { return uid; }
 	void SetUID(UID uid_) { uid = uid_; }
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <DirectXCollision.h>
+#include <memory>
 #include "Animation/Skeleton.h"
+#include "Core/ArrayView.h"
+#include "Core/MappedFile.h"
+#include "Physics/BVH.h"
 #include "Vertex.h"
+#include "VertexStreams.h"
 
 //The actual data for each loaded mesh. Each loaded mesh file will have one of these per its filename.
 struct MeshData
@@ -12,7 +17,75 @@ struct MeshData
 	//Base extents and offset will be the same for each mesh, fine to cache here.
 	DirectX::BoundingBox boundingBox;
 
+	//Filled by the importers. For meshes loaded from a .vmesh this stays empty until GetVertices() is called.
 	std::vector<Vertex> vertices;
 
+	//Filled by MeshOptimiser on import, three per triangle. Meshes without indices are triangle soup.
+	std::vector<indexDataType> indices;
+
+	//Filled by MeshOptimiser on import, the welded vertex each soup vertex became. Only used to carry vertex
+	//colours saved against the soup over to the welded mesh.
+	std::vector<indexDataType> soupRemap;
+
+	//What's uploaded to the GPU and raycast against. Points into mappedFile for .vmesh files.
+	VertexStreams streams;
+	ArrayView<indexDataType> mappedIndices;
+	ArrayView<indexDataType> mappedSoupRemap;
+	std::shared_ptr<MappedFile> mappedFile;
+
 	Skeleton skeleton;
+
+	//Built once on load for raycasts against the mesh's triangles.
+	std::shared_ptr<TriangleBVH> triangleBVH;
+
+	ArrayView<DirectX::XMFLOAT3> GetPositions() const
+	{
+		if (!streams.Empty())
+		{
+			return streams.GetPositions();
+		}
+		if (vertices.empty())
+		{
+			return ArrayView<DirectX::XMFLOAT3>();
+		}
+		return ArrayView<DirectX::XMFLOAT3>(&vertices.data()->pos, vertices.size(), sizeof(Vertex));
+	}
+
+	ArrayView<indexDataType> GetIndices() const
+	{
+		return mappedIndices.empty() ? ArrayView<indexDataType>(indices) : mappedIndices;
+	}
+
+	ArrayView<indexDataType> GetSoupRemap() const
+	{
+		return mappedSoupRemap.empty() ? ArrayView<indexDataType>(soupRemap) : mappedSoupRemap;
+	}
+
+	//Copies everything read in place out of mappedFile and closes it, so the .vmesh can be replaced on disk.
+	//Main thread only, nothing else can be reading the streams.
+	void ReleaseMappedFile()
+	{
+		streams.CopyExternalToStorage();
+		if (!mappedIndices.empty())
+		{
+			indices = mappedIndices.ToVector();
+			mappedIndices = ArrayView<indexDataType>();
+		}
+		if (!mappedSoupRemap.empty())
+		{
+			soupRemap = mappedSoupRemap.ToVector();
+			mappedSoupRemap = ArrayView<indexDataType>();
+		}
+		mappedFile.reset();
+	}
+
+	//Full vertices for editor tools and the mesh slicer. Decodes the streams on first call, so main thread only.
+	ArrayView<Vertex> GetVertices()
+	{
+		if (vertices.empty() && !streams.Empty())
+		{
+			streams.Decode(vertices);
+		}
+		return vertices;
+	}
 };
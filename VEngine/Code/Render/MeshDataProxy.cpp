@@ -0,0 +1,124 @@
+#include "vpch.h"
+#include "MeshDataProxy.h"
+#include "MeshData.h"
+
+ArrayView<XMFLOAT3> MeshDataProxy::GetPositions() const
+{
+	if (UsesSharedVertices())
+	{
+		return sharedMeshData->GetPositions();
+	}
+
+	if (uniqueVertices.empty())
+	{
+		return ArrayView<XMFLOAT3>();
+	}
+	return ArrayView<XMFLOAT3>(&uniqueVertices.data()->pos, uniqueVertices.size(), sizeof(Vertex));
+}
+
+XMFLOAT3 MeshDataProxy::GetNormal(size_t index) const
+{
+	if (UsesSharedVertices() && !sharedMeshData->streams.Empty())
+	{
+		return sharedMeshData->streams.GetNormal(index);
+	}
+	return GetVertices()[index].normal;
+}
+
+XMFLOAT4 MeshDataProxy::GetColour(size_t index) const
+{
+	if (UsesSharedVertices() && !sharedMeshData->streams.Empty())
+	{
+		return sharedMeshData->streams.GetColour(index);
+	}
+	return GetVertices()[index].colour;
+}
+
+XMFLOAT2 MeshDataProxy::GetUV(size_t index) const
+{
+	if (UsesSharedVertices() && !sharedMeshData->streams.Empty())
+	{
+		return sharedMeshData->streams.GetUV(index);
+	}
+	return GetVertices()[index].uv;
+}
+
+ArrayView<uint32_t> MeshDataProxy::GetIndices() const
+{
+	if (hasSoupVertices || sharedMeshData == nullptr)
+	{
+		return ArrayView<uint32_t>();
+	}
+	return sharedMeshData->GetIndices();
+}
+
+ArrayView<uint32_t> MeshDataProxy::GetSoupRemap() const
+{
+	if (hasSoupVertices || sharedMeshData == nullptr)
+	{
+		return ArrayView<uint32_t>();
+	}
+	return sharedMeshData->GetSoupRemap();
+}
+
+size_t MeshDataProxy::GetTriangleCount() const
+{
+	const ArrayView<uint32_t> indices = GetIndices();
+	return (indices.empty() ? GetVertexCount() : indices.size()) / 3;
+}
+
+ArrayView<Vertex> MeshDataProxy::GetVertices() const
+{
+	if (UsesSharedVertices())
+	{
+		return sharedMeshData->GetVertices();
+	}
+	return uniqueVertices;
+}
+
+const VertexStreams* MeshDataProxy::GetSharedStreams() const
+{
+	if (UsesSharedVertices() && !sharedMeshData->streams.Empty())
+	{
+		return &sharedMeshData->streams;
+	}
+	return nullptr;
+}
+
+VertexFormat MeshDataProxy::GetVertexFormat() const
+{
+	if (sharedMeshData && !sharedMeshData->streams.Empty())
+	{
+		return sharedMeshData->streams.GetFormat();
+	}
+	return VertexFormat::Full;
+}
+
+std::vector<Vertex>& MeshDataProxy::GetMutableVertices()
+{
+	if (!hasUniqueVertices)
+	{
+		if (sharedMeshData)
+		{
+			uniqueVertices = sharedMeshData->GetVertices().ToVector();
+		}
+		hasUniqueVertices = true;
+	}
+	return uniqueVertices;
+}
+
+void MeshDataProxy::SetVertices(const std::vector<Vertex>& vertices)
+{
+	uniqueVertices = vertices;
+	hasUniqueVertices = true;
+	hasSoupVertices = true;
+	triangleBVH = nullptr;
+}
+
+void MeshDataProxy::SetSharedMeshData(std::shared_ptr<MeshData> meshData)
+{
+	sharedMeshData = meshData;
+	uniqueVertices.clear();
+	hasUniqueVertices = false;
+	hasSoupVertices = false;
+}
@@ -1,26 +1,86 @@
 #pragma once
 
 #include <DirectXCollision.h>
+#include <memory>
 #include <vector>
 #include "Vertex.h"
+#include "Core/ArrayView.h"
+#include "VertexStreams.h"
 
 class Skeleton;
+class TriangleBVH;
+struct MeshData;
 
 //A pointer structure to a MeshData struct in memory. Each rendered component will have one of these pointing
 //to the mesh data on a per-filename basis.
 struct MeshDataProxy
 {
-	//Still copied from MeshData, but needs to be unique for vertex painting.
-	std::vector<Vertex> vertices;
-
 	DirectX::BoundingBox* boundingBox = nullptr;
 
 	Skeleton* skeleton = nullptr;
 
-	auto GetVerticesByteWidth() const
+	//Only valid while the vertex positions match the cached asset's, SetVertices() clears it.
+	const TriangleBVH* triangleBVH = nullptr;
+
+	size_t GetVerticesByteWidth() const { return sizeof(Vertex) * GetVertexCount(); }
+
+	size_t GetVertexCount() const { return GetPositions().size(); }
+
+	//Positions only, for raycasts, bounds and physics. Safe to read from worker threads.
+	ArrayView<DirectX::XMFLOAT3> GetPositions() const;
+
+	//Single attribute reads that don't decode the whole mesh. Safe to read from worker threads.
+	DirectX::XMFLOAT3 GetNormal(size_t index) const;
+	DirectX::XMFLOAT4 GetColour(size_t index) const;
+	DirectX::XMFLOAT2 GetUV(size_t index) const;
+
+	//Three per triangle. Empty for triangle soup (sliced/destructible meshes, old .vmesh files).
+	ArrayView<uint32_t> GetIndices() const;
+
+	size_t GetTriangleCount() const;
+
+	//For each vertex of the triangle soup the mesh was welded from, the vertex it became. Empty for meshes
+	//that weren't welded on import or are soup again.
+	ArrayView<uint32_t> GetSoupRemap() const;
+
+	//Vertex indices of a triangle whether the mesh is indexed or soup.
+	void GetTriangleVertexIndices(size_t triangleIndex, uint32_t vertexIndices[3]) const
 	{
-		return (sizeof(Vertex) * vertices.size());
+		const ArrayView<uint32_t> indices = GetIndices();
+		for (size_t i = 0; i < 3; i++)
+		{
+			vertexIndices[i] = indices.empty() ? static_cast<uint32_t>(triangleIndex * 3 + i) : indices[triangleIndex * 3 + i];
+		}
 	}
 
-	std::vector<Vertex>& GetVertices() { return vertices; }
+	//Full vertices, read-only. For shared meshes these are decoded from the streams on first use (main thread).
+	ArrayView<Vertex> GetVertices() const;
+
+	//The cached mesh's streams, ready to upload as is. Null once this proxy has its own vertices.
+	const VertexStreams* GetSharedStreams() const;
+
+	//The cached mesh's format, edited vertices are re-encoded in it.
+	VertexFormat GetVertexFormat() const;
+
+	//Copy-on-write access for vertex painting and the like. The first call copies the shared
+	//vertices into this proxy so the cached mesh asset isn't changed for every other component.
+	std::vector<Vertex>& GetMutableVertices();
+
+	//Replaces the geometry with triangle soup.
+	void SetVertices(const std::vector<Vertex>& vertices);
+	void SetSharedMeshData(std::shared_ptr<MeshData> meshData);
+
+	bool HasUniqueVertices() const { return hasUniqueVertices; }
+
+private:
+	bool UsesSharedVertices() const { return !hasUniqueVertices && sharedMeshData != nullptr; }
+
+	//The cached MeshData, holding this also keeps the cached bounds and skeleton alive.
+	std::shared_ptr<MeshData> sharedMeshData;
+
+	std::vector<Vertex> uniqueVertices;
+	bool hasUniqueVertices = false;
+
+	//Painting (GetMutableVertices) keeps the cached mesh's indices, SetVertices() drops them.
+	bool hasSoupVertices = false;
 };
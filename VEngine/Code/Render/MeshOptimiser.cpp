@@ -0,0 +1,374 @@
+#include "vpch.h"
+#include "MeshOptimiser.h"
+#include <algorithm>
+#include <cmath>
+#include <DirectXMath.h>
+#include "Core/Log.h"
+#include "MeshData.h"
+#include "Vertex.h"
+
+//Vertices are hashed and compared as raw bytes.
+static_assert(sizeof(Vertex) == sizeof(float) * 18 + sizeof(uint32_t) * 4, "Vertex can't have padding for welding");
+
+using namespace DirectX;
+
+static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+//Ref: https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+static constexpr uint32_t forsythCacheSize = 32;
+static constexpr float cacheDecayPower = 1.5f;
+static constexpr float lastTriangleScore = 0.75f;
+static constexpr float valenceBoostScale = 2.f;
+static constexpr float valenceBoostPower = 0.5f;
+
+static uint64_t HashVertex(const Vertex& vertex)
+{
+	//FNV-1a
+	const auto bytes = reinterpret_cast<const uint8_t*>(&vertex);
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < sizeof(Vertex); i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static float ScoreVertex(int cachePosition, uint32_t activeTriangleCount)
+{
+	if (activeTriangleCount == 0)
+	{
+		return -1.f;
+	}
+
+	float score = 0.f;
+	if (cachePosition >= 0)
+	{
+		if (cachePosition < 3)
+		{
+			//Vertices of the triangle that was just emitted get a fixed score so that the next triangle doesn't
+			//just pick the same edge again and strip along it.
+			score = lastTriangleScore;
+		}
+		else
+		{
+			const float scaler = 1.f / (forsythCacheSize - 3);
+			score = std::pow(1.f - (cachePosition - 3) * scaler, cacheDecayPower);
+		}
+	}
+
+	//Boost vertices with few triangles left so that lone triangles don't get left behind.
+	score += valenceBoostScale * std::pow(static_cast<float>(activeTriangleCount), -valenceBoostPower);
+	return score;
+}
+
+void MeshOptimiser::WeldVertices(const std::vector<Vertex>& triangleVertices, std::vector<Vertex>& outVertices,
+	std::vector<uint32_t>& outIndices)
+{
+	const size_t vertexCount = triangleVertices.size();
+
+	size_t tableSize = 1;
+	while (tableSize < vertexCount * 2)
+	{
+		tableSize <<= 1;
+	}
+	const size_t tableMask = tableSize - 1;
+
+	//Open addressing, slots hold indices into outVertices.
+	std::vector<uint32_t> table(tableSize, invalidIndex);
+
+	//FBXLoader gives every triangle its own tangent, so tangents are left out of the compare and
+	//averaged over the merged vertices instead (otherwise nothing would weld).
+	std::vector<XMFLOAT3> tangentSums;
+	std::vector<XMFLOAT3> firstTangents;
+
+	outVertices.clear();
+	outVertices.reserve(vertexCount);
+	outIndices.resize(vertexCount);
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		Vertex vertex = triangleVertices[i];
+		const XMFLOAT3 tangent = vertex.tangent;
+		vertex.tangent = XMFLOAT3(0.f, 0.f, 0.f);
+
+		size_t slot = HashVertex(vertex) & tableMask;
+
+		while (true)
+		{
+			uint32_t existing = table[slot];
+			if (existing == invalidIndex)
+			{
+				existing = static_cast<uint32_t>(outVertices.size());
+				outVertices.emplace_back(vertex);
+				tangentSums.emplace_back(0.f, 0.f, 0.f);
+				firstTangents.emplace_back(tangent);
+				table[slot] = existing;
+			}
+			else if (memcmp(&outVertices[existing], &vertex, sizeof(Vertex)) != 0)
+			{
+				slot = (slot + 1) & tableMask;
+				continue;
+			}
+
+			outIndices[i] = existing;
+			tangentSums[existing].x += tangent.x;
+			tangentSums[existing].y += tangent.y;
+			tangentSums[existing].z += tangent.z;
+			break;
+		}
+	}
+
+	for (size_t i = 0; i < outVertices.size(); i++)
+	{
+		Vertex& vertex = outVertices[i];
+		const XMVECTOR normal = XMLoadFloat3(&vertex.normal);
+		XMVECTOR tangent = XMLoadFloat3(&tangentSums[i]);
+
+		//Keep the tangent perpendicular to the normal, opposing face tangents can cancel out to nothing.
+		tangent = XMVectorSubtract(tangent, XMVectorMultiply(normal, XMVector3Dot(normal, tangent)));
+		if (XMVectorGetX(XMVector3LengthSq(tangent)) > 1.0e-12f)
+		{
+			XMStoreFloat3(&vertex.tangent, XMVector3Normalize(tangent));
+		}
+		else
+		{
+			vertex.tangent = firstTangents[i];
+		}
+	}
+}
+
+void MeshOptimiser::OptimiseVertexCache(std::vector<uint32_t>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	//Per vertex list of the triangles that haven't been emitted yet, packed into one array.
+	std::vector<uint32_t> activeTriangleCounts(vertexCount, 0);
+	for (const uint32_t index : indices)
+	{
+		activeTriangleCounts[index]++;
+	}
+
+	std::vector<uint32_t> triangleOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		triangleOffsets[v + 1] = triangleOffsets[v] + activeTriangleCounts[v];
+	}
+
+	std::vector<uint32_t> vertexTriangles(indices.size());
+	{
+		std::vector<uint32_t> fillOffsets(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			vertexTriangles[fillOffsets[indices[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+	}
+
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+	{
+		vertexScores[v] = ScoreVertex(-1, activeTriangleCounts[v]);
+	}
+
+	const auto scoreTriangle = [&](size_t triangle)
+		{
+			return vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] +
+				vertexScores[indices[triangle * 3 + 2]];
+		};
+
+	uint32_t bestTriangle = 0;
+	float bestScore = scoreTriangle(0);
+	for (size_t t = 1; t < triangleCount; t++)
+	{
+		const float score = scoreTriangle(t);
+		if (score > bestScore)
+		{
+			bestScore = score;
+			bestTriangle = static_cast<uint32_t>(t);
+		}
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	size_t scanCursor = 0;
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(forsythCacheSize + 3);
+	newCache.reserve(forsythCacheSize + 3);
+
+	std::vector<uint32_t> output;
+	output.reserve(indices.size());
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		//Nothing left touching the cache, carry on from the first triangle that's still waiting.
+		if (bestTriangle == invalidIndex)
+		{
+			while (emitted[scanCursor])
+			{
+				scanCursor++;
+			}
+			bestTriangle = static_cast<uint32_t>(scanCursor);
+		}
+
+		emitted[bestTriangle] = true;
+
+		const uint32_t triangle[3] = { indices[bestTriangle * 3], indices[bestTriangle * 3 + 1], indices[bestTriangle * 3 + 2] };
+		output.insert(output.end(), triangle, triangle + 3);
+
+		for (const uint32_t v : triangle)
+		{
+			uint32_t* vertexTriangleList = &vertexTriangles[triangleOffsets[v]];
+			uint32_t& count = activeTriangleCounts[v];
+			for (uint32_t i = 0; i < count; i++)
+			{
+				if (vertexTriangleList[i] == bestTriangle)
+				{
+					std::swap(vertexTriangleList[i], vertexTriangleList[count - 1]);
+					count--;
+					break;
+				}
+			}
+		}
+
+		//Emitted triangle's vertices go to the front of the cache, everything else shifts back.
+		newCache.clear();
+		for (const uint32_t v : triangle)
+		{
+			if (std::find(newCache.begin(), newCache.end(), v) == newCache.end())
+			{
+				newCache.emplace_back(v);
+			}
+		}
+		for (const uint32_t v : cache)
+		{
+			if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+			{
+				newCache.emplace_back(v);
+			}
+		}
+
+		for (size_t i = forsythCacheSize; i < newCache.size(); i++)
+		{
+			const uint32_t v = newCache[i];
+			vertexScores[v] = ScoreVertex(-1, activeTriangleCounts[v]);
+		}
+		newCache.resize(std::min<size_t>(newCache.size(), forsythCacheSize));
+		cache.swap(newCache);
+
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			const uint32_t v = cache[i];
+			vertexScores[v] = ScoreVertex(static_cast<int>(i), activeTriangleCounts[v]);
+		}
+
+		//Only triangles touching the cache changed score, the next best one is among them.
+		bestTriangle = invalidIndex;
+		bestScore = -1.f;
+
+		for (const uint32_t v : cache)
+		{
+			const uint32_t* vertexTriangleList = &vertexTriangles[triangleOffsets[v]];
+			for (uint32_t i = 0; i < activeTriangleCounts[v]; i++)
+			{
+				const uint32_t t = vertexTriangleList[i];
+				const float score = scoreTriangle(t);
+				if (score > bestScore)
+				{
+					bestScore = score;
+					bestTriangle = t;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+void MeshOptimiser::OptimiseVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+	std::vector<uint32_t>* outRemap)
+{
+	std::vector<uint32_t> remap(vertices.size(), invalidIndex);
+	std::vector<Vertex> orderedVertices;
+	orderedVertices.reserve(vertices.size());
+
+	for (uint32_t& index : indices)
+	{
+		if (remap[index] == invalidIndex)
+		{
+			remap[index] = static_cast<uint32_t>(orderedVertices.size());
+			orderedVertices.emplace_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	//Vertices no triangle uses are dropped here.
+	vertices.swap(orderedVertices);
+
+	if (outRemap)
+	{
+		outRemap->swap(remap);
+	}
+}
+
+float MeshOptimiser::CalcACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+	const size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return 0.f;
+	}
+
+	//FIFO cache, a vertex is still cached if fewer than cacheSize misses happened since it was loaded.
+	std::vector<uint32_t> loadedAtMiss(vertexCount, invalidIndex);
+	uint32_t misses = 0;
+
+	for (const uint32_t index : indices)
+	{
+		if (loadedAtMiss[index] == invalidIndex || misses - loadedAtMiss[index] >= cacheSize)
+		{
+			loadedAtMiss[index] = misses;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / triangleCount;
+}
+
+void MeshOptimiser::Optimise(MeshData& meshData)
+{
+	if (meshData.vertices.empty())
+	{
+		return;
+	}
+
+	const size_t soupVertexCount = meshData.vertices.size();
+
+	std::vector<Vertex> weldedVertices;
+	WeldVertices(meshData.vertices, weldedVertices, meshData.indices);
+
+	//Triangles are still in soup order here, so index i is what soup vertex i was welded to.
+	std::vector<uint32_t> soupRemap = meshData.indices;
+
+	const float weldedACMR = CalcACMR(meshData.indices, weldedVertices.size());
+
+	OptimiseVertexCache(meshData.indices, weldedVertices.size());
+	std::vector<uint32_t> fetchRemap;
+	OptimiseVertexFetch(weldedVertices, meshData.indices, &fetchRemap);
+	for (uint32_t& weldedIndex : soupRemap)
+	{
+		weldedIndex = fetchRemap[weldedIndex];
+	}
+	meshData.soupRemap = std::move(soupRemap);
+
+	const float optimisedACMR = CalcACMR(meshData.indices, weldedVertices.size());
+
+	meshData.vertices = std::move(weldedVertices);
+
+	Log("Mesh optimised: %zu soup vertices welded to %zu, %zu triangles, ACMR %.3f -> %.3f.",
+		soupVertexCount, meshData.vertices.size(), meshData.indices.size() / 3, weldedACMR, optimisedACMR);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+struct Vertex;
+struct MeshData;
+
+//Import-time passes that turn the triangle soup coming out of FBXLoader into indexed geometry.
+//Welding merges identical vertices, then triangles are reordered for the post-transform vertex cache
+//(Forsyth's linear-speed optimiser) and vertices for fetch locality (order of first use).
+namespace MeshOptimiser
+{
+	//Builds an index buffer over triangleVertices (3 per triangle). Vertices merge when every attribute but the
+	//tangent is bit-identical, so seams with different normals/UVs keep their own vertices. Tangents of merged
+	//vertices are averaged.
+	void WeldVertices(const std::vector<Vertex>& triangleVertices, std::vector<Vertex>& outVertices,
+		std::vector<uint32_t>& outIndices);
+
+	//Reorders triangles in place so that shared vertices are reused while still in the cache.
+	void OptimiseVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+	//Reorders vertices by their first use in indices and remaps the indices to match.
+	//outRemap (if given) gets the new index of every old vertex.
+	void OptimiseVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+		std::vector<uint32_t>* outRemap = nullptr);
+
+	//Average cache miss ratio (transformed vertices per triangle) for a FIFO cache of cacheSize entries.
+	//3 is the worst case (soup), ~0.5-0.7 is typical for optimised meshes.
+	float CalcACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+	//Runs all of the above on meshData.vertices, filling in meshData.indices and meshData.soupRemap.
+	void Optimise(MeshData& meshData);
+}
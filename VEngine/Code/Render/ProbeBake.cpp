@@ -0,0 +1,396 @@
+#include "vpch.h"
+#include "ProbeBake.h"
+#include <SHMath/DirectXSH.h>
+#include "Actors/DiffuseProbeMap.h"
+#include "Components/MeshComponent.h"
+#include "Components/Lights/DirectionalLightComponent.h"
+#include "Components/Lights/PointLightComponent.h"
+#include "Components/Lights/SpotLightComponent.h"
+#include "Core/Log.h"
+#include "Core/ParallelFor.h"
+#include "Core/Profile.h"
+#include "Physics/BVH.h"
+#include "BakeSampling.h"
+#include "Material.h"
+
+ProbeBake::Settings ProbeBake::settings;
+
+static constexpr size_t shOrder = 3;
+static constexpr size_t shCoefficientCount = shOrder * shOrder;
+
+//Rays leaving a surface start this far off it along the normal so they don't hit the same triangle.
+static constexpr float surfaceOffset = 0.01f;
+static constexpr float directionalShadowDistance = 50.f;
+
+//Rays that hit nothing see black, same as the cleared faces of the GPU bake's cubemaps.
+static constexpr float maxTraceDistance = 1000.f;
+
+struct ProbeLight
+{
+	LightType type = LightType::Directional;
+	XMFLOAT3 position = XMFLOAT3(0.f, 0.f, 0.f);
+	XMFLOAT3 direction = XMFLOAT3(0.f, 0.f, 1.f); //Where the light shines, normalised
+	XMFLOAT3 colour = XMFLOAT3(1.f, 1.f, 1.f);
+	float intensity = 0.f;
+	float range = 0.f;
+	float spotAngle = 0.f;
+};
+
+//Static meshes flattened into world space, three vertices per triangle in every per vertex array.
+struct ProbeScene
+{
+	std::vector<XMFLOAT3> positions;
+	std::vector<XMFLOAT3> normals;
+	std::vector<XMFLOAT3> albedos; //Vertex colour * material colour, what CalcFinalColour() multiplies light by
+	std::vector<XMFLOAT3> triangleAmbients; //Material ambient per triangle, CalcForwardLighting() tints light by it
+	TriangleBVH bvh;
+
+	std::vector<ProbeLight> lights;
+	XMFLOAT3 globalAmbient = XMFLOAT3(0.f, 0.f, 0.f);
+};
+
+struct SurfaceHit
+{
+	XMVECTOR position;
+	XMVECTOR normal;
+	XMVECTOR albedo;
+	XMVECTOR ambient;
+};
+
+static void GatherLights(ProbeScene& scene)
+{
+	const auto addLight = [&](LightData lightData, LightType type)
+		{
+			if (!lightData.enabled)
+			{
+				return;
+			}
+
+			ProbeLight& light = scene.lights.emplace_back();
+			light.type = type;
+			light.position = XMFLOAT3(lightData.position.x, lightData.position.y, lightData.position.z);
+			XMStoreFloat3(&light.direction, XMVector3Normalize(XMLoadFloat4(&lightData.direction)));
+			light.colour = XMFLOAT3(lightData.colour.x, lightData.colour.y, lightData.colour.z);
+			light.intensity = lightData.intensity;
+			light.range = lightData.range;
+			light.spotAngle = lightData.spotAngle;
+		};
+
+	for (auto& light : DirectionalLightComponent::system.GetComponents())
+	{
+		if (light->IsActive())
+		{
+			addLight(light->GetLightData(), LightType::Directional);
+		}
+	}
+
+	for (auto& light : PointLightComponent::system.GetComponents())
+	{
+		if (light->IsActive())
+		{
+			addLight(light->GetLightData(), LightType::Point);
+		}
+	}
+
+	for (auto& light : SpotLightComponent::system.GetComponents())
+	{
+		if (light->IsActive())
+		{
+			addLight(light->GetLightData(), LightType::Spot);
+		}
+	}
+
+	//Same as SetLightsConstantBufferData(), the first directional light owns the global ambient.
+	if (!DirectionalLightComponent::system.Empty())
+	{
+		const XMFLOAT4 globalAmbient = DirectionalLightComponent::system.GetFirstComponent()->GetGlobalAmbient();
+		scene.globalAmbient = XMFLOAT3(globalAmbient.x, globalAmbient.y, globalAmbient.z);
+	}
+}
+
+static void AddMesh(MeshComponent& mesh, ProbeScene& scene)
+{
+	const MeshDataProxy& proxy = mesh.meshDataProxy;
+	const XMMATRIX worldMatrix = mesh.GetWorldMatrix();
+	const ArrayView<XMFLOAT3> positions = proxy.GetPositions();
+	const size_t triangleCount = proxy.GetTriangleCount();
+
+	//Textures only live on the GPU, so textured materials are traced as if the texture were white.
+	const MaterialShaderData& material = mesh.GetMaterial().GetMaterialShaderData();
+	const XMVECTOR ambient = XMLoadFloat4(&material.ambient);
+	const XMVECTOR materialColour = material.useTexture ? ambient : ambient * ambient;
+
+	for (size_t triangleIndex = 0; triangleIndex < triangleCount; triangleIndex++)
+	{
+		uint32_t vertexIndices[3];
+		proxy.GetTriangleVertexIndices(triangleIndex, vertexIndices);
+		for (const uint32_t vertexIndex : vertexIndices)
+		{
+			const XMFLOAT3 normal = proxy.GetNormal(vertexIndex);
+			const XMFLOAT4 colour = proxy.GetColour(vertexIndex);
+
+			XMStoreFloat3(&scene.positions.emplace_back(),
+				XMVector3TransformCoord(XMLoadFloat3(&positions[vertexIndex]), worldMatrix));
+			XMStoreFloat3(&scene.normals.emplace_back(),
+				XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&normal), worldMatrix)));
+			XMStoreFloat3(&scene.albedos.emplace_back(), XMLoadFloat4(&colour) * materialColour);
+		}
+
+		XMStoreFloat3(&scene.triangleAmbients.emplace_back(), ambient);
+	}
+}
+
+static bool IsOccluded(const ProbeScene& scene, FXMVECTOR origin, FXMVECTOR direction, float distance)
+{
+	const BVH::Ray ray(origin, direction, distance);
+	return scene.bvh.QueryRayAny(ray, [&](uint32_t triangleIndex)
+		{
+			const XMFLOAT3* triangle = &scene.positions[triangleIndex * 3];
+			float hitDistance = 0.f;
+			return TriangleTests::Intersects(origin, direction, XMLoadFloat3(&triangle[0]),
+				XMLoadFloat3(&triangle[1]), XMLoadFloat3(&triangle[2]), hitDistance) && hitDistance < distance;
+		});
+}
+
+//Interpolates the vertex normal and albedo at the nearest hit. Returns false on a miss.
+static bool TraceNearest(const ProbeScene& scene, FXMVECTOR origin, FXMVECTOR direction, SurfaceHit& outHit)
+{
+	float nearestDistance = maxTraceDistance;
+	uint32_t nearestTriangle = UINT32_MAX;
+
+	const BVH::Ray ray(origin, direction, maxTraceDistance);
+	scene.bvh.QueryRay(ray, [&](uint32_t triangleIndex)
+		{
+			const XMFLOAT3* triangle = &scene.positions[triangleIndex * 3];
+			float hitDistance = 0.f;
+			if (TriangleTests::Intersects(origin, direction, XMLoadFloat3(&triangle[0]),
+				XMLoadFloat3(&triangle[1]), XMLoadFloat3(&triangle[2]), hitDistance) && hitDistance < nearestDistance)
+			{
+				nearestDistance = hitDistance;
+				nearestTriangle = triangleIndex;
+			}
+		});
+
+	if (nearestTriangle == UINT32_MAX)
+	{
+		return false;
+	}
+
+	const size_t first = nearestTriangle * 3;
+	const XMVECTOR v0 = XMLoadFloat3(&scene.positions[first]);
+	const XMVECTOR edge0 = XMLoadFloat3(&scene.positions[first + 1]) - v0;
+	const XMVECTOR edge1 = XMLoadFloat3(&scene.positions[first + 2]) - v0;
+	const XMVECTOR position = origin + direction * nearestDistance;
+	const XMVECTOR toHit = position - v0;
+
+	const float d00 = XMVectorGetX(XMVector3Dot(edge0, edge0));
+	const float d01 = XMVectorGetX(XMVector3Dot(edge0, edge1));
+	const float d11 = XMVectorGetX(XMVector3Dot(edge1, edge1));
+	const float d20 = XMVectorGetX(XMVector3Dot(toHit, edge0));
+	const float d21 = XMVectorGetX(XMVector3Dot(toHit, edge1));
+	const float denominator = d00 * d11 - d01 * d01;
+
+	float v = 0.f, w = 0.f;
+	if (denominator != 0.f)
+	{
+		v = std::clamp((d11 * d20 - d01 * d21) / denominator, 0.f, 1.f);
+		w = std::clamp((d00 * d21 - d01 * d20) / denominator, 0.f, 1.f - v);
+	}
+	const float u = 1.f - v - w;
+
+	const auto interpolate = [&](const std::vector<XMFLOAT3>& values)
+		{
+			return XMLoadFloat3(&values[first]) * u + XMLoadFloat3(&values[first + 1]) * v +
+				XMLoadFloat3(&values[first + 2]) * w;
+		};
+
+	outHit.position = position;
+	outHit.normal = XMVector3Normalize(interpolate(scene.normals));
+	outHit.albedo = interpolate(scene.albedos);
+	outHit.ambient = XMLoadFloat3(&scene.triangleAmbients[nearestTriangle]);
+	return true;
+}
+
+//Diffuse terms of CalcForwardLighting() and CalcFinalColour() in Common.hlsli, without specular.
+static XMVECTOR ShadeHit(const ProbeScene& scene, const SurfaceHit& hit, bool shadows)
+{
+	const XMVECTOR shadowOrigin = hit.position + hit.normal * surfaceOffset;
+
+	XMVECTOR diffuse = XMVectorZero();
+
+	for (const ProbeLight& light : scene.lights)
+	{
+		const XMVECTOR lightDirection = XMLoadFloat3(&light.direction);
+
+		XMVECTOR toLight;
+		float distance = directionalShadowDistance;
+		float lightScale = light.intensity;
+
+		if (light.type == LightType::Directional)
+		{
+			//The shader takes L from the directional light's position, its direction is what's meant.
+			toLight = -lightDirection;
+		}
+		else
+		{
+			toLight = XMLoadFloat3(&light.position) - hit.position;
+			distance = XMVectorGetX(XMVector3Length(toLight));
+			if (distance <= 0.f || (light.type == LightType::Point && distance > light.range))
+			{
+				continue;
+			}
+			toLight /= distance;
+
+			//CalcFalloff()
+			lightScale /= std::max(distance * distance, 0.001f);
+
+			if (light.type == LightType::Spot)
+			{
+				//CalcSpotCone(), which passes spotAngle straight to cos().
+				const float minCos = cosf(light.spotAngle);
+				const float maxCos = (minCos + 1.f) / 2.f;
+				const float cosAngle = XMVectorGetX(XMVector3Dot(lightDirection, -toLight));
+				const float t = std::clamp((cosAngle - minCos) / (maxCos - minCos), 0.f, 1.f);
+				lightScale *= t * t * (3.f - 2.f * t);
+			}
+		}
+
+		const float NdotL = std::clamp(XMVectorGetX(XMVector3Dot(hit.normal, toLight)), 0.f, 1.f);
+		if (NdotL <= 0.f || lightScale <= 0.f)
+		{
+			continue;
+		}
+
+		if (shadows && IsOccluded(scene, shadowOrigin, toLight, distance))
+		{
+			continue;
+		}
+
+		//CalcDiffuse()
+		diffuse += XMLoadFloat3(&light.colour) * (NdotL / XM_PI * lightScale);
+	}
+
+	diffuse = XMVectorSaturate(diffuse) * hit.ambient;
+	return (XMLoadFloat3(&scene.globalAmbient) + diffuse) * hit.albedo;
+}
+
+//Radiance arriving at origin from direction, following settings.bounces diffuse bounces after the first hit.
+static XMVECTOR TracePath(const ProbeScene& scene, XMVECTOR origin, XMVECTOR direction, uint32_t pathSeed)
+{
+	const ProbeBake::Settings& bakeSettings = ProbeBake::settings;
+
+	XMVECTOR radiance = XMVectorZero();
+	XMVECTOR throughput = XMVectorReplicate(1.f);
+
+	for (int bounce = 0; bounce <= bakeSettings.bounces; bounce++)
+	{
+		SurfaceHit hit;
+		if (!TraceNearest(scene, origin, direction, hit))
+		{
+			break;
+		}
+
+		//Back faces are the inside of something, nothing gets lit in there.
+		if (XMVectorGetX(XMVector3Dot(hit.normal, direction)) > 0.f)
+		{
+			break;
+		}
+
+		radiance += throughput * ShadeHit(scene, hit, bakeSettings.shadows);
+		if (bounce == bakeSettings.bounces)
+		{
+			break;
+		}
+
+		//Cosine weighted sampling cancels the Lambert BRDF's cos / pi, leaving just the albedo.
+		throughput *= hit.albedo;
+		origin = hit.position + hit.normal * surfaceOffset;
+		direction = BakeSampling::SampleHemisphere(hit.normal, BakeSampling::HashSample(pathSeed + bounce));
+	}
+
+	return radiance;
+}
+
+static void BakeProbe(const ProbeScene& scene, uint32_t probeIndex, LightProbeInstanceData& probe)
+{
+	const uint32_t sampleCount = static_cast<uint32_t>(std::max(1, ProbeBake::settings.samplesPerProbe));
+	const XMFLOAT2 shift = BakeSampling::HashSample(probeIndex);
+	const XMVECTOR origin = XMLoadFloat3(&probe.position);
+
+	float shR[shCoefficientCount] = {}, shG[shCoefficientCount] = {}, shB[shCoefficientCount] = {};
+	float basis[shCoefficientCount], weighted[shCoefficientCount];
+
+	for (uint32_t sampleIndex = 0; sampleIndex < sampleCount; sampleIndex++)
+	{
+		const XMVECTOR direction = BakeSampling::SampleSphere(BakeSampling::GetSample(sampleIndex, sampleCount, shift));
+		const uint32_t pathSeed = BakeSampling::Hash(probeIndex * sampleCount + sampleIndex);
+		const XMVECTOR radiance = TracePath(scene, origin, direction, pathSeed);
+
+		XMSHEvalDirection(basis, shOrder, direction);
+		XMSHAdd(shR, shOrder, shR, XMSHScale(weighted, shOrder, basis, XMVectorGetX(radiance)));
+		XMSHAdd(shG, shOrder, shG, XMSHScale(weighted, shOrder, basis, XMVectorGetY(radiance)));
+		XMSHAdd(shB, shOrder, shB, XMSHScale(weighted, shOrder, basis, XMVectorGetZ(radiance)));
+	}
+
+	//Monte Carlo over the sphere, each uniform sample stands for 4pi / sampleCount steradians.
+	const float sampleWeight = 4.f * XM_PI / sampleCount;
+	XMSHScale(shR, shOrder, shR, sampleWeight);
+	XMSHScale(shG, shOrder, shG, sampleWeight);
+	XMSHScale(shB, shOrder, shB, sampleWeight);
+
+	//Same layout RenderLightProbeViews() stores SHProjectCubeMap()'s output in.
+	for (size_t i = 0; i < shCoefficientCount; i++)
+	{
+		probe.SH[i] = XMFLOAT4(shR[i], shG[i], shB[i], 1.f);
+	}
+	probe.index = static_cast<int>(probeIndex);
+}
+
+bool ProbeBake::BakeDiffuseProbeMap()
+{
+	const auto startTime = Profile::QuickStart();
+
+	const auto diffuseProbeMap = DiffuseProbeMap::system.GetFirstActor();
+	if (diffuseProbeMap == nullptr)
+	{
+		Log("No diffuse probe map in level to bake probes for.");
+		return false;
+	}
+
+	ProbeScene scene;
+	GatherLights(scene);
+
+	for (auto& mesh : MeshComponent::system.GetComponents())
+	{
+		if (!mesh->IsRenderStatic() || !mesh->IsVisible() || !mesh->IsActive() ||
+			mesh->GetCollisionLayer() == CollisionLayers::Editor)
+		{
+			continue;
+		}
+		AddMesh(*mesh, scene);
+	}
+
+	scene.bvh.Build(scene.positions);
+
+	const double gatherTime = Profile::QuickEnd(startTime);
+	const auto traceStart = Profile::QuickStart();
+
+	auto& probes = diffuseProbeMap->GetLightProbeData();
+	ParallelFor(probes.size(), 1, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				BakeProbe(scene, static_cast<uint32_t>(i), probes[i]);
+			}
+		});
+
+	const double traceTime = Profile::QuickEnd(traceStart);
+
+	diffuseProbeMap->WriteProbeDataToFile();
+
+	Log("CPU probe bake of %zu probes (%d samples, %d bounces) against %zu triangles and %zu lights: "
+		"gathered in [%f] seconds, traced in [%f] seconds.", probes.size(), settings.samplesPerProbe, settings.bounces,
+		scene.positions.size() / 3, scene.lights.size(), gatherTime, traceTime);
+
+	return true;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+//Bakes the world's DiffuseProbeMap on the CPU, the alternative to Renderer::RenderLightProbeViews(). Instead of
+//rendering and projecting a cubemap per probe, every probe traces rays over the sphere against a triangle BVH of
+//the static meshes, shades the hits with the same lighting terms as the default pixel shader and projects them
+//straight into 3rd order SH. Probes are traced in parallel across every core.
+//Writes the same probe data file as the GPU bake. The bake itself doesn't touch D3D, but it reads the loaded
+//world, and loading a world still needs the editor and its renderer. So it's run from the editor's console
+//('BAKE CPU'), not on machines without a GPU.
+namespace ProbeBake
+{
+	struct Settings
+	{
+		//Rays per probe, spread evenly over the sphere.
+		int samplesPerProbe = 256;
+
+		//Diffuse bounces after the first hit. 0 sees what the GPU bake's cubemaps would (direct light and
+		//global ambient only), more bounces gather light reflected between surfaces.
+		int bounces = 0;
+
+		//Shadow rays towards each light from every hit. The GPU bake renders its cubemaps without shadows.
+		bool shadows = true;
+	};
+
+	extern Settings settings;
+
+	//Returns false if there's no DiffuseProbeMap in the world.
+	bool BakeDiffuseProbeMap();
+}
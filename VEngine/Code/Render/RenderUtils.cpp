@@ -40,13 +40,28 @@ namespace RenderUtils
 		SetResourceName(outputBuffer.Get(), "dynamic_buffer_" + std::to_string(GenerateUID()));
 	}
 
-	void CreateVertexBuffer(MeshDataProxy& meshData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer)
+	void CreateVertexBuffers(const VertexStreams& streams, Microsoft::WRL::ComPtr<ID3D11Buffer>* outputBuffers)
 	{
-		CreateDefaultBuffer(meshData.GetVerticesByteWidth(),
-			D3D11_BIND_VERTEX_BUFFER, meshData.vertices.data(), outputBuffer);
+		const size_t vertexCount = streams.GetVertexCount();
+
+		CreateDefaultBuffer(sizeof(XMFLOAT3) * vertexCount, D3D11_BIND_VERTEX_BUFFER,
+			streams.GetPositions().data(), outputBuffers[VertexStreams::positionSlot]);
+
+		CreateDefaultBuffer(VertexStreams::GetShadingStride(streams.GetFormat()) * vertexCount, D3D11_BIND_VERTEX_BUFFER,
+			streams.GetShading(), outputBuffers[VertexStreams::shadingSlot]);
+
+		if (streams.HasSkin())
+		{
+			CreateDefaultBuffer(VertexStreams::GetSkinStride(streams.GetFormat()) * vertexCount, D3D11_BIND_VERTEX_BUFFER,
+				streams.GetSkin(), outputBuffers[VertexStreams::skinSlot]);
+		}
+		else
+		{
+			outputBuffers[VertexStreams::skinSlot].Reset();
+		}
 	}
 
-	void CreateIndexBuffer(std::vector<MeshData::indexDataType>& indices, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer)
+	void CreateIndexBuffer(ArrayView<MeshData::indexDataType> indices, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer)
 	{
 		CreateDefaultBuffer(sizeof(MeshData::indexDataType) * indices.size(),
 			D3D11_BIND_INDEX_BUFFER, indices.data(), outputBuffer);
@@ -78,11 +93,28 @@ namespace RenderUtils
 		D3D11_SUBRESOURCE_DATA data = {};
 		data.pSysMem = initData;
 
-		HR(Renderer::GetDevice().CreateBuffer(&desc, &data, outputBuffer.ReleaseAndGetAddressOf()));
+		HR(Renderer::GetDevice().CreateBuffer(&desc, initData ? &data : nullptr, outputBuffer.ReleaseAndGetAddressOf()));
 
 		SetResourceName(outputBuffer.Get(), "structured_buffer_" + std::to_string(GenerateUID()));
 	}
 
+	void CreateDefaultStructuredBuffer(uint32_t byteWidth, uint32_t byteStride, const void* initData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer)
+	{
+		D3D11_BUFFER_DESC desc = {};
+		desc.ByteWidth = byteWidth;
+		desc.Usage = D3D11_USAGE_DEFAULT;
+		desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+		desc.StructureByteStride = byteStride;
+		desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+
+		D3D11_SUBRESOURCE_DATA data = {};
+		data.pSysMem = initData;
+
+		HR(Renderer::GetDevice().CreateBuffer(&desc, initData ? &data : nullptr, outputBuffer.ReleaseAndGetAddressOf()));
+
+		SetResourceName(outputBuffer.Get(), "default_structured_buffer_" + std::to_string(GenerateUID()));
+	}
+
 	void CreateSamplerState(Microsoft::WRL::ComPtr<ID3D11SamplerState>& samplerState)
 	{
 		D3D11_SAMPLER_DESC sampDesc = {};
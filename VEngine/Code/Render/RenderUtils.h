@@ -22,10 +22,13 @@ namespace RenderUtils
 {
 	void CreateDefaultBuffer(uint64_t byteWidth, uint32_t bindFlags, const void* initData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
 	void CreateDynamicBuffer(uint64_t byteWidth, uint32_t bindFlags, const void* initData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
-	void CreateVertexBuffer(MeshDataProxy& meshData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
-	void CreateIndexBuffer(std::vector<MeshData::indexDataType>& indices, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
+	//One buffer per stream into outputBuffers[VertexStreams::maxStreams], the skin slot is left empty for static meshes.
+	void CreateVertexBuffers(const VertexStreams& streams, Microsoft::WRL::ComPtr<ID3D11Buffer>* outputBuffers);
+	void CreateIndexBuffer(ArrayView<MeshData::indexDataType> indices, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
 	void CreateSRVForMeshInstance(ID3D11Buffer* structuredBuffer, uint32_t numBufferElements, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>& outputSrv);
 	void CreateStructuredBuffer(uint32_t byteWidth, uint32_t byteStride, const void* initData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
+	//GPU only structured buffer, updated a range at a time with UpdateSubresource() instead of being mapped.
+	void CreateDefaultStructuredBuffer(uint32_t byteWidth, uint32_t byteStride, const void* initData, Microsoft::WRL::ComPtr<ID3D11Buffer>& outputBuffer);
 	UINT CalcBufferByteSize(UINT byteSize);
 	void CreateBlendState(D3D11_BLEND_DESC blendDesc, Microsoft::WRL::ComPtr<ID3D11BlendState>& blendState);
 	void CreateRastState(D3D11_RASTERIZER_DESC rastDesc, Microsoft::WRL::ComPtr<ID3D11RasterizerState>& rastState);
@@ -33,8 +36,9 @@ namespace RenderUtils
 	void SetResourceName(ID3D11DeviceChild* resource, std::string name);
 
 	//This function is done as a template because there are several classes inheriting from MeshComponent.
+	//Takes the meshes to sort rather than walking T::system so that culled meshes aren't sorted.
 	template <typename T>
-	std::vector<T*> SortMeshesByDistanceToCamera()
+	std::vector<T*> SortMeshesByDistanceToCamera(const std::vector<T*>& meshes)
 	{
 		struct MeshPack
 		{
@@ -45,14 +49,16 @@ namespace RenderUtils
 
 		const XMVECTOR cameraPos = Camera::GetActiveCamera().GetWorldPositionV();
 
-		for (const auto& mesh : T::system.GetComponents())
+		meshPacks.reserve(meshes.size());
+
+		for (T* mesh : meshes)
 		{
 			float distance = DirectX::XMVector3Length(cameraPos - mesh->GetWorldPositionV()).m128_f32[0];
 			if (mesh->alwaysSortLast)
 			{
 				distance = std::numeric_limits<float>::max();
 			}
-			MeshPack pack = { mesh.get(), distance };
+			MeshPack pack = { mesh, distance };
 			meshPacks.emplace_back(pack);
 		}
 
@@ -63,6 +69,7 @@ namespace RenderUtils
 		std::sort(meshPacks.begin(), meshPacks.end(), DistCompare);
 
 		std::vector<T*> sortedMeshes;
+		sortedMeshes.reserve(meshPacks.size());
 		for (auto& pack : meshPacks)
 		{
 			sortedMeshes.emplace_back(pack.mesh);
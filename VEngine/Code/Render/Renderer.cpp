@@ -18,6 +18,9 @@
 #include "Components/SliceableMeshComponent.h"
 #include "Components/SocketMeshComponent.h"
 #include "ConstantBuffer.h"
+#include "Culling.h"
+#include "LightBake.h"
+#include "DrawList.h"
 #include "Core/Camera.h"
 #include "Core/Core.h"
 #include "Core/Debug.h"
@@ -100,7 +103,7 @@ void CheckSupportedFeatures();
 void RenderShadowPass();
 void RenderMeshComponents();
 void RenderDestructibleMeshes();
-void RenderMeshForShadowPass(MeshComponent* mesh);
+void RenderMeshForShadowPass(MeshComponent* mesh, uint32_t stateChanges);
 void RenderInstanceMeshForShadowPass(InstanceMeshComponent& instanceMesh);
 void AnimateAndRenderSkeletalMeshes();
 void RenderSocketMeshComponents();
@@ -118,10 +121,10 @@ void RenderWireframeForVertexPaintingAndPickedActor();
 void RenderLightProbes();
 void RenderMeshToCaptureMeshIcon();
 
-void VertexColourLightBake();
 
 void MapBuffer(ID3D11Resource* resource, const void* src, size_t size);
 void DrawMesh(MeshComponent* mesh);
+void DrawMeshInstanced(MeshComponent* mesh, uint32_t instanceCount);
 void DrawMeshInstanced(InstanceMeshComponent* mesh);
 void DrawBoundingBox(MeshComponent* mesh, MeshComponent* boundsMesh);
 
@@ -136,8 +139,10 @@ void SetShadowResources();
 void SetMatricesFromMesh(MeshComponent* mesh);
 void SetShaderMeshData(MeshComponent* mesh);
 void SetLightProbeData(MeshComponent* mesh);
-void SetRenderPipelineStates(MeshComponent* mesh);
-void SetRenderPipelineStatesForShadows(MeshComponent* mesh);
+void SetRenderPipelineStates(MeshComponent* mesh, uint32_t stateChanges = DrawState::All);
+void SetRenderPipelineStatesForShadows(MeshComponent* mesh, uint32_t stateChanges = DrawState::All);
+DrawState GetDrawState(MeshComponent* mesh);
+DrawState GetShadowDrawState(MeshComponent* mesh);
 void SetShaders(std::string shaderItemName);
 void SetShaders(ShaderItem* shaderItem);
 void SetRastStateByName(std::string rastStateName);
@@ -161,9 +166,6 @@ bool Renderer::drawBoundingBoxes = false;
 bool Renderer::drawTriggers = true;
 bool Renderer::drawAllAsWireframe = false;
 
-unsigned int Renderer::stride = sizeof(Vertex);
-unsigned int Renderer::offset = 0;
-
 DXGI_FORMAT indexBufferFormat = DXGI_FORMAT_R32_UINT;
 
 Microsoft::WRL::ComPtr<ID3D11Texture2D> backBuffer;
@@ -226,6 +228,8 @@ const int instanceSRVRegister = 4;
 const int environmentMapTextureRegister = 5;
 const int normalMapTextureRegister = 6;
 const int lightProbeInstanceDataRegister = 7;
+const int visibleInstancesRegister = 8;
+const int particleInstanceDataRegister = 9;
 
 const int lightProbeTextureWidth = 64;
 const int lightProbeTextureHeight = 64;
@@ -233,6 +237,16 @@ const int lightProbeTextureHeight = 64;
 ShaderMatrices shaderMatrices;
 ShaderLights shaderLights;
 
+//Both lists go through the same key layout, the pass only keeps them apart if they're ever merged.
+enum DrawPass : uint32_t
+{
+	ShadowDrawPass,
+	MainDrawPass,
+};
+
+DrawList shadowDrawList;
+DrawList mainDrawList;
+
 static bool captureMeshIconOnCurrentFrame = false;
 static std::string captureMeshIconMeshFilename;
 
@@ -246,8 +260,8 @@ struct DebugBoxData
 //Debug object containers
 std::vector<DebugBoxData> debugOrientedBoxesOnTimerToRender;
 std::vector<Vertex> debugLines;
-Microsoft::WRL::ComPtr<ID3D11Buffer> debugLinesBuffer;
-static const uint64_t debugLinesBufferSize = 32 * 32 * sizeof(Vertex);
+VertexBuffer debugLinesBuffer;
+static const uint32_t debugLinesBufferCapacity = 32 * 32;
 
 void Renderer::Init(void* window, int viewportWidth, int viewportHeight)
 {
@@ -281,7 +295,7 @@ void Renderer::Init(void* window, int viewportWidth, int viewportHeight)
 
 	//debugLines.emplace_back(Vertex()); //dummy data so DirectX doesn't crash
 	////@Todo: this crashes the program a lot (most dynamic buffers do) and not sure why.
-	//debugLinesBuffer = RenderUtils::CreateDynamicBuffer(debugLinesBufferSize, D3D11_BIND_VERTEX_BUFFER, debugLines.data());
+	//debugLinesBuffer.CreateDynamicCapped(debugLines, debugLinesBufferCapacity);
 	//debugLines.clear();
 }
 
@@ -315,7 +329,7 @@ void Renderer::Cleanup()
 	lightProbeSRV.Reset();
 	lightProbeTexture.Reset();
 
-	debugLinesBuffer.Reset();
+	debugLinesBuffer.Destroy();
 
 	ReportLiveObjectsVerbose();
 }
@@ -348,9 +362,11 @@ void Renderer::Tick()
 
 	if (Input::GetSystemKeyUp(Keys::F4))
 	{
-		VertexColourLightBake();
+		LightBake::BakeChangedLights();
 	}
 
+	LightBake::Tick();
+
 	ScreenshotCapture();
 }
 
@@ -605,14 +621,38 @@ void SetLightResources()
 	cbLights.SetVSAndPS();
 }
 
+//Indexed meshes bind their index buffer here, callers only set the vertex buffer.
 void DrawMesh(MeshComponent* mesh)
 {
-	context->Draw(static_cast<UINT>(mesh->meshDataProxy.vertices.size()), 0);
+	IndexBuffer& indexBuffer = mesh->GetIndexBuffer();
+	if (!indexBuffer.Empty())
+	{
+		SetIndexBuffer(indexBuffer);
+		context->DrawIndexed(static_cast<UINT>(mesh->meshDataProxy.GetIndices().size()), 0, 0);
+	}
+	else
+	{
+		context->Draw(static_cast<UINT>(mesh->meshDataProxy.GetVertexCount()), 0);
+	}
+}
+
+void DrawMeshInstanced(MeshComponent* mesh, uint32_t instanceCount)
+{
+	IndexBuffer& indexBuffer = mesh->GetIndexBuffer();
+	if (!indexBuffer.Empty())
+	{
+		SetIndexBuffer(indexBuffer);
+		context->DrawIndexedInstanced(static_cast<UINT>(mesh->meshDataProxy.GetIndices().size()), instanceCount, 0, 0, 0);
+	}
+	else
+	{
+		context->DrawInstanced(static_cast<UINT>(mesh->meshDataProxy.GetVertexCount()), instanceCount, 0, 0);
+	}
 }
 
 void DrawMeshInstanced(InstanceMeshComponent* mesh)
 {
-	context->DrawInstanced(static_cast<UINT>(mesh->meshDataProxy.vertices.size()), mesh->GetInstanceCount(), 0, 0);
+	DrawMeshInstanced(mesh, static_cast<uint32_t>(mesh->visibleInstances.size()));
 }
 
 void DrawBoundingBox(MeshComponent* mesh, MeshComponent* boundsMesh)
@@ -651,13 +691,10 @@ void RenderDebugLines()
 	cbMaterial.SetPS();
 	SetShaders("SolidColour");
 
-	D3D11_MAPPED_SUBRESOURCE mappedResource{};
-	HR(context->Map(debugLinesBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-	memcpy(mappedResource.pData, debugLines.data(), debugLinesBufferSize);
-	context->Unmap(debugLinesBuffer.Get(), 0);
+	debugLinesBuffer.UpdateDynamic(*context, debugLines);
 
 	context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
-	context->IASetVertexBuffers(0, 1, debugLinesBuffer.GetAddressOf(), &Renderer::stride, &Renderer::offset);
+	SetVertexBuffer(debugLinesBuffer);
 
 	shaderMatrices.model = XMMatrixIdentity();
 	shaderMatrices.MakeModelViewProjectionMatrix();
@@ -686,16 +723,11 @@ void CheckSupportedFeatures()
 	sampleDesc.Count = sampleCount;
 }
 
-void RenderMeshForShadowPass(MeshComponent* mesh)
+void RenderMeshForShadowPass(MeshComponent* mesh, uint32_t stateChanges)
 {
-	if (!mesh->castsShadow || !mesh->IsVisible() || !mesh->IsActive())
-	{
-		return;
-	}
-
 	Material& mat = mesh->GetMaterial();
 
-	SetRenderPipelineStatesForShadows(mesh);
+	SetRenderPipelineStatesForShadows(mesh, stateChanges);
 
 	//Set matrices
 	shaderMatrices.model = mesh->GetWorldMatrix();
@@ -705,12 +737,8 @@ void RenderMeshForShadowPass(MeshComponent* mesh)
 	cbMatrices.Map(&shaderMatrices);
 	cbMatrices.SetVS();
 
-	//Set textures
-	context->PSSetSamplers(0, 1, mat.GetSampler().GetDataAddress());
-	SetShaderResourceFromMaterial(mat);
-
 	//Draw
-	context->Draw(static_cast<UINT>(mesh->meshDataProxy.vertices.size()), 0);
+	DrawMesh(mesh);
 }
 
 void RenderInstanceMeshForShadowPass(InstanceMeshComponent& instanceMesh)
@@ -722,8 +750,6 @@ void RenderInstanceMeshForShadowPass(InstanceMeshComponent& instanceMesh)
 	Material& mat = instanceMesh.GetMaterial();
 	SetRenderPipelineStatesForShadows(&instanceMesh);
 
-	const auto vertexCount = instanceMesh.meshDataProxy.vertices.size();
-
 	for (const auto& instanceData : instanceMesh.GetInstanceData())
 	{
 		//Set matrices
@@ -739,7 +765,7 @@ void RenderInstanceMeshForShadowPass(InstanceMeshComponent& instanceMesh)
 		SetShaderResourceFromMaterial(mat);
 
 		//Draw
-		context->Draw(static_cast<UINT>(vertexCount), 0);
+		DrawMesh(&instanceMesh);
 	}
 }
 
@@ -747,6 +773,8 @@ void RenderShadowPass()
 {
 	Profile::Start();
 
+	shadowDrawList.Clear();
+
 	if (!shaderLights.shadowsEnabled)
 	{
 		return;
@@ -756,10 +784,20 @@ void RenderShadowPass()
 
 	shadowMap->BindDsvAndSetNullRenderTarget(context.Get());
 
-	for (auto& mesh : MeshComponent::system.GetComponents())
+	const auto& visibleLists = Culling::GetVisibleLists();
+	const XMVECTOR cameraPosition = Camera::GetActiveCamera().GetWorldPositionV();
+
+	//Every caster uses the same shader, so this mostly groups by texture and skips rebinding it.
+	for (MeshComponent* mesh : visibleLists.shadowMeshes)
 	{
-		RenderMeshForShadowPass(mesh.get());
+		const float distance = XMVectorGetX(XMVector3Length(cameraPosition - mesh->GetWorldPositionV()));
+		shadowDrawList.Add(ShadowDrawPass, false, GetShadowDrawState(mesh), distance, mesh);
 	}
+	shadowDrawList.Sort();
+	shadowDrawList.Submit([](const DrawList::Item& item, uint32_t stateChanges)
+		{
+			RenderMeshForShadowPass(static_cast<MeshComponent*>(item.userData), stateChanges);
+		});
 
 	//@Todo: For VagrantTactics, don't need shadows on InstanceMeshes as only the Grid is using them and 
 	//the levels are small enough.
@@ -768,23 +806,17 @@ void RenderShadowPass()
 	//	RenderInstanceMeshForShadowPass(*instanceMesh.get());
 	//}
 
-	for (auto& skeletalMesh : SkeletalMeshComponent::system.GetComponents())
+	for (SkeletalMeshComponent* mesh : visibleLists.shadowSkeletalMeshes)
 	{
-		SkeletalMeshComponent* mesh = skeletalMesh.get();
-
-		if (!mesh->castsShadow || !mesh->IsVisible() || !mesh->IsActive())
-		{
-			return;
-		}
 
 		context->RSSetState(rastStateMap.find(RastStates::shadow)->second->GetData());
 
-		context->IASetVertexBuffers(0, 1, mesh->GetVertexBuffer().GetDataAddress(), &Renderer::stride, &Renderer::offset);
+		SetVertexBuffer(mesh->GetVertexBuffer());
 
 		ShaderItem* shader = ShaderSystem::FindShaderItem("ShadowAnimation");
 
 		context->VSSetShader(shader->GetVertexShader(), nullptr, 0);
-		context->IASetInputLayout(shader->GetInputLayout());
+		context->IASetInputLayout(shader->GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
 		context->PSSetShader(shader->GetPixelShader(), nullptr, 0);
 
 		//Set matrices
@@ -797,7 +829,7 @@ void RenderShadowPass()
 
 		//Set skinning data
 		//The constant buffer set here is working off of the data inputted on animating skeletons
-		ShaderSkinningData skinningData = skeletalMesh->shaderSkinningData;
+		ShaderSkinningData skinningData = mesh->shaderSkinningData;
 		cbSkinningData.Map(&skinningData);
 		cbSkinningData.SetVS();
 
@@ -807,7 +839,7 @@ void RenderShadowPass()
 		SetShaderResourceFromMaterial(mat);
 
 		//Draw
-		context->Draw(static_cast<UINT>(mesh->meshDataProxy.vertices.size()), 0);
+		DrawMesh(mesh);
 	}
 
 	SetNullRTV();
@@ -872,6 +904,10 @@ void Renderer::Render()
 	}
 
 	SetShadowData();
+
+	Culling::CullFrame(shaderMatrices.view * shaderMatrices.proj, activeCamera.GetWorldPositionV(),
+		shaderLights.shadowsEnabled, shaderMatrices.lightViewProj);
+
 	RenderShadowPass();
 
 	if (PostProcessVolume::system.GetNumActors() > 0
@@ -943,18 +979,17 @@ void SetLightProbeData(MeshComponent* mesh)
 		context->PSSetShaderResources(environmentMapTextureRegister, 1, lightProbeSRV.GetAddressOf());
 
 		const auto lightProbeMap = DiffuseProbeMap::system.GetFirstActor();
-		LightProbeInstanceData probeData;
 		if (mesh->IsRenderStatic())
 		{
-			probeData = lightProbeMap->GetProbeByIndex(mesh->cachedLightProbeMapIndex);
+			const LightProbeInstanceData probeData = lightProbeMap->GetProbeByIndex(mesh->cachedLightProbeMapIndex);
+			memcpy(lightProbeData.SH, probeData.SH, sizeof(XMFLOAT4) * 9);
 		}
 		else
 		{
-			probeData = lightProbeMap->FindClosestProbe(mesh->GetWorldPositionV());
+			//Blend between probes so that moving meshes don't pop from one probe to the next.
+			lightProbeMap->SampleProbeSH(mesh->GetWorldPositionV(), lightProbeData.SH);
 		}
 
-		memcpy(lightProbeData.SH, probeData.SH, sizeof(XMFLOAT4) * 9);
-
 		lightProbeData.isDiffuseProbeMapActive = DiffuseProbeMap::system.GetOnlyActor()->IsActive();
 	}
 	else
@@ -974,40 +1009,44 @@ void RenderMeshComponents()
 	SetShadowResources();
 	SetLightResources();
 
-	auto meshes = RenderUtils::SortMeshesByDistanceToCamera<MeshComponent>();
-	for (auto mesh : meshes)
-	{
-		if (!mesh->IsVisible() || !mesh->IsActive())
-		{
-			continue;
-		}
+	const XMVECTOR cameraPosition = Camera::GetActiveCamera().GetWorldPositionV();
 
-		SetRenderPipelineStates(mesh);
+	mainDrawList.Clear();
 
-		//Constant buffer data
-		SetMatricesFromMesh(mesh);
-		SetShaderMeshData(mesh);
-		SetLightProbeData(mesh);
+	const auto addDraw = [&](MeshComponent* mesh)
+		{
+			const float distance = XMVectorGetX(XMVector3Length(cameraPosition - mesh->GetWorldPositionV()));
+			const DrawState drawState = GetDrawState(mesh);
+			mainDrawList.Add(MainDrawPass, mesh->alwaysSortLast, drawState.blendState != nullptr, drawState, distance, mesh);
+		};
 
-		DrawMesh(mesh);
+	for (MeshComponent* mesh : Culling::GetVisibleLists().meshes)
+	{
+		addDraw(mesh);
 	}
 
 	for (auto& mesh : SliceableMeshComponent::system.GetComponents())
 	{
-		if (!mesh->IsVisible() || !mesh->IsActive())
+		if (mesh->IsVisible() && mesh->IsActive())
 		{
-			continue;
+			addDraw(mesh.get());
 		}
+	}
 
-		SetRenderPipelineStates(mesh.get());
+	mainDrawList.Sort();
+	mainDrawList.Submit([](const DrawList::Item& item, uint32_t stateChanges)
+		{
+			auto mesh = static_cast<MeshComponent*>(item.userData);
 
-		//Constant buffer data
-		SetMatricesFromMesh(mesh.get());
-		SetShaderMeshData(mesh.get());
-		SetLightProbeData(mesh.get());
+			SetRenderPipelineStates(mesh, stateChanges);
 
-		DrawMesh(mesh.get());
-	}
+			//Constant buffer data
+			SetMatricesFromMesh(mesh);
+			SetShaderMeshData(mesh);
+			SetLightProbeData(mesh);
+
+			DrawMesh(mesh);
+		});
 
 	SetGeneralShaderResourcesToNull();
 
@@ -1128,7 +1167,7 @@ void Renderer::RenderLightProbeViews()
 				context->RSSetState(mesh->GetRastState().GetData());
 
 				context->VSSetShader(lightProbeShader->GetVertexShader(), nullptr, 0);
-				context->IASetInputLayout(lightProbeShader->GetInputLayout());
+				context->IASetInputLayout(lightProbeShader->GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
 
 				context->PSSetShader(lightProbeShader->GetPixelShader(), nullptr, 0);
 
@@ -1136,7 +1175,7 @@ void Renderer::RenderLightProbeViews()
 
 				SetShaderResourceFromMaterial(material);
 
-				context->IASetVertexBuffers(0, 1, mesh->GetVertexBuffer().GetDataAddress(), &stride, &offset);
+				SetVertexBuffer(mesh->GetVertexBuffer());
 
 				cbMaterial.Map(&material.GetMaterialShaderData());
 				cbMaterial.SetPS();
@@ -1160,7 +1199,7 @@ void Renderer::RenderLightProbeViews()
 				cbMeshData.SetVSAndPS();
 
 				//Draw
-				context->Draw(static_cast<UINT>(mesh->meshDataProxy.vertices.size()), 0);
+				DrawMesh(mesh.get());
 			}
 
 			//Remove lightprobe RTV
@@ -1213,29 +1252,27 @@ void RenderInstanceMeshComponents()
 	//Note: Sorting instance meshes for transparency won't work, mesh instances could be anywhere in the world.
 	//Correct transparency isn't supported right now, and only gets by by calling this function before
 	//mesh components are rendered.
-	for (auto& instanceMesh : InstanceMeshComponent::system.GetComponents())
+	for (InstanceMeshComponent* instanceMesh : Culling::GetVisibleLists().instanceMeshes)
 	{
-		if (!instanceMesh->IsVisible() || !instanceMesh->IsActive())
-		{
-			continue;
-		}
-
-		SetRenderPipelineStates(instanceMesh.get());
+		SetRenderPipelineStates(instanceMesh);
 
 		//Update texture matrix
 		shaderMatrices.MakeTextureMatrix(instanceMesh->GetMaterial());
 		cbMatrices.Map(&shaderMatrices);
 		cbMatrices.SetVS();
 
-		//Update instance data and set SRV
-		MapBuffer(instanceMesh->structuredBuffer.Get(), instanceMesh->GetInstanceData().data(), sizeof(InstanceData) * instanceMesh->GetInstanceData().size());
+		//Upload changed instances and the indices of the ones that survived culling, then set SRVs
+		instanceMesh->UploadInstanceData();
+		MapBuffer(instanceMesh->visibleInstanceBuffer.Get(), instanceMesh->visibleInstances.data(),
+			sizeof(uint32_t) * instanceMesh->visibleInstances.size());
 		context->VSSetShaderResources(instanceSRVRegister, 1, instanceMesh->srv.GetAddressOf());
 		context->PSSetShaderResources(instanceSRVRegister, 1, instanceMesh->srv.GetAddressOf());
+		context->VSSetShaderResources(visibleInstancesRegister, 1, instanceMesh->visibleInstanceSrv.GetAddressOf());
 
 		//Set lights buffer
 		cbLights.SetPS();
 
-		DrawMeshInstanced(instanceMesh.get());
+		DrawMeshInstanced(instanceMesh);
 	}
 
 	Profile::End();
@@ -1357,7 +1394,7 @@ void RenderPhysicsMeshes()
 
 		auto shaderItem = ShaderSystem::FindShaderItem("SolidColour");
 		context->VSSetShader(shaderItem->GetVertexShader(), nullptr, 0);
-		context->IASetInputLayout(shaderItem->GetInputLayout());
+		context->IASetInputLayout(shaderItem->GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
 		context->PSSetShader(shaderItem->GetPixelShader(), nullptr, 0);
 
 		SetVertexBuffer(mesh->GetVertexBuffer());
@@ -1608,12 +1645,7 @@ void RenderPolyboards()
 		SetShaderResourcePixel(0, polyboard->GetTextureFilename());
 
 		//VERTEX MAP
-		{
-			D3D11_MAPPED_SUBRESOURCE mappedResource = {};
-			HR(context->Map(polyboard->GetVertexBuffer().GetData(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-			memcpy(mappedResource.pData, polyboard->GetVertices().data(), sizeof(Vertex) * polyboard->GetVertices().size());
-			context->Unmap(polyboard->GetVertexBuffer().GetData(), 0);
-		}
+		polyboard->GetVertexBuffer().UpdateDynamic(*context, polyboard->GetVertices());
 
 		//INDEX MAP
 		{
@@ -1684,10 +1716,8 @@ void AnimateAndRenderSkeletalMeshes()
 	SetShadowResources();
 	SetLightResources();
 
-	for (auto skeletalMesh : RenderUtils::SortMeshesByDistanceToCamera<SkeletalMeshComponent>())
+	for (auto skeletalMesh : RenderUtils::SortMeshesByDistanceToCamera(Culling::GetVisibleLists().skeletalMeshes))
 	{
-		if (!skeletalMesh->IsVisible()) { continue; }
-
 		SetRenderPipelineStates(skeletalMesh);
 
 		//Constant buffer data
@@ -1701,19 +1731,10 @@ void AnimateAndRenderSkeletalMeshes()
 				//Set shader for skeletal animation
 				ShaderItem* shaderItem = ShaderSystem::FindShaderItem("Animation");
 				context->VSSetShader(shaderItem->GetVertexShader(), nullptr, 0);
-				context->IASetInputLayout(shaderItem->GetInputLayout());
+				context->IASetInputLayout(shaderItem->GetInputLayout(skeletalMesh->GetVertexBuffer().GetFormat()));
 				context->PSSetShader(shaderItem->GetPixelShader(), nullptr, 0);
 
-				if (!skeletalMesh->GetNextAnimationName().empty())
-				{
-					skeletalMesh->CrossFadeNextAnimation();
-				}
-				else
-				{
-					skeletalMesh->InterpolateCurrentAnimation();
-				}
-
-				//Update skinning constant buffers
+				//Update skinning constant buffers. Poses were set in SkeletalMeshComponent::AnimateAllSkeletalMeshes().
 				ShaderSkinningData& skinningData = skeletalMesh->shaderSkinningData;
 				cbSkinningData.Map(&skinningData);
 				cbSkinningData.SetVS();
@@ -1757,15 +1778,24 @@ void Renderer::RenderParticleEmitters()
 
 	//Only need to build sprite quad once for in-world rendering
 	SpriteSystem::BuildSpriteQuadForParticleRendering();
+	SpriteSystem::UpdateAndSetSpriteBuffers();
 
+	//Particle positions are already in world space, Particle_vs billboards them with the view matrix.
 	auto& activeCamera = Camera::GetActiveCamera();
 	shaderMatrices.view = activeCamera.GetViewMatrix();
 	shaderMatrices.proj = activeCamera.GetProjectionMatrix();
 	shaderMatrices.texMatrix = XMMatrixIdentity();
+	shaderMatrices.model = XMMatrixIdentity();
+	shaderMatrices.MakeModelViewProjectionMatrix();
+
+	cbMatrices.Map(&shaderMatrices);
+	cbMatrices.SetVS();
+
+	ShaderItem* particleShaderItem = ShaderSystem::FindShaderItem("Particle");
 
 	for (auto& emitter : ParticleEmitter::system.GetComponents())
 	{
-		if (!emitter->IsVisible() || !emitter->IsActive())
+		if (!emitter->IsVisible() || !emitter->IsActive() || emitter->GetParticleCount() == 0)
 		{
 			continue;
 		}
@@ -1781,38 +1811,27 @@ void Renderer::RenderParticleEmitters()
 
 		SetBlendStateByName(BlendStates::Transparent);
 
+		//The emitter's material still picks the pixel shader, but every emitter needs the instanced vertex shader.
 		SetShaders(emitter->GetMaterial().GetShaderItem().GetName());
+		context->VSSetShader(particleShaderItem->GetVertexShader(), nullptr, 0);
+		context->IASetInputLayout(particleShaderItem->GetInputLayout());
 
 		context->PSSetSamplers(0, 1, Renderer::GetDefaultSampler().GetDataAddress());
 
 		//Set texture from emitter for every particle
 		SetShaderResourcePixel(0, emitter->GetMaterial().defaultTextureData.filename);
 
-		SpriteSystem::UpdateAndSetSpriteBuffers();
-
-		for (auto& particle : emitter->particles)
-		{
-			//Add rotation to particle (keep in mind that rotate speed needs to match angle's +/- value)
-			auto particleRotation =
-				VMath::LookAtRotation(Camera::GetActiveCamera().GetWorldPositionV(), XMLoadFloat3(&particle.transform.position));
-			XMStoreFloat4(&particle.transform.rotation, particleRotation);
-
-			shaderMatrices.model = particle.transform.GetAffine();
-			shaderMatrices.MakeModelViewProjectionMatrix();
-
-			cbMatrices.Map(&shaderMatrices);
-			cbMatrices.SetVS();
+		//Per particle alpha comes through the instance colour and is multiplied with the material's.
+		MaterialShaderData materialShaderData = emitter->GetMaterial().GetMaterialShaderData();
+		cbMaterial.Map(&materialShaderData);
+		cbMaterial.SetPS();
 
-			MaterialShaderData materialShaderData;
-			materialShaderData = emitter->GetMaterial().GetMaterialShaderData();
-			materialShaderData.ambient.w = particle.alpha;
-			cbMaterial.Map(&materialShaderData);
-			cbMaterial.SetPS();
+		emitter->BuildInstanceData();
+		MapBuffer(emitter->instanceBuffer.Get(), emitter->instanceData.data(),
+			sizeof(ParticleInstanceData) * emitter->instanceData.size());
+		context->VSSetShaderResources(particleInstanceDataRegister, 1, emitter->instanceSrv.GetAddressOf());
 
-			//Note: Apparently using DrawInstanced() degrades performance when the vertex count it really low
-			//and DrawIndexed is actually faster.
-			context->DrawIndexed(6, 0, 0);
-		}
+		context->DrawIndexedInstanced(6, static_cast<UINT>(emitter->instanceData.size()), 0, 0, 0);
 	}
 
 	Profile::End();
@@ -1929,6 +1948,13 @@ void Renderer::Present()
 	HR(swapchain->Present(1, 0));
 }
 
+DrawListStats Renderer::GetDrawListStats()
+{
+	DrawListStats stats = mainDrawList.GetStats();
+	stats.Add(shadowDrawList.GetStats());
+	return stats;
+}
+
 void* Renderer::GetSwapchain()
 {
 	return swapchain.Get();
@@ -2055,48 +2081,134 @@ void Renderer::PlayerPhotoCapture(std::wstring outputFilename)
 	Log("Photo taken [%S]", imageFile.c_str());
 }
 
-void SetRenderPipelineStates(MeshComponent* mesh)
+//Needs to match what SetRenderPipelineStates() binds.
+DrawState GetDrawState(MeshComponent* mesh)
 {
 	Material& material = mesh->GetMaterial();
 
-	if (Renderer::drawAllAsWireframe)
+	DrawState state;
+	state.shader = &material.GetShaderItem();
+	state.inputLayout = material.GetInputLayout(mesh->GetVertexBuffer().GetFormat());
+	state.rastState = Renderer::drawAllAsWireframe ?
+		rastStateMap.find(RastStates::wireframe)->second.get() : &material.GetRastState();
+	state.blendState = material.GetBlendState().GetData();
+	state.sampler = &material.GetSampler();
+	state.texture = &material.GetDefaultTexture();
+	state.secondaryTexture = &material.GetSecondaryTexture();
+	state.materialData = &material;
+	state.vertexBuffer = &mesh->GetVertexBuffer();
+	return state;
+}
+
+//Needs to match what SetRenderPipelineStatesForShadows() binds.
+DrawState GetShadowDrawState(MeshComponent* mesh)
+{
+	Material& material = mesh->GetMaterial();
+	ShaderItem* shader = ShaderSystem::FindShaderItem("Shadow");
+
+	DrawState state;
+	state.shader = shader;
+	state.inputLayout = shader->GetInputLayout(mesh->GetVertexBuffer().GetFormat());
+	state.rastState = rastStateMap.find(RastStates::shadow)->second.get();
+	state.sampler = &material.GetSampler();
+	state.texture = &material.GetDefaultTexture();
+	state.secondaryTexture = &material.GetSecondaryTexture();
+	state.vertexBuffer = &mesh->GetVertexBuffer();
+	return state;
+}
+
+//stateChanges are DrawState flags from DrawList::Submit(), states that are already bound are skipped.
+void SetRenderPipelineStates(MeshComponent* mesh, uint32_t stateChanges)
+{
+	Material& material = mesh->GetMaterial();
+
+	if (stateChanges & DrawState::RastState)
 	{
-		context->RSSetState(rastStateMap.find(RastStates::wireframe)->second->GetData());
+		if (Renderer::drawAllAsWireframe)
+		{
+			context->RSSetState(rastStateMap.find(RastStates::wireframe)->second->GetData());
+		}
+		else
+		{
+			context->RSSetState(material.GetRastState().GetData());
+		}
 	}
-	else
+
+	if (stateChanges & DrawState::BlendState)
 	{
-		context->RSSetState(material.GetRastState().GetData());
+		constexpr FLOAT blendState[4] = { 0.f };
+		context->OMSetBlendState(material.GetBlendState().GetData(), blendState, 0xFFFFFFFF);
 	}
 
-	constexpr FLOAT blendState[4] = { 0.f };
-	context->OMSetBlendState(material.GetBlendState().GetData(), blendState, 0xFFFFFFFF);
+	if (stateChanges & DrawState::Shader)
+	{
+		context->VSSetShader(material.GetVertexShader(), nullptr, 0);
+		context->PSSetShader(material.GetPixelShader(), nullptr, 0);
+	}
 
-	context->VSSetShader(material.GetVertexShader(), nullptr, 0);
-	context->IASetInputLayout(material.GetInputLayout());
+	if (stateChanges & DrawState::InputLayout)
+	{
+		context->IASetInputLayout(material.GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
+	}
 
-	context->PSSetShader(material.GetPixelShader(), nullptr, 0);
+	if (stateChanges & DrawState::Sampler)
+	{
+		context->PSSetSamplers(0, 1, material.GetSampler().GetDataAddress());
+	}
 
-	context->PSSetSamplers(0, 1, material.GetSampler().GetDataAddress());
-	SetShaderResourceFromMaterial(material);
+	if (stateChanges & DrawState::Textures)
+	{
+		SetShaderResourceFromMaterial(material);
+	}
 
-	SetVertexBuffer(mesh->GetVertexBuffer());
+	if (stateChanges & DrawState::VertexBuffer)
+	{
+		SetVertexBuffer(mesh->GetVertexBuffer());
+	}
 
-	cbMaterial.Map(&material.GetMaterialShaderData());
-	cbMaterial.SetPS();
+	if (stateChanges & DrawState::MaterialData)
+	{
+		cbMaterial.Map(&material.GetMaterialShaderData());
+		cbMaterial.SetPS();
+	}
 }
 
-void SetRenderPipelineStatesForShadows(MeshComponent* mesh)
+void SetRenderPipelineStatesForShadows(MeshComponent* mesh, uint32_t stateChanges)
 {
-	context->RSSetState(rastStateMap.find(RastStates::shadow)->second->GetData());
+	if (stateChanges & DrawState::RastState)
+	{
+		context->RSSetState(rastStateMap.find(RastStates::shadow)->second->GetData());
+	}
 
 	ShaderItem* shader = ShaderSystem::FindShaderItem("Shadow");
 
-	context->VSSetShader(shader->GetVertexShader(), nullptr, 0);
-	context->IASetInputLayout(shader->GetInputLayout());
+	if (stateChanges & DrawState::Shader)
+	{
+		context->VSSetShader(shader->GetVertexShader(), nullptr, 0);
+		context->PSSetShader(shader->GetPixelShader(), nullptr, 0);
+	}
+
+	if (stateChanges & DrawState::InputLayout)
+	{
+		context->IASetInputLayout(shader->GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
+	}
+
+	Material& material = mesh->GetMaterial();
+
+	if (stateChanges & DrawState::Sampler)
+	{
+		context->PSSetSamplers(0, 1, material.GetSampler().GetDataAddress());
+	}
 
-	context->PSSetShader(shader->GetPixelShader(), nullptr, 0);
+	if (stateChanges & DrawState::Textures)
+	{
+		SetShaderResourceFromMaterial(material);
+	}
 
-	context->IASetVertexBuffers(0, 1, mesh->GetVertexBuffer().GetDataAddress(), &Renderer::stride, &Renderer::offset);
+	if (stateChanges & DrawState::VertexBuffer)
+	{
+		SetVertexBuffer(mesh->GetVertexBuffer());
+	}
 }
 
 void SetShaders(ShaderItem* shaderItem)
@@ -2162,7 +2274,7 @@ void SetConstantBufferPixel(uint32_t shaderRegister, ID3D11Buffer* constantBuffe
 
 void SetVertexBuffer(VertexBuffer& vertexBuffer)
 {
-	context->IASetVertexBuffers(0, 1, vertexBuffer.GetDataAddress(), &Renderer::stride, &Renderer::offset);
+	vertexBuffer.Set(*context);
 }
 
 void SetIndexBuffer(IndexBuffer& indexBuffer)
@@ -2247,7 +2359,7 @@ void RenderWireframeForVertexPaintingAndPickedActor()
 
 			ShaderItem* shaderItem = ShaderSystem::FindShaderItem("SolidColour");
 			context->VSSetShader(shaderItem->GetVertexShader(), nullptr, 0);
-			context->IASetInputLayout(shaderItem->GetInputLayout());
+			context->IASetInputLayout(shaderItem->GetInputLayout(mesh->GetVertexBuffer().GetFormat()));
 			context->PSSetShader(shaderItem->GetPixelShader(), nullptr, 0);
 
 			SetVertexBuffer(mesh->GetVertexBuffer());
@@ -2333,7 +2445,7 @@ void RenderLightProbes()
 
 	cbLights.SetPS();
 
-	context->DrawInstanced(static_cast<UINT>(instanceMesh->meshDataProxy.vertices.size()), probeMap->GetProbeCount(), 0, 0);
+	DrawMeshInstanced(instanceMesh, probeMap->GetProbeCount());
 }
 
 void RenderMeshToCaptureMeshIcon()
@@ -2366,120 +2478,6 @@ void RenderMeshToCaptureMeshIcon()
 	Camera::SetActiveCamera(&previousActiveCamera);
 }
 
-//Don't actually want to use usual light calculations with vertex colour baking.
-//Because the pixel shaders are already adding colour to meshes, instead, vertex colour baking can be used
-//like a more coarse ambient occlusion, only considering raycast hits from the light source.
-void VertexColourLightBake()
-{
-	const auto startTime = Profile::QuickStart();
-
-	for (const auto& mesh : MeshComponent::system.GetComponents())
-	{
-		//Skipping baking vertex colours to non-static meshes
-		if (!mesh->IsRenderStatic())
-		{
-			continue;
-		}
-
-		const auto meshWorldMatrix = mesh->GetWorldMatrix();
-		auto& vertices = mesh->GetAllVertices();
-
-		const auto defaultGrey = XMVectorSet(0.3f, 0.3f, 0.3f, 1.f);
-
-		for (const auto& dLight : DirectionalLightComponent::system.GetComponents())
-		{
-			for (auto& vertex : vertices)
-			{
-				const auto vertexPos = XMLoadFloat3(&vertex.pos);
-				const auto worldSpaceVertexPos = XMVector3TransformCoord(vertexPos, meshWorldMatrix);
-
-				auto normal = XMLoadFloat3(&vertex.normal);
-				normal = XMVector3TransformNormal(normal, meshWorldMatrix);
-				normal = XMVector3Normalize(normal);
-
-				HitResult vertexRayHit;
-				vertexRayHit.AddAllRenderStaticMeshesToIgnore();
-				vertexRayHit.ignoreBackFaceHits = false;
-				vertexRayHit.ignoreLayer = CollisionLayers::Editor;
-
-				const auto rayOrigin = worldSpaceVertexPos + (normal * 0.1f);
-				const auto dLightDirection = dLight->GetForwardVectorV();
-				if (Physics::Raycast(vertexRayHit, rayOrigin, -dLightDirection, 50.f))
-				{
-					const auto result = XMLoadFloat4(&vertex.colour) * defaultGrey;
-					XMStoreFloat4(&vertex.colour, result);
-				}
-			}
-		}
-
-		for (const auto& pointLight : PointLightComponent::system.GetComponents())
-		{
-			for (auto& vertex : vertices)
-			{
-				const auto vertexPos = XMLoadFloat3(&vertex.pos);
-				const auto worldSpaceVertexPos = XMVector3TransformCoord(vertexPos, meshWorldMatrix);
-
-				auto normal = XMLoadFloat3(&vertex.normal);
-				normal = XMVector3TransformNormal(normal, meshWorldMatrix);
-				normal = XMVector3Normalize(normal);
-
-				HitResult vertexRayHit;
-				vertexRayHit.AddAllRenderStaticMeshesToIgnore();
-				vertexRayHit.ignoreBackFaceHits = false;
-				vertexRayHit.ignoreLayer = CollisionLayers::Editor;
-
-				const auto vertexToLightDirection =
-					XMVector3Normalize(pointLight->GetWorldPositionV() - worldSpaceVertexPos);
-				const auto rayOrigin = worldSpaceVertexPos + (normal * 0.1f);
-				if (Physics::Raycast(vertexRayHit, rayOrigin, pointLight->GetWorldPositionV()))
-				{
-					const auto result = XMLoadFloat4(&vertex.colour) * defaultGrey;
-					XMStoreFloat4(&vertex.colour, result);
-				}
-			}
-		}
-
-		for (const auto& spotLight : SpotLightComponent::system.GetComponents())
-		{
-			for (auto& vertex : vertices)
-			{
-				const auto vertexPos = XMLoadFloat3(&vertex.pos);
-				const auto worldSpaceVertexPos = XMVector3TransformCoord(vertexPos, meshWorldMatrix);
-
-				auto normal = XMLoadFloat3(&vertex.normal);
-				normal = XMVector3TransformNormal(normal, meshWorldMatrix);
-				normal = XMVector3Normalize(normal);
-
-				HitResult vertexRayHit;
-				vertexRayHit.AddAllRenderStaticMeshesToIgnore();
-				vertexRayHit.ignoreBackFaceHits = false;
-				vertexRayHit.ignoreLayer = CollisionLayers::Editor;
-
-				const auto spotLightWorldPos = spotLight->GetWorldPositionV();
-				const auto rayOrigin = worldSpaceVertexPos + (normal * 0.1f);
-
-				const float angleBetweenSpotLightForwardAndRaycastDirection =
-					XMConvertToDegrees(XMVector3AngleBetweenNormals(
-						spotLight->GetForwardVectorV(),
-						XMVector3Normalize(rayOrigin - spotLightWorldPos)).m128_f32[0]);
-				if (angleBetweenSpotLightForwardAndRaycastDirection <= spotLight->GetLightData().spotAngle)
-				{
-					if (Physics::Raycast(vertexRayHit, rayOrigin, spotLight->GetWorldPositionV()))
-					{
-						const auto result = XMLoadFloat4(&vertex.colour) * defaultGrey;
-						XMStoreFloat4(&vertex.colour, result);
-					}
-				}
-			}
-		}
-
-		mesh->CreateNewVertexBuffer();
-	}
-
-	const auto endTime = Profile::QuickEnd(startTime);
-	Log("Vertex colour baking completed in [%f] seconds.", endTime);
-}
-
 RastState* Renderer::GetRastState(std::string rastStateName)
 {
 	return rastStateMap.find(rastStateName)->second.get();
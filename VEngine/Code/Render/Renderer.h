@@ -6,6 +6,7 @@ class RastState;
 class Sampler;
 class BlendState;
 struct Line;
+struct DrawListStats;
 namespace DirectX {
 	struct BoundingOrientedBox;
 }
@@ -20,9 +21,6 @@ namespace Renderer
 	extern bool drawTriggers;
 	extern bool drawAllAsWireframe;
 
-	extern unsigned int stride;
-	extern unsigned int offset;
-
 	void Init(void* window, int viewportWidth, int viewportHeight);
 	void Cleanup();
 	void Tick();
@@ -68,4 +66,7 @@ namespace Renderer
 	bool IsRendererSetToCaptureMeshIcon();
 
 	void ReportLiveObjectsVerbose();
+
+	//Draws and state binds from this frame's mesh and shadow draw lists.
+	DrawListStats GetDrawListStats();
 };
@@ -8,6 +8,14 @@ struct InstanceData
 	DirectX::XMFLOAT4 colour = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
 };
 
+//One per live particle in a ParticleEmitter, the quad is billboarded in Particle_vs.hlsl.
+struct ParticleInstanceData
+{
+	DirectX::XMFLOAT3 position = DirectX::XMFLOAT3(0.f, 0.f, 0.f);
+	float angle = 0.f; //Roll around the view direction in radians
+	DirectX::XMFLOAT4 colour = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+};
+
 struct LightProbeInstanceData
 {
 	DirectX::XMFLOAT4 SH[9]{}; //Spherical Harmonics
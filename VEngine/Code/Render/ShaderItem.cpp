@@ -15,8 +15,8 @@ ShaderItem::ShaderItem(std::string shaderItemName_,
 	pixelShader = ShaderSystem::FindPixelShader(pixelShaderFilename)->GetShader();
 }
 
-ID3D11InputLayout* ShaderItem::GetInputLayout() const
+ID3D11InputLayout* ShaderItem::GetInputLayout(VertexFormat format) const
 {
 	auto vertShader = ShaderSystem::FindVertexShader(vertexShaderFilename);
-	return vertShader->GetInputLayout();
+	return vertShader->GetInputLayout(format);
 }
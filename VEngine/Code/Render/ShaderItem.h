@@ -2,6 +2,7 @@
 
 #include <string>
 #include <Core/UID.h>
+#include "VertexStreams.h"
 
 class VertexShader;
 class PixelShader;
@@ -25,7 +26,7 @@ public:
 	auto GetVertexShaderFilename() { return vertexShaderFilename; }
 	auto GetPixelShaderFilename() { return pixelShaderFilename; }
 
-	ID3D11InputLayout* GetInputLayout() const;
+	ID3D11InputLayout* GetInputLayout(VertexFormat format = VertexFormat::Full) const;
 
 	auto GetUID() const { return uid; }
 
@@ -17,18 +17,46 @@ struct InstanceData
     float4 colour;
 };
 
+struct ParticleInstanceData
+{
+    float3 position;
+    float angle;
+    float4 colour;
+};
+
+//Inputs come from separate vertex streams (see VertexStreams.h on the C++ side). Normals and tangents are
+//octahedral encoded, use DecodeOctahedral().
 struct VS_IN
 {
     float4 colour : COLOUR;
     float3 pos : POSITION;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
+    float2 normal : NORMAL;
+    float2 tangent : TANGENT;
+    float2 uv : TEXCOORD;
+    uint instanceID : SV_InstanceID;
+};
+
+//Skinned meshes have a third stream with the bone data.
+struct VS_IN_SKINNED
+{
+    float4 colour : COLOUR;
+    float3 pos : POSITION;
+    float2 normal : NORMAL;
+    float2 tangent : TANGENT;
     float2 uv : TEXCOORD;
     uint4 boneIndices : BONEINDICES;
     float3 weights : WEIGHTS;
     uint instanceID : SV_InstanceID;
 };
 
+float3 DecodeOctahedral(float2 e)
+{
+    float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+    const float t = saturate(-n.z);
+    n.xy += (n.xy >= 0.0f) ? -t : t;
+    return normalize(n);
+}
+
 struct VS_OUT
 {
     float4 colour : COLOUR;
@@ -49,6 +77,8 @@ StructuredBuffer<InstanceData> instanceData : register(t4);
 TextureCube environmentMap : register(t5);
 Texture2D normalMap : register(t6);
 StructuredBuffer<LightProbeInstanceData> lightProbeInstanceData : register(t7);
+StructuredBuffer<uint> visibleInstances : register(t8);
+StructuredBuffer<ParticleInstanceData> particleInstanceData : register(t9);
 
 SamplerState defaultSampler : register(s0);
 SamplerComparisonState shadowSampler : register(s1);
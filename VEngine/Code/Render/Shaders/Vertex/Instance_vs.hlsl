@@ -2,7 +2,10 @@
 
 VS_OUT main(VS_IN i)
 {
-	VS_OUT o = TransformOutInstance(i, instanceData[i.instanceID].modelMatrix);
+	//Instances are culled on the CPU, the draw only covers the visible ones.
+	const uint instanceIndex = visibleInstances[i.instanceID];
+	VS_OUT o = TransformOutInstance(i, instanceData[instanceIndex].modelMatrix);
+	o.instanceID = instanceIndex;
 	return o;
 }
 
@@ -0,0 +1,30 @@
+#include "../Include/Common.hlsli"
+
+//Every particle in an emitter is one instance of the sprite quad. The quad is built along the camera's
+//right and up axes so it always faces the screen, then rolled by the particle's angle.
+VS_OUT main(VS_IN i)
+{
+	const ParticleInstanceData particle = particleInstanceData[i.instanceID];
+
+	//The first two rows of the view matrix are the camera's right and up axes in world space.
+	const float3 cameraRight = view[0].xyz;
+	const float3 cameraUp = view[1].xyz;
+
+	float s, c;
+	sincos(particle.angle, s, c);
+	const float2 corner = float2(i.pos.x * c - i.pos.y * s, i.pos.x * s + i.pos.y * c);
+
+	const float3 posWS = particle.position + cameraRight * corner.x + cameraUp * corner.y;
+	const float3 cameraForward = cross(cameraRight, cameraUp);
+
+	VS_OUT o;
+	o.colour = i.colour * particle.colour;
+	o.posWS = float4(posWS, 1.0f);
+	o.pos = mul(proj, mul(view, o.posWS));
+	o.normal = -cameraForward;
+	o.tangent = cameraRight;
+	o.uv = i.uv;
+	o.shadowPos = float4(1.0f, 1.0f, 1.0f, 1.0f);
+	o.instanceID = i.instanceID;
+	return o;
+}
@@ -1,6 +1,6 @@
 #include "../Include/Common.hlsli"
 
-VS_OUT main(VS_IN i)
+VS_OUT main(VS_IN_SKINNED i)
 {
     VS_OUT o;
 
@@ -11,6 +11,8 @@ VS_OUT main(VS_IN i)
     weights[2] = i.weights.z;
     weights[3] = 1.0f - weights[0] - weights[1] - weights[2];
 
+    const float3 normal = DecodeOctahedral(i.normal);
+
     float3 posL = float3(0.0f, 0.0f, 0.0f);
     float3 normalL = float3(0.0f, 0.0f, 0.0f);
     if(isAnimated)
@@ -19,7 +21,7 @@ VS_OUT main(VS_IN i)
         {
 		    //no nonuniform scaling
             posL += weights[index] * mul(boneTransforms[i.boneIndices[index]], float4(i.pos.xyz, 1.0f)).xyz;
-            normalL += weights[index] * mul((float3x3) boneTransforms[i.boneIndices[index]], i.normal);
+            normalL += weights[index] * mul((float3x3) boneTransforms[i.boneIndices[index]], normal);
         }
     }
     else
@@ -35,7 +37,7 @@ VS_OUT main(VS_IN i)
     o.normal = mul((float3x3) model, normalL);
     o.shadowPos = mul(lightMVP, o.pos);
     o.instanceID = i.instanceID;
-    o.tangent = i.tangent;
+    o.tangent = DecodeOctahedral(i.tangent);
     o.colour = i.colour;
 
     return o;
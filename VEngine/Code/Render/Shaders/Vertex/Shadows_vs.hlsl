@@ -9,9 +9,9 @@ VS_OUT main(VS_IN i)
 	o.posWS = mul(model, float4(i.pos.xyz, 1.0f));
 	float4 newUv = mul(texMatrix, float4(i.uv, 0.f, 1.0f));
 	o.uv = float2(newUv.x, newUv.y);
-	o.normal = mul((float3x3)model, i.normal);
+	o.normal = mul((float3x3)model, DecodeOctahedral(i.normal));
 	o.instanceID = i.instanceID;
-    o.tangent = i.tangent;
+    o.tangent = DecodeOctahedral(i.tangent);
     o.colour = i.colour;
 
     o.shadowPos = mul(lightMVP, float4(i.pos.xyz, 1.0f));
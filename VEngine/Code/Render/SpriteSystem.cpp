@@ -5,21 +5,21 @@
 #include "TextureSystem.h"
 #include "Core/Debug.h"
 #include "Render/Vertex.h"
+#include "Render/VertexBuffer.h"
 #include "Render/MeshData.h"
 #include "Render/Texture2D.h"
 
 static SystemStates systemState = SystemStates::Unloaded;
-static Microsoft::WRL::ComPtr<ID3D11Buffer> spriteVertexBuffer;
+static VertexBuffer spriteVertexBuffer;
 static Microsoft::WRL::ComPtr<ID3D11Buffer> spriteIndexBuffer;
-static Vertex verts[4];
+static std::vector<Vertex> verts(4);
 static std::vector<Sprite> screenSprites;
 
 XMFLOAT3 PointToNdc(int x, int y, float z);
 
 void SpriteSystem::Init()
 {
-	RenderUtils::CreateDynamicBuffer(4 * sizeof(Vertex),
-		D3D11_BIND_VERTEX_BUFFER, &verts[0], spriteVertexBuffer);
+	spriteVertexBuffer.CreateDynamic(verts);
 
 	//Always a quad, for now
 	MeshData::indexDataType spriteIndices[]
@@ -49,12 +49,8 @@ void SpriteSystem::UpdateAndSetSpriteBuffers()
 	ID3D11DeviceContext& context = Renderer::GetDeviceContext();
 
 	//Update vertex buffer
-	D3D11_MAPPED_SUBRESOURCE mappedResource{};
-	HR(context.Map(spriteVertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource));
-	memcpy(mappedResource.pData, &verts, sizeof(verts));
-	context.Unmap(spriteVertexBuffer.Get(), 0);
-
-	context.IASetVertexBuffers(0, 1, spriteVertexBuffer.GetAddressOf(), &Renderer::stride, &Renderer::offset);
+	spriteVertexBuffer.UpdateDynamic(context, verts);
+	spriteVertexBuffer.Set(context);
 	context.IASetIndexBuffer(spriteIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 }
 
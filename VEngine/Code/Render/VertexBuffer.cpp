@@ -1,25 +1,101 @@
 #include "vpch.h"
 #include "VertexBuffer.h"
 #include "Render/RenderUtils.h"
+#include "Render/MeshDataProxy.h"
+#include "Animation/Skeleton.h"
+#include "Core/Debug.h"
 
 void VertexBuffer::CreateDefault(MeshDataProxy& meshDataProxy)
 {
-	RenderUtils::CreateVertexBuffer(meshDataProxy, data);
+	//Cached meshes upload their streams as they are (straight out of the mapped .vmesh), meshes with
+	//their own vertices (painted, sliced) are encoded here.
+	const VertexStreams* sharedStreams = meshDataProxy.GetSharedStreams();
+	if (sharedStreams)
+	{
+		RenderUtils::CreateVertexBuffers(*sharedStreams, streams);
+		format = sharedStreams->GetFormat();
+		strides[VertexStreams::skinSlot] = sharedStreams->HasSkin() ? VertexStreams::GetSkinStride(format) : 0;
+	}
+	else
+	{
+		const bool hasSkin = meshDataProxy.skeleton && meshDataProxy.skeleton->GetNumJoints() > 0;
+
+		VertexStreams encodedStreams;
+		encodedStreams.Encode(meshDataProxy.GetVertices(), meshDataProxy.GetVertexFormat(), hasSkin);
+		RenderUtils::CreateVertexBuffers(encodedStreams, streams);
+		format = encodedStreams.GetFormat();
+		strides[VertexStreams::skinSlot] = hasSkin ? VertexStreams::GetSkinStride(format) : 0;
+	}
+
+	strides[VertexStreams::positionSlot] = sizeof(XMFLOAT3);
+	strides[VertexStreams::shadingSlot] = VertexStreams::GetShadingStride(format);
+	dynamicCapacity = 0;
 }
 
 void VertexBuffer::CreateDynamic(std::vector<Vertex>& vertices)
 {
-	RenderUtils::CreateDynamicBuffer(sizeof(Vertex) * vertices.size(),
-		D3D11_BIND_VERTEX_BUFFER, vertices.data(), data);
+	CreateDynamicStreams(vertices, static_cast<uint32_t>(vertices.size()));
 }
 
 void VertexBuffer::CreateDynamicCapped(std::vector<Vertex>& vertexData, uint32_t cappedSize)
 {
-	RenderUtils::CreateDynamicBuffer(sizeof(Vertex) * cappedSize,
-		D3D11_BIND_VERTEX_BUFFER, vertexData.data(), data);
+	CreateDynamicStreams(vertexData, cappedSize);
+}
+
+void VertexBuffer::CreateDynamicStreams(ArrayView<Vertex> vertices, uint32_t capacity)
+{
+	assert(vertices.size() <= capacity);
+
+	format = VertexFormat::Full;
+	dynamicCapacity = capacity;
+
+	strides[VertexStreams::positionSlot] = sizeof(XMFLOAT3);
+	strides[VertexStreams::shadingSlot] = VertexStreams::GetShadingStride(format);
+	strides[VertexStreams::skinSlot] = 0;
+
+	//Zero filled past vertices.size() so the initial data covers the whole capacity
+	std::vector<XMFLOAT3> positions(capacity);
+	std::vector<uint8_t> shading(capacity * strides[VertexStreams::shadingSlot]);
+	VertexStreams::EncodeInto(vertices, format, positions.data(), shading.data(), nullptr);
+
+	RenderUtils::CreateDynamicBuffer(sizeof(XMFLOAT3) * capacity, D3D11_BIND_VERTEX_BUFFER,
+		positions.data(), streams[VertexStreams::positionSlot]);
+	RenderUtils::CreateDynamicBuffer(shading.size(), D3D11_BIND_VERTEX_BUFFER,
+		shading.data(), streams[VertexStreams::shadingSlot]);
+	streams[VertexStreams::skinSlot].Reset();
+}
+
+void VertexBuffer::UpdateDynamic(ID3D11DeviceContext& context, ArrayView<Vertex> vertices)
+{
+	assert(vertices.size() <= dynamicCapacity);
+
+	D3D11_MAPPED_SUBRESOURCE mappedPositions = {};
+	D3D11_MAPPED_SUBRESOURCE mappedShading = {};
+	HR(context.Map(streams[VertexStreams::positionSlot].Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedPositions));
+	HR(context.Map(streams[VertexStreams::shadingSlot].Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedShading));
+
+	VertexStreams::EncodeInto(vertices, format, static_cast<XMFLOAT3*>(mappedPositions.pData),
+		static_cast<uint8_t*>(mappedShading.pData), nullptr);
+
+	context.Unmap(streams[VertexStreams::positionSlot].Get(), 0);
+	context.Unmap(streams[VertexStreams::shadingSlot].Get(), 0);
 }
 
 void VertexBuffer::Destroy()
 {
-	data.Reset();
+	for (auto& stream : streams)
+	{
+		stream.Reset();
+	}
+}
+
+void VertexBuffer::Set(ID3D11DeviceContext& context)
+{
+	ID3D11Buffer* buffers[VertexStreams::maxStreams];
+	UINT offsets[VertexStreams::maxStreams]{};
+	for (uint32_t i = 0; i < VertexStreams::maxStreams; i++)
+	{
+		buffers[i] = streams[i].Get();
+	}
+	context.IASetVertexBuffers(0, VertexStreams::maxStreams, buffers, strides, offsets);
 }
@@ -4,20 +4,34 @@
 #include <wrl.h>
 #include <vector>
 #include "Render/Vertex.h"
+#include "Render/VertexStreams.h"
 
 struct MeshDataProxy;
 
+//One D3D buffer per vertex stream (see VertexStreams). Set() binds them all from slot 0.
 class VertexBuffer
 {
 public:
 	void CreateDefault(MeshDataProxy& meshDataProxy);
+
+	//Dynamic buffers only have the position and shading streams, they're drawn with the static mesh shaders.
 	void CreateDynamic(std::vector<Vertex>& vertices);
 	void CreateDynamicCapped(std::vector<Vertex>& vertexData, uint32_t cappedSize);
+
+	//Encodes vertices straight into the mapped dynamic streams. Can't go past the created size.
+	void UpdateDynamic(ID3D11DeviceContext& context, ArrayView<Vertex> vertices);
+
 	void Destroy();
 
-	auto GetDataAddress() { return data.GetAddressOf(); }
-	auto GetData() { return data.Get(); }
+	void Set(ID3D11DeviceContext& context);
+
+	VertexFormat GetFormat() const { return format; }
 
 private:
-	Microsoft::WRL::ComPtr<ID3D11Buffer> data;
+	void CreateDynamicStreams(ArrayView<Vertex> vertices, uint32_t capacity);
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer> streams[VertexStreams::maxStreams];
+	UINT strides[VertexStreams::maxStreams]{};
+	VertexFormat format = VertexFormat::Full;
+	uint32_t dynamicCapacity = 0;
 };
@@ -2,6 +2,7 @@
 #include "VertexShader.h"
 #include "Renderer.h"
 #include "Core/Debug.h"
+#include "Render/VertexStreams.h"
 #include <d3dcompiler.h>
 
 void VertexShader::Create(const std::wstring filename)
@@ -23,8 +24,38 @@ void VertexShader::Reset()
 	byteCode.clear();
 }
 
+//Where each VS_IN semantic lives in the vertex streams, see VertexStreams.h.
+struct StreamElement
+{
+	const char* semanticName;
+	UINT inputSlot;
+	UINT fullOffset;
+	DXGI_FORMAT fullFormat;
+	UINT compressedOffset;
+	DXGI_FORMAT compressedFormat;
+};
+
+static const StreamElement streamElements[] =
+{
+	{ "POSITION", VertexStreams::positionSlot, 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, DXGI_FORMAT_R32G32B32_FLOAT },
+	{ "COLOUR", VertexStreams::shadingSlot, offsetof(VertexShading, colour), DXGI_FORMAT_R32G32B32A32_FLOAT,
+		offsetof(VertexShadingCompressed, colour), DXGI_FORMAT_R8G8B8A8_UNORM },
+	{ "NORMAL", VertexStreams::shadingSlot, offsetof(VertexShading, normal), DXGI_FORMAT_R32G32_FLOAT,
+		offsetof(VertexShadingCompressed, normal), DXGI_FORMAT_R16G16_SNORM },
+	{ "TANGENT", VertexStreams::shadingSlot, offsetof(VertexShading, tangent), DXGI_FORMAT_R32G32_FLOAT,
+		offsetof(VertexShadingCompressed, tangent), DXGI_FORMAT_R16G16_SNORM },
+	{ "TEXCOORD", VertexStreams::shadingSlot, offsetof(VertexShading, uv), DXGI_FORMAT_R32G32_FLOAT,
+		offsetof(VertexShadingCompressed, uv), DXGI_FORMAT_R16G16_FLOAT },
+	{ "BONEINDICES", VertexStreams::skinSlot, offsetof(VertexSkin, boneIndices), DXGI_FORMAT_R32G32B32A32_UINT,
+		offsetof(VertexSkinCompressed, boneIndices), DXGI_FORMAT_R8G8B8A8_UINT },
+	{ "WEIGHTS", VertexStreams::skinSlot, offsetof(VertexSkin, weights), DXGI_FORMAT_R32G32B32_FLOAT,
+		offsetof(VertexSkinCompressed, weights), DXGI_FORMAT_R16G16B16A16_UNORM },
+};
+
 //Ref:https://rtarun9.github.io/blogs/shader_reflection/
 //Ref:https://takinginitiative.net/2011/12/11/directx-1011-basic-shader-reflection-automatic-input-layout-creation/
+//Semantics are looked up in streamElements for their slot, offset and format. One layout is made per VertexFormat,
+//the shaders see the same types either way.
 void VertexShader::CreateInputLayoutDescFromVertexShaderSignature()
 {
 	ID3D11ShaderReflection* pReflector = NULL;
@@ -32,50 +63,49 @@ void VertexShader::CreateInputLayoutDescFromVertexShaderSignature()
 	D3D11_SHADER_DESC shaderDesc = {};
 	pReflector->GetDesc(&shaderDesc);
 
-	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
-	for (UINT i = 0; i < shaderDesc.InputParameters; i++)
+	const VertexFormat formats[] = { VertexFormat::Full, VertexFormat::Compressed };
+	for (const VertexFormat format : formats)
 	{
-		D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
-		pReflector->GetInputParameterDesc(i, &paramDesc);
+		std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
+		for (UINT i = 0; i < shaderDesc.InputParameters; i++)
+		{
+			D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
+			pReflector->GetInputParameterDesc(i, &paramDesc);
 
-		D3D11_INPUT_ELEMENT_DESC elementDesc = {};
-		elementDesc.SemanticName = paramDesc.SemanticName;
-		elementDesc.SemanticIndex = paramDesc.SemanticIndex;
-		elementDesc.InputSlot = 0;
-		elementDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-		elementDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-		elementDesc.InstanceDataStepRate = 0;
+			//SV_InstanceID and the like are generated by the input assembler
+			if (paramDesc.SystemValueType != D3D_NAME_UNDEFINED)
+			{
+				continue;
+			}
 
-		if (paramDesc.Mask == 1)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 3)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 7)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 15)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			D3D11_INPUT_ELEMENT_DESC elementDesc = {};
+			elementDesc.SemanticName = paramDesc.SemanticName;
+			elementDesc.SemanticIndex = paramDesc.SemanticIndex;
+			elementDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+			elementDesc.InstanceDataStepRate = 0;
+
+			bool foundStreamElement = false;
+			for (const auto& streamElement : streamElements)
+			{
+				if (_stricmp(streamElement.semanticName, paramDesc.SemanticName) == 0)
+				{
+					elementDesc.InputSlot = streamElement.inputSlot;
+					const bool compressed = format == VertexFormat::Compressed;
+					elementDesc.AlignedByteOffset = compressed ? streamElement.compressedOffset : streamElement.fullOffset;
+					elementDesc.Format = compressed ? streamElement.compressedFormat : streamElement.fullFormat;
+					foundStreamElement = true;
+					break;
+				}
+			}
+
+			assert(foundStreamElement && "Vertex shader input semantic isn't in any vertex stream.");
+
+			inputLayoutDesc.push_back(elementDesc);
 		}
 
-		inputLayoutDesc.push_back(elementDesc);
+		HR(Renderer::GetDevice().CreateInputLayout(inputLayoutDesc.data(), inputLayoutDesc.size(), GetByteCodeData(),
+			GetByteCodeSize(), inputLayouts[static_cast<int>(format)].ReleaseAndGetAddressOf()));
 	}
 
-	HR(Renderer::GetDevice().CreateInputLayout(&inputLayoutDesc[0], inputLayoutDesc.size(), GetByteCodeData(), GetByteCodeSize(), inputLayout.GetAddressOf()));
-
 	pReflector->Release();
 }
-
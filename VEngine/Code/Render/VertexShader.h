@@ -2,6 +2,7 @@
 
 #include <wrl.h>
 #include "Shader.h"
+#include "VertexStreams.h"
 
 struct ID3D11VertexShader;
 struct ID3D11InputLayout;
@@ -15,11 +16,14 @@ public:
 	ID3D11VertexShader* GetShader() { return shader.Get(); }
 	ID3D11VertexShader** GetShaderAddress() { return shader.GetAddressOf(); }
 
-	ID3D11InputLayout* GetInputLayout() const { return inputLayout.Get(); }
+	ID3D11InputLayout* GetInputLayout(VertexFormat format = VertexFormat::Full) const
+	{
+		return inputLayouts[static_cast<int>(format)].Get();
+	}
 
 private:
 	void CreateInputLayoutDescFromVertexShaderSignature();
 
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> shader;
-	Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayouts[2]; //Indexed by VertexFormat
 };
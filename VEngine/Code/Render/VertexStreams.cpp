@@ -0,0 +1,288 @@
+#include "vpch.h"
+#include "VertexStreams.h"
+#include <algorithm>
+#include <cmath>
+#include <DirectXPackedVector.h>
+#include "Vertex.h"
+
+using namespace DirectX;
+
+static_assert(sizeof(VertexShading) == 40, "VertexShading layout is read by the shader input layouts");
+static_assert(sizeof(VertexShadingCompressed) == 16, "VertexShadingCompressed layout is read by the shader input layouts");
+static_assert(sizeof(VertexSkin) == 28, "VertexSkin layout is read by the shader input layouts");
+static_assert(sizeof(VertexSkinCompressed) == 12, "VertexSkinCompressed layout is read by the shader input layouts");
+
+static int16_t PackSnorm16(float value)
+{
+	value = std::clamp(value, -1.f, 1.f);
+	return static_cast<int16_t>(std::round(value * 32767.f));
+}
+
+static float UnpackSnorm16(int16_t value)
+{
+	return std::max(static_cast<float>(value) / 32767.f, -1.f);
+}
+
+static uint8_t PackUnorm8(float value)
+{
+	return static_cast<uint8_t>(std::round(std::clamp(value, 0.f, 1.f) * 255.f));
+}
+
+static uint16_t PackUnorm16(float value)
+{
+	return static_cast<uint16_t>(std::round(std::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+uint32_t VertexStreams::GetShadingStride(VertexFormat format)
+{
+	return format == VertexFormat::Compressed ? sizeof(VertexShadingCompressed) : sizeof(VertexShading);
+}
+
+uint32_t VertexStreams::GetSkinStride(VertexFormat format)
+{
+	return format == VertexFormat::Compressed ? sizeof(VertexSkinCompressed) : sizeof(VertexSkin);
+}
+
+//Ref: http://jcgt.org/published/0003/02/01/ (A Survey of Efficient Representations for Independent Unit Vectors)
+XMFLOAT2 VertexStreams::EncodeOctahedral(XMFLOAT3 direction)
+{
+	const float l1Norm = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+	if (l1Norm == 0.f)
+	{
+		return XMFLOAT2(0.f, 0.f);
+	}
+
+	float x = direction.x / l1Norm;
+	float y = direction.y / l1Norm;
+
+	//Fold the lower hemisphere over the diagonals
+	if (direction.z < 0.f)
+	{
+		const float foldedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+		const float foldedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+		x = foldedX;
+		y = foldedY;
+	}
+
+	return XMFLOAT2(x, y);
+}
+
+XMFLOAT3 VertexStreams::DecodeOctahedral(XMFLOAT2 encoded)
+{
+	XMFLOAT3 direction(encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y));
+
+	const float t = std::max(-direction.z, 0.f);
+	direction.x += direction.x >= 0.f ? -t : t;
+	direction.y += direction.y >= 0.f ? -t : t;
+
+	XMStoreFloat3(&direction, XMVector3Normalize(XMLoadFloat3(&direction)));
+	return direction;
+}
+
+void VertexStreams::EncodeInto(ArrayView<Vertex> vertices, VertexFormat format,
+	XMFLOAT3* positions, uint8_t* shading, uint8_t* skin)
+{
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const Vertex& vertex = vertices[i];
+
+		positions[i] = vertex.pos;
+
+		const XMFLOAT2 normal = EncodeOctahedral(vertex.normal);
+		const XMFLOAT2 tangent = EncodeOctahedral(vertex.tangent);
+
+		if (format == VertexFormat::Compressed)
+		{
+			auto& packedShading = reinterpret_cast<VertexShadingCompressed*>(shading)[i];
+			packedShading.colour[0] = PackUnorm8(vertex.colour.x);
+			packedShading.colour[1] = PackUnorm8(vertex.colour.y);
+			packedShading.colour[2] = PackUnorm8(vertex.colour.z);
+			packedShading.colour[3] = PackUnorm8(vertex.colour.w);
+			packedShading.normal[0] = PackSnorm16(normal.x);
+			packedShading.normal[1] = PackSnorm16(normal.y);
+			packedShading.tangent[0] = PackSnorm16(tangent.x);
+			packedShading.tangent[1] = PackSnorm16(tangent.y);
+			packedShading.uv[0] = PackedVector::XMConvertFloatToHalf(vertex.uv.x);
+			packedShading.uv[1] = PackedVector::XMConvertFloatToHalf(vertex.uv.y);
+
+			if (skin)
+			{
+				auto& packedSkin = reinterpret_cast<VertexSkinCompressed*>(skin)[i];
+				for (int boneIndex = 0; boneIndex < 4; boneIndex++)
+				{
+					assert(vertex.boneIndices[boneIndex] <= UINT8_MAX && "Compressed vertices only index 256 joints.");
+					packedSkin.boneIndices[boneIndex] = static_cast<uint8_t>(vertex.boneIndices[boneIndex]);
+				}
+				for (int weightIndex = 0; weightIndex < 3; weightIndex++)
+				{
+					packedSkin.weights[weightIndex] = PackUnorm16(vertex.weights[weightIndex]);
+				}
+				packedSkin.weights[3] = 0;
+			}
+		}
+		else
+		{
+			auto& fullShading = reinterpret_cast<VertexShading*>(shading)[i];
+			fullShading.colour = vertex.colour;
+			fullShading.normal = normal;
+			fullShading.tangent = tangent;
+			fullShading.uv = vertex.uv;
+
+			if (skin)
+			{
+				auto& fullSkin = reinterpret_cast<VertexSkin*>(skin)[i];
+				memcpy(fullSkin.boneIndices, vertex.boneIndices, sizeof(fullSkin.boneIndices));
+				memcpy(fullSkin.weights, vertex.weights, sizeof(fullSkin.weights));
+			}
+		}
+	}
+}
+
+void VertexStreams::Encode(ArrayView<Vertex> vertices, VertexFormat format_, bool includeSkin)
+{
+	format = format_;
+
+	positionStorage.resize(vertices.size());
+	shadingStorage.resize(vertices.size() * GetShadingStride(format));
+	skinStorage.resize(includeSkin ? vertices.size() * GetSkinStride(format) : 0);
+
+	externalPositions = ArrayView<XMFLOAT3>();
+	externalShading = nullptr;
+	externalSkin = nullptr;
+
+	EncodeInto(vertices, format, positionStorage.data(), shadingStorage.data(),
+		includeSkin ? skinStorage.data() : nullptr);
+}
+
+void VertexStreams::SetExternal(VertexFormat format_, ArrayView<XMFLOAT3> positions,
+	const uint8_t* shading, const uint8_t* skin)
+{
+	format = format_;
+
+	positionStorage.clear();
+	shadingStorage.clear();
+	skinStorage.clear();
+
+	externalPositions = positions;
+	externalShading = shading;
+	externalSkin = skin;
+}
+
+void VertexStreams::CopyExternalToStorage()
+{
+	if (externalPositions.empty())
+	{
+		return;
+	}
+
+	const size_t vertexCount = externalPositions.size();
+	positionStorage = externalPositions.ToVector();
+	shadingStorage.assign(externalShading, externalShading + vertexCount * GetShadingStride(format));
+	if (externalSkin)
+	{
+		skinStorage.assign(externalSkin, externalSkin + vertexCount * GetSkinStride(format));
+	}
+
+	externalPositions = ArrayView<XMFLOAT3>();
+	externalShading = nullptr;
+	externalSkin = nullptr;
+}
+
+size_t VertexStreams::GetByteWidth() const
+{
+	const size_t vertexCount = GetVertexCount();
+	size_t byteWidth = vertexCount * (sizeof(XMFLOAT3) + GetShadingStride(format));
+	if (HasSkin())
+	{
+		byteWidth += vertexCount * GetSkinStride(format);
+	}
+	return byteWidth;
+}
+
+XMFLOAT3 VertexStreams::GetNormal(size_t index) const
+{
+	XMFLOAT2 encoded;
+	if (format == VertexFormat::Compressed)
+	{
+		const auto& packedShading = reinterpret_cast<const VertexShadingCompressed*>(GetShading())[index];
+		encoded = XMFLOAT2(UnpackSnorm16(packedShading.normal[0]), UnpackSnorm16(packedShading.normal[1]));
+	}
+	else
+	{
+		encoded = reinterpret_cast<const VertexShading*>(GetShading())[index].normal;
+	}
+	return DecodeOctahedral(encoded);
+}
+
+XMFLOAT4 VertexStreams::GetColour(size_t index) const
+{
+	if (format == VertexFormat::Compressed)
+	{
+		const auto& packedShading = reinterpret_cast<const VertexShadingCompressed*>(GetShading())[index];
+		return XMFLOAT4(packedShading.colour[0] / 255.f, packedShading.colour[1] / 255.f,
+			packedShading.colour[2] / 255.f, packedShading.colour[3] / 255.f);
+	}
+	return reinterpret_cast<const VertexShading*>(GetShading())[index].colour;
+}
+
+XMFLOAT2 VertexStreams::GetUV(size_t index) const
+{
+	if (format == VertexFormat::Compressed)
+	{
+		const auto& packedShading = reinterpret_cast<const VertexShadingCompressed*>(GetShading())[index];
+		return XMFLOAT2(PackedVector::XMConvertHalfToFloat(packedShading.uv[0]),
+			PackedVector::XMConvertHalfToFloat(packedShading.uv[1]));
+	}
+	return reinterpret_cast<const VertexShading*>(GetShading())[index].uv;
+}
+
+void VertexStreams::DecodeVertex(size_t index, Vertex& vertex) const
+{
+	vertex.pos = GetPositions()[index];
+	vertex.colour = GetColour(index);
+	vertex.normal = GetNormal(index);
+	vertex.uv = GetUV(index);
+
+	const uint8_t* skin = GetSkin();
+
+	if (format == VertexFormat::Compressed)
+	{
+		const auto& packedShading = reinterpret_cast<const VertexShadingCompressed*>(GetShading())[index];
+		vertex.tangent = DecodeOctahedral(XMFLOAT2(UnpackSnorm16(packedShading.tangent[0]),
+			UnpackSnorm16(packedShading.tangent[1])));
+
+		if (skin)
+		{
+			const auto& packedSkin = reinterpret_cast<const VertexSkinCompressed*>(skin)[index];
+			for (int i = 0; i < 4; i++)
+			{
+				vertex.boneIndices[i] = packedSkin.boneIndices[i];
+			}
+			for (int i = 0; i < 3; i++)
+			{
+				vertex.weights[i] = packedSkin.weights[i] / 65535.f;
+			}
+		}
+	}
+	else
+	{
+		const auto& fullShading = reinterpret_cast<const VertexShading*>(GetShading())[index];
+		vertex.tangent = DecodeOctahedral(fullShading.tangent);
+
+		if (skin)
+		{
+			const auto& fullSkin = reinterpret_cast<const VertexSkin*>(skin)[index];
+			memcpy(vertex.boneIndices, fullSkin.boneIndices, sizeof(vertex.boneIndices));
+			memcpy(vertex.weights, fullSkin.weights, sizeof(vertex.weights));
+		}
+	}
+}
+
+void VertexStreams::Decode(std::vector<Vertex>& vertices) const
+{
+	vertices.resize(GetVertexCount());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		DecodeVertex(i, vertices[i]);
+	}
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "Core/ArrayView.h"
+
+struct Vertex;
+
+//Meshes are rendered from up to three vertex buffers instead of one interleaved Vertex array:
+//positions (slot 0), shading attributes (slot 1) and bone indices/weights (slot 2, skinned meshes only).
+//Raycasts and bounds only touch the position stream, and static meshes don't pay for skinning data.
+//Vertex stays the editing format for painting, slicing and importing.
+
+enum class VertexFormat : uint8_t
+{
+	Full,
+	//Colour as RGBA8, normals/tangents as 16 bit octahedral, half float UVs, 8 bit bone indices and
+	//16 bit weights. Half UVs lose precision past a few repeats, so it's opt-in per mesh.
+	Compressed
+};
+
+//Normals and tangents are octahedral encoded in both formats so the shaders have a single input layout.
+struct VertexShading
+{
+	DirectX::XMFLOAT4 colour = DirectX::XMFLOAT4(1.f, 1.f, 1.f, 1.f);
+	DirectX::XMFLOAT2 normal = DirectX::XMFLOAT2(0.f, 0.f);
+	DirectX::XMFLOAT2 tangent = DirectX::XMFLOAT2(0.f, 0.f);
+	DirectX::XMFLOAT2 uv = DirectX::XMFLOAT2(0.f, 0.f);
+};
+
+struct VertexShadingCompressed
+{
+	uint8_t colour[4]{};
+	int16_t normal[2]{};
+	int16_t tangent[2]{};
+	uint16_t uv[2]{}; //Half floats
+};
+
+struct VertexSkin
+{
+	uint32_t boneIndices[4]{};
+	float weights[3]{};
+};
+
+struct VertexSkinCompressed
+{
+	uint8_t boneIndices[4]{};
+	uint16_t weights[4]{}; //Last one is padding, the shaders rebuild it from the other three.
+};
+
+struct VertexStreams
+{
+	static const uint32_t positionSlot = 0;
+	static const uint32_t shadingSlot = 1;
+	static const uint32_t skinSlot = 2;
+	static const uint32_t maxStreams = 3;
+
+	static uint32_t GetShadingStride(VertexFormat format);
+	static uint32_t GetSkinStride(VertexFormat format);
+
+	//Writes vertices into caller owned stream memory (e.g. a mapped dynamic buffer). skin can be null.
+	static void EncodeInto(ArrayView<Vertex> vertices, VertexFormat format,
+		DirectX::XMFLOAT3* positions, uint8_t* shading, uint8_t* skin);
+
+	static DirectX::XMFLOAT2 EncodeOctahedral(DirectX::XMFLOAT3 direction);
+	static DirectX::XMFLOAT3 DecodeOctahedral(DirectX::XMFLOAT2 encoded);
+
+	//Encodes into memory owned by this struct.
+	void Encode(ArrayView<Vertex> vertices, VertexFormat format_, bool includeSkin);
+
+	//Points the streams at memory owned elsewhere (a memory-mapped .vmesh), nothing is copied.
+	void SetExternal(VertexFormat format_, ArrayView<DirectX::XMFLOAT3> positions,
+		const uint8_t* shading, const uint8_t* skin);
+
+	//Copies external streams into memory owned by this struct, so whatever they pointed at can be released.
+	void CopyExternalToStorage();
+
+	VertexFormat GetFormat() const { return format; }
+	size_t GetVertexCount() const { return GetPositions().size(); }
+	bool Empty() const { return GetVertexCount() == 0; }
+	bool HasSkin() const { return GetSkin() != nullptr; }
+
+	ArrayView<DirectX::XMFLOAT3> GetPositions() const
+	{
+		return positionStorage.empty() ? externalPositions : ArrayView<DirectX::XMFLOAT3>(positionStorage);
+	}
+	const uint8_t* GetShading() const { return shadingStorage.empty() ? externalShading : shadingStorage.data(); }
+	const uint8_t* GetSkin() const { return skinStorage.empty() ? externalSkin : skinStorage.data(); }
+
+	//Size of all streams together, what a GPU upload of the mesh costs.
+	size_t GetByteWidth() const;
+
+	//Single attribute reads that don't need the whole Vertex decoded. Safe from worker threads.
+	DirectX::XMFLOAT3 GetNormal(size_t index) const;
+	DirectX::XMFLOAT4 GetColour(size_t index) const;
+	DirectX::XMFLOAT2 GetUV(size_t index) const;
+
+	void DecodeVertex(size_t index, Vertex& vertex) const;
+	void Decode(std::vector<Vertex>& vertices) const;
+
+private:
+	VertexFormat format = VertexFormat::Full;
+
+	std::vector<DirectX::XMFLOAT3> positionStorage;
+	std::vector<uint8_t> shadingStorage;
+	std::vector<uint8_t> skinStorage;
+
+	ArrayView<DirectX::XMFLOAT3> externalPositions;
+	const uint8_t* externalShading = nullptr;
+	const uint8_t* externalSkin = nullptr;
+};